@@ -129,7 +129,16 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // `art` is what the parser fills in when there is no USING clause; it is served by a B+ tree here
+  std::string index_type = stmt->accessMethod == nullptr ? "btree" : StringUtil::Lower(stmt->accessMethod);
+  if (index_type == "art") {
+    index_type = "btree";
+  }
+  if (index_type != "btree" && index_type != "hash") {
+    throw NotImplementedException(fmt::format("index type {} is not supported", index_type));
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), std::move(index_type));
 }
 
 }  // namespace bustub
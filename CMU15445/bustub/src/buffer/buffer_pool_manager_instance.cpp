@@ -12,6 +12,12 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <new>
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
 #include "common/logger.h"
 #include "common/macros.h"
@@ -20,11 +26,34 @@ namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
                                                      LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(instance_index),
+      frame_arena_(pool_size, buffer_pool_huge_pages, buffer_pool_numa_policy, instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      io_in_progress_(pool_size),
+      io_cv_(pool_size),
+      scan_ring_size_(std::min<size_t>(SCAN_RING_SIZE, std::max<size_t>(pool_size / 4, 1))),
+      in_scan_ring_(pool_size) {
+  BUSTUB_ASSERT(num_instances > 0, "num_instances must be positive");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "instance_index must be below num_instances; 0 for a standalone instance");
+  // we allocate a consecutive memory space for the book-keeping of the buffer pool, the data is in the arena
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_.FrameData(static_cast<frame_id_t>(i)));
+    pages_[i].pin_count_ = FRAME_CLAIMED;
+  }
+  page_table_ = new PageTable(pool_size_);
   replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  scan_ring_.reserve(scan_ring_size_);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -38,61 +67,188 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopPageCleaner();
+  {
+    // The I/O threads of the disk manager still write into our frames until every prefetch has completed.
+    std::unique_lock lock(latch_);
+    prefetch_cv_.wait(lock, [&] { return prefetches_in_flight_ == 0; });
+  }
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+void BufferPoolManagerInstance::StartPageCleaner(size_t clean_target) {
+  std::scoped_lock thread_lock(cleaner_thread_latch_);
   std::scoped_lock lock(latch_);
+  clean_target_ = std::min(clean_target, pool_size_);
+  if (!cleaner_running_) {
+    cleaner_stop_ = false;
+    cleaner_running_ = true;
+    page_cleaner_ = std::thread([this] { PageCleanerMain(); });
+  }
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  // page_cleaner_ itself is only touched under cleaner_thread_latch_; evictions look at cleaner_running_ instead
+  std::scoped_lock thread_lock(cleaner_thread_latch_);
+  {
+    std::scoped_lock lock(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
+    cleaner_stop_ = true;
+  }
+  cleaner_cv_.notify_one();
+  page_cleaner_.join();
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  std::unique_lock lock(latch_);
   Page *page = nullptr;
   frame_id_t frame_id;
-  if (!GetAvailableFrame(&frame_id)) {
+  page_id_t write_back_page_id;
+  if (!GetAvailableFrame(&frame_id, &write_back_page_id)) {
     return nullptr;
   }
   page = &pages_[frame_id];
+  in_scan_ring_[frame_id] = false;
   page->page_id_ = AllocatePage();
-  // by default is_dirty is false
-  // page->is_dirty_ = false;
   page->pin_count_ = 1;
-  page->ResetMemory();
   page_table_->Insert(page->GetPageId(), frame_id);
   *page_id = page->GetPageId();
   replacer_->RecordAccess(frame_id);
   replacer_->SetEvictable(frame_id, false);
+
+  if (write_back_page_id == INVALID_PAGE_ID) {
+    page->ResetMemory();
+    return page;
+  }
+  io_in_progress_[frame_id] = true;
+  lock.unlock();
+  disk_manager_->WritePage(write_back_page_id, page->GetData());
+  page->ResetMemory();
+  lock.lock();
+  FinishFrameIo(frame_id, write_back_page_id);
   return page;
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock lock(latch_);
-
-  Page *page = nullptr;
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * {
   frame_id_t frame_id;
-
   if (page_table_->Find(page_id, frame_id)) {
-    // LOG_INFO("###### . I get here ############");
-    page = &pages_[frame_id];
-    page->pin_count_++;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    // replacer_->SetEvictable(frame_id, false);
-    return page;
+    Page *page = FetchHit(page_id, frame_id, access_type);
+    if (page != nullptr) {
+      return page;
+    }
   }
 
-  if (!GetAvailableFrame(&frame_id)) {
-    return nullptr;
+  std::unique_lock lock(latch_);
+  Page *page = nullptr;
+  while (true) {
+    if (page_table_->Find(page_id, frame_id)) {
+      page = &pages_[frame_id];
+      page->pin_count_++;
+      if (access_type != AccessType::Scan) {
+        in_scan_ring_[frame_id] = false;
+      }
+      replacer_->RecordAccess(frame_id, access_type);
+      replacer_->SetEvictable(frame_id, false);
+      // Another thread may still be loading the page. It is pinned now, so it stays in this frame while we wait.
+      io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+      return page;
+    }
+    // If the page was just evicted and is still being written back, reading it now would see a stale copy.
+    auto write_back = write_back_table_.find(page_id);
+    if (write_back == write_back_table_.end()) {
+      break;
+    }
+    io_cv_[write_back->second].wait(lock);
+  }
+
+  page_id_t write_back_page_id;
+  if (access_type == AccessType::Scan) {
+    if (!GetScanFrame(&frame_id, &write_back_page_id)) {
+      return nullptr;
+    }
+  } else {
+    if (!GetAvailableFrame(&frame_id, &write_back_page_id)) {
+      return nullptr;
+    }
+    in_scan_ring_[frame_id] = false;
   }
 
+  // Fetchers of this page find it in the page table and wait on the frame; everyone else goes ahead without us.
+  io_in_progress_[frame_id] = true;
   page = &pages_[frame_id];
   page->page_id_ = page_id;
   page->is_dirty_ = false;
   page->pin_count_ = 1;
+  page_table_->Insert(page->GetPageId(), frame_id);
+  replacer_->RecordAccess(frame_id, access_type);
+  replacer_->SetEvictable(frame_id, false);
+  lock.unlock();
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    disk_manager_->WritePage(write_back_page_id, page->GetData());
+  }
   disk_manager_->ReadPage(page_id, page->GetData());
+  lock.lock();
+  FinishFrameIo(frame_id, write_back_page_id);
+  return page;
+}
 
+void BufferPoolManagerInstance::PrefetchPgImp(page_id_t page_id, AccessType access_type) {
+  std::unique_lock lock(latch_);
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || page_table_->Find(page_id, frame_id) || write_back_table_.count(page_id) > 0) {
+    return;
+  }
+
+  page_id_t write_back_page_id;
+  if (access_type == AccessType::Scan) {
+    if (!GetScanFrame(&frame_id, &write_back_page_id)) {
+      return;
+    }
+  } else {
+    if (!GetAvailableFrame(&frame_id, &write_back_page_id)) {
+      return;
+    }
+    in_scan_ring_[frame_id] = false;
+  }
+
+  io_in_progress_[frame_id] = true;
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->pin_count_ = 1;
   page_table_->Insert(page->GetPageId(), frame_id);
-  replacer_->RecordAccess(frame_id);
+  replacer_->RecordAccess(frame_id, access_type);
   replacer_->SetEvictable(frame_id, false);
-  return page;
+  prefetches_in_flight_++;
+  lock.unlock();
+
+  auto finish_read = [this, page, frame_id, write_back_page_id] {
+    std::scoped_lock lock(latch_);
+    FinishFrameIo(frame_id, write_back_page_id);
+    page->pin_count_--;
+    if (page->GetPinCount() == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+    if (--prefetches_in_flight_ == 0) {
+      prefetch_cv_.notify_all();
+    }
+  };
+  DiskRequest read{false, page_id, page->GetData(), std::move(finish_read)};
+  if (write_back_page_id == INVALID_PAGE_ID) {
+    disk_manager_->SubmitRequests({std::move(read)});
+    return;
+  }
+  // The read may only start once the old contents of the frame are on disk.
+  auto submit_read = [this, read = std::move(read)] { disk_manager_->SubmitRequests({read}); };
+  disk_manager_->SubmitRequests({DiskRequest{true, write_back_page_id, page->GetData(), std::move(submit_read)}});
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
@@ -100,8 +256,6 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
   Page *page = nullptr;
   frame_id_t frame_id;
 
-  // LOG_INFO("i REACHED HERE BRO");
-
   if (!page_table_->Find(page_id, frame_id)) {
     return false;
   }
@@ -125,45 +279,73 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock lock(latch_);
+  std::unique_lock lock(latch_);
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id) || page_id == INVALID_PAGE_ID) {
+  if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, frame_id)) {
     return false;
   }
+  Page *page = &pages_[frame_id];
 
-  disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].data_);
-  pages_[frame_id].is_dirty_ = false;
+  // Pin the page so that it cannot be evicted while the latch is released for the write.
+  page->pin_count_++;
+  replacer_->SetEvictable(frame_id, false);
+  io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+  // Clear the flag before writing, so that an unpin with is_dirty during the write is not lost.
+  page->is_dirty_ = false;
+  lock.unlock();
+  disk_manager_->WritePage(page_id, page->GetData());
+  lock.lock();
+  page->pin_count_--;
+  if (page->GetPinCount() == 0) {
+    replacer_->SetEvictable(frame_id, true);
+  }
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
+  WriteDirtyPages();
+  // Flushing the whole pool is what a checkpoint does, so this is where the writes are made durable.
+  disk_manager_->Sync();
+}
+
+void BufferPoolManagerInstance::WriteDirtyPages() {
+  std::unique_lock lock(latch_);
+  // Pin every dirty page so that it stays in its frame, then let the I/O already running on those frames finish.
+  std::vector<frame_id_t> frames;
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
-      disk_manager_->WritePage(pages_[i].page_id_, pages_[i].data_);
-      pages_[i].is_dirty_ = false;
-    }
-  }
-  // for (auto &item : page_table_->GetItems()) {
-  //   for (const auto &[page_id, frame_id] : item->GetItems()) {
-  //     Page *page = &pages_[frame_id];
-  //     disk_manager_->WritePage(page->GetPageId(), page->GetData());
-  //     page->is_dirty_ = false;
-  //   }
-  // }
-}
-/**
- * TODO(P1): Add implementation
- *
- * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
- * page is pinned and cannot be deleted, return false immediately.
- *
- * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
- * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
- * imitate freeing the page on the disk.
- *
- * @param page_id id of page to be deleted
- * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
- */
+    auto frame_id = static_cast<frame_id_t>(i);
+    Page *page = &pages_[frame_id];
+    if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_) {
+      page->pin_count_++;
+      replacer_->SetEvictable(frame_id, false);
+      frames.push_back(frame_id);
+    }
+  }
+  for (auto frame_id : frames) {
+    io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+  }
+
+  // All the writes go to the disk manager as one batch instead of one after the other.
+  std::vector<DiskRequest> requests;
+  requests.reserve(frames.size());
+  for (auto frame_id : frames) {
+    Page *page = &pages_[frame_id];
+    // Clear the flag before writing, so that an unpin with is_dirty during the write is not lost.
+    page->is_dirty_ = false;
+    requests.push_back(DiskRequest{true, page->page_id_, page->GetData(), nullptr});
+  }
+  lock.unlock();
+  disk_manager_->RunRequests(std::move(requests));
+  lock.lock();
+
+  for (auto frame_id : frames) {
+    Page *page = &pages_[frame_id];
+    page->pin_count_--;
+    if (page->GetPinCount() == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
+}
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   std::scoped_lock lock(latch_);
@@ -174,43 +356,193 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   }
   page = &pages_[frame_id];
 
-  if (page->GetPinCount() != 0) {
+  // The frame goes to the free list claimed, so that hits which looked the page up just before it is removed back off.
+  if (!ClaimFrame(frame_id)) {
     return false;
   }
-  if (page->IsDirty()) {
-    disk_manager_->WritePage(page->GetPageId(), page->GetData());
-  }
 
-  page->pin_count_ = 0;
+  // The page is gone for good, so there is no point in writing it back even if it is dirty.
+  page_table_->Remove(page_id);
+  replacer_->Remove(frame_id);
+  in_scan_ring_[frame_id] = false;
   page->is_dirty_ = false;
   page->ResetMemory();
   page->page_id_ = INVALID_PAGE_ID;
-  page_table_->Remove(page->GetPageId());
-  replacer_->Remove(frame_id);
   free_list_.push_back(frame_id);
   DeallocatePage(page_id);
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  const page_id_t next_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
-auto BufferPoolManagerInstance::GetAvailableFrame(frame_id_t *out_frame_id) -> bool {
+auto BufferPoolManagerInstance::GetAvailableFrame(frame_id_t *out_frame_id, page_id_t *write_back_page_id) -> bool {
   frame_id_t fid;
+  *write_back_page_id = INVALID_PAGE_ID;
   if (!free_list_.empty()) {
     fid = free_list_.front();
     free_list_.pop_front();
     *out_frame_id = fid;
     return true;
   }
-  if (replacer_->Evict(&fid)) {
-    if (pages_[fid].is_dirty_) {
-      disk_manager_->WritePage(pages_[fid].page_id_, pages_[fid].data_);
-      pages_[fid].is_dirty_ = false;
-    }
-    page_table_->Remove(pages_[fid].page_id_);
+  if (replacer_->Evict(&fid, [this](frame_id_t frame_id) { return ClaimFrame(frame_id); })) {
+    EvictFrame(fid, write_back_page_id);
     *out_frame_id = fid;
     return true;
   }
   return false;
 }
+
+auto BufferPoolManagerInstance::GetScanFrame(frame_id_t *out_frame_id, page_id_t *write_back_page_id) -> bool {
+  frame_id_t fid;
+  if (scan_ring_.size() < scan_ring_size_) {
+    if (!GetAvailableFrame(&fid, write_back_page_id)) {
+      return false;
+    }
+    // The replacer prefers scan pages, so the victim may already be in the ring.
+    if (!in_scan_ring_[fid]) {
+      scan_ring_.push_back(fid);
+      in_scan_ring_[fid] = true;
+    }
+    *out_frame_id = fid;
+    return true;
+  }
+
+  size_t slot = scan_ring_next_;
+  scan_ring_next_ = (scan_ring_next_ + 1) % scan_ring_.size();
+  fid = scan_ring_[slot];
+  if (in_scan_ring_[fid] && ClaimFrame(fid)) {
+    replacer_->Remove(fid);
+    EvictFrame(fid, write_back_page_id);
+    *out_frame_id = fid;
+    return true;
+  }
+
+  // The frame in this slot is pinned or has become part of the regular working set: leave it alone.
+  if (!GetAvailableFrame(&fid, write_back_page_id)) {
+    return false;
+  }
+  in_scan_ring_[scan_ring_[slot]] = false;
+  if (!in_scan_ring_[fid]) {
+    scan_ring_[slot] = fid;
+    in_scan_ring_[fid] = true;
+  }
+  *out_frame_id = fid;
+  return true;
+}
+
+auto BufferPoolManagerInstance::FetchHit(page_id_t page_id, frame_id_t frame_id, AccessType access_type) -> Page * {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  while (pin_count != FRAME_CLAIMED && !page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+  }
+  if (pin_count == FRAME_CLAIMED) {
+    return nullptr;
+  }
+  if (page->page_id_ != page_id) {
+    // The frame went to another page between the lookup and the pin. That page may be unpinned by now, in which case
+    // an eviction may have found it pinned by us and taken it out of the replacer.
+    std::scoped_lock lock(latch_);
+    page->pin_count_--;
+    if (page->GetPinCount() == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+    return nullptr;
+  }
+
+  // The pin keeps the frame from being claimed, so the page stays here from now on.
+  if (access_type != AccessType::Scan) {
+    in_scan_ring_[frame_id] = false;
+  }
+  replacer_->RecordAccess(frame_id, access_type);
+  replacer_->SetEvictable(frame_id, false);
+  if (io_in_progress_[frame_id]) {
+    // Another thread is still loading the page.
+    std::unique_lock lock(latch_);
+    io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) -> bool {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, FRAME_CLAIMED);
+}
+
+void BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id, page_id_t *write_back_page_id) {
+  Page *page = &pages_[frame_id];
+  *write_back_page_id = INVALID_PAGE_ID;
+  if (page->is_dirty_) {
+    *write_back_page_id = page->page_id_;
+    write_back_table_.emplace(page->page_id_, frame_id);
+    page->is_dirty_ = false;
+    foreground_write_backs_++;
+    if (cleaner_running_) {
+      // The cleaner has fallen behind: let it catch up instead of waiting for its next round.
+      cleaner_wakeup_ = true;
+      cleaner_cv_.notify_one();
+    }
+  }
+  page_table_->Remove(page->page_id_);
+}
+
+void BufferPoolManagerInstance::FinishFrameIo(frame_id_t frame_id, page_id_t write_back_page_id) {
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    write_back_table_.erase(write_back_page_id);
+  }
+  io_in_progress_[frame_id] = false;
+  io_cv_[frame_id].notify_all();
+}
+
+void BufferPoolManagerInstance::PageCleanerMain() {
+  std::unique_lock lock(latch_);
+  while (!cleaner_stop_) {
+    std::vector<frame_id_t> frames;
+    if (free_list_.size() < clean_target_) {
+      for (auto frame_id : replacer_->EvictionCandidates(clean_target_ - free_list_.size())) {
+        Page *page = &pages_[frame_id];
+        if (page->is_dirty_) {
+          page->pin_count_++;
+          replacer_->SetEvictable(frame_id, false);
+          frames.push_back(frame_id);
+        }
+      }
+    }
+    if (frames.empty()) {
+      cleaner_cv_.wait_for(lock, std::chrono::milliseconds(PAGE_CLEANER_INTERVAL_MS),
+                           [&] { return cleaner_stop_ || cleaner_wakeup_; });
+      cleaner_wakeup_ = false;
+      continue;
+    }
+
+    std::vector<DiskRequest> requests;
+    requests.reserve(frames.size());
+    for (auto frame_id : frames) {
+      Page *page = &pages_[frame_id];
+      // Clear the flag before writing, so that an unpin with is_dirty during the write is not lost.
+      page->is_dirty_ = false;
+      requests.push_back(DiskRequest{true, page->page_id_, page->GetData(), nullptr});
+    }
+    lock.unlock();
+    disk_manager_->RunRequests(std::move(requests));
+    lock.lock();
+    background_write_backs_ += frames.size();
+
+    for (auto frame_id : frames) {
+      Page *page = &pages_[frame_id];
+      page->pin_count_--;
+      if (page->GetPinCount() == 0) {
+        replacer_->SetEvictable(frame_id, true);
+      }
+    }
+  }
+}
+
 }  // namespace bustub
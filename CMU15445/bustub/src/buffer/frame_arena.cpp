@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#ifdef BUSTUB_HAVE_MBIND
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_MBIND
+namespace {
+
+/** @return the ids of the online NUMA nodes, parsed from a list like "0-3,6" */
+auto OnlineNumaNodes() -> std::vector<int> {
+  std::vector<int> nodes;
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string range;
+  while (std::getline(online, range, ',')) {
+    std::istringstream parser(range);
+    int first;
+    if (!(parser >> first)) {
+      continue;
+    }
+    int last = first;
+    if (parser.peek() == '-') {
+      parser.ignore();
+      parser >> last;
+    }
+    for (int node = first; node <= last; node++) {
+      nodes.push_back(node);
+    }
+  }
+  if (nodes.empty()) {
+    nodes.push_back(0);
+  }
+  return nodes;
+}
+
+auto SysMbind(void *addr, size_t len, int mode, const uint64_t *nodemask, size_t maxnode) -> long {  // NOLINT
+  return syscall(__NR_mbind, addr, len, mode, nodemask, maxnode, 0);
+}
+
+}  // namespace
+#endif
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages, NumaPolicy numa_policy, size_t shard_index)
+    : size_(std::max<size_t>(num_frames, 1) * BUSTUB_PAGE_SIZE) {
+  if (huge_pages) {
+    size_ = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    void *base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base != MAP_FAILED) {
+      base_ = static_cast<char *>(base);
+      backing_ = Backing::HugeTlb;
+    }
+#endif
+    if (base_ == nullptr && MapAligned()) {
+#ifdef MADV_HUGEPAGE
+      // No reserved huge pages: let khugepaged and the fault handler use transparent ones.
+      if (madvise(base_, size_, MADV_HUGEPAGE) == 0) {
+        backing_ = Backing::TransparentHugePages;
+      }
+#endif
+    }
+  } else {
+    void *base = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+      base_ = static_cast<char *>(base);
+#ifdef MADV_NOHUGEPAGE
+      // Keep THP in "always" mode from backing the arena anyway.
+      madvise(base_, size_, MADV_NOHUGEPAGE);
+#endif
+    }
+  }
+  if (base_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the buffer pool frames");
+  }
+  if (numa_policy != NumaPolicy::Default) {
+    BindToNodes(numa_policy, shard_index);
+  }
+}
+
+FrameArena::~FrameArena() { munmap(base_, size_); }
+
+auto FrameArena::MapAligned() -> bool {
+  size_t padded_size = size_ + HUGE_PAGE_SIZE;
+  void *base = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+  auto start = reinterpret_cast<uintptr_t>(base);
+  uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  if (aligned > start) {
+    munmap(base, aligned - start);
+  }
+  size_t tail = start + padded_size - (aligned + size_);
+  if (tail > 0) {
+    munmap(reinterpret_cast<void *>(aligned + size_), tail);
+  }
+  base_ = reinterpret_cast<char *>(aligned);
+  return true;
+}
+
+void FrameArena::BindToNodes(NumaPolicy numa_policy, size_t shard_index) {
+#ifdef BUSTUB_HAVE_MBIND
+  std::vector<int> nodes = OnlineNumaNodes();
+  if (nodes.size() < 2) {
+    return;
+  }
+  constexpr size_t bits_per_word = 64;
+  std::vector<uint64_t> nodemask(nodes.back() / bits_per_word + 1, 0);
+  int mode;
+  if (numa_policy == NumaPolicy::Interleave) {
+    for (int node : nodes) {
+      nodemask[node / bits_per_word] |= uint64_t{1} << (node % bits_per_word);
+    }
+    mode = MPOL_INTERLEAVE;
+    numa_nodes_ = nodes.size();
+  } else {
+    // Preferred rather than bound, so that a full node spills over instead of failing the allocation.
+    int node = nodes[shard_index % nodes.size()];
+    nodemask[node / bits_per_word] |= uint64_t{1} << (node % bits_per_word);
+    mode = MPOL_PREFERRED;
+  }
+  if (SysMbind(base_, size_, mode, nodemask.data(), nodemask.size() * bits_per_word + 1) != 0) {
+    LOG_WARN("mbind failed (errno %d), buffer pool frames use the default NUMA policy", errno);
+    numa_nodes_ = 1;
+  }
+#else
+  LOG_WARN("NUMA placement is only supported on Linux, buffer pool frames use the default policy");
+#endif
+}
+
+}  // namespace bustub
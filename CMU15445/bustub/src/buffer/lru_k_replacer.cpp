@@ -10,102 +10,201 @@
 //
 //===----------------------------------------------------------------------===//
 #include "buffer/lru_k_replacer.h"
+
+#include <queue>
+
 #include "common/logger.h"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : entries_(num_frames), history_(num_frames * k), replacer_size_(num_frames), k_(k) {
+  heap_.reserve(num_frames);
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  for (auto it = hist_list_.rbegin(); it != hist_list_.rend(); ++it) {
-    if (entries_[(*it)].evictable_) {
-      *frame_id = *it;
-      hist_list_.erase(std::next(it).base());
-      entries_.erase(*frame_id);
-      --curr_size_;
-      return true;
-    }
-  }
+  return Evict(frame_id, [](frame_id_t) { return true; });
+}
 
-  for (auto it = cache_list_.rbegin(); it != cache_list_.rend(); ++it) {
-    if (entries_[(*it)].evictable_) {
-      *frame_id = *it;
-      cache_list_.erase(std::next(it).base());
-      entries_.erase(*frame_id);
-      --curr_size_;
+auto LRUKReplacer::Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  while (!heap_.empty()) {
+    frame_id_t victim = heap_.front();
+    HeapErase(victim);
+    --curr_size_;
+    if (can_evict(victim)) {
+      entries_[victim] = FrameEntry{};
+      *frame_id = victim;
       return true;
     }
+    // whoever pinned it makes it evictable again when they unpin it
+    entries_[victim].evictable_ = false;
   }
-
   return false;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::invalid_argument(std::string("Invalid frame_id: ") + std::to_string(frame_id));
+  CheckFrameId(frame_id);
+  FrameEntry &entry = entries_[frame_id];
+  bool is_scan = access_type == AccessType::Scan;
+  if (is_scan && entry.hit_count_ > 0) {
+    // a scan passing over a page says nothing about how hot the page is
+    return;
   }
-  // for new frames, the default count is 0
-  // 如果新来的 frame_id 不存在，unordered_map 的 [] 运算符会自动以默认值创建键值对。
-  size_t new_count = ++entries_[frame_id].hit_count_;
-  // LOG_INFO("# the value of new_count: %zu", new_count);
-  //  new
-  if (new_count == 1) {
+  history_[frame_id * k_ + entry.hit_count_ % k_] = current_timestamp_++;
+  ++entry.hit_count_;
+  if (entry.hit_count_ == 1) {
+    // for new frames, the default is evictable
+    entry.evictable_ = true;
+    entry.scan_only_ = is_scan;
     ++curr_size_;
-    hist_list_.emplace_front(frame_id);
-    entries_[frame_id].pos_ = hist_list_.begin();
-  } else {
-    // re
-    if (new_count == k_) {
-      hist_list_.erase(entries_[frame_id].pos_);
-      cache_list_.emplace_front(frame_id);
-      entries_[frame_id].pos_ = cache_list_.begin();
-    } else if (new_count > k_) {
-      cache_list_.erase(entries_[frame_id].pos_);
-      cache_list_.emplace_front(frame_id);
-      entries_[frame_id].pos_ = cache_list_.begin();
-    }
+    HeapPush(frame_id);
+    return;
+  }
+  entry.scan_only_ = false;
+  if (entry.evictable_) {
+    // an access only ever moves a frame further away from eviction
+    HeapSiftDown(entry.heap_pos_);
   }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::invalid_argument(std::string("Invalid frame_id: ") + std::to_string(frame_id));
-  }
-  if (entries_.find(frame_id) == entries_.end()) {
+  CheckFrameId(frame_id);
+  FrameEntry &entry = entries_[frame_id];
+  if (entry.hit_count_ == 0 || entry.evictable_ == set_evictable) {
     return;
   }
-  if (set_evictable && !entries_[frame_id].evictable_) {
+  entry.evictable_ = set_evictable;
+  if (set_evictable) {
     curr_size_++;
-  } else if (entries_[frame_id].evictable_ && !set_evictable) {
+    HeapPush(frame_id);
+  } else {
     curr_size_--;
+    HeapErase(frame_id);
   }
-
-  entries_[frame_id].evictable_ = set_evictable;
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-
-  if (entries_.find(frame_id) == entries_.end()) {
+  CheckFrameId(frame_id);
+  FrameEntry &entry = entries_[frame_id];
+  if (entry.hit_count_ == 0) {
     return;
   }
 
-  if (!entries_[frame_id].evictable_) {
+  if (!entry.evictable_) {
     throw std::logic_error(std::string("Can't remove an evictable frame") + std::to_string(frame_id));
   }
 
-  if (entries_[frame_id].hit_count_ < k_) {
-    hist_list_.erase(entries_[frame_id].pos_);
-  } else {
-    cache_list_.erase(entries_[frame_id].pos_);
-  }
+  HeapErase(frame_id);
+  entry = FrameEntry{};
   --curr_size_;
-  entries_.erase(frame_id);
 }
 
 auto LRUKReplacer::Size() -> size_t { return curr_size_; }
 
+auto LRUKReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // A heap position only becomes a candidate once its parent has been taken, so positions leave the frontier in
+  // eviction order.
+  auto evicts_later = [this](size_t a, size_t b) { return EvictsBefore(heap_[b], heap_[a]); };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(evicts_later)> frontier(evicts_later);
+  if (!heap_.empty()) {
+    frontier.push(0);
+  }
+  while (!frontier.empty() && candidates.size() < max_frames) {
+    size_t pos = frontier.top();
+    frontier.pop();
+    candidates.push_back(heap_[pos]);
+    for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); child++) {
+      frontier.push(child);
+    }
+  }
+  return candidates;
+}
+
+auto LRUKReplacer::EvictsBefore(frame_id_t a, frame_id_t b) const -> bool {
+  // Frames that only scans have touched go first, then frames with +inf backward k-distance. Among frames of the
+  // same kind, the larger backward k-distance, i.e. the older k-th timestamp, goes first.
+  if (entries_[a].scan_only_ != entries_[b].scan_only_) {
+    return entries_[a].scan_only_;
+  }
+  bool a_has_k = entries_[a].hit_count_ >= k_;
+  bool b_has_k = entries_[b].hit_count_ >= k_;
+  if (a_has_k != b_has_k) {
+    return !a_has_k;
+  }
+  return KthTimestamp(a) < KthTimestamp(b);
+}
+
+auto LRUKReplacer::KthTimestamp(frame_id_t frame_id) const -> size_t {
+  size_t hit_count = entries_[frame_id].hit_count_;
+  // Once the ring buffer is full, the slot that will be overwritten next holds the oldest of the last k accesses.
+  return history_[frame_id * k_ + (hit_count < k_ ? 0 : hit_count % k_)];
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id: ") + std::to_string(frame_id));
+  }
+}
+
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  entries_[frame_id].heap_pos_ = heap_.size();
+  heap_.push_back(frame_id);
+  HeapSiftUp(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  size_t pos = entries_[frame_id].heap_pos_;
+  HeapSwap(pos, heap_.size() - 1);
+  heap_.pop_back();
+  entries_[frame_id].heap_pos_ = INVALID_HEAP_POS;
+  if (pos < heap_.size()) {
+    // the frame that took its place may belong either above or below it
+    frame_id_t moved = heap_[pos];
+    HeapSiftUp(pos);
+    HeapSiftDown(entries_[moved].heap_pos_);
+  }
+}
+
+void LRUKReplacer::HeapSiftUp(size_t pos) {
+  while (pos > 0) {
+    size_t parent = (pos - 1) / 2;
+    if (!EvictsBefore(heap_[pos], heap_[parent])) {
+      break;
+    }
+    HeapSwap(pos, parent);
+    pos = parent;
+  }
+}
+
+void LRUKReplacer::HeapSiftDown(size_t pos) {
+  while (true) {
+    size_t first = pos;
+    size_t left = 2 * pos + 1;
+    size_t right = 2 * pos + 2;
+    if (left < heap_.size() && EvictsBefore(heap_[left], heap_[first])) {
+      first = left;
+    }
+    if (right < heap_.size() && EvictsBefore(heap_[right], heap_[first])) {
+      first = right;
+    }
+    if (first == pos) {
+      break;
+    }
+    HeapSwap(pos, first);
+    pos = first;
+  }
+}
+
+void LRUKReplacer::HeapSwap(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  entries_[heap_[a]].heap_pos_ = a;
+  entries_[heap_[b]].heap_pos_ = b;
+}
+
 }  // namespace bustub
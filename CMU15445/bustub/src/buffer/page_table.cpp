@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <thread>  // NOLINT
+#include <utility>
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(MIN_CAPACITY), capacity_bits_(4) {
+  while (capacity_ < 2 * num_frames) {
+    capacity_ *= 2;
+    capacity_bits_++;
+  }
+  lines_ = std::vector<CacheLine>((capacity_ + SLOTS_PER_LINE - 1) / SLOTS_PER_LINE);
+  for (size_t i = 0; i < capacity_; i++) {
+    Slot(i).store(Pack(EMPTY_PAGE_ID, 0), std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+  while (true) {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    if (version % 2 == 1) {
+      // A rebuild is moving the entries around.
+      std::this_thread::yield();
+      continue;
+    }
+    frame_id_t found;
+    bool hit = Probe(page_id, found);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) == version) {
+      if (hit) {
+        frame_id = found;
+      }
+      return hit;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != EMPTY_PAGE_ID && page_id != TOMBSTONE_PAGE_ID, "invalid page id");
+  std::scoped_lock lock(writer_latch_);
+  if ((num_entries_ + num_tombstones_ + 1) * 4 > capacity_ * 3) {
+    Rebuild();
+  }
+  BUSTUB_ASSERT(num_entries_ < capacity_ / 2, "page table is full");
+
+  size_t index = HomeSlot(page_id);
+  size_t target = capacity_;
+  while (true) {
+    page_id_t slot_page_id = PageIdOf(Slot(index).load(std::memory_order_relaxed));
+    if (slot_page_id == page_id) {
+      Slot(index).store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    if (slot_page_id == TOMBSTONE_PAGE_ID && target == capacity_) {
+      target = index;
+    }
+    if (slot_page_id == EMPTY_PAGE_ID) {
+      break;
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+  // The page is not in the table: take the first tombstone on its probe sequence, or else the empty slot.
+  if (target == capacity_) {
+    target = index;
+  } else {
+    num_tombstones_--;
+  }
+  Slot(target).store(Pack(page_id, frame_id), std::memory_order_release);
+  num_entries_++;
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  std::scoped_lock lock(writer_latch_);
+  size_t index = HomeSlot(page_id);
+  while (true) {
+    page_id_t slot_page_id = PageIdOf(Slot(index).load(std::memory_order_relaxed));
+    if (slot_page_id == EMPTY_PAGE_ID) {
+      return false;
+    }
+    if (slot_page_id == page_id) {
+      break;
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+  num_entries_--;
+
+  size_t next = (index + 1) & (capacity_ - 1);
+  if (PageIdOf(Slot(next).load(std::memory_order_relaxed)) != EMPTY_PAGE_ID) {
+    Slot(index).store(Pack(TOMBSTONE_PAGE_ID, 0), std::memory_order_release);
+    num_tombstones_++;
+    return true;
+  }
+  // Nothing can be reached through the end of a cluster, so the tombstones right before it may become empty again.
+  Slot(index).store(Pack(EMPTY_PAGE_ID, 0), std::memory_order_release);
+  size_t prev = (index + capacity_ - 1) & (capacity_ - 1);
+  while (PageIdOf(Slot(prev).load(std::memory_order_relaxed)) == TOMBSTONE_PAGE_ID) {
+    Slot(prev).store(Pack(EMPTY_PAGE_ID, 0), std::memory_order_release);
+    num_tombstones_--;
+    prev = (prev + capacity_ - 1) & (capacity_ - 1);
+  }
+  return true;
+}
+
+auto PageTable::Size() -> size_t {
+  std::scoped_lock lock(writer_latch_);
+  return num_entries_;
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing spreads the consecutive page ids of a table over the whole array.
+  return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> (64 - capacity_bits_);
+}
+
+auto PageTable::Probe(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+  size_t index = HomeSlot(page_id);
+  for (size_t i = 0; i < capacity_; i++) {
+    uint64_t slot = Slot(index).load(std::memory_order_acquire);
+    page_id_t slot_page_id = PageIdOf(slot);
+    if (slot_page_id == page_id) {
+      frame_id = FrameIdOf(slot);
+      return true;
+    }
+    if (slot_page_id == EMPTY_PAGE_ID) {
+      return false;
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+  return false;
+}
+
+void PageTable::Rebuild() {
+  std::vector<uint64_t> entries;
+  entries.reserve(num_entries_);
+  for (size_t i = 0; i < capacity_; i++) {
+    uint64_t slot = Slot(i).load(std::memory_order_relaxed);
+    if (PageIdOf(slot) != EMPTY_PAGE_ID && PageIdOf(slot) != TOMBSTONE_PAGE_ID) {
+      entries.push_back(slot);
+    }
+  }
+
+  uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < capacity_; i++) {
+    Slot(i).store(Pack(EMPTY_PAGE_ID, 0), std::memory_order_relaxed);
+  }
+  for (auto entry : entries) {
+    size_t index = HomeSlot(PageIdOf(entry));
+    while (PageIdOf(Slot(index).load(std::memory_order_relaxed)) != EMPTY_PAGE_ID) {
+      index = (index + 1) & (capacity_ - 1);
+    }
+    Slot(index).store(entry, std::memory_order_relaxed);
+  }
+  version_.store(version + 2, std::memory_order_release);
+  num_tombstones_ = 0;
+}
+
+}  // namespace bustub
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cctype>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -17,6 +19,7 @@
 #include "common/bustub_instance.h"
 #include "common/enums/statement_type.h"
 #include "common/exception.h"
+#include "common/thread_pool.h"
 #include "common/util/string_util.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
@@ -37,8 +40,21 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return the value of a session variable as an integer of at most max_digits digits, or 0 if it is not one */
+auto ParsePositiveInteger(const std::string &value, size_t max_digits) -> uint64_t {
+  if (value.empty() || value.size() > max_digits || !std::all_of(value.begin(), value.end(), ::isdigit)) {
+    return 0;
+  }
+  return std::stoull(value);
+}
+
+}  // namespace
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_,
+                                           thread_pool_.get(), work_mem_);
 }
 
 BustubInstance::BustubInstance(const std::string &db_file_name) {
@@ -240,7 +256,8 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         std::unique_lock<std::shared_mutex> l(catalog_lock_);
         auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
             txn, index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
+            INTEGER_SIZE, IntegerHashFunctionType{},
+            index_stmt.index_type_ == "hash" ? IndexType::HashTableIndex : IndexType::BPlusTreeIndex, work_mem_);
         l.unlock();
 
         if (info == nullptr) {
@@ -257,6 +274,20 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        if (set_stmt.variable_ == "parallelism") {
+          auto parallelism = ParsePositiveInteger(set_stmt.value_, 3);
+          if (parallelism == 0) {
+            throw Exception(fmt::format("parallelism must be an integer from 1 to 999, not {}", set_stmt.value_));
+          }
+          // a query runs on the calling thread and parallelism - 1 threads of the pool
+          thread_pool_ = parallelism == 1 ? nullptr : std::make_unique<ThreadPool>(parallelism);
+        } else if (set_stmt.variable_ == "work_mem") {
+          auto work_mem = ParsePositiveInteger(set_stmt.value_, 15);
+          if (work_mem == 0) {
+            throw Exception(fmt::format("work_mem must be a positive number of bytes, not {}", set_stmt.value_));
+          }
+          work_mem_ = work_mem;
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<NumaPolicy> buffer_pool_numa_policy(NumaPolicy::Default);
+
+std::atomic<bool> enable_vectorized_execution(true);
+
 }  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.cpp
+//
+// Identification: src/common/thread_pool.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/thread_pool.h"
+
+namespace bustub {
+
+ThreadPool::ThreadPool(size_t num_workers) {
+  BUSTUB_ASSERT(num_workers > 0, "a thread pool has at least one worker");
+  for (size_t i = 0; i < num_workers; i++) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  for (size_t i = 1; i < num_workers; i++) {
+    threads_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock(latch_);
+    shutdown_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Run(size_t num_tasks, const std::function<void(size_t, size_t)> &task) {
+  std::scoped_lock run_lock(run_latch_);
+  // deal contiguous ranges, so each worker starts on tasks next to each other
+  for (size_t worker = 0; worker < queues_.size(); worker++) {
+    auto &queue = *queues_[worker];
+    std::scoped_lock lock(queue.latch_);
+    for (size_t t = worker * num_tasks / queues_.size(); t < (worker + 1) * num_tasks / queues_.size(); t++) {
+      queue.tasks_.push_back(t);
+    }
+  }
+  {
+    std::scoped_lock lock(latch_);
+    task_ = &task;
+    error_ = nullptr;
+    busy_threads_ = threads_.size();
+    job_++;
+  }
+  job_cv_.notify_all();
+
+  Work(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(latch_);
+    done_cv_.wait(lock, [this] { return busy_threads_ == 0; });
+    task_ = nullptr;
+    error = error_;
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::WorkerLoop(size_t worker) {
+  uint64_t last_job = 0;
+  while (true) {
+    {
+      std::unique_lock lock(latch_);
+      job_cv_.wait(lock, [this, last_job] { return shutdown_ || job_ != last_job; });
+      if (shutdown_) {
+        return;
+      }
+      last_job = job_;
+    }
+    Work(worker);
+    {
+      std::scoped_lock lock(latch_);
+      if (--busy_threads_ == 0) {
+        done_cv_.notify_one();
+      }
+    }
+  }
+}
+
+void ThreadPool::Work(size_t worker) {
+  size_t task;
+  while (NextTask(worker, &task)) {
+    {
+      std::scoped_lock lock(latch_);
+      if (error_ != nullptr) {
+        // skip what is left of a failed job
+        continue;
+      }
+    }
+    try {
+      (*task_)(worker, task);
+    } catch (...) {
+      std::scoped_lock lock(latch_);
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+auto ThreadPool::NextTask(size_t worker, size_t *task) -> bool {
+  {
+    auto &queue = *queues_[worker];
+    std::scoped_lock lock(queue.latch_);
+    if (!queue.tasks_.empty()) {
+      *task = queue.tasks_.front();
+      queue.tasks_.pop_front();
+      return true;
+    }
+  }
+  // steal from the end of the range of another worker, away from the tasks it works on
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto &victim = *queues_[(worker + i) % queues_.size()];
+    std::scoped_lock lock(victim.latch_);
+    if (!victim.tasks_.empty()) {
+      *task = victim.tasks_.back();
+      victim.tasks_.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,7 +27,22 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // a directory of global depth 0 pointing to a single empty bucket
+  Page *dir_page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (dir_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the hash table directory");
+  }
+  page_id_t bucket_page_id;
+  if (buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the first hash table bucket");
+  }
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(dir_page->GetData());
+  directory->SetPageId(directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+  directory->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -46,22 +62,30 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+  return Hash(key) & dir_page->GetGlobalDepthMask();
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the hash table directory");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_SWISS_TYPE * {
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  return reinterpret_cast<HASH_TABLE_SWISS_TYPE *>(page->GetData());
 }
 
 /*****************************************************************************
@@ -69,7 +93,24 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(hash & dir_page->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    table_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a hash table bucket");
+  }
+  auto *bucket = reinterpret_cast<HASH_TABLE_SWISS_TYPE *>(page->GetData());
+  page->RLatch();
+  bool found = bucket->GetValue(key, hash, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +118,101 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(hash & dir_page->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    table_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a hash table bucket");
+  }
+  auto *bucket = reinterpret_cast<HASH_TABLE_SWISS_TYPE *>(page->GetData());
+  page->WLatch();
+  if (bucket->IsFull()) {
+    // the bucket has to split, which changes the directory: start over under the table write latch
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    table_latch_.RUnlock();
+    return SplitInsert(transaction, key, value);
+  }
+  bool inserted = bucket->Insert(key, value, hash, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  table_latch_.RUnlock();
+  return inserted;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  // Nobody else holds the table latch, so no reader or writer is in any bucket and the pages need no latches
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  bool inserted = false;
+  uint32_t hash = Hash(key);
+  while (true) {
+    uint32_t bucket_idx = hash & dir_page->GetGlobalDepthMask();
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    HASH_TABLE_SWISS_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    if (bucket == nullptr) {
+      break;
+    }
+    if (!bucket->IsFull()) {
+      inserted = bucket->Insert(key, value, hash, comparator_);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+
+    // a full bucket may hold the pair already; and a bucket as deep as a full-sized directory cannot split
+    std::vector<ValueType> values;
+    bucket->GetValue(key, hash, comparator_, &values);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (std::find(values.begin(), values.end(), value) != values.end() ||
+        (local_depth == dir_page->GetGlobalDepth() && dir_page->Size() == DIRECTORY_ARRAY_SIZE)) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    page_id_t image_page_id;
+    Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    auto *image = reinterpret_cast<HASH_TABLE_SWISS_TYPE *>(image_page->GetData());
+
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+    // the entries whose hash has the high bit set move to the split image. The bucket is refilled from scratch
+    // rather than having the moved entries marked deleted, which would leave its probes as long as before
+    uint32_t high_bit = dir_page->GetLocalHighBit(bucket_idx);
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    entries.reserve(bucket->NumReadable());
+    for (uint32_t i = bucket->NextReadable(0); i < SWISS_ARRAY_SIZE; i = bucket->NextReadable(i + 1)) {
+      entries.emplace_back(bucket->KeyAt(i), bucket->ValueAt(i));
+    }
+    bucket->Clear();
+    for (const auto &[entry_key, entry_value] : entries) {
+      uint32_t entry_hash = Hash(entry_key);
+      ((entry_hash & high_bit) != 0 ? image : bucket)->Insert(entry_key, entry_value, entry_hash, comparator_);
+    }
+    // every slot pointing to the bucket is one deeper now, and the ones with the high bit point to the image
+    for (uint32_t idx = bucket_idx & (high_bit - 1); idx < dir_page->Size(); idx += high_bit) {
+      dir_page->SetLocalDepth(idx, local_depth + 1);
+      if ((idx & high_bit) != 0) {
+        dir_page->SetBucketPageId(idx, image_page_id);
+      }
+    }
+    dir_dirty = true;
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,14 +220,82 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(hash & dir_page->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    table_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a hash table bucket");
+  }
+  auto *bucket = reinterpret_cast<HASH_TABLE_SWISS_TYPE *>(page->GetData());
+  page->WLatch();
+  bool removed = bucket->Remove(key, value, hash, comparator_);
+  bool empty = removed && bucket->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  table_latch_.RUnlock();
+
+  if (empty) {
+    Merge(transaction, key, value);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  // as in SplitInsert, the table write latch keeps everybody else out of the buckets
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool dir_dirty = false;
+  // a merge can leave an empty bucket whose own split image is empty, so keep going until nothing merges
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (local_depth == 0 || dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    HASH_TABLE_SWISS_TYPE *bucket = FetchBucketPage(bucket_page_id);
+    if (bucket == nullptr) {
+      break;
+    }
+    bool bucket_empty = bucket->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    HASH_TABLE_SWISS_TYPE *image = FetchBucketPage(image_page_id);
+    if (image == nullptr) {
+      break;
+    }
+    bool image_empty = image->IsEmpty();
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    if (!bucket_empty && !image_empty) {
+      break;
+    }
+
+    // every slot of the pair now points to the one that is kept, one shallower
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    uint32_t stride = 1U << (local_depth - 1);
+    for (uint32_t idx = bucket_idx & (stride - 1); idx < dir_page->Size(); idx += stride) {
+      dir_page->SetBucketPageId(idx, kept_page_id);
+      dir_page->SetLocalDepth(idx, local_depth - 1);
+    }
+    buffer_pool_manager_->DeletePage(bucket_empty ? bucket_page_id : image_page_id);
+    while (dir_page->CanShrink()) {
+      dir_page->DecrGlobalDepth();
+    }
+    dir_dirty = true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, dir_dirty);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
@@ -107,7 +305,7 @@ auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
   table_latch_.RLock();
   HashTableDirectoryPage *dir_page = FetchDirectoryPage();
   uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
   table_latch_.RUnlock();
   return global_depth;
 }
@@ -120,7 +318,7 @@ void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
   HashTableDirectoryPage *dir_page = FetchDirectoryPage();
   dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
   table_latch_.RUnlock();
 }
 
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -22,25 +23,229 @@
 
 namespace bustub {
 
+auto LinearProbeStats::MeanProbeLength() const -> double {
+  size_t total = 0;
+  size_t num_pairs = 0;
+  for (size_t i = 0; i < probe_lengths_.size(); i++) {
+    total += (i + 1) * probe_lengths_[i];
+    num_pairs += probe_lengths_[i];
+  }
+  return num_pairs == 0 ? 0 : static_cast<double>(total) / num_pairs;
+}
+
+auto LinearProbeStats::ProbeLengthPercentile(double fraction) const -> size_t {
+  size_t num_pairs = 0;
+  for (auto count : probe_lengths_) {
+    num_pairs += count;
+  }
+  size_t seen = 0;
+  for (size_t i = 0; i < probe_lengths_.size(); i++) {
+    seen += probe_lengths_[i];
+    if (static_cast<double>(seen) >= fraction * num_pairs) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  // num_buckets is a number of slots, and there are SWISS_ARRAY_SIZE of them in a block
+  header_page_id_ = NewTable(std::clamp<size_t>((num_buckets + SWISS_ARRAY_SIZE - 1) / SWISS_ARRAY_SIZE, 1,
+                                                HashTableHeaderPage::MaxBlocks()));
+  migration_thread_ = std::thread(&LinearProbeHashTable::RunMigration, this);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_TYPE::~LinearProbeHashTable() {
+  {
+    std::scoped_lock lock(migration_mutex_);
+    stop_migration_ = true;
+  }
+  migration_cv_.notify_one();
+  migration_thread_.join();
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NewTable(size_t num_blocks) -> page_id_t {
+  page_id_t header_page_id;
+  PinnedPage header(buffer_pool_manager_, &header_page_id);
+  auto *header_page = header.As<HashTableHeaderPage>();
+  header_page->SetPageId(header_page_id);
+  try {
+    for (size_t i = 0; i < num_blocks; i++) {
+      page_id_t block_page_id;
+      PinnedPage block(buffer_pool_manager_, &block_page_id);
+      header_page->AddBlockPageId(block_page_id);
+    }
+  } catch (...) {
+    // hand back the pages of the table allocated so far
+    for (size_t i = 0; i < header_page->NumBlocks(); i++) {
+      buffer_pool_manager_->DeletePage(header_page->GetBlockPageId(i));
+    }
+    header.Release();
+    buffer_pool_manager_->DeletePage(header_page_id);
+    throw;
+  }
+  header_page->SetSize(header_page->NumBlocks() * SWISS_ARRAY_SIZE);
+  num_slots_ = header_page->GetSize();
+  return header_page_id;
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  TableLatchGuard table_latch(&table_latch_, false);
+  bool found = LookupInTable(PinnedPage(buffer_pool_manager_, header_page_id_).As<HashTableHeaderPage>(), 0, key,
+                             hash, result);
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    // a block whose move failed half way has some of its pairs in both tables
+    std::vector<ValueType> old_values;
+    LookupInTable(PinnedPage(buffer_pool_manager_, old_header_page_id_).As<HashTableHeaderPage>(),
+                  next_block_to_move_, key, hash, &old_values);
+    size_t num_new = result->size();
+    for (const auto &value : old_values) {
+      if (std::find(result->begin(), result->begin() + num_new, value) == result->begin() + num_new) {
+        result->push_back(value);
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::LookupInTable(HashTableHeaderPage *header_page, size_t first_block, const KeyType &key,
+                                    uint64_t hash, std::vector<ValueType> *result) -> bool {
+  size_t num_blocks = header_page->NumBlocks();
+  size_t block_idx = hash % num_blocks;
+  bool found = false;
+  for (size_t i = 0; i < num_blocks; i++, block_idx = block_idx + 1 == num_blocks ? 0 : block_idx + 1) {
+    if (block_idx < first_block) {
+      // moved away, but pairs after it may have been pushed past it
+      continue;
+    }
+    PinnedPage block(buffer_pool_manager_, header_page->GetBlockPageId(block_idx));
+    block.RLatch();
+    bool probe_ended = false;
+    found |= block.As<HASH_TABLE_SWISS_TYPE>()->GetValue(key, hash, comparator_, result, &probe_ended);
+    if (probe_ended) {
+      break;
+    }
+  }
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  TableLatchGuard table_latch(&table_latch_, false);
+  // reserve a slot first, so that the pairs a resize has yet to move always fit into the current table
+  if (num_entries_.fetch_add(1) >= num_slots_) {
+    num_entries_--;
+    table_latch.Unlock();
+    return MakeRoom() && Insert(transaction, key, value);
+  }
+  std::optional<bool> inserted;
+  try {
+    inserted = InsertLatched(key, value, hash, false);
+    table_latch.Unlock();
+    if (!inserted.has_value()) {
+      // the probe wraps around: nobody else is in the blocks under the table write latch, so they need no latches
+      TableLatchGuard exclusive_latch(&table_latch_, true);
+      inserted = InsertLatched(key, value, hash, true);
+    }
+  } catch (...) {
+    num_entries_--;
+    throw;
+  }
+  if (!*inserted) {
+    num_entries_--;
+    return false;
+  }
+  MaybeResize();
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertLatched(const KeyType &key, const ValueType &value, uint64_t hash, bool exclusive)
+    -> std::optional<bool> {
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    std::vector<ValueType> values;
+    LookupInTable(PinnedPage(buffer_pool_manager_, old_header_page_id_).As<HashTableHeaderPage>(),
+                  next_block_to_move_, key, hash, &values);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      return false;
+    }
+  }
+  PinnedPage header(buffer_pool_manager_, header_page_id_);
+  return InsertIntoProbe(header.As<HashTableHeaderPage>(), key, value, hash, !exclusive);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::InsertIntoProbe(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value,
+                                      uint64_t hash, bool latch_blocks) -> std::optional<bool> {
+  size_t num_blocks = header_page->NumBlocks();
+  size_t home = hash % num_blocks;
+  // released when the probe is done, or when a fetch throws before anything was inserted
+  std::vector<PinnedPage> blocks;
+  PinnedPage *target = nullptr;
+  auto insert_into_target = [&]() {
+    if (target == nullptr) {
+      return false;
+    }
+    auto *block = target->As<HASH_TABLE_SWISS_TYPE>();
+    uint32_t num_deleted = block->NumDeleted();
+    bool done = block->Insert(key, value, hash, comparator_);
+    num_tombstones_ -= num_deleted - block->NumDeleted();
+    if (done) {
+      target->MarkDirty();
+    }
+    return done;
+  };
+  blocks.reserve(num_blocks);
+  for (size_t i = 0; i < num_blocks; i++) {
+    size_t block_idx = home + i;
+    if (block_idx >= num_blocks) {
+      if (latch_blocks) {
+        break;
+      }
+      block_idx -= num_blocks;
+    }
+    auto &page = blocks.emplace_back(buffer_pool_manager_, header_page->GetBlockPageId(block_idx));
+    if (latch_blocks) {
+      page.WLatch();
+    }
+    auto *block = page.As<HASH_TABLE_SWISS_TYPE>();
+
+    std::vector<ValueType> values;
+    bool probe_ended = false;
+    block->GetValue(key, hash, comparator_, &values, &probe_ended);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      return false;
+    }
+    if (target == nullptr && !block->IsFull()) {
+      target = &page;
+    }
+    if (probe_ended || i + 1 == num_blocks) {
+      // a probe ends at a free slot, so it has been seen at the latest in this block; a probe of the whole table
+      // that does not end puts the pair into a deleted slot, if there is any
+      return insert_into_target();
+    }
+  }
+  return std::nullopt;
 }
 
 /*****************************************************************************
@@ -48,21 +253,224 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  bool removed;
+  {
+    TableLatchGuard table_latch(&table_latch_, false);
+    removed = RemoveFromTable(PinnedPage(buffer_pool_manager_, header_page_id_).As<HashTableHeaderPage>(), 0, key,
+                              value, hash);
+    if (old_header_page_id_ != INVALID_PAGE_ID) {
+      // even if it was in the current table: a block whose move failed half way has some of its pairs in both
+      removed |= RemoveFromTable(PinnedPage(buffer_pool_manager_, old_header_page_id_).As<HashTableHeaderPage>(),
+                                 next_block_to_move_, key, value, hash);
+    }
+  }
+  if (removed) {
+    num_entries_--;
+    MaybeResize();
+  }
+  return removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::RemoveFromTable(HashTableHeaderPage *header_page, size_t first_block, const KeyType &key,
+                                      const ValueType &value, uint64_t hash) -> bool {
+  size_t num_blocks = header_page->NumBlocks();
+  size_t block_idx = hash % num_blocks;
+  bool removed = false;
+  for (size_t i = 0; i < num_blocks && !removed; i++, block_idx = block_idx + 1 == num_blocks ? 0 : block_idx + 1) {
+    if (block_idx < first_block) {
+      continue;
+    }
+    PinnedPage page(buffer_pool_manager_, header_page->GetBlockPageId(block_idx));
+    page.WLatch();
+    auto *block = page.As<HASH_TABLE_SWISS_TYPE>();
+    uint32_t num_deleted = block->NumDeleted();
+    bool probe_ended = false;
+    removed = block->Remove(key, value, hash, comparator_, &probe_ended);
+    num_tombstones_ += block->NumDeleted() - num_deleted;
+    if (removed) {
+      page.MarkDirty();
+    }
+    if (probe_ended) {
+      break;
+    }
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  TableLatchGuard table_latch(&table_latch_, true);
+  while (old_header_page_id_ != INVALID_PAGE_ID) {
+    MoveBlock();
+  }
+  size_t num_slots = std::max(2 * initial_size, num_entries_.load());
+  StartResize(std::clamp<size_t>((num_slots + SWISS_ARRAY_SIZE - 1) / SWISS_ARRAY_SIZE, 1,
+                                 HashTableHeaderPage::MaxBlocks()));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::FinishResize() {
+  TableLatchGuard table_latch(&table_latch_, true);
+  while (old_header_page_id_ != INVALID_PAGE_ID) {
+    MoveBlock();
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::StartResize(size_t num_blocks) {
+  page_id_t new_header_page_id = NewTable(num_blocks);
+  old_header_page_id_ = header_page_id_;
+  header_page_id_ = new_header_page_id;
+  next_block_to_move_ = 0;
+  {
+    std::scoped_lock lock(migration_mutex_);
+    resizing_ = true;
+  }
+  migration_cv_.notify_one();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MoveBlock() {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  PinnedPage old_header(buffer_pool_manager_, old_header_page_id_);
+  PinnedPage header(buffer_pool_manager_, header_page_id_);
+  auto *old_header_page = old_header.As<HashTableHeaderPage>();
+  page_id_t block_page_id = old_header_page->GetBlockPageId(next_block_to_move_);
+  PinnedPage page(buffer_pool_manager_, block_page_id);
+  auto *block = page.As<HASH_TABLE_SWISS_TYPE>();
+  // the slots are reserved already, so every pair finds one; a pair that a failed move got over already is skipped
+  for (uint32_t idx = block->NextReadable(0); idx < SWISS_ARRAY_SIZE; idx = block->NextReadable(idx + 1)) {
+    KeyType key = block->KeyAt(idx);
+    InsertIntoProbe(header.As<HashTableHeaderPage>(), key, block->ValueAt(idx), hash_fn_.GetHash(key), false);
+  }
+  // only now that all of its pairs are in the current table does the block count as moved
+  next_block_to_move_++;
+  num_tombstones_ -= block->NumDeleted();
+  page.Release();
+  buffer_pool_manager_->DeletePage(block_page_id);
+
+  bool done = next_block_to_move_ == old_header_page->NumBlocks();
+  old_header.Release();
+  if (done) {
+    buffer_pool_manager_->DeletePage(old_header_page_id_);
+    old_header_page_id_ = INVALID_PAGE_ID;
+    next_block_to_move_ = 0;
+    std::scoped_lock lock(migration_mutex_);
+    resizing_ = false;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MaybeResize() {
+  size_t num_slots = num_slots_;
+  bool can_grow = num_slots < HashTableHeaderPage::MaxBlocks() * SWISS_ARRAY_SIZE;
+  bool too_full = can_grow && static_cast<double>(num_entries_) > MAX_LOAD_FACTOR * num_slots;
+  bool too_many_tombstones = static_cast<double>(num_tombstones_) > MAX_TOMBSTONE_FACTOR * num_slots;
+  if (resizing_ || (!too_full && !too_many_tombstones)) {
+    return;
+  }
+  TableLatchGuard table_latch(&table_latch_, true);
+  // someone else may have started the resize in the meantime
+  if (old_header_page_id_ == INVALID_PAGE_ID && num_slots == num_slots_) {
+    size_t num_blocks = num_slots / SWISS_ARRAY_SIZE;
+    try {
+      StartResize(too_full ? std::min(2 * num_blocks, HashTableHeaderPage::MaxBlocks()) : num_blocks);
+    } catch (const Exception &e) {
+      // the table still has room, so the resize waits for a later insert or remove
+      LOG_DEBUG("hash table resize deferred: %s", e.what());
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MakeRoom() -> bool {
+  TableLatchGuard table_latch(&table_latch_, true);
+  while (old_header_page_id_ != INVALID_PAGE_ID) {
+    MoveBlock();
+  }
+  size_t num_blocks = num_slots_ / SWISS_ARRAY_SIZE;
+  bool has_room = num_entries_ < num_slots_;
+  if (!has_room && num_blocks < HashTableHeaderPage::MaxBlocks()) {
+    StartResize(std::min(2 * num_blocks, HashTableHeaderPage::MaxBlocks()));
+    has_room = true;
+  }
+  return has_room;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::RunMigration() {
+  std::unique_lock lock(migration_mutex_);
+  while (true) {
+    migration_cv_.wait(lock, [this] { return stop_migration_ || resizing_; });
+    if (stop_migration_) {
+      return;
+    }
+    lock.unlock();
+    bool moved = true;
+    try {
+      // one block per hold of the write latch, so that reads and writes get in between
+      TableLatchGuard table_latch(&table_latch_, true);
+      MoveBlock();
+    } catch (const Exception &e) {
+      // the buffer pool is full for now; the block stays where it is, and the move is retried
+      LOG_DEBUG("hash table migration backs off: %s", e.what());
+      moved = false;
+    }
+    std::this_thread::yield();
+    lock.lock();
+    if (!moved) {
+      migration_cv_.wait_for(lock, MIGRATION_BACKOFF, [this] { return stop_migration_; });
+    }
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  return num_slots_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetProbeStats() -> LinearProbeStats {
+  LinearProbeStats stats;
+  TableLatchGuard table_latch(&table_latch_, false);
+  stats.num_slots_ = num_slots_;
+  for (page_id_t header_page_id : {header_page_id_, old_header_page_id_}) {
+    if (header_page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    PinnedPage header(buffer_pool_manager_, header_page_id);
+    auto *header_page = header.As<HashTableHeaderPage>();
+    size_t num_blocks = header_page->NumBlocks();
+    size_t first_block = header_page_id == old_header_page_id_ ? next_block_to_move_ : 0;
+    for (size_t block_idx = first_block; block_idx < num_blocks; block_idx++) {
+      PinnedPage page(buffer_pool_manager_, header_page->GetBlockPageId(block_idx));
+      page.RLatch();
+      auto *block = page.As<HASH_TABLE_SWISS_TYPE>();
+      stats.num_entries_ += block->NumReadable();
+      stats.num_tombstones_ += block->NumDeleted();
+      for (uint32_t idx = block->NextReadable(0); idx < SWISS_ARRAY_SIZE; idx = block->NextReadable(idx + 1)) {
+        uint64_t hash = hash_fn_.GetHash(block->KeyAt(idx));
+        // a probe goes through every group of each block before the one the pair is in
+        size_t blocks_passed = (block_idx + num_blocks - hash % num_blocks) % num_blocks;
+        size_t length = blocks_passed * HASH_TABLE_SWISS_TYPE::NumGroups() + block->ProbeLength(idx, hash);
+        if (stats.probe_lengths_.size() < length) {
+          stats.probe_lengths_.resize(length);
+        }
+        stats.probe_lengths_[length - 1]++;
+      }
+    }
+  }
+  return stats;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <functional>
 #include <list>
+#include <string>
 #include <utility>
 
 #include "container/hash/extendible_hash_table.h"
@@ -22,160 +23,240 @@
 namespace bustub {
 
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size)
-    : global_depth_(0), bucket_size_(bucket_size), num_buckets_(1) {
-  std::shared_ptr<Bucket> ptr = std::make_shared<Bucket>(bucket_size_);
-  dir_.emplace_back(ptr);
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::IndexOf(const K &key) -> size_t {
-  int mask = (1 << global_depth_) - 1;
-  return std::hash<K>()(key) & mask;
+ExtendibleHashTable<K, V>::ExtendibleHashTable(size_t bucket_size) : bucket_size_(bucket_size) {
+  buckets_.emplace_back(std::make_unique<Bucket>(bucket_size_));
+  directories_.emplace_back(std::make_unique<Directory>(0, 1));
+  directories_.back()->buckets_[0].store(buckets_.back().get());
+  dir_.store(directories_.back().get());
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetGlobalDepth() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetGlobalDepthInternal();
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetGlobalDepthInternal() const -> int {
-  return global_depth_;
+  return dir_.load(std::memory_order_acquire)->global_depth_;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetLocalDepth(int dir_index) const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetLocalDepthInternal(dir_index);
-}
-
-template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetLocalDepthInternal(int dir_index) const -> int {
-  return dir_[dir_index]->GetDepth();
+  Bucket *bucket = dir_.load(std::memory_order_acquire)->buckets_[dir_index].load(std::memory_order_acquire);
+  bucket->latch_.RLock();
+  int depth = bucket->GetDepth();
+  bucket->latch_.RUnlock();
+  return depth;
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::GetNumBuckets() const -> int {
-  std::scoped_lock<std::mutex> lock(latch_);
-  return GetNumBucketsInternal();
+  return num_buckets_.load();
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::GetNumBucketsInternal() const -> int {
-  return num_buckets_;
+auto ExtendibleHashTable<K, V>::BucketOf(size_t hash) const -> Bucket * {
+  const Directory *dir = dir_.load(std::memory_order_acquire);
+  size_t mask = (size_t{1} << dir->global_depth_) - 1;
+  return dir->buckets_[hash & mask].load(std::memory_order_acquire);
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Find(const K &key, V &value) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
-  return dir_[index]->Find(key, value);
+  size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    bucket->latch_.RLock();
+    // the bucket may have been split since the directory was read; if so, look again
+    if (bucket->Covers(hash)) {
+      bool found = bucket->Find(key, hash, value);
+      bucket->latch_.RUnlock();
+      return found;
+    }
+    bucket->latch_.RUnlock();
+  }
 }
 
 template <typename K, typename V>
 auto ExtendibleHashTable<K, V>::Remove(const K &key) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
-  V val;
-  if (dir_[index]->Find(key, val)) {
-    dir_[index]->Remove(key);
-    return true;
+  size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    bucket->latch_.WLock();
+    if (bucket->Covers(hash)) {
+      bool removed = bucket->Remove(key, hash);
+      bucket->latch_.WUnlock();
+      return removed;
+    }
+    bucket->latch_.WUnlock();
   }
-  return false;
 }
 
 template <typename K, typename V>
 void ExtendibleHashTable<K, V>::Insert(const K &key, const V &value) {
-  std::scoped_lock<std::mutex> lock(latch_);
-  size_t index = IndexOf(key);
-  V val;
-  if (dir_[index]->Find(key, val)) {
-    dir_[index]->Insert(key, value);
-    return;
-  }
-
-  while (dir_[index]->IsFull()) {
-    int local_depth = dir_[index]->GetDepth();
-    // split the bucket and expand the dictiona
-    if (local_depth == global_depth_) {
-      size_t dir_size = dir_.size();
-      dir_.reserve(2 * dir_size);
-      std::copy_n(dir_.begin(), dir_size, std::back_inserter(dir_));
-      ++global_depth_;
+  size_t hash = std::hash<K>()(key);
+  while (true) {
+    Bucket *bucket = BucketOf(hash);
+    bucket->latch_.WLock();
+    if (!bucket->Covers(hash)) {
+      bucket->latch_.WUnlock();
+      continue;
     }
-    // make two new buckets
-    auto b0 = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-    auto b1 = std::make_shared<Bucket>(bucket_size_, local_depth + 1);
-    ++num_buckets_;
-    int local_mask = 1 << local_depth;
-    // redistributed items from the old bucket
-    for (const auto &[k, v] : dir_[index]->GetItems()) {
-      size_t item_hash = std::hash<K>()(k);
-      if (static_cast<bool>(item_hash & local_mask)) {
-        b1->Insert(k, v);
-      } else {
-        b0->Insert(k, v);
-      }
+    if (bucket->Insert(key, hash, value)) {
+      bucket->latch_.WUnlock();
+      return;
     }
+    // the bucket is full: split it, then try again in whichever half the key belongs to
+    SplitBucket(bucket);
+    bucket->latch_.WUnlock();
+  }
+}
 
-    for (size_t i = (std::hash<K>()(key) & (local_mask - 1)); i < dir_.size(); i += local_mask) {
-      if (static_cast<bool>(i & local_mask)) {
-        dir_[i] = b1;
-      } else {
-        dir_[i] = b0;
-      }
+template <typename K, typename V>
+void ExtendibleHashTable<K, V>::SplitBucket(Bucket *bucket) {
+  std::scoped_lock<std::mutex> lock(dir_latch_);
+  Directory *dir = dir_.load(std::memory_order_relaxed);
+  int local_depth = bucket->GetDepth();
+  if (local_depth == dir->global_depth_) {
+    // double the directory: a new version, as readers may still be looking at the old one
+    size_t size = size_t{1} << dir->global_depth_;
+    auto grown = std::make_unique<Directory>(dir->global_depth_ + 1, 2 * size);
+    for (size_t i = 0; i < size; i++) {
+      Bucket *entry = dir->buckets_[i].load(std::memory_order_relaxed);
+      grown->buckets_[i].store(entry, std::memory_order_relaxed);
+      grown->buckets_[i + size].store(entry, std::memory_order_relaxed);
     }
-    index = IndexOf(key);
+    dir = grown.get();
+    directories_.emplace_back(std::move(grown));
+    dir_.store(dir, std::memory_order_release);
   }
 
-  // if the bucket is not full
-  dir_[index]->Insert(key, value);
+  // The sibling is filled before the directory points to it, so readers only ever find it complete.
+  size_t high_bit = size_t{1} << local_depth;
+  buckets_.emplace_back(std::make_unique<Bucket>(bucket_size_, local_depth + 1, bucket->GetPrefix() | high_bit));
+  Bucket *sibling = buckets_.back().get();
+  bucket->SplitTo(sibling);
+  size_t dir_size = size_t{1} << dir->global_depth_;
+  for (size_t i = sibling->GetPrefix(); i < dir_size; i += high_bit << 1) {
+    dir->buckets_[i].store(sibling, std::memory_order_release);
+  }
+  num_buckets_++;
 }
 
 //===--------------------------------------------------------------------===//
 // Bucket
 //===--------------------------------------------------------------------===//
 template <typename K, typename V>
-ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth) : size_(array_size), depth_(depth) {}
+ExtendibleHashTable<K, V>::Bucket::Bucket(size_t array_size, int depth, size_t prefix)
+    : size_(array_size), depth_(depth), prefix_(prefix) {
+  // a power of two of slots, so that probing wraps around with a mask, and usually finds an empty slot early
+  size_t num_slots = 1;
+  while (num_slots < size_) {
+    num_slots <<= 1;
+  }
+  slot_mask_ = num_slots - 1;
+  tags_.resize(num_slots, 0);
+  hashes_.resize(num_slots);
+  slots_.resize(num_slots);
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::HomeSlot(size_t hash) const -> size_t {
+  // the directory uses the low bits of the hash, which all keys of a bucket share, so mix in the others
+  return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ULL) >> 32) & slot_mask_;
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::TagOf(size_t hash) -> uint8_t {
+  return static_cast<uint8_t>((hash * 0x9E3779B97F4A7C15ULL) >> 57) | 0x80;
+}
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, V &value) -> bool {
-  for (const auto &[k, v] : list_) {
-    if (k == key) {
-      value = v;
-      return true;
+auto ExtendibleHashTable<K, V>::Bucket::SlotOf(const K &key, size_t hash) const -> size_t {
+  uint8_t tag = TagOf(hash);
+  size_t slot = HomeSlot(hash);
+  for (size_t probes = 0; probes <= slot_mask_ && tags_[slot] != 0; probes++) {
+    if (tags_[slot] == tag && slots_[slot].first == key) {
+      return slot;
     }
+    slot = (slot + 1) & slot_mask_;
+  }
+  return NO_SLOT;
+}
+
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Find(const K &key, size_t hash, V &value) const -> bool {
+  size_t slot = SlotOf(key, hash);
+  if (slot == NO_SLOT) {
+    return false;
   }
-  return false;
+  value = slots_[slot].second;
+  return true;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key) -> bool {
-  for (auto it = list_.begin(); it != list_.end(); it++) {
-    if (it->first == key) {
-      list_.erase(it);
-      return true;
+auto ExtendibleHashTable<K, V>::Bucket::Remove(const K &key, size_t hash) -> bool {
+  size_t slot = SlotOf(key, hash);
+  if (slot == NO_SLOT) {
+    return false;
+  }
+  tags_[slot] = 0;
+  num_entries_--;
+  // Shift back the entries after it that would not be found any more across the hole: those whose home slot does
+  // not lie cyclically in (hole, next].
+  size_t hole = slot;
+  size_t next = slot;
+  while (true) {
+    next = (next + 1) & slot_mask_;
+    if (tags_[next] == 0) {
+      break;
+    }
+    size_t home = HomeSlot(hashes_[next]);
+    bool reachable = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+    if (!reachable) {
+      tags_[hole] = tags_[next];
+      hashes_[hole] = hashes_[next];
+      slots_[hole] = std::move(slots_[next]);
+      tags_[next] = 0;
+      hole = next;
     }
   }
+  return true;
+}
 
-  return false;
+template <typename K, typename V>
+auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, size_t hash, const V &value) -> bool {
+  size_t slot = SlotOf(key, hash);
+  if (slot != NO_SLOT) {
+    slots_[slot].second = value;
+    return true;
+  }
+  if (IsFull()) {
+    return false;
+  }
+  slot = HomeSlot(hash);
+  while (tags_[slot] != 0) {
+    slot = (slot + 1) & slot_mask_;
+  }
+  tags_[slot] = TagOf(hash);
+  hashes_[slot] = hash;
+  slots_[slot] = {key, value};
+  num_entries_++;
+  return true;
 }
 
 template <typename K, typename V>
-auto ExtendibleHashTable<K, V>::Bucket::Insert(const K &key, const V &value) -> bool {
-  for (auto &[k, v] : list_) {
-    if (k == key) {
-      v = value;
-      return true;
+void ExtendibleHashTable<K, V>::Bucket::SplitTo(Bucket *sibling) {
+  size_t high_bit = size_t{1} << depth_;
+  depth_++;
+  // take everything out, then put back what stays and hand over what moves
+  std::vector<std::pair<size_t, std::pair<K, V>>> entries;
+  entries.reserve(num_entries_);
+  for (size_t slot = 0; slot <= slot_mask_; slot++) {
+    if (tags_[slot] != 0) {
+      entries.emplace_back(hashes_[slot], std::move(slots_[slot]));
+      tags_[slot] = 0;
     }
   }
-  if (!IsFull()) {
-    list_.emplace_back(key, value);
-    return true;
+  num_entries_ = 0;
+  for (auto &[hash, entry] : entries) {
+    ((hash & high_bit) != 0 ? sibling : this)->Insert(entry.first, hash, entry.second);
   }
-  return false;
 }
 
 template class ExtendibleHashTable<page_id_t, Page *>;
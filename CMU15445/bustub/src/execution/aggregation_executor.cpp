@@ -9,20 +9,151 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
 #include <memory>
 #include <vector>
 
 #include "execution/executors/aggregation_executor.h"
+#include "execution/pipeline.h"
 
 namespace bustub {
 
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
 
-void AggregationExecutor::Init() {}
+void AggregationExecutor::Init() {
+  child_->Init();
+  aht_ = nullptr;
+  spilled_.clear();
+  built_ = false;
+}
 
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+void AggregationExecutor::InsertBatch(const TupleBatch &batch, AggregationHashTable *aht) const {
+  // evaluate every expression column by column, then fold the rows into the table
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  std::vector<std::vector<Value>> key_columns(group_bys.size());
+  std::vector<std::vector<Value>> value_columns(aggregates.size());
+  for (size_t i = 0; i < group_bys.size(); i++) {
+    group_bys[i]->EvaluateBatch(batch, &key_columns[i]);
+  }
+  for (size_t i = 0; i < aggregates.size(); i++) {
+    aggregates[i]->EvaluateBatch(batch, &value_columns[i]);
+  }
+  AggregateKey key;
+  AggregateValue value;
+  for (auto row : batch.GetSelection()) {
+    key.group_bys_.clear();
+    for (const auto &column : key_columns) {
+      key.group_bys_.push_back(column[row]);
+    }
+    value.aggregates_.clear();
+    for (const auto &column : value_columns) {
+      value.aggregates_.push_back(column[row]);
+    }
+    aht->InsertCombine(key, value);
+  }
+}
+
+void AggregationExecutor::Build(bool by_batches) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto aht = std::make_unique<AggregationHashTable>(plan_, bpm, exec_ctx_->GetWorkMem());
+  // the worker tables spill on their own, but each pins a page per spilled partition while it writes to it, so a
+  // parallel build only runs while those pages leave half of the pool to the scan and the merge
+  if (auto pipeline = Pipeline::Make(child_.get());
+      pipeline != nullptr &&
+      pipeline->NumWorkers() * AggregationHashTable::NUM_PARTITIONS <= bpm->GetPoolSize() / 2) {
+    // each worker pre-aggregates the morsels it scans into its own table, then the tables are merged by partition
+    std::vector<std::unique_ptr<AggregationHashTable>> partials;
+    partials.reserve(pipeline->NumWorkers());
+    auto worker_budget = std::max<uint64_t>(exec_ctx_->GetWorkMem() / pipeline->NumWorkers(), 1);
+    for (size_t i = 0; i < pipeline->NumWorkers(); i++) {
+      partials.push_back(std::make_unique<AggregationHashTable>(plan_, bpm, worker_budget));
+    }
+    pipeline->Run(
+        [&](size_t worker, size_t /* morsel */, TupleBatch *batch) { InsertBatch(*batch, partials[worker].get()); });
+    for (auto &partial : partials) {
+      aht->Merge(partial.get(), exec_ctx_->GetThreadPool());
+    }
+  } else if (by_batches) {
+    TupleBatch batch;
+    while (child_->NextBatch(&batch)) {
+      InsertBatch(batch, aht.get());
+    }
+  } else {
+    Tuple tuple;
+    RID rid;
+    while (child_->Next(&tuple, &rid)) {
+      aht->InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
+    }
+  }
+  // without group-bys there is one output row even if the child produced nothing
+  if (plan_->GetGroupBys().empty()) {
+    aht->InsertInitial(AggregateKey{});
+  }
+  StartTable(std::move(aht));
+  built_ = true;
+}
+
+void AggregationExecutor::StartTable(std::unique_ptr<AggregationHashTable> &&aht) {
+  aht->Finish();
+  for (auto &file : aht->TakeSpilledPartitions()) {
+    spilled_.emplace_back(std::move(file), aht->GetLevel() + 1);
+  }
+  aht_ = std::move(aht);
+  aht_iterator_ = aht_->Begin();
+}
+
+auto AggregationExecutor::FindNextGroup() -> bool {
+  while (aht_iterator_ == aht_->End()) {
+    if (spilled_.empty()) {
+      return false;
+    }
+    // the partitions spilled last are aggregated first, so that a partition that spilled again is done before others
+    auto [file, level] = std::move(spilled_.back());
+    spilled_.pop_back();
+    auto aht = std::make_unique<AggregationHashTable>(plan_, exec_ctx_->GetBufferPoolManager(),
+                                                      exec_ctx_->GetWorkMem(), level);
+    aht->LoadSpilled(file.get());
+    StartTable(std::move(aht));
+  }
+  return true;
+}
+
+auto AggregationExecutor::MakeOutputValues() -> std::vector<Value> {
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  const auto &key = aht_iterator_.Key();
+  values.insert(values.end(), key.group_bys_.begin(), key.group_bys_.end());
+  const auto &val = aht_iterator_.Val();
+  values.insert(values.end(), val.aggregates_.begin(), val.aggregates_.end());
+  return values;
+}
+
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (!built_) {
+    Build(false);
+  }
+  if (!FindNextGroup()) {
+    return false;
+  }
+  *tuple = Tuple{MakeOutputValues(), &GetOutputSchema()};
+  ++aht_iterator_;
+  return true;
+}
+
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!built_) {
+    Build(true);
+  }
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && FindNextGroup()) {
+    batch->Append(MakeOutputValues());
+    ++aht_iterator_;
+  }
+  return !batch->IsEmpty();
+}
 
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
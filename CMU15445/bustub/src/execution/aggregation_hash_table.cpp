@@ -0,0 +1,344 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.cpp
+//
+// Identification: src/execution/aggregation_hash_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/aggregation_hash_table.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "execution/sort_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+AggregationHashTable::AggregationHashTable(const AggregationPlanNode *plan, BufferPoolManager *bpm,
+                                           uint64_t memory_budget, size_t level)
+    : plan_(plan), bpm_(bpm), memory_budget_(memory_budget), level_(level) {}
+
+auto AggregationHashTable::EncodeKey(const AggregateKey &key, std::string *encoded) const -> hash_t {
+  // the encoding of equal values is the same bytes, nulls included, so that null keys make one group
+  encoded->clear();
+  for (const auto &value : key.group_bys_) {
+    SortKeyEncoder::EncodeValue(value, false, encoded);
+  }
+  // fmix64 of MurmurHash3, since the top bits pick the partition
+  hash_t hash = HashUtil::HashBytes(encoded->data(), encoded->size());
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+auto AggregationHashTable::FindOrInsert(Partition *partition, std::string_view encoded, hash_t hash,
+                                        const AggregateKey &key) -> uint32_t {
+  if (partition->file_ != nullptr) {
+    return NO_GROUP;
+  }
+  if (2 * (partition->keys_.size() + 1) > partition->slots_.size()) {
+    Grow(partition);
+  }
+  auto mask = partition->slots_.size() - 1;
+  for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+    auto group = partition->slots_[slot];
+    if (group == NO_GROUP) {
+      group = partition->keys_.size();
+      partition->slots_[slot] = group;
+      partition->encoded_keys_.append(encoded);
+      partition->key_offsets_.push_back(partition->encoded_keys_.size());
+      partition->hashes_.push_back(hash);
+      partition->keys_.push_back(key);
+      partition->values_.push_back(GenerateInitialAggregateValue());
+      // besides the encoded key, a group has its hash, an offset, about two slots, and its values
+      auto num_bytes = encoded.size() + sizeof(hash_t) + sizeof(size_t) + 2 * sizeof(uint32_t) +
+                       sizeof(AggregateKey) + sizeof(AggregateValue) +
+                       (key.group_bys_.size() + plan_->GetAggregates().size()) * sizeof(Value);
+      partition->num_bytes_ += num_bytes;
+      return group;
+    }
+    if (partition->hashes_[group] == hash) {
+      auto begin = partition->key_offsets_[group];
+      auto size = partition->key_offsets_[group + 1] - begin;
+      if (size == encoded.size() && memcmp(partition->encoded_keys_.data() + begin, encoded.data(), size) == 0) {
+        return group;
+      }
+    }
+  }
+}
+
+void AggregationHashTable::Grow(Partition *partition) {
+  auto num_slots = std::max<size_t>(16, 2 * partition->slots_.size());
+  auto mask = num_slots - 1;
+  partition->slots_.assign(num_slots, NO_GROUP);
+  for (uint32_t group = 0; group < partition->hashes_.size(); group++) {
+    auto slot = partition->hashes_[group] & mask;
+    while (partition->slots_[slot] != NO_GROUP) {
+      slot = (slot + 1) & mask;
+    }
+    partition->slots_[slot] = group;
+  }
+}
+
+void AggregationHashTable::InsertCombine(const AggregateKey &key, const AggregateValue &value) {
+  auto hash = EncodeKey(key, &encoded_);
+  auto &partition = partitions_[PartitionOf(hash)];
+  auto num_bytes = partition.num_bytes_;
+  auto group = FindOrInsert(&partition, encoded_, hash, key);
+  if (group == NO_GROUP) {
+    auto partial = GenerateInitialAggregateValue();
+    CombineAggregateValues(&partial, value);
+    WriteSpilled(&partition, key, partial);
+    return;
+  }
+  CombineAggregateValues(&partition.values_[group], value);
+  num_bytes_ += partition.num_bytes_ - num_bytes;
+  if (num_bytes_ > memory_budget_) {
+    SpillUntilFits();
+  }
+}
+
+void AggregationHashTable::InsertInitial(const AggregateKey &key) {
+  auto hash = EncodeKey(key, &encoded_);
+  auto &partition = partitions_[PartitionOf(hash)];
+  auto num_bytes = partition.num_bytes_;
+  if (FindOrInsert(&partition, encoded_, hash, key) == NO_GROUP) {
+    WriteSpilled(&partition, key, GenerateInitialAggregateValue());
+  }
+  num_bytes_ += partition.num_bytes_ - num_bytes;
+}
+
+void AggregationHashTable::Merge(AggregationHashTable *other, ThreadPool *thread_pool) {
+  // partitions are merged independently, each into the same partition since both tables are at the same level
+  auto merge_partition = [this, other](size_t index) {
+    auto &from = other->partitions_[index];
+    auto &to = partitions_[index];
+    if (from.file_ != nullptr || to.file_ != nullptr) {
+      // the groups of a key must all end up in one file, so both partitions go to the file of this one
+      if (to.file_ == nullptr) {
+        SpillPartition(&to);
+      }
+      for (uint32_t group = 0; group < from.keys_.size(); group++) {
+        WriteSpilled(&to, from.keys_[group], from.values_[group]);
+      }
+      if (from.file_ != nullptr) {
+        from.file_->FinishWriting();
+        TmpTupleFile::Reader reader(from.file_.get());
+        Tuple tuple;
+        while (reader.Next(&tuple)) {
+          to.file_->Append(tuple);
+        }
+      }
+      from = Partition{};
+      return;
+    }
+    for (uint32_t group = 0; group < from.keys_.size(); group++) {
+      auto begin = from.key_offsets_[group];
+      std::string_view encoded(from.encoded_keys_.data() + begin, from.key_offsets_[group + 1] - begin);
+      auto into = FindOrInsert(&to, encoded, from.hashes_[group], from.keys_[group]);
+      MergeAggregateValues(&to.values_[into], from.values_[group]);
+    }
+    from = Partition{};
+  };
+  // the memory of the whole table is recounted once all partitions are merged
+  if (thread_pool != nullptr) {
+    thread_pool->Run(NUM_PARTITIONS, [&](size_t /* worker */, size_t index) { merge_partition(index); });
+  } else {
+    for (size_t index = 0; index < NUM_PARTITIONS; index++) {
+      merge_partition(index);
+    }
+  }
+  num_bytes_ = 0;
+  for (const auto &partition : partitions_) {
+    num_bytes_ += partition.num_bytes_;
+  }
+  other->num_bytes_ = 0;
+  if (num_bytes_ > memory_budget_) {
+    SpillUntilFits();
+  }
+}
+
+void AggregationHashTable::SpillUntilFits() {
+  if (level_ >= MAX_LEVEL) {
+    return;
+  }
+  while (num_bytes_ > memory_budget_) {
+    auto largest = std::max_element(partitions_.begin(), partitions_.end(), [](const auto &a, const auto &b) {
+      return a.num_bytes_ < b.num_bytes_;
+    });
+    if (largest->num_bytes_ == 0) {
+      return;
+    }
+    num_bytes_ -= largest->num_bytes_;
+    SpillPartition(&*largest);
+  }
+}
+
+void AggregationHashTable::SpillPartition(Partition *partition) {
+  partition->file_ = std::make_unique<TmpTupleFile>(bpm_);
+  for (size_t group = 0; group < partition->keys_.size(); group++) {
+    WriteSpilled(partition, partition->keys_[group], partition->values_[group]);
+  }
+  auto file = std::move(partition->file_);
+  *partition = Partition{};
+  partition->file_ = std::move(file);
+}
+
+void AggregationHashTable::WriteSpilled(Partition *partition, const AggregateKey &key, const AggregateValue &value) {
+  // a spilled group is a row of the output schema; a null takes the type of its column so that it serializes as one
+  const auto &schema = plan_->OutputSchema();
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (const auto *column_values : {&key.group_bys_, &value.aggregates_}) {
+    for (const auto &column_value : *column_values) {
+      values.push_back(column_value.IsNull()
+                           ? ValueFactory::GetNullValueByType(schema.GetColumn(values.size()).GetType())
+                           : column_value);
+    }
+  }
+  partition->file_->Append(Tuple(values, &schema));
+}
+
+void AggregationHashTable::Finish() {
+  for (auto &partition : partitions_) {
+    if (partition.file_ != nullptr) {
+      partition.file_->FinishWriting();
+    }
+  }
+}
+
+auto AggregationHashTable::TakeSpilledPartitions() -> std::vector<std::unique_ptr<TmpTupleFile>> {
+  std::vector<std::unique_ptr<TmpTupleFile>> files;
+  for (auto &partition : partitions_) {
+    if (partition.file_ != nullptr) {
+      files.push_back(std::move(partition.file_));
+    }
+  }
+  return files;
+}
+
+void AggregationHashTable::LoadSpilled(TmpTupleFile *file) {
+  const auto &schema = plan_->OutputSchema();
+  const auto num_group_bys = plan_->GetGroupBys().size();
+  TmpTupleFile::Reader reader(file);
+  Tuple tuple;
+  AggregateKey key;
+  AggregateValue partial;
+  while (reader.Next(&tuple)) {
+    key.group_bys_.clear();
+    partial.aggregates_.clear();
+    for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+      (i < num_group_bys ? key.group_bys_ : partial.aggregates_).push_back(tuple.GetValue(&schema, i));
+    }
+    auto hash = EncodeKey(key, &encoded_);
+    auto &partition = partitions_[PartitionOf(hash)];
+    auto num_bytes = partition.num_bytes_;
+    auto group = FindOrInsert(&partition, encoded_, hash, key);
+    if (group == NO_GROUP) {
+      WriteSpilled(&partition, key, partial);
+      continue;
+    }
+    MergeAggregateValues(&partition.values_[group], partial);
+    num_bytes_ += partition.num_bytes_ - num_bytes;
+    if (num_bytes_ > memory_budget_) {
+      SpillUntilFits();
+    }
+  }
+}
+
+auto AggregationHashTable::GenerateInitialAggregateValue() const -> AggregateValue {
+  const auto &schema = plan_->OutputSchema();
+  const auto num_group_bys = plan_->GetGroupBys().size();
+  std::vector<Value> values{};
+  for (const auto &agg_type : plan_->GetAggregateTypes()) {
+    switch (agg_type) {
+      case AggregationType::CountStarAggregate:
+        // Count start starts at zero.
+        values.emplace_back(ValueFactory::GetIntegerValue(0));
+        break;
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+      case AggregationType::MinAggregate:
+      case AggregationType::MaxAggregate:
+        // Others starts at null, of the type of their output column.
+        values.emplace_back(
+            ValueFactory::GetNullValueByType(schema.GetColumn(num_group_bys + values.size()).GetType()));
+        break;
+    }
+  }
+  return {values};
+}
+
+void AggregationHashTable::CombineAggregateValues(AggregateValue *result, const AggregateValue &input) const {
+  const auto &agg_types = plan_->GetAggregateTypes();
+  for (uint32_t i = 0; i < agg_types.size(); i++) {
+    auto &acc = result->aggregates_[i];
+    const auto &val = input.aggregates_[i];
+    switch (agg_types[i]) {
+      case AggregationType::CountStarAggregate:
+        // counts are integers, which are bumped without going through Value::Add()
+        acc = ValueFactory::GetIntegerValue(acc.GetAs<int32_t>() + 1);
+        break;
+      case AggregationType::CountAggregate:
+        if (!val.IsNull()) {
+          acc = ValueFactory::GetIntegerValue(acc.IsNull() ? 1 : acc.GetAs<int32_t>() + 1);
+        }
+        break;
+      case AggregationType::SumAggregate:
+        if (!val.IsNull()) {
+          acc = acc.IsNull() ? val : acc.Add(val);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (!val.IsNull() && (acc.IsNull() || val.CompareLessThan(acc) == CmpBool::CmpTrue)) {
+          acc = val;
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (!val.IsNull() && (acc.IsNull() || val.CompareGreaterThan(acc) == CmpBool::CmpTrue)) {
+          acc = val;
+        }
+        break;
+    }
+  }
+}
+
+void AggregationHashTable::MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) const {
+  const auto &agg_types = plan_->GetAggregateTypes();
+  for (uint32_t i = 0; i < agg_types.size(); i++) {
+    auto &acc = result->aggregates_[i];
+    const auto &val = partial.aggregates_[i];
+    switch (agg_types[i]) {
+      case AggregationType::CountStarAggregate:
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        // counts add up like sums
+        if (!val.IsNull()) {
+          acc = acc.IsNull() ? val : acc.Add(val);
+        }
+        break;
+      case AggregationType::MinAggregate:
+        if (!val.IsNull() && (acc.IsNull() || val.CompareLessThan(acc) == CmpBool::CmpTrue)) {
+          acc = val;
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (!val.IsNull() && (acc.IsNull() || val.CompareGreaterThan(acc) == CmpBool::CmpTrue)) {
+          acc = val;
+        }
+        break;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -13,15 +13,48 @@
 #include <memory>
 
 #include "execution/executors/delete_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 DeleteExecutor::DeleteExecutor(ExecutorContext *exec_ctx, const DeletePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void DeleteExecutor::Init() { throw NotImplementedException("DeleteExecutor is not implemented"); }
+void DeleteExecutor::Init() {
+  child_executor_->Init();
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->TableOid());
+  done_ = false;
+}
 
-auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto indexes = catalog->GetTableIndexes(table_info_->name_);
+
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    if (!table_info_->table_->MarkDelete(child_rid, txn)) {
+      continue;
+    }
+    for (auto *index_info : indexes) {
+      auto key = child_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_,
+                                          index_info->index_->GetKeyAttrs());
+      index_info->index_->DeleteEntry(key, child_rid, txn);
+      txn->GetIndexWriteSet()->emplace_back(child_rid, table_info_->oid_, WType::DELETE, child_tuple,
+                                            index_info->index_oid_, catalog);
+    }
+    count++;
+  }
+
+  *tuple = Tuple{{ValueFactory::GetIntegerValue(count)}, &GetOutputSchema()};
+  done_ = true;
+  return true;
+}
 
 }  // namespace bustub
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.cpp
+//
+// Identification: src/execution/external_sorter.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/external_sorter.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+/** @return the first 8 bytes of a key as a big-endian number, so that numbers compare like the keys do */
+auto KeyPrefix(const char *key, size_t size) -> uint64_t {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < size ? static_cast<uint8_t>(key[i]) : 0);
+  }
+  return prefix;
+}
+
+}  // namespace
+
+void ExternalSorter::Insert(const Tuple &tuple) {
+  auto key_offset = keys_.size();
+  encoder_->Encode(tuple, &keys_);
+  auto key_size = keys_.size() - key_offset;
+  auto tuple_offset = tuples_.size();
+  tuples_.resize(tuples_.size() + sizeof(uint32_t) + tuple.GetLength());
+  tuple.SerializeTo(tuples_.data() + tuple_offset);
+  entries_.push_back({KeyPrefix(keys_.data() + key_offset, key_size), key_offset, static_cast<uint32_t>(key_size),
+                      tuple_offset});
+  if (RunBytes() > memory_budget_) {
+    SpillRun();
+  }
+}
+
+void ExternalSorter::SortRun() {
+  const auto *keys = keys_.data();
+  std::stable_sort(entries_.begin(), entries_.end(), [keys](const Entry &a, const Entry &b) {
+    if (a.prefix_ != b.prefix_) {
+      return a.prefix_ < b.prefix_;
+    }
+    return SortKeyEncoder::Compare({keys + a.key_offset_, a.key_size_}, {keys + b.key_offset_, b.key_size_}) < 0;
+  });
+}
+
+void ExternalSorter::SpillRun() {
+  SortRun();
+  auto file = std::make_unique<TmpTupleFile>(bpm_);
+  Tuple tuple;
+  for (const auto &entry : entries_) {
+    tuple.DeserializeFrom(tuples_.data() + entry.tuple_offset_);
+    file->Append(tuple);
+  }
+  file->FinishWriting();
+  runs_.push_back(std::move(file));
+  num_spilled_runs_++;
+  keys_.clear();
+  tuples_.clear();
+  entries_.clear();
+}
+
+void ExternalSorter::Finish() {
+  cursor_ = 0;
+  if (runs_.empty()) {
+    SortRun();
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillRun();
+  }
+  keys_ = {};
+  tuples_ = {};
+  entries_ = {};
+  // each run being merged holds a page of tuples in memory
+  auto fan_in = std::max<size_t>(2, memory_budget_ / BUSTUB_PAGE_SIZE);
+  while (runs_.size() > fan_in) {
+    std::vector<std::unique_ptr<TmpTupleFile>> merged;
+    for (size_t begin = 0; begin < runs_.size(); begin += fan_in) {
+      auto end = std::min(begin + fan_in, runs_.size());
+      std::vector<std::unique_ptr<TmpTupleFile>> group(std::make_move_iterator(runs_.begin() + begin),
+                                                      std::make_move_iterator(runs_.begin() + end));
+      merged.push_back(group.size() == 1 ? std::move(group[0]) : MergeRuns(std::move(group)));
+    }
+    runs_ = std::move(merged);
+  }
+  sources_ = OpenSources(std::move(runs_));
+  runs_.clear();
+  merge_ = std::make_unique<LoserTree<SourceLess>>(sources_.size(), SourceLess{&sources_});
+}
+
+auto ExternalSorter::Next(Tuple *tuple) -> bool {
+  if (merge_ == nullptr) {
+    if (cursor_ >= entries_.size()) {
+      return false;
+    }
+    tuple->DeserializeFrom(tuples_.data() + entries_[cursor_++].tuple_offset_);
+    return true;
+  }
+  auto &source = sources_[merge_->Top()];
+  if (!source.valid_) {
+    return false;
+  }
+  *tuple = source.tuple_;
+  source.Advance();
+  merge_->Replay();
+  return true;
+}
+
+auto ExternalSorter::MergeRuns(std::vector<std::unique_ptr<TmpTupleFile>> &&runs) -> std::unique_ptr<TmpTupleFile> {
+  auto sources = OpenSources(std::move(runs));
+  LoserTree<SourceLess> merge(sources.size(), SourceLess{&sources});
+  auto file = std::make_unique<TmpTupleFile>(bpm_);
+  for (auto *source = &sources[merge.Top()]; source->valid_; source = &sources[merge.Top()]) {
+    file->Append(source->tuple_);
+    source->Advance();
+    merge.Replay();
+  }
+  file->FinishWriting();
+  // the merged runs are deleted with their sources
+  return file;
+}
+
+auto ExternalSorter::OpenSources(std::vector<std::unique_ptr<TmpTupleFile>> &&runs) const -> std::vector<Source> {
+  std::vector<Source> sources(runs.size());
+  for (size_t i = 0; i < runs.size(); i++) {
+    sources[i].encoder_ = encoder_;
+    sources[i].file_ = std::move(runs[i]);
+    sources[i].reader_ = std::make_unique<TmpTupleFile::Reader>(sources[i].file_.get());
+    sources[i].Advance();
+  }
+  return sources;
+}
+
+auto ExternalSorter::Source::Advance() -> bool {
+  valid_ = reader_->Next(&tuple_);
+  if (valid_) {
+    key_.clear();
+    encoder_->Encode(tuple_, &key_);
+  }
+  return valid_;
+}
+
+auto ExternalSorter::SourceLess::operator()(size_t a, size_t b) const -> bool {
+  const auto &lhs = (*sources_)[a];
+  const auto &rhs = (*sources_)[b];
+  // a run that is done is larger than everything
+  if (!lhs.valid_ || !rhs.valid_) {
+    return lhs.valid_ != rhs.valid_ ? lhs.valid_ : a < b;
+  }
+  auto cmp = SortKeyEncoder::Compare(lhs.key_, rhs.key_);
+  return cmp != 0 ? cmp < 0 : a < b;
+}
+
+}  // namespace bustub
@@ -31,4 +31,15 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // Keep the rows of the child batches that pass, until a batch keeps any
+  while (child_executor_->NextBatch(batch)) {
+    FilterBatch(batch);
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace bustub
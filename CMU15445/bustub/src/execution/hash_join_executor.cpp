@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
 #include "execution/executors/hash_join_executor.h"
+#include "type/value_factory.h"
 
 // Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
 // if you want to get faster in leaderboard tests.
@@ -20,15 +25,290 @@ namespace bustub {
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void HashJoinExecutor::Init() { throw NotImplementedException("HashJoinExecutor is not implemented"); }
+void HashJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  table_ = std::make_unique<JoinHashTable>(exec_ctx_->GetBufferPoolManager(), &right_executor_->GetOutputSchema(),
+                                           &plan_->RightJoinKeyExpression(), exec_ctx_->GetWorkMem());
+  built_ = false;
+  left_batch_.Reset(&left_executor_->GetOutputSchema());
+  cursor_ = ProbeCursor{};
+  partitioned_ = false;
+  spilled_.clear();
+  left_reader_ = nullptr;
+  left_file_ = nullptr;
+  pipeline_ = nullptr;
+  next_morsel_ = 0;
+  gathered_.clear();
+  next_batch_.Reset(&GetOutputSchema());
+  next_row_ = 0;
+}
+
+void HashJoinExecutor::BuildHashTable() {
+  if (built_) {
+    return;
+  }
+  // a parallel build holds all rows in memory until it is done, so it is only used when the table fits the budget
+  if (auto pipeline = Pipeline::Make(right_executor_.get());
+      pipeline != nullptr && pipeline->NumPages() * BUSTUB_PAGE_SIZE <= exec_ctx_->GetWorkMem()) {
+    BuildParallel(pipeline.get());
+  } else {
+    Build();
+  }
+  built_ = true;
+}
+
+void HashJoinExecutor::Build() {
+  TupleBatch batch;
+  std::vector<Value> keys;
+  while (right_executor_->NextBatch(&batch)) {
+    plan_->RightJoinKeyExpression().EvaluateBatch(batch, &keys);
+    for (auto row : batch.GetSelection()) {
+      // a null key equals nothing, so the row can never match
+      if (!keys[row].IsNull()) {
+        table_->Insert(keys[row], batch.GetTuple(row));
+      }
+    }
+  }
+  table_->Finish(nullptr);
+}
+
+void HashJoinExecutor::BuildParallel(Pipeline *pipeline) {
+  // first the workers hash the rows of each morsel into the partitions of the table ...
+  using StagedRows = std::vector<JoinHashTable::Rows>;
+  std::vector<StagedRows> staged(pipeline->NumMorsels(), StagedRows(JoinHashTable::NUM_PARTITIONS));
+  pipeline->Run([&](size_t /* worker */, size_t morsel, TupleBatch *batch) {
+    std::vector<Value> keys;
+    plan_->RightJoinKeyExpression().EvaluateBatch(*batch, &keys);
+    for (auto row : batch->GetSelection()) {
+      if (!keys[row].IsNull()) {
+        auto hash = JoinHashTable::Hash(keys[row]);
+        staged[morsel][JoinHashTable::PartitionOf(hash, 0)].Append(hash, keys[row], batch->GetTuple(row));
+      }
+    }
+  });
+  // ... then each worker collects a partition, going through the morsels in order so that the matches of a key keep
+  // the order of the table, like in a serial build
+  auto *thread_pool = exec_ctx_->GetThreadPool();
+  thread_pool->Run(JoinHashTable::NUM_PARTITIONS, [&](size_t /* worker */, size_t partition) {
+    for (auto &morsel : staged) {
+      table_->Append(partition, std::move(morsel[partition]));
+    }
+  });
+  table_->Finish(thread_pool);
+}
+
+auto HashJoinExecutor::GatherMorsels() -> bool {
+  // a few morsels at a time, so that the output kept is bounded by their number rather than by the table
+  auto begin = next_morsel_;
+  if (begin >= pipeline_->NumMorsels()) {
+    return false;
+  }
+  auto end = std::min(pipeline_->NumMorsels(), begin + pipeline_->NumWorkers() * GATHER_MORSELS_PER_WORKER);
+  std::vector<std::vector<TupleBatch>> output(end - begin);
+  pipeline_->Run(begin, end, [&output, begin](size_t /* worker */, size_t morsel, TupleBatch *batch) {
+    output[morsel - begin].push_back(std::move(*batch));
+  });
+  for (auto &morsel : output) {
+    std::move(morsel.begin(), morsel.end(), std::back_inserter(gathered_));
+  }
+  next_morsel_ = end;
+  return true;
+}
+
+void HashJoinExecutor::PartitionLeft(TmpTupleFile *left_file) {
+  auto level = table_->GetLevel();
+  std::vector<std::unique_ptr<TmpTupleFile>> left_files(JoinHashTable::NUM_PARTITIONS);
+  for (auto &file : left_files) {
+    file = std::make_unique<TmpTupleFile>(exec_ctx_->GetBufferPoolManager());
+  }
+  auto append = [&](const Tuple &tuple, const Value &key) {
+    // a row with a null key matches nothing, but a left join still emits it, from any partition
+    if (key.IsNull() && plan_->GetJoinType() != JoinType::LEFT) {
+      return;
+    }
+    auto partition = key.IsNull() ? 0 : JoinHashTable::PartitionOf(JoinHashTable::Hash(key), level);
+    left_files[partition]->Append(tuple);
+  };
+  if (left_file == nullptr) {
+    TupleBatch batch;
+    std::vector<Value> keys;
+    while (left_executor_->NextBatch(&batch)) {
+      plan_->LeftJoinKeyExpression().EvaluateBatch(batch, &keys);
+      for (auto row : batch.GetSelection()) {
+        append(batch.GetTuple(row), keys[row]);
+      }
+    }
+  } else {
+    const auto &left_schema = left_executor_->GetOutputSchema();
+    TmpTupleFile::Reader reader(left_file);
+    Tuple tuple;
+    while (reader.Next(&tuple)) {
+      append(tuple, plan_->LeftJoinKeyExpression().Evaluate(&tuple, left_schema));
+    }
+  }
+  auto right_files = table_->TakeSpilledPartitions();
+  // queued last to first, so that the partitions are joined in order
+  for (size_t partition = JoinHashTable::NUM_PARTITIONS; partition-- > 0;) {
+    left_files[partition]->FinishWriting();
+    // without left rows a partition has no output, and without right rows an inner join has none either
+    if (left_files[partition]->NumTuples() == 0 ||
+        (right_files[partition]->NumTuples() == 0 && plan_->GetJoinType() != JoinType::LEFT)) {
+      continue;
+    }
+    spilled_.push_back({std::move(right_files[partition]), std::move(left_files[partition]), level + 1});
+  }
+}
+
+auto HashJoinExecutor::LoadNextSpilled() -> bool {
+  while (!spilled_.empty()) {
+    auto [right_file, left_file, level] = std::move(spilled_.back());
+    spilled_.pop_back();
+    table_ = std::make_unique<JoinHashTable>(exec_ctx_->GetBufferPoolManager(), &right_executor_->GetOutputSchema(),
+                                             &plan_->RightJoinKeyExpression(), exec_ctx_->GetWorkMem(), level);
+    table_->LoadSpilled(right_file.get());
+    right_file = nullptr;
+    table_->Finish(nullptr);
+    if (table_->IsSpilled()) {
+      // still too large: split both sides again by the next bits of the hash
+      PartitionLeft(left_file.get());
+      continue;
+    }
+    left_file_ = std::move(left_file);
+    left_reader_ = std::make_unique<TmpTupleFile::Reader>(left_file_.get());
+    return true;
+  }
+  return false;
+}
+
+auto HashJoinExecutor::NextLeftBatch(TupleBatch *batch) -> bool {
+  if (!partitioned_) {
+    if (!table_->IsSpilled()) {
+      return left_executor_->NextBatch(batch);
+    }
+    PartitionLeft(nullptr);
+    partitioned_ = true;
+  }
+  Tuple tuple;
+  while (left_reader_ != nullptr || LoadNextSpilled()) {
+    batch->Reset(&left_executor_->GetOutputSchema());
+    while (!batch->IsFull() && left_reader_->Next(&tuple)) {
+      batch->Append(tuple, RID{});
+    }
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+    // the partition is done, its pages can go
+    left_reader_ = nullptr;
+    left_file_ = nullptr;
+  }
+  return false;
+}
+
+auto HashJoinExecutor::MakeOutputRow(const TupleBatch &left_batch, size_t row, JoinHashTable::Match match) const
+    -> std::vector<Value> {
+  const auto num_left_columns = left_executor_->GetOutputSchema().GetColumnCount();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema().GetColumnCount());
+  for (uint32_t i = 0; i < num_left_columns; i++) {
+    values.push_back(left_batch.GetValue(row, i));
+  }
+  if (match.IsValid()) {
+    table_->AppendValues(match, &values);
+  } else {
+    // a left join emits a left row without match once, padded with nulls
+    const auto &right_schema = right_executor_->GetOutputSchema();
+    for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+      values.push_back(ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+    }
+  }
+  return values;
+}
+
+void HashJoinExecutor::ProbeRows(const TupleBatch &left_batch, const std::vector<Value> &left_keys,
+                                 ProbeCursor *cursor, TupleBatch *batch) const {
+  const auto &selection = left_batch.GetSelection();
+  while (!batch->IsFull() && cursor->row_ < selection.size()) {
+    auto row = selection[cursor->row_];
+    if (!cursor->row_started_) {
+      cursor->match_ = table_->Find(left_keys[row]);
+      cursor->row_started_ = true;
+      if (!cursor->match_.IsValid() && plan_->GetJoinType() == JoinType::LEFT) {
+        batch->Append(MakeOutputRow(left_batch, row, cursor->match_));
+      }
+    }
+    while (!batch->IsFull() && cursor->match_.IsValid()) {
+      batch->Append(MakeOutputRow(left_batch, row, cursor->match_));
+      cursor->match_ = table_->NextMatch(cursor->match_);
+    }
+    if (!cursor->match_.IsValid()) {
+      cursor->row_++;
+      cursor->row_started_ = false;
+    }
+  }
+}
+
+void HashJoinExecutor::ProbeBatch(const TupleBatch &left_batch, TupleBatch *scratch,
+                                  const Pipeline::Emit &emit) const {
+  std::vector<Value> keys;
+  plan_->LeftJoinKeyExpression().EvaluateBatch(left_batch, &keys);
+  ProbeCursor cursor;
+  while (cursor.row_ < left_batch.NumSelected()) {
+    scratch->Reset(&GetOutputSchema());
+    ProbeRows(left_batch, keys, &cursor, scratch);
+    emit(scratch);
+  }
+}
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (next_row_ >= next_batch_.NumSelected()) {
+    if (!NextBatch(&next_batch_)) {
+      return false;
+    }
+    next_row_ = 0;
+  }
+  *tuple = next_batch_.GetTuple(next_batch_.GetSelection()[next_row_++]);
+  return true;
+}
+
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!built_) {
+    pipeline_ = Pipeline::Make(this);
+    BuildHashTable();
+  }
+  if (pipeline_ != nullptr) {
+    while (gathered_.empty()) {
+      if (!GatherMorsels()) {
+        return false;
+      }
+    }
+    *batch = std::move(gathered_.front());
+    gathered_.pop_front();
+    return true;
+  }
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (cursor_.row_ >= left_batch_.NumSelected()) {
+      if (!NextLeftBatch(&left_batch_)) {
+        left_batch_.Reset(&left_executor_->GetOutputSchema());
+        break;
+      }
+      plan_->LeftJoinKeyExpression().EvaluateBatch(left_batch_, &left_keys_);
+      cursor_ = ProbeCursor{};
+    }
+    ProbeRows(left_batch_, left_keys_, &cursor_, batch);
+  }
+  return !batch->IsEmpty();
+}
 
 }  // namespace bustub
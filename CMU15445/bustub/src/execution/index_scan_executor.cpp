@@ -13,10 +13,51 @@
 
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info->table_name_);
+  auto *tree = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info->index_.get());
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  auto to_key = [&index_info](const std::optional<IndexScanBound> &bound) -> std::optional<IntegerKeyType> {
+    if (!bound.has_value()) {
+      return std::nullopt;
+    }
+    IntegerKeyType key;
+    key.SetFromKey(Tuple{{bound->key_}, &index_info->key_schema_});
+    return key;
+  };
+  const auto &lower = plan_->lower_bound_;
+  const auto &upper = plan_->upper_bound_;
+  // Close any iterator of an earlier run before opening the new one, as both latch leaves.
+  iterator_.reset();
+  iterator_.reset(new BPlusTreeIndexIteratorForOneIntegerColumn(tree->GetScanIterator(
+      to_key(lower), !lower.has_value() || lower->inclusive_, to_key(upper), !upper.has_value() || upper->inclusive_,
+      plan_->descending_ ? ScanDirection::Backward : ScanDirection::Forward)));
+}
+
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (!iterator_->IsEnd()) {
+    RID tuple_rid = (**iterator_).second;
+    ++(*iterator_);
+    Tuple table_tuple;
+    if (!table_info_->table_->GetTuple(tuple_rid, &table_tuple, exec_ctx_->GetTransaction())) {
+      continue;
+    }
+    if (plan_->filter_predicate_ != nullptr) {
+      // a predicate that evaluates to null does not select the row
+      auto value = plan_->filter_predicate_->Evaluate(&table_tuple, table_info_->schema_);
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    *tuple = table_tuple;
+    *rid = tuple_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
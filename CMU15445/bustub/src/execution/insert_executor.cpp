@@ -13,15 +13,49 @@
 #include <memory>
 
 #include "execution/executors/insert_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
+void InsertExecutor::Init() {
+  child_executor_->Init();
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->TableOid());
+  done_ = false;
+}
 
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto indexes = catalog->GetTableIndexes(table_info_->name_);
+
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    RID new_rid;
+    if (!table_info_->table_->InsertTuple(child_tuple, &new_rid, txn)) {
+      continue;
+    }
+    for (auto *index_info : indexes) {
+      auto key = child_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_,
+                                          index_info->index_->GetKeyAttrs());
+      index_info->index_->InsertEntry(key, new_rid, txn);
+      txn->GetIndexWriteSet()->emplace_back(new_rid, table_info_->oid_, WType::INSERT, child_tuple,
+                                            index_info->index_oid_, catalog);
+    }
+    count++;
+  }
+
+  *tuple = Tuple{{ValueFactory::GetIntegerValue(count)}, &GetOutputSchema()};
+  done_ = true;
+  return true;
+}
 
 }  // namespace bustub
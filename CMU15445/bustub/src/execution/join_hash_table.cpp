@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.cpp
+//
+// Identification: src/execution/join_hash_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/join_hash_table.h"
+
+#include <iterator>
+
+namespace bustub {
+
+void JoinHashTable::Rows::Append(hash_t hash, const Value &key, const Tuple &tuple) {
+  offsets_.push_back(arena_.size());
+  arena_.resize(arena_.size() + sizeof(uint32_t) + tuple.GetLength());
+  tuple.SerializeTo(arena_.data() + offsets_.back());
+  hashes_.push_back(hash);
+  keys_.push_back(key);
+}
+
+void JoinHashTable::Rows::Append(Rows &&other) {
+  auto base = arena_.size();
+  arena_.insert(arena_.end(), other.arena_.begin(), other.arena_.end());
+  for (auto offset : other.offsets_) {
+    offsets_.push_back(base + offset);
+  }
+  hashes_.insert(hashes_.end(), other.hashes_.begin(), other.hashes_.end());
+  keys_.insert(keys_.end(), std::make_move_iterator(other.keys_.begin()), std::make_move_iterator(other.keys_.end()));
+  other = Rows{};
+}
+
+auto JoinHashTable::Rows::NumBytes() const -> size_t {
+  // besides the arena, each row has an offset, a hash, a key, a link in its chain and about two slots
+  return arena_.size() + Size() * (sizeof(size_t) + sizeof(hash_t) + sizeof(Value) + 3 * sizeof(uint32_t));
+}
+
+JoinHashTable::JoinHashTable(BufferPoolManager *bpm, const Schema *schema, const AbstractExpression *key_expr,
+                             uint64_t memory_budget, size_t level)
+    : bpm_(bpm), schema_(schema), key_expr_(key_expr), memory_budget_(memory_budget), level_(level) {}
+
+void JoinHashTable::Insert(const Value &key, const Tuple &tuple) {
+  auto hash = Hash(key);
+  auto &partition = partitions_[PartitionOf(hash, level_)];
+  if (spilled_) {
+    partition.file_->Append(tuple);
+    return;
+  }
+  auto num_bytes = partition.rows_.NumBytes();
+  partition.rows_.Append(hash, key, tuple);
+  num_bytes_ += partition.rows_.NumBytes() - num_bytes;
+  if (num_bytes_ > memory_budget_ && level_ < MAX_LEVEL) {
+    Spill();
+  }
+}
+
+void JoinHashTable::Spill() {
+  for (auto &partition : partitions_) {
+    partition.file_ = std::make_unique<TmpTupleFile>(bpm_);
+    for (uint32_t row = 0; row < partition.rows_.Size(); row++) {
+      partition.file_->Append(RowTuple(partition, row));
+    }
+    partition.rows_ = Rows{};
+  }
+  num_bytes_ = 0;
+  spilled_ = true;
+}
+
+void JoinHashTable::Finish(ThreadPool *thread_pool) {
+  if (!spilled_) {
+    // rows appended by a parallel build are only counted now
+    num_bytes_ = 0;
+    for (const auto &partition : partitions_) {
+      num_bytes_ += partition.rows_.NumBytes();
+    }
+    if (num_bytes_ > memory_budget_ && level_ < MAX_LEVEL) {
+      Spill();
+    }
+  }
+  if (spilled_) {
+    for (auto &partition : partitions_) {
+      partition.file_->FinishWriting();
+    }
+    return;
+  }
+  if (thread_pool != nullptr) {
+    thread_pool->Run(partitions_.size(),
+                     [this](size_t /* worker */, size_t partition) { BuildSlots(&partitions_[partition]); });
+  } else {
+    for (auto &partition : partitions_) {
+      BuildSlots(&partition);
+    }
+  }
+}
+
+auto JoinHashTable::TakeSpilledPartitions() -> std::vector<std::unique_ptr<TmpTupleFile>> {
+  std::vector<std::unique_ptr<TmpTupleFile>> files;
+  files.reserve(partitions_.size());
+  for (auto &partition : partitions_) {
+    files.push_back(std::move(partition.file_));
+  }
+  return files;
+}
+
+void JoinHashTable::LoadSpilled(TmpTupleFile *file) {
+  TmpTupleFile::Reader reader(file);
+  Tuple tuple;
+  while (reader.Next(&tuple)) {
+    Insert(key_expr_->Evaluate(&tuple, *schema_), tuple);
+  }
+}
+
+void JoinHashTable::BuildSlots(Partition *partition) {
+  const auto &rows = partition->rows_;
+  size_t num_slots = 16;
+  while (num_slots < 2 * rows.Size()) {
+    num_slots *= 2;
+  }
+  auto mask = num_slots - 1;
+  partition->slots_.assign(num_slots, NO_ROW);
+  partition->next_.assign(rows.Size(), NO_ROW);
+  // going backwards, each row becomes the head of the chain of its key, so a chain goes forwards
+  for (auto row = static_cast<uint32_t>(rows.Size()); row-- > 0;) {
+    for (auto slot = rows.hashes_[row] & mask;; slot = (slot + 1) & mask) {
+      auto head = partition->slots_[slot];
+      if (head == NO_ROW) {
+        partition->slots_[slot] = row;
+        break;
+      }
+      if (rows.hashes_[head] == rows.hashes_[row] &&
+          rows.keys_[head].CompareEquals(rows.keys_[row]) == CmpBool::CmpTrue) {
+        partition->next_[row] = head;
+        partition->slots_[slot] = row;
+        break;
+      }
+    }
+  }
+}
+
+auto JoinHashTable::Find(const Value &key) const -> Match {
+  // a null key equals nothing
+  if (key.IsNull()) {
+    return {};
+  }
+  auto hash = Hash(key);
+  auto partition = PartitionOf(hash, level_);
+  const auto &part = partitions_[partition];
+  if (part.slots_.empty()) {
+    return {};
+  }
+  auto mask = part.slots_.size() - 1;
+  for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+    auto head = part.slots_[slot];
+    if (head == NO_ROW) {
+      return {};
+    }
+    if (part.rows_.hashes_[head] == hash && part.rows_.keys_[head].CompareEquals(key) == CmpBool::CmpTrue) {
+      return {partition, head};
+    }
+  }
+}
+
+auto JoinHashTable::RowTuple(const Partition &partition, uint32_t row) const -> Tuple {
+  const auto *data = partition.rows_.arena_.data() + partition.rows_.offsets_[row];
+  Tuple tuple;
+  tuple.size_ = *reinterpret_cast<const uint32_t *>(data);
+  tuple.data_ = const_cast<char *>(data + sizeof(uint32_t));  // NOLINT
+  return tuple;
+}
+
+void JoinHashTable::AppendValues(Match match, std::vector<Value> *values) const {
+  auto tuple = RowTuple(partitions_[match.partition_], match.row_);
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    values->push_back(tuple.GetValue(schema_, i));
+  }
+}
+
+}  // namespace bustub
@@ -16,10 +16,29 @@ namespace bustub {
 
 LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *plan,
                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void LimitExecutor::Init() { throw NotImplementedException("LimitExecutor is not implemented"); }
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  emitted_ = 0;
+}
 
-auto LimitExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto LimitExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (emitted_ >= plan_->GetLimit() || !child_executor_->Next(tuple, rid)) {
+    return false;
+  }
+  emitted_++;
+  return true;
+}
+
+auto LimitExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // the rows of the child batch are passed on as they are, past the limit they are just deselected
+  if (emitted_ >= plan_->GetLimit() || !child_executor_->NextBatch(batch)) {
+    return false;
+  }
+  batch->TruncateSelection(plan_->GetLimit() - emitted_);
+  emitted_ += batch->NumSelected();
+  return true;
+}
 
 }  // namespace bustub
@@ -12,19 +12,99 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include "type/value_factory.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestIndexJoinExecutor::Init() { throw NotImplementedException("NestIndexJoinExecutor is not implemented"); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  auto *catalog = exec_ctx_->GetCatalog();
+  index_info_ = catalog->GetIndex(plan_->GetIndexOid());
+  inner_table_info_ = catalog->GetTable(plan_->GetInnerTableOid());
+  outer_tuples_.clear();
+  inner_rids_.clear();
+  outer_cursor_ = 0;
+  inner_cursor_ = 0;
+}
+
+auto NestIndexJoinExecutor::FetchOuterBatch() -> bool {
+  outer_tuples_.clear();
+  outer_cursor_ = 0;
+  inner_cursor_ = 0;
+
+  Tuple outer_tuple;
+  RID outer_rid;
+  while (outer_tuples_.size() < static_cast<size_t>(INDEX_JOIN_BATCH_SIZE) &&
+         child_executor_->Next(&outer_tuple, &outer_rid)) {
+    outer_tuples_.push_back(outer_tuple);
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
 
-auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto *key_schema = index_info_->index_->GetKeySchema();
+  std::vector<Tuple> keys;
+  keys.reserve(outer_tuples_.size());
+  for (const auto &tuple : outer_tuples_) {
+    keys.emplace_back(std::vector<Value>{plan_->KeyPredicate()->Evaluate(&tuple, outer_schema)}, key_schema);
+  }
+  index_info_->index_->ScanKeys(keys, &inner_rids_, exec_ctx_->GetTransaction());
+  return true;
+}
+
+auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto &outer_schema = child_executor_->GetOutputSchema();
+  const auto &inner_schema = plan_->InnerTableSchema();
+
+  while (true) {
+    if (outer_cursor_ >= outer_tuples_.size() && !FetchOuterBatch()) {
+      return false;
+    }
+
+    const auto &outer_tuple = outer_tuples_[outer_cursor_];
+    const auto &matches = inner_rids_[outer_cursor_];
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema().GetColumnCount());
+    for (uint32_t i = 0; i < outer_schema.GetColumnCount(); i++) {
+      values.push_back(outer_tuple.GetValue(&outer_schema, i));
+    }
+
+    if (inner_cursor_ < matches.size()) {
+      Tuple inner_tuple;
+      auto found = inner_table_info_->table_->GetTuple(matches[inner_cursor_++], &inner_tuple,
+                                                       exec_ctx_->GetTransaction());
+      if (!found) {
+        continue;
+      }
+      for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+        values.push_back(inner_tuple.GetValue(&inner_schema, i));
+      }
+    } else {
+      // every match of this outer tuple has been emitted; a left join emits one padded row if there was none
+      bool emit_padded = plan_->GetJoinType() == JoinType::LEFT && matches.empty();
+      outer_cursor_++;
+      inner_cursor_ = 0;
+      if (!emit_padded) {
+        continue;
+      }
+      for (uint32_t i = 0; i < inner_schema.GetColumnCount(); i++) {
+        values.push_back(ValueFactory::GetNullValueByType(inner_schema.GetColumn(i).GetType()));
+      }
+    }
+
+    *tuple = Tuple{values, &GetOutputSchema()};
+    return true;
+  }
+}
 
 }  // namespace bustub
@@ -13,21 +13,73 @@
 #include "execution/executors/nested_loop_join_executor.h"
 #include "binder/table_ref/bound_join_ref.h"
 #include "common/exception.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void NestedLoopJoinExecutor::Init() { throw NotImplementedException("NestedLoopJoinExecutor is not implemented"); }
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  has_left_tuple_ = false;
+  left_matched_ = false;
+}
+
+auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  auto make_output = [&](const Tuple *right_tuple) {
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema().GetColumnCount());
+    for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+      values.push_back(left_tuple_.GetValue(&left_schema, i));
+    }
+    for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+      values.push_back(right_tuple != nullptr ? right_tuple->GetValue(&right_schema, i)
+                                              : ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+    }
+    return Tuple{values, &GetOutputSchema()};
+  };
 
-auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  while (true) {
+    if (!has_left_tuple_) {
+      RID left_rid;
+      if (!left_executor_->Next(&left_tuple_, &left_rid)) {
+        return false;
+      }
+      has_left_tuple_ = true;
+      left_matched_ = false;
+    }
+    Tuple right_tuple;
+    RID right_rid;
+    while (right_executor_->Next(&right_tuple, &right_rid)) {
+      auto value = plan_->Predicate().EvaluateJoin(&left_tuple_, left_schema, &right_tuple, right_schema);
+      if (!value.IsNull() && value.GetAs<bool>()) {
+        left_matched_ = true;
+        *tuple = make_output(&right_tuple);
+        return true;
+      }
+    }
+    // the inner side is exhausted: rewind it for the next left tuple
+    has_left_tuple_ = false;
+    right_executor_->Init();
+    if (!left_matched_ && plan_->GetJoinType() == JoinType::LEFT) {
+      *tuple = make_output(nullptr);
+      return true;
+    }
+  }
+}
 
 }  // namespace bustub
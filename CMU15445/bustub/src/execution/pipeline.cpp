@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.cpp
+//
+// Identification: src/execution/pipeline.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/pipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "execution/executors/filter_executor.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/executors/projection_executor.h"
+
+namespace bustub {
+
+Pipeline::Pipeline(ThreadPool *thread_pool, const SeqScanExecutor *scan, std::vector<Stage> &&stages)
+    : thread_pool_(thread_pool), scan_(scan), stages_(std::move(stages)), morsels_(scan->MakeMorsels()) {}
+
+auto Pipeline::Make(AbstractExecutor *executor) -> std::unique_ptr<Pipeline> {
+  auto *thread_pool = executor->GetExecutorContext()->GetThreadPool();
+  if (thread_pool == nullptr) {
+    return nullptr;
+  }
+  // walk down to the scan, collecting the stages from the top
+  std::vector<Stage> stages;
+  std::vector<HashJoinExecutor *> joins;
+  while (true) {
+    if (const auto *scan = dynamic_cast<const SeqScanExecutor *>(executor); scan != nullptr) {
+      // the lowest join first, in case its build side runs a pipeline through another one; a spilled hash table can
+      // only be joined one partition at a time, which the join does on its own
+      for (auto iter = joins.rbegin(); iter != joins.rend(); ++iter) {
+        (*iter)->BuildHashTable();
+        if ((*iter)->IsSpilled()) {
+          return nullptr;
+        }
+      }
+      std::reverse(stages.begin(), stages.end());
+      return std::unique_ptr<Pipeline>(new Pipeline(thread_pool, scan, std::move(stages)));
+    }
+    if (const auto *filter = dynamic_cast<const FilterExecutor *>(executor); filter != nullptr) {
+      stages.emplace_back([filter](TupleBatch *batch, TupleBatch * /* scratch */, const Emit &emit) {
+        filter->FilterBatch(batch);
+        emit(batch);
+      });
+      executor = filter->GetChildExecutor();
+    } else if (const auto *projection = dynamic_cast<const ProjectionExecutor *>(executor); projection != nullptr) {
+      stages.emplace_back([projection](TupleBatch *batch, TupleBatch *scratch, const Emit &emit) {
+        projection->ProjectBatch(*batch, scratch);
+        emit(scratch);
+      });
+      executor = projection->GetChildExecutor();
+    } else if (auto *join = dynamic_cast<HashJoinExecutor *>(executor); join != nullptr) {
+      stages.emplace_back([join](TupleBatch *batch, TupleBatch *scratch, const Emit &emit) {
+        join->ProbeBatch(*batch, scratch, emit);
+      });
+      joins.push_back(join);
+      executor = join->GetLeftExecutor();
+    } else {
+      return nullptr;
+    }
+  }
+}
+
+auto Pipeline::NumPages() const -> size_t {
+  size_t num_pages = 0;
+  for (const auto &morsel : morsels_) {
+    num_pages += morsel.size();
+  }
+  return num_pages;
+}
+
+void Pipeline::Run(size_t begin, size_t end, const Sink &sink) {
+  thread_pool_->Run(end - begin, [&](size_t worker, size_t task) {
+    auto morsel = begin + task;
+    // each stage writes into its own scratch batch, since the stages above still read it when it emits the next one
+    std::vector<TupleBatch> scratch(stages_.size());
+    std::function<void(size_t, TupleBatch *)> push = [&](size_t stage, TupleBatch *batch) {
+      if (batch->IsEmpty()) {
+        return;
+      }
+      if (stage == stages_.size()) {
+        sink(worker, morsel, batch);
+        return;
+      }
+      stages_[stage](batch, &scratch[stage], [&](TupleBatch *output) { push(stage + 1, output); });
+    };
+    scan_->ScanMorsel(morsels_[morsel], [&](TupleBatch *scanned) { push(0, scanned); });
+  });
+}
+
+}  // namespace bustub
@@ -73,8 +73,15 @@ auto AggregationPlanNode::InferAggSchema(const std::vector<AbstractExpressionRef
     }
   }
   for (size_t idx = 0; idx < aggregates.size(); idx++) {
-    // TODO(chi): correctly infer agg call return type
-    output.emplace_back(Column("<unnamed>", TypeId::INTEGER));
+    // counts are integers, while sum, min and max take the type of their input
+    auto is_count =
+        agg_types[idx] == AggregationType::CountStarAggregate || agg_types[idx] == AggregationType::CountAggregate;
+    auto type = is_count ? TypeId::INTEGER : aggregates[idx]->GetReturnType();
+    if (type == TypeId::VARCHAR) {
+      output.emplace_back(Column("<unnamed>", type, 128));
+    } else {
+      output.emplace_back(Column("<unnamed>", type));
+    }
   }
   return Schema(output);
 }
@@ -33,4 +33,26 @@ auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
 
   return true;
 }
+
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  // Get the next batch
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+
+  ProjectBatch(child_batch_, batch);
+  return true;
+}
+
+void ProjectionExecutor::ProjectBatch(const TupleBatch &child_batch, TupleBatch *batch) const {
+  // Compute expressions column by column, over the rows the child batch selects
+  batch->Reset(&GetOutputSchema());
+  batch->CopyRowLayout(child_batch);
+  const auto &exprs = plan_->GetExpressions();
+  for (uint32_t i = 0; i < exprs.size(); i++) {
+    std::vector<Value> column;
+    exprs[i]->EvaluateBatch(child_batch, &column);
+    batch->SetColumn(i, std::move(column));
+  }
+}
 }  // namespace bustub
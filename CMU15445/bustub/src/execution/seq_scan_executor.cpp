@@ -14,10 +14,87 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  iterator_ = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction()));
+  end_ = std::make_unique<TableIterator>(table_info_->table_->End());
+}
 
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (*iterator_ != *end_) {
+    *tuple = **iterator_;
+    *rid = tuple->GetRid();
+    ++(*iterator_);
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(tuple, table_info_->schema_);
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  while (true) {
+    batch->Reset(&GetOutputSchema());
+    while (!batch->IsFull() && *iterator_ != *end_) {
+      batch->Append(**iterator_, (*iterator_)->GetRid());
+      ++(*iterator_);
+    }
+    if (batch->NumRows() == 0) {
+      return false;
+    }
+    if (plan_->filter_predicate_ != nullptr) {
+      plan_->filter_predicate_->SelectBatch(batch);
+    }
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+}
+
+auto SeqScanExecutor::MakeMorsels() const -> std::vector<Morsel> {
+  std::vector<Morsel> morsels;
+  for (auto page_id : table_info_->table_->GetPageIds()) {
+    if (morsels.empty() || morsels.back().size() >= static_cast<size_t>(MORSEL_PAGES)) {
+      morsels.emplace_back();
+    }
+    morsels.back().push_back(page_id);
+  }
+  return morsels;
+}
+
+void SeqScanExecutor::ScanMorsel(const Morsel &morsel, const std::function<void(TupleBatch *)> &consume) const {
+  TupleBatch batch;
+  batch.Reset(&GetOutputSchema());
+  auto flush = [&]() {
+    if (plan_->filter_predicate_ != nullptr) {
+      plan_->filter_predicate_->SelectBatch(&batch);
+    }
+    if (!batch.IsEmpty()) {
+      consume(&batch);
+    }
+    batch.Reset(&GetOutputSchema());
+  };
+  std::vector<Tuple> tuples;
+  for (auto page_id : morsel) {
+    tuples.clear();
+    table_info_->table_->GetPageTuples(page_id, exec_ctx_->GetTransaction(), &tuples);
+    for (const auto &tuple : tuples) {
+      batch.Append(tuple, tuple.GetRid());
+      if (batch.IsFull()) {
+        flush();
+      }
+    }
+  }
+  if (batch.NumRows() > 0) {
+    flush();
+  }
+}
 
 }  // namespace bustub
@@ -4,10 +4,23 @@ namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      encoder_(&child_executor_->GetOutputSchema(), &plan_->GetOrderBy()) {}
 
-void SortExecutor::Init() { throw NotImplementedException("SortExecutor is not implemented"); }
+void SortExecutor::Init() {
+  child_executor_->Init();
+  sorter_ = std::make_unique<ExternalSorter>(exec_ctx_->GetBufferPoolManager(), &encoder_, exec_ctx_->GetWorkMem());
+  TupleBatch batch;
+  while (child_executor_->NextBatch(&batch)) {
+    for (auto row : batch.GetSelection()) {
+      sorter_->Insert(batch.GetTuple(row));
+    }
+  }
+  sorter_->Finish();
+}
 
-auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool { return sorter_->Next(tuple); }
 
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key.h"
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+namespace {
+
+/** Append the low num_bytes bytes of a number to a key, most significant first. */
+void AppendBigEndian(uint64_t bits, size_t num_bytes, std::string *key) {
+  for (size_t i = num_bytes; i-- > 0;) {
+    key->push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+  }
+}
+
+/** Append a signed integer of num_bytes bytes, with its sign bit flipped so that negative numbers come first. */
+void AppendSigned(int64_t value, size_t num_bytes, std::string *key) {
+  AppendBigEndian(static_cast<uint64_t>(value) ^ (uint64_t{1} << (8 * num_bytes - 1)), num_bytes, key);
+}
+
+}  // namespace
+
+void SortKeyEncoder::EncodeValue(const Value &value, bool descending, std::string *key) {
+  auto start = key->size();
+  if (value.IsNull()) {
+    key->push_back(0);
+  } else {
+    key->push_back(1);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+        key->push_back(static_cast<char>(value.GetAs<int8_t>()));
+        break;
+      case TypeId::TINYINT:
+        AppendSigned(value.GetAs<int8_t>(), sizeof(int8_t), key);
+        break;
+      case TypeId::SMALLINT:
+        AppendSigned(value.GetAs<int16_t>(), sizeof(int16_t), key);
+        break;
+      case TypeId::INTEGER:
+        AppendSigned(value.GetAs<int32_t>(), sizeof(int32_t), key);
+        break;
+      case TypeId::BIGINT:
+        AppendSigned(value.GetAs<int64_t>(), sizeof(int64_t), key);
+        break;
+      case TypeId::DECIMAL: {
+        // -0.0 equals 0.0; a negative number has all bits flipped so that a larger magnitude comes first
+        auto number = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        bits = (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+        AppendBigEndian(bits, sizeof(bits), key);
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), sizeof(uint64_t), key);
+        break;
+      case TypeId::VARCHAR: {
+        // the length of a varchar counts its terminating '\0'
+        const auto *data = value.GetData();
+        for (uint32_t i = 0; i + 1 < value.GetLength(); i++) {
+          key->push_back(data[i]);
+          if (data[i] == 0) {
+            key->push_back(static_cast<char>(0xff));
+          }
+        }
+        key->push_back(0);
+        key->push_back(0);
+        break;
+      }
+      default:
+        throw NotImplementedException(
+            fmt::format("cannot sort by a value of type {}", Type::TypeIdToString(value.GetTypeId())));
+    }
+  }
+  if (descending) {
+    for (auto i = start; i < key->size(); i++) {
+      (*key)[i] = static_cast<char>(~(*key)[i]);
+    }
+  }
+}
+
+}  // namespace bustub
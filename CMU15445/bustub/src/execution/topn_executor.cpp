@@ -1,13 +1,50 @@
+#include <algorithm>
+#include <queue>
+
 #include "execution/executors/topn_executor.h"
 
 namespace bustub {
 
 TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      encoder_(&child_executor_->GetOutputSchema(), &plan_->GetOrderBy()) {}
 
-void TopNExecutor::Init() { throw NotImplementedException("TopNExecutor is not implemented"); }
+void TopNExecutor::Init() {
+  child_executor_->Init();
+  entries_.clear();
+  cursor_ = 0;
+  // a max-heap of the best n entries seen so far, so that the worst of them is the one to evict
+  std::priority_queue<Entry> heap;
+  Tuple tuple;
+  RID rid;
+  for (size_t position = 0; child_executor_->Next(&tuple, &rid); position++) {
+    Entry entry{{}, position, {}};
+    encoder_.Encode(tuple, &entry.key_);
+    if (heap.size() < plan_->GetN()) {
+      entry.tuple_ = tuple;
+      heap.push(std::move(entry));
+    } else if (!heap.empty() && entry < heap.top()) {
+      entry.tuple_ = tuple;
+      heap.pop();
+      heap.push(std::move(entry));
+    }
+  }
+  while (!heap.empty()) {
+    entries_.push_back(heap.top());
+    heap.pop();
+  }
+  std::reverse(entries_.begin(), entries_.end());
+}
 
-auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (cursor_ >= entries_.size()) {
+    return false;
+  }
+  *tuple = entries_[cursor_++].tuple_;
+  return true;
+}
 
 }  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  columns_.resize(schema->GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+  }
+  rids_.clear();
+  selection_.clear();
+  num_rows_ = 0;
+}
+
+void TupleBatch::Append(const Tuple &tuple, RID rid) {
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+  selection_.push_back(num_rows_++);
+}
+
+void TupleBatch::Append(std::vector<Value> &&values, RID rid) {
+  BUSTUB_ASSERT(values.size() == columns_.size(), "a row holds one value per column");
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(std::move(values[i]));
+  }
+  rids_.push_back(rid);
+  selection_.push_back(num_rows_++);
+}
+
+void TupleBatch::CopyRowLayout(const TupleBatch &other) {
+  for (auto &column : columns_) {
+    column.clear();
+  }
+  rids_ = other.rids_;
+  selection_ = other.selection_;
+  num_rows_ = other.num_rows_;
+}
+
+auto TupleBatch::GetTuple(size_t row) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  return Tuple{values, schema_};
+}
+
+}  // namespace bustub
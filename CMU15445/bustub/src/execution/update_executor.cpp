@@ -12,17 +12,57 @@
 #include <memory>
 
 #include "execution/executors/update_executor.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 UpdateExecutor::UpdateExecutor(ExecutorContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {
-  // As of Fall 2022, you DON'T need to implement update executor to have perfect score in project 3 / project 4.
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void UpdateExecutor::Init() {
+  child_executor_->Init();
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->TableOid());
+  done_ = false;
 }
 
-void UpdateExecutor::Init() { throw NotImplementedException("UpdateExecutor is not implemented"); }
+auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto indexes = catalog->GetTableIndexes(table_info_->name_);
+
+  int32_t count = 0;
+  Tuple old_tuple;
+  RID old_rid;
+  while (child_executor_->Next(&old_tuple, &old_rid)) {
+    std::vector<Value> values;
+    values.reserve(plan_->target_expressions_.size());
+    for (const auto &expr : plan_->target_expressions_) {
+      values.push_back(expr->Evaluate(&old_tuple, child_executor_->GetOutputSchema()));
+    }
+    Tuple new_tuple{values, &table_info_->schema_};
+    if (!table_info_->table_->UpdateTuple(new_tuple, old_rid, txn)) {
+      continue;
+    }
+    for (auto *index_info : indexes) {
+      const auto &key_attrs = index_info->index_->GetKeyAttrs();
+      auto old_key = old_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, key_attrs);
+      auto new_key = new_tuple.KeyFromTuple(table_info_->schema_, index_info->key_schema_, key_attrs);
+      index_info->index_->DeleteEntry(old_key, old_rid, txn);
+      index_info->index_->InsertEntry(new_key, old_rid, txn);
+      IndexWriteRecord record{old_rid, table_info_->oid_, WType::UPDATE, new_tuple, index_info->index_oid_, catalog};
+      record.old_tuple_ = old_tuple;
+      txn->GetIndexWriteSet()->push_back(record);
+    }
+    count++;
+  }
 
-auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+  *tuple = Tuple{{ValueFactory::GetIntegerValue(count)}, &GetOutputSchema()};
+  done_ = true;
+  return true;
+}
 
 }  // namespace bustub
@@ -39,12 +39,31 @@ class BufferPoolManager {
 
   /** Grading function. Do not modify! */
   auto FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) -> Page * {
+    return FetchPage(page_id, AccessType::Unknown, callback);
+  }
+
+  /**
+   * Fetch a page and tell the buffer pool how it is going to be used. Pages fetched by sequential scans
+   * (AccessType::Scan) do not build up access history and are recycled through a small ring of frames, so that a
+   * large scan does not push the rest of the working set out of the pool.
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type, bufferpool_callback_fn callback = nullptr) -> Page * {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
-    auto *result = FetchPgImp(page_id);
+    auto *result = FetchPgImp(page_id, access_type);
     GradingCallback(callback, CallbackType::AFTER, page_id);
     return result;
   }
 
+  /**
+   * Start reading a page into the buffer pool in the background, so that a later FetchPage finds it resident. This is
+   * only a hint: nothing happens if the page is already resident or no frame can be freed for it.
+   * @param page_id id of the page to read ahead
+   * @param access_type how the page is going to be used once it is fetched
+   */
+  void PrefetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) {
+    PrefetchPgImp(page_id, access_type);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -104,9 +123,17 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return the requested page
    */
-  virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
+  virtual auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * = 0;
+
+  /**
+   * Start reading the requested page into the buffer pool without waiting for it.
+   * @param page_id id of page to be prefetched
+   * @param access_type how the page is going to be used
+   */
+  virtual void PrefetchPgImp(page_id_t page_id, AccessType access_type) = 0;
 
   /**
    * Unpin the target page from the buffer pool.
@@ -12,14 +12,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -41,17 +46,59 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
                             LogManager *log_manager = nullptr);
 
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr);
+
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
    */
   ~BufferPoolManagerInstance() override;
 
+  /**
+   * @brief Write every dirty page to disk as a single batch, without syncing them.
+   *
+   * FlushAllPages() is this followed by DiskManager::Sync(). A ParallelBufferPoolManager calls it on every instance
+   * and then syncs once.
+   */
+  void WriteDirtyPages();
+
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Start a background page cleaner, which writes dirty pages back before they come up for eviction.
+   *
+   * The cleaner keeps the clean_target frames that the replacer would evict next (counting free frames) clean, so
+   * that NewPage() and FetchPage() rarely have to write a victim back themselves. It runs whenever a foreground
+   * eviction had to write back, and every PAGE_CLEANER_INTERVAL_MS otherwise. Calling this again only changes the
+   * target.
+   *
+   * @param clean_target number of clean frames to keep available for eviction
+   */
+  void StartPageCleaner(size_t clean_target);
+
+  /** @brief Stop the page cleaner, if it is running. The destructor does this as well. */
+  void StopPageCleaner();
+
+  /** @brief Return the number of dirty victims that NewPage(), FetchPage() or a prefetch had to write back. */
+  auto GetForegroundWriteBacks() const -> size_t { return foreground_write_backs_; }
+
+  /** @brief Return the number of dirty pages that the page cleaner wrote back. */
+  auto GetBackgroundWriteBacks() const -> size_t { return background_write_backs_; }
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -85,10 +132,27 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPgImp().
    *
+   * Misses of sequential scans (AccessType::Scan) take their frame from the scan ring instead, see GetScanFrame().
+   *
+   * A hit does not take latch_, see FetchHit(); only a miss does.
+   *
    * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
-  auto FetchPgImp(page_id_t page_id) -> Page * override;
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
+  /**
+   * @brief Start reading a page into the buffer pool on the disk manager's background I/O threads.
+   *
+   * The frame is picked, registered in the page table and marked as in progress just like a FetchPgImp() miss, so a
+   * FetchPgImp() that arrives before the read completes simply waits for it. Until then the frame carries a pin of its
+   * own, which the I/O thread drops once the page is in memory.
+   *
+   * @param page_id id of page to be prefetched
+   * @param access_type how the page is going to be used
+   */
+  void PrefetchPgImp(page_id_t page_id, AccessType access_type) override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +185,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk, then DiskManager::Sync() them.
+   *
+   * Only dirty pages are written, and they are handed to DiskManager::RunRequests() as a single batch, so a
+   * checkpoint costs one round of concurrent writes plus one sync instead of one write per frame.
    */
   void FlushAllPgsImp() override;
 
@@ -140,29 +207,137 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  auto GetAvailableFrame(frame_id_t *out_frame_id) -> bool;
+  /**
+   * @brief Take a frame from the free list, or evict one from the replacer. Caller must hold latch_.
+   *
+   * If the victim is dirty, it is not written back here: its page id is returned through write_back_page_id and
+   * registered in write_back_table_, and the caller writes it back after releasing the latch.
+   *
+   * @param[out] out_frame_id the frame that is now owned by the caller
+   * @param[out] write_back_page_id the dirty page that still occupies the frame, or INVALID_PAGE_ID
+   * @return false if all frames are pinned, true otherwise
+   */
+  auto GetAvailableFrame(frame_id_t *out_frame_id, page_id_t *write_back_page_id) -> bool;
+
+  /**
+   * @brief Take a frame for a page that a sequential scan misses on. Caller must hold latch_.
+   *
+   * Scans cycle through a ring of at most scan_ring_size_ frames: the ring slot that comes up next is reused if the
+   * scan page in it is unpinned and nobody but a scan has touched it since, otherwise the slot is refilled through
+   * GetAvailableFrame(). A large scan therefore only ever displaces a handful of frames.
+   *
+   * @param[out] out_frame_id the frame that is now owned by the caller
+   * @param[out] write_back_page_id the dirty page that still occupies the frame, or INVALID_PAGE_ID
+   * @return false if all frames are pinned, true otherwise
+   */
+  auto GetScanFrame(frame_id_t *out_frame_id, page_id_t *write_back_page_id) -> bool;
+
+  /**
+   * @brief Pin a page that the page table maps to a frame, without taking latch_.
+   *
+   * The pin is taken with a compare-and-swap on the pin count, unless the frame is claimed. The page id is checked
+   * once the frame is pinned, since the frame may have gone to another page after the lookup.
+   *
+   * @param page_id the page that was looked up
+   * @param frame_id the frame that the page table mapped it to
+   * @param access_type how the page is going to be used
+   * @return the pinned page, or nullptr if the frame no longer holds it and the fetch has to go through latch_
+   */
+  auto FetchHit(page_id_t page_id, frame_id_t frame_id, AccessType access_type) -> Page *;
+
+  /**
+   * @brief Take an unpinned frame away from hits, by setting its pin count to FRAME_CLAIMED. Caller must hold latch_.
+   * @return false if the frame is pinned
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * @brief Detach the page in a frame that is being reused from the page table. Caller must hold latch_.
+   * @param frame_id the frame, which must no longer be tracked by the replacer
+   * @param[out] write_back_page_id the page if it is dirty and must be written back, or INVALID_PAGE_ID
+   */
+  void EvictFrame(frame_id_t frame_id, page_id_t *write_back_page_id);
+
+  /**
+   * @brief Mark the I/O on a frame as done and wake up everyone waiting for it. Caller must hold latch_.
+   * @param frame_id the frame whose contents are now valid
+   * @param write_back_page_id the page that was written back from the frame, or INVALID_PAGE_ID
+   */
+  void FinishFrameIo(frame_id_t frame_id, page_id_t write_back_page_id);
+
+  /**
+   * @brief Loop of the page cleaner thread.
+   *
+   * Each round pins the dirty frames among the next eviction candidates, writes them back as one batch through
+   * DiskManager::RunRequests() with the latch released, and unpins them again. Pinning keeps the frames out of the
+   * replacer without touching their access history, so they are still the next victims afterwards, just clean ones.
+   */
+  void PageCleanerMain();
+
+  /** Pin count of a frame that is free, or that latch_ holders are handing to another page. */
+  static constexpr int FRAME_CLAIMED = -1;
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
   /** The next page id to be allocated  */
   std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
 
-  /** Array of buffer pool pages. */
+  /** Array of buffer pool pages. It only holds the book-keeping of each frame; the data is in frame_arena_. */
   Page *pages_;
+  /** The data of all frames, placed according to buffer_pool_huge_pages and buffer_pool_numa_policy. */
+  FrameArena frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups in it are lock-free; updates happen under latch_. */
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
   LRUKReplacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the page table, the replacer, the free list, the page metadata and the I/O bookkeeping below.
+   * It is never held across disk I/O: the frame is marked as in progress instead, and the latch is dropped. Hits are
+   * the exception: they pin, read the flags below and update the replacer (which has a latch of its own) without it.
+   */
   std::mutex latch_;
+  /** Per frame: true while its contents are being read from or written back to disk. */
+  std::vector<std::atomic<bool>> io_in_progress_;
+  /** Per frame: signalled when the I/O on the frame completes. */
+  std::vector<std::condition_variable> io_cv_;
+  /** Dirty pages that were evicted but are still being written back, mapped to the frame they are written from. */
+  std::unordered_map<page_id_t, frame_id_t> write_back_table_;
+  /** Maximum number of frames in the scan ring. */
+  const size_t scan_ring_size_;
+  /** Frames recycled by sequential scans, and the slot the next scan miss looks at. */
+  std::vector<frame_id_t> scan_ring_;
+  size_t scan_ring_next_{0};
+  /** Per frame: true while the frame is in scan_ring_ and only scans have accessed its page. */
+  std::vector<std::atomic<bool>> in_scan_ring_;
+  /** Number of prefetches scheduled on the disk manager that have not completed yet. */
+  size_t prefetches_in_flight_{0};
+  /** Signalled when prefetches_in_flight_ drops to zero. */
+  std::condition_variable prefetch_cv_;
+  /** The page cleaner thread, if it was started. Started and joined under cleaner_thread_latch_. */
+  std::thread page_cleaner_;
+  std::mutex cleaner_thread_latch_;
+  /** True from when the page cleaner is started until it is told to stop. Set under latch_. */
+  std::atomic<bool> cleaner_running_{false};
+  /** Number of clean frames the page cleaner keeps available for eviction. */
+  size_t clean_target_{0};
+  /** Set to stop the page cleaner, and to wake it up early. */
+  bool cleaner_stop_{false};
+  bool cleaner_wakeup_{false};
+  /** Wakes up the page cleaner. */
+  std::condition_variable cleaner_cv_;
+  /** Dirty victims written back by the foreground, and dirty pages written back by the page cleaner. */
+  std::atomic<size_t> foreground_write_backs_{0};
+  std::atomic<size_t> background_write_backs_{0};
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
@@ -170,6 +345,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
+   * validate input data and ensure that a parallel BPM is routing requests to the correct BPI
+   * @param page_id
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
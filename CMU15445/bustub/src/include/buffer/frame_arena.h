@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is one contiguous, page-aligned mapping that holds the data of every frame of a buffer pool.
+ *
+ * With huge pages, the arena is first mapped from the hugetlbfs pool (MAP_HUGETLB). If no huge pages are reserved
+ * there, it is mapped 2MB-aligned and handed to transparent huge pages with madvise(MADV_HUGEPAGE). Either way a
+ * 2MB TLB entry covers 512 frames instead of one.
+ *
+ * Memory is not touched on construction, so each frame is faulted in by its first user, after the NUMA policy has
+ * been applied to the whole mapping with mbind().
+ */
+class FrameArena {
+ public:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** How the arena ended up being backed. */
+  enum class Backing { SmallPages, TransparentHugePages, HugeTlb };
+
+  /**
+   * @brief Map an arena for a buffer pool.
+   * @param num_frames number of frames in the buffer pool
+   * @param huge_pages back the arena with huge pages if the OS lets us
+   * @param numa_policy where to place the frames
+   * @param shard_index index of the buffer pool instance, which picks its node under NumaPolicy::ShardLocal
+   */
+  FrameArena(size_t num_frames, bool huge_pages, NumaPolicy numa_policy, size_t shard_index);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  ~FrameArena();
+
+  /** @return the data of a frame, BUSTUB_PAGE_SIZE bytes aligned to BUSTUB_PAGE_SIZE */
+  auto FrameData(frame_id_t frame_id) -> char * { return base_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE; }
+
+  /** @return how the arena is backed */
+  auto GetBacking() const -> Backing { return backing_; }
+
+  /** @return the number of NUMA nodes the arena is spread over; 1 if no policy was applied */
+  auto GetNumaNodes() const -> size_t { return numa_nodes_; }
+
+ private:
+  /** Map size_ bytes aligned to HUGE_PAGE_SIZE, trimming the excess. @return false if the mapping failed */
+  auto MapAligned() -> bool;
+
+  /** Apply the NUMA policy with mbind(). */
+  void BindToNodes(NumaPolicy numa_policy, size_t shard_index);
+
+  char *base_{nullptr};
+  size_t size_;
+  Backing backing_{Backing::SmallPages};
+  size_t numa_nodes_{1};
+};
+
+}  // namespace bustub
@@ -12,10 +12,9 @@
 
 #pragma once
 
+#include <functional>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
 #include "common/config.h"
@@ -33,6 +32,11 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * All bookkeeping lives in arrays indexed by frame id that are sized once at construction, so the replacer never
+ * allocates after that. The last k access timestamps of a frame are kept in a ring buffer, and the evictable frames
+ * (and only those) are kept in a binary min-heap ordered by eviction priority. Evict, RecordAccess, SetEvictable and
+ * Remove are O(log n) in the number of evictable frames.
  */
 class LRUKReplacer {
  public:
@@ -72,6 +76,18 @@ class LRUKReplacer {
    */
   auto Evict(frame_id_t *frame_id) -> bool;
 
+  /**
+   * @brief Evict like Evict(frame_id), but only a frame that the caller manages to take.
+   *
+   * can_evict is called on the next victim with the replacer latch held. If it fails, the frame was pinned behind the
+   * replacer's back: it is made non-evictable, keeping its access history, and the next victim is tried.
+   *
+   * @param[out] frame_id id of frame that is evicted.
+   * @param can_evict called on each victim in turn, true if the caller took the frame
+   * @return true if a frame is evicted successfully, false if no frames can be evicted.
+   */
+  auto Evict(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &can_evict) -> bool;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -81,9 +97,13 @@ class LRUKReplacer {
    * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
+   * Accesses of sequential scans (AccessType::Scan) only start tracking a frame; they are not added to the history of
+   * a frame that is already tracked. A frame that only scans have accessed is evicted before any other frame.
+   *
    * @param frame_id id of frame that received a new access.
+   * @param access_type how the frame is being accessed
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
 
   /**
    * TODO(P1): Add implementation
@@ -132,20 +152,52 @@ class LRUKReplacer {
    */
   auto Size() -> size_t;
 
+  /**
+   * @brief Peek at the frames that Evict() would pick next, without evicting them.
+   *
+   * The heap is walked best-first, so this costs O(m log m) for m returned frames instead of a full sort.
+   *
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames evictable frames, the next victim first
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t>;
+
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
+  static constexpr size_t INVALID_HEAP_POS = std::numeric_limits<size_t>::max();
 
   struct FrameEntry {
+    /** Number of accesses recorded since the frame was last evicted or removed; 0 if the frame is not tracked. */
     size_t hit_count_{0};
-    bool evictable_{true};
-    std::list<frame_id_t>::iterator pos_;
+    bool evictable_{false};
+    /** True if every recorded access came from a sequential scan. */
+    bool scan_only_{false};
+    /** Position of the frame in heap_, or INVALID_HEAP_POS if it is not evictable. */
+    size_t heap_pos_{INVALID_HEAP_POS};
   };
 
-  std::list<frame_id_t> hist_list_;
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, FrameEntry> entries_;
-  [[maybe_unused]] size_t current_timestamp_{0};
+  /** @return true if frame a should be evicted before frame b. */
+  auto EvictsBefore(frame_id_t a, frame_id_t b) const -> bool;
+
+  /**
+   * @return timestamp of the k-th most recent access of the frame, or of its earliest access if it has fewer than k.
+   */
+  auto KthTimestamp(frame_id_t frame_id) const -> size_t;
+
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  void HeapSiftUp(size_t pos);
+  void HeapSiftDown(size_t pos);
+  void HeapSwap(size_t a, size_t b);
+
+  /** Per frame bookkeeping, indexed by frame id. */
+  std::vector<FrameEntry> entries_;
+  /** Per frame ring buffer of the last k access timestamps, frame f owns [f * k, (f + 1) * k). */
+  std::vector<size_t> history_;
+  /** Evictable frames, as a binary heap with the next victim at the front. */
+  std::vector<frame_id_t> heap_;
+  size_t current_timestamp_{0};
   size_t curr_size_{0};
   size_t replacer_size_;
   size_t k_;
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames that hold them.
+ *
+ * It is a fixed-capacity open-addressing table with linear probing. Every slot is a single 64-bit word that packs a
+ * page id with its frame id, so a lookup reads a slot with one atomic load and never sees half of an update: Find()
+ * takes no lock and writes nothing. Insert() and Remove() serialize on a writer latch.
+ *
+ * Removed entries leave a tombstone behind, because moving entries around under concurrent readers could make them
+ * miss an entry that is there. Once tombstones fill up the table, a writer rebuilds it in place; readers detect a
+ * rebuild through a sequence counter (odd while a rebuild is running) and retry.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a page table for a buffer pool.
+   * @param num_frames the number of frames in the buffer pool, i.e. the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * @brief Find the frame that holds a page. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page is in the table, false otherwise
+   */
+  auto Find(page_id_t page_id, frame_id_t &frame_id) const -> bool;
+
+  /**
+   * @brief Map a page to a frame, replacing the mapping the page had before.
+   * @param page_id the page, which must not be INVALID_PAGE_ID
+   * @param frame_id the frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove a page from the table.
+   * @param page_id the page to remove
+   * @return true if the page was in the table, false otherwise
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @return the number of pages in the table */
+  auto Size() -> size_t;
+
+ private:
+  static constexpr size_t SLOTS_PER_LINE = 8;
+  /** Page id of a slot that has never been used since the last rebuild. Probing stops here. */
+  static constexpr page_id_t EMPTY_PAGE_ID = INVALID_PAGE_ID;
+  /** Page id of a slot whose entry was removed. Probing goes on past it. */
+  static constexpr page_id_t TOMBSTONE_PAGE_ID = INVALID_PAGE_ID - 1;
+  /** Smallest number of slots, so that the hash always has some bits to work with. */
+  static constexpr size_t MIN_CAPACITY = 16;
+
+  /** Eight slots sharing one cache line, so that a probe sequence rarely touches more than one line. */
+  struct alignas(64) CacheLine {
+    std::atomic<uint64_t> slots_[SLOTS_PER_LINE];
+  };
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageIdOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameIdOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  auto Slot(size_t index) -> std::atomic<uint64_t> & {
+    return lines_[index / SLOTS_PER_LINE].slots_[index % SLOTS_PER_LINE];
+  }
+  auto Slot(size_t index) const -> const std::atomic<uint64_t> & {
+    return lines_[index / SLOTS_PER_LINE].slots_[index % SLOTS_PER_LINE];
+  }
+
+  /** @return the slot the probe sequence of a page starts at */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  /** Probe for a page without synchronizing with rebuilds. */
+  auto Probe(page_id_t page_id, frame_id_t &frame_id) const -> bool;
+
+  /** Drop every tombstone by reinserting the live entries. Caller holds writer_latch_. */
+  void Rebuild();
+
+  std::vector<CacheLine> lines_;
+  /** Number of slots, a power of two with at least twice as many slots as there are frames. */
+  size_t capacity_;
+  /** log2(capacity_) */
+  int capacity_bits_;
+  /** Incremented before and after every rebuild, so that it is odd while one is running. */
+  std::atomic<uint64_t> version_{0};
+
+  /** Serializes Insert() and Remove(), and protects the counters below. */
+  std::mutex writer_latch_;
+  size_t num_entries_{0};
+  size_t num_tombstones_{0};
+};
+
+}  // namespace bustub
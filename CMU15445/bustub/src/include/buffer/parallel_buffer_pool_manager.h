@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool across several independent BufferPoolManagerInstances.
+ *
+ * Every instance owns its own latch, page table, replacer and free list. A page is always handled by the instance
+ * `page_id % num_instances`, so operations on pages that live in different instances never contend on a latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override = default;
+
+  /** @return size of the buffer pool, summed over all instances */
+  auto GetPoolSize() -> size_t override { return num_instances_ * pool_size_; }
+
+  /** @return the number of BufferPoolManagerInstances in this pool */
+  auto GetNumInstances() const -> size_t { return num_instances_; }
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @param access_type how the page is going to be used
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessType access_type) -> Page * override;
+
+  /**
+   * Start reading the requested page into the instance responsible for it, without waiting for it.
+   * @param page_id id of page to be prefetched
+   * @param access_type how the page is going to be used
+   */
+  void PrefetchPgImp(page_id_t page_id, AccessType access_type) override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried round-robin, starting from a different instance on
+   * every call, until one of them has a frame to spare.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes all the pages in the buffer pool to disk. Every instance writes its dirty pages, and then the disk
+   * manager is synced once for all of them.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** Number of BufferPoolManagerInstances. */
+  const size_t num_instances_;
+  /** Number of frames in each instance. */
+  const size_t pool_size_;
+  /** The disk manager all instances share. */
+  DiskManager *disk_manager_;
+  /** The instance NewPgImp starts searching from on its next call. */
+  std::atomic<size_t> next_instance_{0};
+  /** The individual buffer pool shards. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+};
+
+}  // namespace bustub
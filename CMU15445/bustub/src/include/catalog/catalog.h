@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -21,10 +22,13 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/external_sorter.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -35,6 +39,9 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The data structures an index can be built on */
+enum class IndexType { BPlusTreeIndex, HashTableIndex };
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -70,15 +77,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The data structure of the index
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        index_type_{index_type} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -91,6 +100,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The data structure of the index; only a B+ tree index supports range scans */
+  const IndexType index_type_;
 };
 
 /**
@@ -196,12 +207,15 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The data structure to build the index on
+   * @param work_mem The bytes the sort of a B+ tree index's entries may take before it spills to temp pages
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::BPlusTreeIndex,
+                   uint64_t work_mem = DEFAULT_WORK_MEM) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -220,27 +234,73 @@ class Catalog {
     // Construct index metdata
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
-    // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
-
-    // Populate the index with all tuples in table heap
+    // Construct the index, take ownership of metadata, and populate it with all tuples in table heap
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::HashTableIndex) {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                           hash_function);
+      for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+        index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      }
+    } else {
+      // A B+ tree is loaded sorted and bottom-up rather than inserted one by one. The entries are sorted as records of
+      // the key columns and the RID by an ExternalSorter, so that a table larger than work_mem spills while it sorts.
+      auto tree = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+      auto columns = key_schema.GetColumns();
+      columns.emplace_back("__rid", TypeId::BIGINT);
+      Schema record_schema(columns);
+      std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys;
+      for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+        order_bys.emplace_back(OrderByType::ASC,
+                               std::make_shared<ColumnValueExpression>(0, i, key_schema.GetColumn(i).GetType()));
+      }
+      SortKeyEncoder encoder(&record_schema, &order_bys);
+      ExternalSorter sorter(bpm_, &encoder, work_mem);
+      // NULL compares equal to every key in the index but sorts first here, so keys with NULLs are inserted afterwards
+      std::vector<std::pair<Tuple, RID>> null_keys;
+      std::vector<Value> values;
+      for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+        auto key = tuple->KeyFromTuple(schema, key_schema, key_attrs);
+        values.clear();
+        for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+          values.push_back(key.GetValue(&key_schema, i));
+        }
+        if (std::any_of(values.begin(), values.end(), [](const Value &value) { return value.IsNull(); })) {
+          null_keys.emplace_back(std::move(key), tuple->GetRid());
+          continue;
+        }
+        values.push_back(ValueFactory::GetBigIntValue(tuple->GetRid().Get()));
+        sorter.Insert(Tuple(values, &record_schema));
+      }
+      sorter.Finish();
+
+      std::vector<std::pair<KeyType, ValueType>> entries;
+      Tuple record;
+      while (sorter.Next(&record)) {
+        values.clear();
+        for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+          values.push_back(record.GetValue(&record_schema, i));
+        }
+        KeyType index_key;
+        index_key.SetFromKey(Tuple(values, &key_schema));
+        auto rid = record.GetValue(&record_schema, key_schema.GetColumnCount()).GetAs<int64_t>();
+        entries.emplace_back(index_key, RID(rid));
+      }
+      tree->BulkLoad(&entries, txn);
+      for (const auto &[key, rid] : null_keys) {
+        tree->InsertEntry(key, rid, txn);
+      }
+      index = std::move(tree);
     }
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, index_type);
     auto *tmp = index_info.get();
 
     // Update internal tracking
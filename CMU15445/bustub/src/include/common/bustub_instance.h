@@ -40,6 +40,7 @@ class LogManager;
 class CheckpointManager;
 class Catalog;
 class ExecutionEngine;
+class ThreadPool;
 
 class ResultWriter {
  public:
@@ -272,6 +273,10 @@ class BustubInstance {
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
+  /** Runs the parallel pipelines of queries; `nullptr` while the parallelism is 1 */
+  std::unique_ptr<ThreadPool> thread_pool_;
+  /** The memory budget of each operator of a query, set by `SET work_mem` */
+  uint64_t work_mem_{DEFAULT_WORK_MEM};
 };
 
 }  // namespace bustub
@@ -27,6 +27,25 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** How buffer pool frames are placed on the NUMA nodes of the machine. */
+enum class NumaPolicy {
+  /** Wherever the thread that first touches a frame runs. */
+  Default = 0,
+  /** Round-robin over all nodes, page by page. */
+  Interleave,
+  /** All frames of a buffer pool instance on one node, instances spread round-robin over the nodes. */
+  ShardLocal
+};
+
+/** True if the frames of buffer pools created from now on should be backed by 2MB huge pages. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** NUMA placement of the frames of buffer pools created from now on. */
+extern std::atomic<NumaPolicy> buffer_pool_numa_policy;
+
+/** True if the execution engine pulls result batches with NextBatch() instead of single tuples with Next(). */
+extern std::atomic<bool> enable_vectorized_execution;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -35,7 +54,19 @@ static constexpr int BUSTUB_PAGE_SIZE = 4096;
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;           // lookback window for lru-k replacer
+static constexpr int SCAN_RING_SIZE = 16;            // max frames sequential scans recycle in a buffer pool instance
+static constexpr int READ_AHEAD_PAGES = 4;           // pages a scan keeps in flight ahead of the page it is on
+static constexpr int DISK_IO_THREADS = 2;            // background threads serving asynchronous disk requests
+static constexpr int IO_URING_ENTRIES = 256;         // submission queue size of the io_uring for batched page I/O
+static constexpr int PAGE_CLEANER_INTERVAL_MS = 10;  // how often an idle page cleaner looks for dirty cold frames
+static constexpr double INDEX_FILL_FACTOR = 0.9;     // share of each B+ tree page that a bulk load fills
+static constexpr int TUPLE_BATCH_SIZE = 1024;        // rows an executor produces per NextBatch() call
+static constexpr int INDEX_JOIN_BATCH_SIZE = 256;    // outer tuples a nested index join probes the index with at once
+static constexpr int MORSEL_PAGES = 16;              // table pages per task of a parallel scan
+static constexpr int HASH_JOIN_RADIX_BITS = 4;       // hash bits that split the build side of a hash join
+static constexpr int HASH_AGG_RADIX_BITS = 4;        // hash bits that split the groups of a hash aggregation
+static constexpr uint64_t DEFAULT_WORK_MEM = 64 << 20;  // bytes an operator may hold before it spills to temp pages
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -46,4 +77,7 @@ using oid_t = uint16_t;
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
+/** How a page is about to be used, as a hint for the buffer pool's replacement policy. */
+enum class AccessType { Unknown = 0, Lookup, Scan, Index };
+
 }  // namespace bustub
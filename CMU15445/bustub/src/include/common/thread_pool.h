@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.h
+//
+// Identification: src/include/common/thread_pool.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ThreadPool runs the tasks of one parallel job at a time on a fixed set of workers, with work stealing.
+ *
+ * The thread calling Run() is worker 0 and the pool starts one thread for each other worker. The tasks of a job are
+ * numbered; Run() deals each worker a contiguous range of them, which the worker works through in order, so that
+ * neighbouring tasks (e.g. scans of neighbouring pages) stay on one worker. A worker whose range is done steals from
+ * the far end of the range of another worker, which keeps all workers busy until the last task has started.
+ */
+class ThreadPool {
+ public:
+  /**
+   * Start the pool.
+   * @param num_workers the number of workers, including the thread calling Run(); at least one
+   */
+  explicit ThreadPool(size_t num_workers);
+
+  /** Stop and join the worker threads. */
+  ~ThreadPool();
+
+  DISALLOW_COPY_AND_MOVE(ThreadPool);
+
+  /** @return the number of workers; a worker id passed to a task is below it */
+  auto NumWorkers() const -> size_t { return queues_.size(); }
+
+  /**
+   * Run a job and wait for all of its tasks. Jobs of different callers run one after the other. A task must not call
+   * Run() on the same pool.
+   *
+   * If a task throws, the tasks that have not started yet are skipped and the first exception is rethrown here.
+   *
+   * @param num_tasks the number of tasks of the job
+   * @param task called once for each task id in [0, num_tasks), with the id of the worker running it; tasks run
+   * concurrently, but the tasks of one worker never overlap
+   */
+  void Run(size_t num_tasks, const std::function<void(size_t worker, size_t task)> &task);
+
+ private:
+  /** The task ids dealt to one worker and not started yet. */
+  struct WorkerQueue {
+    std::mutex latch_;
+    std::deque<size_t> tasks_;
+  };
+
+  /** Loop run by the thread of each worker but worker 0. */
+  void WorkerLoop(size_t worker);
+
+  /** Run tasks of the current job on a worker until no worker has any left. */
+  void Work(size_t worker);
+
+  /** Take the next task of a worker, or steal one from another worker. @return false if no task is left */
+  auto NextTask(size_t worker, size_t *task) -> bool;
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  /** Held by Run() for a whole job. */
+  std::mutex run_latch_;
+
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** Signals a new job, or shutdown, to the worker threads. */
+  std::condition_variable job_cv_;
+  /** Signals Run() that the last worker thread is done with the job. */
+  std::condition_variable done_cv_;
+  /** Incremented by every job, so that each worker thread joins each job once. */
+  uint64_t job_{0};
+  /** The number of worker threads still working on the current job. */
+  size_t busy_threads_{0};
+  /** The tasks of the current job. */
+  const std::function<void(size_t, size_t)> *task_{nullptr};
+  /** The first exception thrown by a task of the current job. */
+  std::exception_ptr error_;
+  bool shutdown_{false};
+};
+
+}  // namespace bustub
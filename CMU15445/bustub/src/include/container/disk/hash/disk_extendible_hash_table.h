@@ -19,8 +19,8 @@
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
-#include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_swiss_page.h"
 
 namespace bustub {
 
@@ -29,7 +29,13 @@ namespace bustub {
 /**
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
- * table grows/shrinks dynamically as buckets become full/empty.
+ * table grows/shrinks dynamically as buckets become full/empty. Buckets are
+ * Swiss table pages, probed by a fingerprint of the hash of the key.
+ *
+ * Concurrency: lookups, inserts and removes read-latch the table, which keeps the directory as it is, and then
+ * latch only the one bucket page they touch, read for lookups and write otherwise. An insert into a full bucket or
+ * a remove that empties one starts over under the table write latch to split or merge; that excludes every other
+ * operation, so splits and merges move entries and rewrite the directory without latching pages.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -134,7 +140,7 @@ class DiskExtendibleHashTable {
    * @param bucket_page_id the page_id to fetch
    * @return a pointer to a bucket page
    */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_SWISS_TYPE *;
 
   /**
    * Performs insertion with an optional bucket splitting.
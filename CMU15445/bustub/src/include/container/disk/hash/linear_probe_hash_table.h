@@ -12,28 +12,183 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <optional>
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
-#include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
+#include "storage/page/hash_table_swiss_page.h"
 
 namespace bustub {
 
 #define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
 /**
- * Implementation of linear probing hash table that is backed by a buffer pool
- * manager. Non-unique keys are supported. Supports insert and delete. The
- * table dynamically grows once full.
+ * How long the probes of the pairs in a LinearProbeHashTable are, see LinearProbeHashTable::GetProbeStats().
+ */
+struct LinearProbeStats {
+  /** Number of pairs in the table */
+  size_t num_entries_{0};
+  /** Number of slots marked deleted, which keep probes long until the table is rehashed */
+  size_t num_tombstones_{0};
+  /** Number of slots in the table */
+  size_t num_slots_{0};
+  /** probe_lengths_[i] is the number of pairs a lookup finds in the (i + 1)-th group of control bytes it probes */
+  std::vector<size_t> probe_lengths_;
+
+  /** @return the average number of groups a lookup probes to find a pair of the table */
+  auto MeanProbeLength() const -> double;
+
+  /** @return the smallest number of groups that lookups of at least the fraction of the pairs find them within */
+  auto ProbeLengthPercentile(double fraction) const -> size_t;
+};
+
+/**
+ * Keeps a page of a LinearProbeHashTable pinned, and latched once asked to, until it goes out of scope, so that an
+ * exception thrown on the way does not leak the pin or the latch.
+ */
+class HashTablePinnedPage {
+ public:
+  /** Fetches a page, and throws if there is no frame for it */
+  HashTablePinnedPage(BufferPoolManager *bpm, page_id_t page_id) : bpm_(bpm), page_(bpm->FetchPage(page_id)) {
+    if (page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a hash table page");
+    }
+  }
+
+  /** Allocates a new page, dirty, and throws if there is no frame for it */
+  HashTablePinnedPage(BufferPoolManager *bpm, page_id_t *new_page_id)
+      : bpm_(bpm), page_(bpm->NewPage(new_page_id)), dirty_(true) {
+    if (page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a new hash table page");
+    }
+  }
+
+  HashTablePinnedPage(HashTablePinnedPage &&other) noexcept
+      : bpm_(other.bpm_), page_(std::exchange(other.page_, nullptr)), latch_(other.latch_), dirty_(other.dirty_) {}
+  HashTablePinnedPage(const HashTablePinnedPage &) = delete;
+  auto operator=(const HashTablePinnedPage &) -> HashTablePinnedPage & = delete;
+  auto operator=(HashTablePinnedPage &&) -> HashTablePinnedPage & = delete;
+
+  ~HashTablePinnedPage() { Release(); }
+
+  template <typename T>
+  auto As() const -> T * {
+    return reinterpret_cast<T *>(page_->GetData());
+  }
+
+  auto GetPageId() const -> page_id_t { return page_->GetPageId(); }
+
+  void RLatch() {
+    page_->RLatch();
+    latch_ = Latch::READ;
+  }
+
+  void WLatch() {
+    page_->WLatch();
+    latch_ = Latch::WRITE;
+  }
+
+  void MarkDirty() { dirty_ = true; }
+
+  /** Unlatches and unpins the page ahead of going out of scope */
+  void Release() {
+    if (page_ == nullptr) {
+      return;
+    }
+    if (latch_ == Latch::READ) {
+      page_->RUnlatch();
+    } else if (latch_ == Latch::WRITE) {
+      page_->WUnlatch();
+    }
+    bpm_->UnpinPage(page_->GetPageId(), dirty_);
+    page_ = nullptr;
+  }
+
+ private:
+  enum class Latch { NONE, READ, WRITE };
+
+  BufferPoolManager *bpm_;
+  Page *page_;
+  Latch latch_{Latch::NONE};
+  bool dirty_{false};
+};
+
+/** Holds the latch of a LinearProbeHashTable, read or write, until it goes out of scope or is unlocked */
+class HashTableLatchGuard {
+ public:
+  HashTableLatchGuard(ReaderWriterLatch *latch, bool exclusive) : latch_(latch), exclusive_(exclusive) {
+    if (exclusive_) {
+      latch_->WLock();
+    } else {
+      latch_->RLock();
+    }
+  }
+
+  HashTableLatchGuard(const HashTableLatchGuard &) = delete;
+  auto operator=(const HashTableLatchGuard &) -> HashTableLatchGuard & = delete;
+
+  ~HashTableLatchGuard() { Unlock(); }
+
+  void Unlock() {
+    if (latch_ == nullptr) {
+      return;
+    }
+    if (exclusive_) {
+      latch_->WUnlock();
+    } else {
+      latch_->RUnlock();
+    }
+    latch_ = nullptr;
+  }
+
+ private:
+  ReaderWriterLatch *latch_;
+  bool exclusive_;
+};
+
+/**
+ * Implementation of linear probing hash table that is backed by a buffer
+ * pool manager. Non-unique keys are supported. Supports insert and delete. The
+ * table grows online once it gets too full.
+ *
+ * The blocks are Swiss table pages. A key's probe starts in the block its hash picks, probes that block by
+ * fingerprint, and only goes on to the next block if it does not end at an empty slot there.
+ *
+ * Resizing: a resize allocates the blocks of a new table and makes it the current one, into which all inserts go. A
+ * background thread then moves the pairs of the old table over a block at a time, each move under the table write
+ * latch, so that reads and writes go on in between; until it is done, lookups and removes look in both tables. An
+ * insert reserves a slot in the current table first, so that the pairs still to be moved always fit. The table
+ * doubles once pairs take MAX_LOAD_FACTOR of the slots, and is rehashed at its size to drop the slots marked deleted
+ * once those take MAX_TOMBSTONE_FACTOR of them.
+ *
+ * Concurrency: every operation read-latches the table, which keeps the set of blocks as it is. Lookups and removes
+ * latch one block at a time. An insert keeps the blocks of its probe write-latched until it is done, so that no
+ * other insert can add the same pair behind it; to latch blocks in a single order, an insert whose probe would wrap
+ * around past the last block starts over under the table write latch.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
  public:
+  /** The table grows once its pairs take more than this fraction of the slots */
+  static constexpr double MAX_LOAD_FACTOR = 0.75;
+  /** The table is rehashed at its size once slots marked deleted take more than this fraction of the slots */
+  static constexpr double MAX_TOMBSTONE_FACTOR = 0.2;
+  /** How long the background migration waits before it retries a move that found no free frame */
+  static constexpr std::chrono::milliseconds MIGRATION_BACKOFF{10};
+
   /**
    * Creates a new LinearProbeHashTable
    *
@@ -45,6 +200,11 @@ class LinearProbeHashTable {
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                 const KeyComparator &comparator, size_t num_buckets, HashFunction<KeyType> hash_fn);
 
+  /**
+   * Stops the background migration. The pages of a resize that is under way are left behind.
+   */
+  ~LinearProbeHashTable();
+
   /**
    * Inserts a key-value pair into the hash table.
    * @param transaction the current transaction
@@ -73,35 +233,137 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. Any resize under way is finished first; the new
+   * one moves the pairs in the background, see FinishResize().
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
+  /**
+   * Moves whatever pairs a resize under way has left in the old table, so that the resize is done on return.
+   */
+  void FinishResize();
+
+  /**
+   * @return whether a resize is under way
+   */
+  auto IsResizing() const -> bool { return resizing_; }
+
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return current size of the hash table, in slots
    */
   auto GetSize() -> size_t;
 
+  /**
+   * Walks the whole table to collect how long the probes of its pairs are.
+   */
+  auto GetProbeStats() -> LinearProbeStats;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
-  void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  using PinnedPage = HashTablePinnedPage;
+  using TableLatchGuard = HashTableLatchGuard;
+
+  /**
+   * Allocates the header and num_blocks empty blocks of a table, and makes its slots the current number of slots. If
+   * a page cannot be allocated, the pages allocated so far are deleted before throwing.
+   * @return the page id of the header
+   */
+  auto NewTable(size_t num_blocks) -> page_id_t;
+
+  /**
+   * Looks the key up in the blocks of a table, skipping those before first_block, which have been moved away. The
+   * caller holds the table latch.
+   */
+  auto LookupInTable(HashTableHeaderPage *header_page, size_t first_block, const KeyType &key, uint64_t hash,
+                     std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Removes the pair from the blocks of a table, skipping those before first_block.
+   */
+  auto RemoveFromTable(HashTableHeaderPage *header_page, size_t first_block, const KeyType &key,
+                       const ValueType &value, uint64_t hash) -> bool;
+
+  /**
+   * Inserts the pair into the first block of its probe with a free slot, unless the table holds the pair already.
+   * With latch_blocks the blocks of the probe are write-latched; the insert gives up and returns nothing if the
+   * probe would then have to wrap around past the last block. If a block cannot be fetched, the blocks of the probe
+   * are released before throwing, and nothing has been inserted.
+   */
+  auto InsertIntoProbe(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value, uint64_t hash,
+                       bool latch_blocks) -> std::optional<bool>;
+
+  /**
+   * Checks the old table for the pair and inserts it into the current one. The caller holds the table latch, the
+   * write latch if exclusive.
+   */
+  auto InsertLatched(const KeyType &key, const ValueType &value, uint64_t hash, bool exclusive)
+      -> std::optional<bool>;
+
+  /**
+   * Makes the current table the old one of a resize to num_blocks blocks. The caller holds the table write latch and
+   * no resize is under way. Throws, and leaves the table as it was, if there are no frames for the new table.
+   */
+  void StartResize(size_t num_blocks);
+
+  /**
+   * Moves the pairs of the next block of the old table into the current one and frees the block, and the old table
+   * with its last block. The caller holds the table write latch.
+   *
+   * The block counts as moved only once all of its pairs are in the current table. If a page cannot be fetched
+   * half way, the pairs moved so far are in both tables until the move is retried, which skips them; lookups and
+   * removes look in both tables during a resize, so they do not mind.
+   */
+  void MoveBlock();
+
+  /**
+   * Starts a resize if the table got too full or has too many slots marked deleted. Called without latches. A resize
+   * that finds no frames is left to a later call.
+   */
+  void MaybeResize();
+
+  /**
+   * Makes room for an insert that found the table full: finishes the resize under way, and grows the table if it is
+   * still full. Called without latches.
+   *
+   * @return false if the table cannot grow any more
+   */
+  auto MakeRoom() -> bool;
+
+  /**
+   * Body of the background thread that moves blocks while a resize is under way. A move that fails for want of a
+   * frame is retried after MIGRATION_BACKOFF.
+   */
+  void RunMigration();
 
   // member variable
   page_id_t header_page_id_;
+  // header of the table a resize is moving pairs away from, INVALID_PAGE_ID unless a resize is under way
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // the blocks of the old table before this one have been moved and freed
+  size_t next_block_to_move_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts and removes, writers are resizes and the moves of blocks
   ReaderWriterLatch table_latch_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // slots of the current table, changed under the table write latch
+  std::atomic<size_t> num_slots_{0};
+  // pairs in both tables, counting the inserts under way that have reserved a slot
+  std::atomic<size_t> num_entries_{0};
+  // slots marked deleted in both tables
+  std::atomic<size_t> num_tombstones_{0};
+
+  // the background migration waits for resizing_ or stop_migration_, which are changed under migration_mutex_
+  std::mutex migration_mutex_;
+  std::condition_variable migration_cv_;
+  std::atomic<bool> resizing_{false};
+  bool stop_migration_{false};
+  std::thread migration_thread_;
 };
 
 }  // namespace bustub
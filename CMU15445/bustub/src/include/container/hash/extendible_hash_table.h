@@ -17,18 +17,30 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "container/hash/hash_table.h"
 
 namespace bustub {
 
 /**
  * ExtendibleHashTable implements a hash table using the extendible hashing algorithm.
+ *
+ * Concurrency: Find(), Insert() and Remove() take no table-wide latch. The directory is read without any lock: it is
+ * an array of atomic bucket pointers, published through an atomic pointer. Splits serialize on dir_latch_; they update
+ * the current array in place, or, when the directory has to double, publish a new array and keep the old one around
+ * for readers still looking at it. Each bucket has its own reader/writer latch. A bucket knows which hashes it covers
+ * (its local depth and the hash bits below it), and exactly one bucket covers any hash at any time, so an operation
+ * that followed a stale directory entry notices once it holds the bucket latch and starts over. Buckets are only freed
+ * with the table, so a stale entry always points to a valid bucket.
+ *
+ * Buckets keep their entries flat, in a small open-addressed array with a one-byte tag per slot.
+ *
  * @tparam K key type
  * @tparam V value type
  */
@@ -36,9 +48,6 @@ template <typename K, typename V>
 class ExtendibleHashTable : public HashTable<K, V> {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Create a new ExtendibleHashTable.
    * @param bucket_size: fixed size for each bucket
    */
@@ -64,13 +73,7 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto GetNumBuckets() const -> int;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Find the value associated with the given key.
-   *
-   * Use IndexOf(key) to find the directory index the key hashes to.
-   *
    * @param key The key to be searched.
    * @param[out] value The value associated with the key.
    * @return True if the key is found, false otherwise.
@@ -78,9 +81,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   auto Find(const K &key, V &value) -> bool override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Insert the given key-value pair into the hash table.
    * If a key already exists, the value should be updated.
    * If the bucket is full and can't be inserted, do the following steps before retrying:
@@ -95,9 +95,6 @@ class ExtendibleHashTable : public HashTable<K, V> {
   void Insert(const K &key, const V &value) override;
 
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief Given the key, remove the corresponding key-value pair in the hash table.
    * Shrink & Combination is not required for this project
    * @param key The key to be deleted.
@@ -107,97 +104,117 @@ class ExtendibleHashTable : public HashTable<K, V> {
 
   /**
    * Bucket class for each hash table bucket that the directory points to.
+   *
+   * The entries live in an array of at least size slots, probed linearly from a home slot picked by the hash. A parallel array
+   * of one-byte tags, zero for an empty slot and otherwise a few bits of the hash, keeps most probes from comparing
+   * keys. Removal shifts the following entries back instead of leaving tombstones. The caller latches the bucket.
    */
   class Bucket {
    public:
-    explicit Bucket(size_t size, int depth = 0);
+    explicit Bucket(size_t size, int depth = 0, size_t prefix = 0);
 
     /** @brief Check if a bucket is full. */
-    inline auto IsFull() const -> bool { return list_.size() == size_; }
+    inline auto IsFull() const -> bool { return num_entries_ == size_; }
 
     /** @brief Get the local depth of the bucket. */
     inline auto GetDepth() const -> int { return depth_; }
 
-    /** @brief Increment the local depth of a bucket. */
-    inline void IncrementDepth() { depth_++; }
+    /** @brief Get the low hash bits, as many as the local depth, that all keys in the bucket share. */
+    inline auto GetPrefix() const -> size_t { return prefix_; }
 
-    inline auto GetItems() -> std::list<std::pair<K, V>> & { return list_; }
+    /** @brief Whether this bucket holds the keys of the given hash. */
+    inline auto Covers(size_t hash) const -> bool { return (hash & ((size_t{1} << depth_) - 1)) == prefix_; }
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Find the value associated with the given key in the bucket.
      * @param key The key to be searched.
+     * @param hash The hash of the key.
      * @param[out] value The value associated with the key.
      * @return True if the key is found, false otherwise.
      */
-    auto Find(const K &key, V &value) -> bool;
+    auto Find(const K &key, size_t hash, V &value) const -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Given the key, remove the corresponding key-value pair in the bucket.
      * @param key The key to be deleted.
+     * @param hash The hash of the key.
      * @return True if the key exists, false otherwise.
      */
-    auto Remove(const K &key) -> bool;
+    auto Remove(const K &key, size_t hash) -> bool;
 
     /**
-     *
-     * TODO(P1): Add implementation
-     *
      * @brief Insert the given key-value pair into the bucket.
      *      1. If a key already exists, the value should be updated.
      *      2. If the bucket is full, do nothing and return false.
      * @param key The key to be inserted.
+     * @param hash The hash of the key.
      * @param value The value to be inserted.
      * @return True if the key-value pair is inserted, false otherwise.
      */
-    auto Insert(const K &key, const V &value) -> bool;
+    auto Insert(const K &key, size_t hash, const V &value) -> bool;
+
+    /**
+     * @brief Increment the local depth, and move the entries whose hash has the new bit set to an empty sibling that
+     * covers them.
+     * @param sibling The new bucket, with the same local depth as this one will have.
+     */
+    void SplitTo(Bucket *sibling);
+
+    /** Latch of the bucket's entries, depth and prefix. */
+    mutable ReaderWriterLatch latch_;
 
    private:
-    // TODO(student): You may add additional private members and helper functions
+    /** @return the slot that probing for a hash starts at */
+    auto HomeSlot(size_t hash) const -> size_t;
+    /** @return the tag of a hash, never zero */
+    static auto TagOf(size_t hash) -> uint8_t;
+
+    /** @return the slot of the key, or NO_SLOT if it is not in the bucket */
+    auto SlotOf(const K &key, size_t hash) const -> size_t;
+
+    static constexpr size_t NO_SLOT = static_cast<size_t>(-1);
+
     size_t size_;
+    /** The number of slots, the smallest power of two of at least size_, minus one. */
+    size_t slot_mask_;
     int depth_;
-    std::list<std::pair<K, V>> list_;
+    /** The low depth_ bits that the hashes of all keys in this bucket share. */
+    size_t prefix_;
+    size_t num_entries_{0};
+    std::vector<uint8_t> tags_;
+    std::vector<size_t> hashes_;
+    std::vector<std::pair<K, V>> slots_;
   };
 
-  auto GetItems() -> std::vector<std::shared_ptr<Bucket>> & { return dir_; };
-
  private:
-  // TODO(student): You may add additional private members and helper functions and remove the ones
-  // you don't need.
+  /** A version of the directory: 2^global_depth_ bucket pointers. */
+  struct Directory {
+    Directory(int global_depth, size_t size)
+        : global_depth_(global_depth), buckets_(std::make_unique<std::atomic<Bucket *>[]>(size)) {}
 
-  int global_depth_;    // The global depth of the directory
-  size_t bucket_size_;  // The size of a bucket
-  int num_buckets_;     // The number of buckets in the hash table
-  mutable std::mutex latch_;
-  std::vector<std::shared_ptr<Bucket>> dir_;  // The directory of the hash table
-
-  // The following functions are completely optional, you can delete them if you have your own ideas.
-
-  /**
-   * @brief Redistribute the kv pairs in a full bucket.
-   * @param bucket The bucket to be redistributed.
-   */
-  auto RedistributeBucket(std::shared_ptr<Bucket> bucket) -> void;
+    int global_depth_;
+    std::unique_ptr<std::atomic<Bucket *>[]> buckets_;
+  };
 
-  /*****************************************************************
-   * Must acquire latch_ first before calling the below functions. *
-   *****************************************************************/
+  /** @return the bucket the current directory points to for a hash; it may no longer cover the hash */
+  auto BucketOf(size_t hash) const -> Bucket *;
 
   /**
-   * @brief For the given key, return the entry index in the directory where the key hashes to.
-   * @param key The key to be hashed.
-   * @return The entry index in the directory.
+   * @brief Split a full bucket, doubling the directory first if it has to.
+   * @param bucket The bucket, write-latched by the caller.
    */
-  auto IndexOf(const K &key) -> size_t;
+  void SplitBucket(Bucket *bucket);
 
-  auto GetGlobalDepthInternal() const -> int;
-  auto GetLocalDepthInternal(int dir_index) const -> int;
-  auto GetNumBucketsInternal() const -> int;
+  size_t bucket_size_;  // The size of a bucket
+  std::atomic<int> num_buckets_{1};  // The number of buckets in the hash table
+  /** The current directory. */
+  std::atomic<Directory *> dir_;
+
+  /** Serializes splits, and protects the two vectors below. */
+  std::mutex dir_latch_;
+  /** Every directory version and every bucket there has been, freed with the table. */
+  std::vector<std::unique_ptr<Directory>> directories_;
+  std::vector<std::unique_ptr<Bucket>> buckets_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.h
+//
+// Identification: src/include/execution/aggregation_hash_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/thread_pool.h"
+#include "common/util/hash_util.h"
+#include "execution/plans/aggregation_plan.h"
+#include "storage/table/tmp_tuple_file.h"
+
+namespace bustub {
+
+/**
+ * AggregationHashTable holds the groups of a hash aggregation and their running aggregates.
+ *
+ * Groups are split into NUM_PARTITIONS partitions by bits of the hash of their key. A partition finds a group through
+ * a flat open addressing table with linear probing over the group keys encoded as bytes (see SortKeyEncoder), so
+ * that a lookup hashes once and compares keys with memcmp.
+ *
+ * Once the groups take more than the memory budget, the largest partition is spilled to temp pages: its groups are
+ * written out as partial aggregates, and every row of it inserted after that is written out as a partial aggregate of
+ * one row. A spilled partition is aggregated later by a table one level down, which splits it by the next bits of the
+ * hash and may spill in turn.
+ */
+class AggregationHashTable {
+ public:
+  static constexpr size_t NUM_PARTITIONS = size_t{1} << HASH_AGG_RADIX_BITS;
+  /**
+   * The deepest level, at which a table no longer spills: 8 levels have split the rows by 32 bits of the hash already,
+   * so a partition that is still too large holds few distinct keys
+   */
+  static constexpr size_t MAX_LEVEL = 8;
+
+  /**
+   * @param plan The aggregation, whose output schema is also the schema of spilled groups
+   * @param bpm The buffer pool to spill to
+   * @param memory_budget The bytes the groups may take before a partition spills
+   * @param level The bits of the hash that pick a partition; a table that aggregates a spilled partition is one
+   * level below the table that spilled it
+   */
+  AggregationHashTable(const AggregationPlanNode *plan, BufferPoolManager *bpm, uint64_t memory_budget,
+                       size_t level = 0);
+
+  /**
+   * Combine a row into the aggregates of its group, adding the group if it is new.
+   * @param key the group-by values of the row
+   * @param value the values of the aggregate expressions on the row
+   */
+  void InsertCombine(const AggregateKey &key, const AggregateValue &value);
+
+  /** Add a group with the initial aggregates if it is not in the table yet. */
+  void InsertInitial(const AggregateKey &key);
+
+  /**
+   * Merge the groups of a table at the same level that aggregated other input, e.g. on another worker, which is left
+   * empty. A partition that spilled in either table is spilled here, and the merged groups spill if they take more
+   * than the budget.
+   * @param thread_pool merges the partitions in parallel, unless it is `nullptr`
+   */
+  void Merge(AggregationHashTable *other, ThreadPool *thread_pool);
+
+  /** Finish writing the spilled partitions, after all input was inserted. */
+  void Finish();
+
+  /** @return the partitions that spilled, each to be aggregated by a table one level down with LoadSpilled() */
+  auto TakeSpilledPartitions() -> std::vector<std::unique_ptr<TmpTupleFile>>;
+
+  /** Merge the partial aggregates of a partition spilled by the table one level up. */
+  void LoadSpilled(TmpTupleFile *file);
+
+  /** @return the level of the table */
+  auto GetLevel() const -> size_t { return level_; }
+
+  /** An iterator over the groups of the table that are in memory */
+  class Iterator {
+   public:
+    Iterator(const AggregationHashTable *table, size_t partition, size_t group)
+        : table_(table), partition_(partition), group_(group) {
+      SkipEmpty();
+    }
+
+    /** @return The key of the iterator */
+    auto Key() const -> const AggregateKey & { return table_->partitions_[partition_].keys_[group_]; }
+
+    /** @return The value of the iterator */
+    auto Val() const -> const AggregateValue & { return table_->partitions_[partition_].values_[group_]; }
+
+    /** @return The iterator before it is incremented */
+    auto operator++() -> Iterator & {
+      group_++;
+      SkipEmpty();
+      return *this;
+    }
+
+    /** @return `true` if both iterators are identical */
+    auto operator==(const Iterator &other) const -> bool {
+      return partition_ == other.partition_ && group_ == other.group_;
+    }
+
+    /** @return `true` if both iterators are different */
+    auto operator!=(const Iterator &other) const -> bool { return !(*this == other); }
+
+   private:
+    /** Move on to the first group of the next partition that has any, if this one is done */
+    void SkipEmpty() {
+      while (partition_ < NUM_PARTITIONS && group_ >= table_->partitions_[partition_].keys_.size()) {
+        partition_++;
+        group_ = 0;
+      }
+    }
+
+    const AggregationHashTable *table_;
+    size_t partition_;
+    size_t group_;
+  };
+
+  /** @return Iterator to the first group in memory */
+  auto Begin() const -> Iterator { return {this, 0, 0}; }
+
+  /** @return Iterator past the last group in memory */
+  auto End() const -> Iterator { return {this, NUM_PARTITIONS, 0}; }
+
+ private:
+  /** Ends a probe sequence */
+  static constexpr uint32_t NO_GROUP = UINT32_MAX;
+
+  struct Partition {
+    /** The group of each slot, or NO_GROUP; a power of two of them */
+    std::vector<uint32_t> slots_;
+    /**
+     * The encoded key of each group, back to back, and where each starts; one more offset ends the last key. The
+     * arena may grow past 4GB with a large budget.
+     */
+    std::string encoded_keys_;
+    std::vector<size_t> key_offsets_{0};
+    std::vector<hash_t> hashes_;
+    std::vector<AggregateKey> keys_;
+    std::vector<AggregateValue> values_;
+    /** An estimate of the memory the groups take */
+    size_t num_bytes_{0};
+    /** The partial aggregates of the partition, once it spilled */
+    std::unique_ptr<TmpTupleFile> file_;
+  };
+
+  /** @return the encoded key of a group, and its hash */
+  auto EncodeKey(const AggregateKey &key, std::string *encoded) const -> hash_t;
+
+  /** @return the partition of a hash at the level of the table */
+  auto PartitionOf(hash_t hash) const -> size_t {
+    return (hash >> (sizeof(hash_t) * 8 - HASH_AGG_RADIX_BITS * (level_ + 1))) & (NUM_PARTITIONS - 1);
+  }
+
+  /**
+   * @return the group of a key in a partition, which is added with the initial aggregates if it is new, or NO_GROUP if
+   * the partition spilled
+   */
+  auto FindOrInsert(Partition *partition, std::string_view encoded, hash_t hash, const AggregateKey &key) -> uint32_t;
+
+  /** Double the slots of a partition. */
+  static void Grow(Partition *partition);
+
+  /** Spill partitions, largest first, until the groups in memory fit the budget. */
+  void SpillUntilFits();
+
+  /** Write the groups of a partition to temp pages, where its rows go from now on. Leaves num_bytes_ to the caller. */
+  void SpillPartition(Partition *partition);
+
+  /** Write a partial aggregate to the file of a spilled partition. */
+  void WriteSpilled(Partition *partition, const AggregateKey &key, const AggregateValue &value);
+
+  /** @return The initial aggregate values */
+  auto GenerateInitialAggregateValue() const -> AggregateValue;
+
+  /** Combine the values of the aggregate expressions on a row into the aggregates of a group. */
+  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) const;
+
+  /** Combine the partial aggregates of a group, computed over other input, into the aggregates of a group. */
+  void MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) const;
+
+  const AggregationPlanNode *plan_;
+  BufferPoolManager *bpm_;
+  uint64_t memory_budget_;
+  size_t level_;
+  /** The memory taken by the groups in memory */
+  size_t num_bytes_{0};
+  std::vector<Partition> partitions_{NUM_PARTITIONS};
+  /** Scratch space for the encoded key of a row */
+  std::string encoded_;
+};
+
+}  // namespace bustub
@@ -16,10 +16,12 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/config.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -84,6 +86,17 @@ class ExecutionEngine {
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
                            std::vector<Tuple> *result_set) {
+    if (enable_vectorized_execution) {
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
+        if (result_set != nullptr) {
+          for (auto row : batch.GetSelection()) {
+            result_set->push_back(batch.GetTuple(row));
+          }
+        }
+      }
+      return;
+    }
     RID rid{};
     Tuple tuple{};
     while (executor->Next(&tuple, &rid)) {
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/thread_pool.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
 
@@ -33,10 +34,17 @@ class ExecutorContext {
    * @param bpm The buffer pool manager that the executor uses
    * @param txn_mgr The transaction manager that the executor uses
    * @param lock_mgr The lock manager that the executor uses
+   * @param thread_pool The pool that runs parallel pipelines, or `nullptr` to run the query on the calling thread
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
-                  LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+                  LockManager *lock_mgr, ThreadPool *thread_pool = nullptr, uint64_t work_mem = DEFAULT_WORK_MEM)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        thread_pool_(thread_pool),
+        work_mem_(work_mem) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +68,12 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /** @return the pool that runs parallel pipelines, or `nullptr` if the query runs on the calling thread */
+  auto GetThreadPool() const -> ThreadPool * { return thread_pool_; }
+
+  /** @return the bytes an operator may hold in memory before it spills to temp pages */
+  auto GetWorkMem() const -> uint64_t { return work_mem_; }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +85,10 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The thread pool associated with this executor context */
+  ThreadPool *thread_pool_;
+  /** The memory budget of each operator, in bytes */
+  uint64_t work_mem_;
 };
 
 }  // namespace bustub
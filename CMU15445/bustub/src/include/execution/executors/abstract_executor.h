@@ -13,6 +13,7 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -20,6 +21,9 @@ namespace bustub {
  * The AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
  * This is the base class from which all executors in the BustTub execution
  * engine inherit, and defines the minimal interface that all executors support.
+ *
+ * Executors may also be pulled a batch of rows at a time with NextBatch(). Executors that implement it natively
+ * pull their children by batches too; all others fall back on filling the batch from Next().
  */
 class AbstractExecutor {
  public:
@@ -46,6 +50,21 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of rows from this executor. Calls to Next() and NextBatch() must not be mixed.
+   * @param[out] batch The next rows produced by this executor, with at least one row selected
+   * @return `true` if rows were produced, `false` if there are no more rows
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->Append(tuple, rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
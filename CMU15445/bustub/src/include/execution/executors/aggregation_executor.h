@@ -13,140 +13,24 @@
 #pragma once
 
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
-#include "common/util/hash_util.h"
-#include "container/hash/hash_function.h"
+#include "execution/aggregation_hash_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
 #include "storage/table/tuple.h"
-#include "type/value_factory.h"
 
 namespace bustub {
 
-/**
- * A simplified hash table that has all the necessary functionality for aggregations.
- */
-class SimpleAggregationHashTable {
- public:
-  /**
-   * Construct a new SimpleAggregationHashTable instance.
-   * @param agg_exprs the aggregation expressions
-   * @param agg_types the types of aggregations
-   */
-  SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return The initial aggregrate value for this aggregation executor */
-  auto GenerateInitialAggregateValue() -> AggregateValue {
-    std::vector<Value> values{};
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountStarAggregate:
-          // Count start starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-          // Others starts at null.
-          values.emplace_back(ValueFactory::GetNullValueByType(TypeId::INTEGER));
-          break;
-      }
-    }
-    return {values};
-  }
-
-  /**
-   * TODO(Student)
-   *
-   * Combines the input into the aggregation result.
-   * @param[out] result The output aggregate value
-   * @param input The input value
-   */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountStarAggregate:
-        case AggregationType::CountAggregate:
-        case AggregationType::SumAggregate:
-        case AggregationType::MinAggregate:
-        case AggregationType::MaxAggregate:
-          break;
-      }
-    }
-  }
-
-  /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
-   */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
-  }
-
-  /**
-   * Clear the hash table
-   */
-  void Clear() { ht_.clear(); }
-
-  /** An iterator over the aggregation hash table */
-  class Iterator {
-   public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_{iter} {}
-
-    /** @return The key of the iterator */
-    auto Key() -> const AggregateKey & { return iter_->first; }
-
-    /** @return The value of the iterator */
-    auto Val() -> const AggregateValue & { return iter_->second; }
-
-    /** @return The iterator before it is incremented */
-    auto operator++() -> Iterator & {
-      ++iter_;
-      return *this;
-    }
-
-    /** @return `true` if both iterators are identical */
-    auto operator==(const Iterator &other) -> bool { return this->iter_ == other.iter_; }
-
-    /** @return `true` if both iterators are different */
-    auto operator!=(const Iterator &other) -> bool { return this->iter_ != other.iter_; }
-
-   private:
-    /** Aggregates map */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
-  };
-
-  /** @return Iterator to the start of the hash table */
-  auto Begin() -> Iterator { return Iterator{ht_.cbegin()}; }
-
-  /** @return Iterator to the end of the hash table */
-  auto End() -> Iterator { return Iterator{ht_.cend()}; }
-
- private:
-  /** The hash table is just a map from aggregate keys to aggregate values */
-  std::unordered_map<AggregateKey, AggregateValue> ht_{};
-  /** The aggregate expressions that we have */
-  const std::vector<AbstractExpressionRef> &agg_exprs_;
-  /** The types of aggregations that we have */
-  const std::vector<AggregationType> &agg_types_;
-};
-
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * Groups that do not fit the memory budget of the query spill to temp pages by partition, and each spilled partition
+ * is aggregated on its own once the groups in memory were emitted.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -170,6 +54,13 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the aggregation, pulling the child by batches.
+   * @param[out] batch One row per group
+   * @return `true` if tuples were produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -195,14 +86,36 @@ class AggregationExecutor : public AbstractExecutor {
     return {vals};
   }
 
+  /**
+   * Build the hash table from all tuples of the child, pulled one at a time or by batches, or run in parallel if its
+   * table fits the memory budget.
+   */
+  void Build(bool by_batches);
+
+  /** Aggregate the selected rows of a batch of the child into a table. Safe to call concurrently on other tables. */
+  void InsertBatch(const TupleBatch &batch, AggregationHashTable *aht) const;
+
+  /** Finish a table, whose groups in memory are emitted next, and queue the partitions it spilled. */
+  void StartTable(std::unique_ptr<AggregationHashTable> &&aht);
+
+  /** @return false if all groups were emitted, or true once the iterator is on the next group to emit */
+  auto FindNextGroup() -> bool;
+
+  /** @return The output row of the group the iterator is on */
+  auto MakeOutputValues() -> std::vector<Value>;
+
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The hash table whose groups are being emitted */
+  std::unique_ptr<AggregationHashTable> aht_;
+  /** The next group of aht_ to emit */
+  AggregationHashTable::Iterator aht_iterator_{nullptr, AggregationHashTable::NUM_PARTITIONS, 0};
+  /** The spilled partitions that are still to be aggregated, with the level of the table that aggregates each */
+  std::vector<std::pair<std::unique_ptr<TmpTupleFile>, size_t>> spilled_;
+  /** True once the hash table holds every tuple of the child */
+  bool built_{false};
 };
 }  // namespace bustub
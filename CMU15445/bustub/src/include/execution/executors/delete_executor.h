@@ -60,5 +60,9 @@ class DeleteExecutor : public AbstractExecutor {
   const DeletePlanNode *plan_;
   /** The child executor from which RIDs for deleted tuples are pulled */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Metadata identifying the table that tuples are deleted from */
+  TableInfo *table_info_{nullptr};
+  /** True once the number of deleted rows has been produced */
+  bool done_{false};
 };
 }  // namespace bustub
@@ -48,9 +48,25 @@ class FilterExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the filter.
+   * @param[out] batch The next tuples produced by the filter
+   * @return `true` if tuples were produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /**
+   * Narrow the selection of a batch of the child to the rows that pass the filter. Safe to call concurrently.
+   * @param batch A batch produced by the child
+   */
+  void FilterBatch(TupleBatch *batch) const { plan_->GetPredicate()->SelectBatch(batch); }
+
   /** @return The output schema for the filter plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
+  /** @return The child executor */
+  auto GetChildExecutor() const -> AbstractExecutor * { return child_executor_.get(); }
+
  private:
   /** The filter plan node to be executed */
   const FilterPlanNode *plan_;
@@ -12,18 +12,29 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/join_hash_table.h"
+#include "execution/pipeline.h"
 #include "execution/plans/hash_join_plan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes a hash JOIN on two tables. The hash table is built on the right table and probed with
+ * the tuples of the left one, which come out in order, each followed by its matches in the order of the right table.
+ *
+ * If the right table does not fit the memory budget of the query, the hash table spills, and the join becomes a grace
+ * hash join: the left table is split into the same partitions on temp pages, and each partition of it is joined with
+ * the matching partition of the hash table once that is loaded back. A partition of the hash table that spills again
+ * when it is loaded is split once more, together with its left partition, by the next bits of the hash. The output
+ * then comes partition by partition.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -48,12 +59,127 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the join, pulling both children by batches.
+   * @param[out] batch The next tuples produced by the join.
+   * @return `true` if tuples were produced, `false` if there are no more tuples.
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
+  /** @return The child executor that produces the probe side */
+  auto GetLeftExecutor() const -> AbstractExecutor * { return left_executor_.get(); }
+
+  /**
+   * Build the hash table from all tuples of the right child, unless it is built already. The right child runs as a
+   * parallel pipeline if it can and its table fits the memory budget, or is pulled by batches.
+   */
+  void BuildHashTable();
+
+  /** @return true if the hash table was spilled, so that the join cannot probe it from a pipeline */
+  auto IsSpilled() const -> bool { return table_->IsSpilled(); }
+
+  /**
+   * Join a batch of the left child with the hash table, which must be built and not spilled. Safe to call
+   * concurrently.
+   * @param left_batch A batch produced by the left child
+   * @param scratch The batch the output rows are written into, a full batch at a time
+   * @param emit Called with scratch each time it is full, and once more with the last rows; together the batches hold
+   * every output row of the selected left rows, in order
+   */
+  void ProbeBatch(const TupleBatch &left_batch, TupleBatch *scratch, const Pipeline::Emit &emit) const;
+
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** Where the probe of a left batch stands: the selected row being probed, and its next match once looked up */
+  struct ProbeCursor {
+    size_t row_{0};
+    JoinHashTable::Match match_;
+    bool row_started_{false};
+  };
+
+  /** The number of morsels per worker a parallel join pushes through its pipeline before handing out the output */
+  static constexpr size_t GATHER_MORSELS_PER_WORKER = 4;
+
+  /** Build the hash table from the right child pulled by batches. */
+  void Build();
+
+  /** Build the hash table from a pipeline that produces the right child, partitioned by the workers. */
+  void BuildParallel(Pipeline *pipeline);
+
+  /**
+   * Run the join as the end of a pipeline on the next few morsels, and keep their output in the order of the morsels.
+   * @return false if all morsels have been run
+   */
+  auto GatherMorsels() -> bool;
+
+  /**
+   * Append output rows of a left batch to a batch until it is full or the left batch is done, from where the cursor
+   * stands. The output of one left row may span several batches.
+   */
+  void ProbeRows(const TupleBatch &left_batch, const std::vector<Value> &left_keys, ProbeCursor *cursor,
+                 TupleBatch *batch) const;
+
+  /** A partition of a spilled hash table and the left rows that go with it, still to be joined */
+  struct SpilledPartition {
+    std::unique_ptr<TmpTupleFile> right_;
+    std::unique_ptr<TmpTupleFile> left_;
+    size_t level_;
+  };
+
+  /**
+   * Split left rows into the partitions of the spilled table_, on temp pages, and queue up each pair of partitions.
+   * @param left_file The left rows of the partition that table_ loaded, or `nullptr` to split the left child
+   */
+  void PartitionLeft(TmpTupleFile *left_file);
+
+  /** Load the next spilled partition that fits in memory into table_, splitting those that do not fit again. */
+  auto LoadNextSpilled() -> bool;
+
+  /**
+   * Get the next batch of left rows to probe: from the left child, or from the spilled partition of it whose partition
+   * of the hash table is loaded.
+   */
+  auto NextLeftBatch(TupleBatch *batch) -> bool;
+
+  /** @return The output row joining a row of a left batch with a match, or with nulls if there is none */
+  auto MakeOutputRow(const TupleBatch &left_batch, size_t row, JoinHashTable::Match match) const
+      -> std::vector<Value>;
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The child executor that produces the probe side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  /** The child executor that produces the build side */
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  /** The hash table */
+  std::unique_ptr<JoinHashTable> table_;
+  /** True once the hash table holds every tuple of the right child */
+  bool built_{false};
+
+  /** The left batch being probed, its join keys, and where its probe stands */
+  TupleBatch left_batch_;
+  std::vector<Value> left_keys_;
+  ProbeCursor cursor_;
+
+  /** True once the hash table spilled and the left child was partitioned */
+  bool partitioned_{false};
+  /** The partitions still to be joined, the next one last */
+  std::vector<SpilledPartition> spilled_;
+  /** The left partition being joined with the loaded table_, and its reader */
+  std::unique_ptr<TmpTupleFile> left_file_;
+  std::unique_ptr<TmpTupleFile::Reader> left_reader_;
+
+  /** The pipeline of the join if it runs in parallel, the next morsel to run, and the output not handed out yet */
+  std::unique_ptr<Pipeline> pipeline_;
+  size_t next_morsel_{0};
+  std::deque<TupleBatch> gathered_;
+
+  /** The batch Next() hands out one row at a time, and the next selected row of it */
+  TupleBatch next_batch_;
+  size_t next_row_{0};
 };
 
 }  // namespace bustub
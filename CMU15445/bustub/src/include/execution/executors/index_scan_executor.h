@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -44,5 +46,9 @@ class IndexScanExecutor : public AbstractExecutor {
  private:
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The table the index belongs to. */
+  TableInfo *table_info_{nullptr};
+  /** The range scan over the index; owned through a pointer, as the iterator holds a latch and cannot be copied. */
+  std::unique_ptr<BPlusTreeIndexIteratorForOneIntegerColumn> iterator_;
 };
 }  // namespace bustub
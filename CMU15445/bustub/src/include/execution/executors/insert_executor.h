@@ -57,6 +57,12 @@ class InsertExecutor : public AbstractExecutor {
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** The child executor from which inserted tuples are pulled */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Metadata identifying the table that tuples are inserted into */
+  TableInfo *table_info_{nullptr};
+  /** True once the number of inserted rows has been produced */
+  bool done_{false};
 };
 
 }  // namespace bustub
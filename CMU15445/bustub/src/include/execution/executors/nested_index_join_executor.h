@@ -18,6 +18,7 @@
 #include <utility>
 #include <vector>
 
+#include "catalog/catalog.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
@@ -48,7 +49,24 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /**
+   * Pull the next batch of up to INDEX_JOIN_BATCH_SIZE outer tuples and probe the index with all of their keys at once.
+   * @return false if the outer table is exhausted
+   */
+  auto FetchOuterBatch() -> bool;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The outer table. */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The index probed for matches, and the inner table it indexes. */
+  IndexInfo *index_info_{nullptr};
+  TableInfo *inner_table_info_{nullptr};
+  /** The current batch of outer tuples, and the RIDs of the inner tuples matching each of them. */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<std::vector<RID>> inner_rids_;
+  /** The outer tuple being joined, and the next of its matches to emit. */
+  size_t outer_cursor_{0};
+  size_t inner_cursor_{0};
 };
 }  // namespace bustub
@@ -55,6 +55,16 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
  private:
   /** The NestedLoopJoin plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
+  /** The child executor of the outer side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  /** The child executor of the inner side, run again for each left tuple */
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The left tuple being joined */
+  Tuple left_tuple_;
+  /** True if left_tuple_ is being joined, false if the next one must be pulled */
+  bool has_left_tuple_{false};
+  /** True if some right tuple joined with left_tuple_ */
+  bool left_matched_{false};
 };
 
 }  // namespace bustub
@@ -47,14 +47,34 @@ class ProjectionExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the projection.
+   * @param[out] batch The next tuples produced by the projection
+   * @return `true` if tuples were produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /**
+   * Compute the projection of a batch of the child. Safe to call concurrently.
+   * @param child_batch A batch produced by the child
+   * @param[out] batch The projected rows, with the selection of the child batch
+   */
+  void ProjectBatch(const TupleBatch &child_batch, TupleBatch *batch) const;
+
   /** @return The output schema for the projection plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
+  /** @return The child executor */
+  auto GetChildExecutor() const -> AbstractExecutor * { return child_executor_.get(); }
+
  private:
   /** The projection plan node to be executed */
   const ProjectionPlanNode *plan_;
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The batch the expressions are evaluated on, kept to reuse its buffers */
+  TupleBatch child_batch_;
 };
 }  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
@@ -44,11 +46,36 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of tuples from the sequential scan.
+   * @param[out] batch The next tuples produced by the scan that pass its filter
+   * @return `true` if tuples were produced, `false` if there are no more tuples
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** A morsel of a parallel scan: a run of consecutive pages of the table */
+  using Morsel = std::vector<page_id_t>;
+
+  /** @return The table split into morsels of MORSEL_PAGES pages, in the order of the table */
+  auto MakeMorsels() const -> std::vector<Morsel>;
+
+  /**
+   * Scan one morsel, independently of Next() and NextBatch(). Morsels may be scanned concurrently.
+   * @param morsel The pages to scan
+   * @param consume Called with each batch of the tuples of the morsel that pass the filter of the scan, in order
+   */
+  void ScanMorsel(const Morsel &morsel, const std::function<void(TupleBatch *)> &consume) const;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  TableInfo *table_info_{nullptr};
+  /** The position of the scan and the end of the table; iterators cannot be default-constructed */
+  std::unique_ptr<TableIterator> iterator_;
+  std::unique_ptr<TableIterator> end_;
 };
 }  // namespace bustub
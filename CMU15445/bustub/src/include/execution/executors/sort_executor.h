@@ -13,10 +13,12 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/external_sorter.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
 #include "storage/table/tuple.h"
@@ -24,7 +26,8 @@
 namespace bustub {
 
 /**
- * The SortExecutor executor executes a sort.
+ * The SortExecutor executor executes a sort. The tuples are sorted by a normalized key of their ORDER BY values, and
+ * spill to temp pages as sorted runs that are merged when they do not fit the memory budget of the query.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -52,5 +55,11 @@ class SortExecutor : public AbstractExecutor {
  private:
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Makes the sort key of a tuple of the child */
+  SortKeyEncoder encoder_;
+  /** All tuples of the child, sorted */
+  std::unique_ptr<ExternalSorter> sorter_;
 };
 }  // namespace bustub
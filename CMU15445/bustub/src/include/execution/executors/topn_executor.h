@@ -13,18 +13,21 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/topn_plan.h"
+#include "execution/sort_key.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The TopNExecutor executor executes a topn.
+ * The TopNExecutor executor executes a topn. It keeps the best n tuples seen so far in a heap ordered by their
+ * normalized sort keys.
  */
 class TopNExecutor : public AbstractExecutor {
  public:
@@ -52,5 +55,25 @@ class TopNExecutor : public AbstractExecutor {
  private:
   /** The topn plan node to be executed */
   const TopNPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** A tuple with its sort key, and its position in the child to keep ties in the order of the child */
+  struct Entry {
+    std::string key_;
+    size_t position_;
+    Tuple tuple_;
+
+    auto operator<(const Entry &other) const -> bool {
+      auto cmp = SortKeyEncoder::Compare(key_, other.key_);
+      return cmp != 0 ? cmp < 0 : position_ < other.position_;
+    }
+  };
+
+  /** Makes the sort key of a tuple of the child */
+  SortKeyEncoder encoder_;
+  /** The first n tuples of the child in sort order */
+  std::vector<Entry> entries_;
+  /** The next entry to produce */
+  size_t cursor_{0};
 };
 }  // namespace bustub
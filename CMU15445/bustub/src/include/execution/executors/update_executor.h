@@ -64,5 +64,7 @@ class UpdateExecutor : public AbstractExecutor {
   const TableInfo *table_info_;
   /** The child executor to obtain value from */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** True once the number of updated rows has been produced */
+  bool done_{false};
 };
 }  // namespace bustub
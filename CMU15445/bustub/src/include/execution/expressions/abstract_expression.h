@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "storage/table/tuple.h"
 
@@ -65,6 +66,37 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression on every selected row of a batch. Expressions that do not override this evaluate the
+   * rows one by one as tuples.
+   * @param batch The rows to evaluate the expression on
+   * @param[out] result One value per stored row of the batch; only the values of selected rows are set
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const {
+    result->resize(batch.NumRows());
+    for (auto row : batch.GetSelection()) {
+      auto tuple = batch.GetTuple(row);
+      (*result)[row] = Evaluate(&tuple, *batch.GetSchema());
+    }
+  }
+
+  /**
+   * Narrow the selection of a batch to the rows this boolean expression is true on.
+   * @param batch The rows to filter
+   */
+  void SelectBatch(TupleBatch *batch) const {
+    std::vector<Value> result;
+    EvaluateBatch(*batch, &result);
+    std::vector<uint32_t> selection;
+    selection.reserve(batch->NumSelected());
+    for (auto row : batch->GetSelection()) {
+      if (!result[row].IsNull() && result[row].GetAs<bool>()) {
+        selection.push_back(row);
+      }
+    }
+    batch->SetSelection(std::move(selection));
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -45,6 +45,14 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(&right_schema, col_idx_);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    const auto &column = batch.GetColumn(col_idx_);
+    result->resize(batch.NumRows());
+    for (auto row : batch.GetSelection()) {
+      (*result)[row] = column[row];
+    }
+  }
+
   auto GetTupleIdx() const -> uint32_t { return tuple_idx_; }
   auto GetColIdx() const -> uint32_t { return col_idx_; }
 
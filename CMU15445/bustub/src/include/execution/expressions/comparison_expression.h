@@ -49,6 +49,28 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->resize(batch.NumRows());
+    for (auto row : batch.GetSelection()) {
+      const auto &l = lhs[row];
+      const auto &r = rhs[row];
+      CmpBool cmp;
+      if (l.GetTypeId() != TypeId::INTEGER || r.GetTypeId() != TypeId::INTEGER) {
+        cmp = PerformComparison(l, r);
+      } else if (l.IsNull() || r.IsNull()) {
+        cmp = CmpBool::CmpNull;
+      } else {
+        // integers are compared in place, without calls through their type
+        cmp = GetCmpBool(PerformIntegerComparison(l.GetAs<int32_t>(), r.GetAs<int32_t>()));
+      }
+      (*result)[row] = ValueFactory::GetBooleanValue(cmp);
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), comp_type_, *GetChildAt(1));
@@ -77,6 +99,25 @@ class ComparisonExpression : public AbstractExpression {
         BUSTUB_ASSERT(false, "Unsupported comparison type.");
     }
   }
+
+  auto PerformIntegerComparison(int32_t lhs, int32_t rhs) const -> bool {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return lhs == rhs;
+      case ComparisonType::NotEqual:
+        return lhs != rhs;
+      case ComparisonType::LessThan:
+        return lhs < rhs;
+      case ComparisonType::LessThanOrEqual:
+        return lhs <= rhs;
+      case ComparisonType::GreaterThan:
+        return lhs > rhs;
+      case ComparisonType::GreaterThanOrEqual:
+        return lhs >= rhs;
+      default:
+        BUSTUB_ASSERT(false, "Unsupported comparison type.");
+    }
+  }
 };
 }  // namespace bustub
 
@@ -34,6 +34,13 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    result->resize(batch.NumRows());
+    for (auto row : batch.GetSelection()) {
+      (*result)[row] = val_;
+    }
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/execution/external_sorter.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "execution/sort_key.h"
+#include "storage/table/tmp_tuple_file.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * LoserTree finds the smallest of k sorted sources again after each step with log k comparisons. Each inner node
+ * keeps the source that lost the match played there, and the root keeps the winner.
+ * @tparam Less the strict order of sources, by their current element
+ */
+template <typename Less>
+class LoserTree {
+ public:
+  LoserTree(size_t num_sources, Less less) : tree_(std::max<size_t>(num_sources, 1)), less_(std::move(less)) {
+    tree_[0] = Build(1);
+  }
+
+  /** @return the source with the smallest element */
+  auto Top() const -> size_t { return tree_[0]; }
+
+  /** Find the smallest source again, after the element of Top() changed. */
+  void Replay() {
+    auto winner = tree_[0];
+    for (auto node = (winner + tree_.size()) / 2; node > 0; node /= 2) {
+      if (less_(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  /** @return the winner of the subtree under a node, whose leaves are the nodes from k to 2k - 1 */
+  auto Build(size_t node) -> size_t {
+    if (node >= tree_.size()) {
+      return node - tree_.size();
+    }
+    auto left = Build(2 * node);
+    auto right = Build(2 * node + 1);
+    if (less_(right, left)) {
+      tree_[node] = left;
+      return right;
+    }
+    tree_[node] = right;
+    return left;
+  }
+
+  std::vector<size_t> tree_;
+  Less less_;
+};
+
+/**
+ * ExternalSorter sorts tuples by a normalized key (see SortKeyEncoder) within a memory budget.
+ *
+ * Tuples are collected into a run in memory, with their keys in one arena and their data in another. When the run
+ * takes more than the budget, it is sorted and written to temp pages, and a new one starts. Once all tuples are in, a
+ * sorter that never spilled sorts its one run in memory; otherwise the runs are merged through a loser tree, first in
+ * groups into longer runs while there are more of them than the budget has pages for. The sort is stable.
+ */
+class ExternalSorter {
+ public:
+  /**
+   * @param bpm The buffer pool to spill to
+   * @param encoder Makes the key of a tuple
+   * @param memory_budget The bytes a run may take before it spills
+   */
+  ExternalSorter(BufferPoolManager *bpm, const SortKeyEncoder *encoder, uint64_t memory_budget)
+      : bpm_(bpm), encoder_(encoder), memory_budget_(memory_budget) {}
+
+  /** Add a tuple, spilling the run if it grows over the budget. */
+  void Insert(const Tuple &tuple);
+
+  /** Sort the tuples added so far, after which Next() returns them. */
+  void Finish();
+
+  /**
+   * @param[out] tuple the next tuple in sort order
+   * @return false if all tuples were returned
+   */
+  auto Next(Tuple *tuple) -> bool;
+
+  /** @return the number of runs written to temp pages */
+  auto NumSpilledRuns() const -> size_t { return num_spilled_runs_; }
+
+ private:
+  /** A tuple of the run in memory */
+  struct Entry {
+    /** The first bytes of the key, big-endian and zero padded, which decide most comparisons */
+    uint64_t prefix_;
+    /** Offsets into the arenas, which may grow past 4GB with a large budget */
+    size_t key_offset_;
+    uint32_t key_size_;
+    size_t tuple_offset_;
+  };
+
+  /**
+   * A sorted run being merged, read back from temp pages. Runs hold only the tuples, so that a spilled tuple takes no
+   * more of a page than the tuple itself; keys are encoded again as they are read.
+   */
+  struct Source {
+    const SortKeyEncoder *encoder_{nullptr};
+    std::unique_ptr<TmpTupleFile> file_;
+    std::unique_ptr<TmpTupleFile::Reader> reader_;
+    /** The current tuple and its key; not valid once the run is done */
+    Tuple tuple_;
+    std::string key_;
+    bool valid_{false};
+
+    /** Read the next tuple, returning false at the end of the run */
+    auto Advance() -> bool;
+  };
+
+  /** Orders sources by their current key, then by their position so that the merge is stable */
+  struct SourceLess {
+    const std::vector<Source> *sources_;
+
+    auto operator()(size_t a, size_t b) const -> bool;
+  };
+
+  /** @return The bytes the run in memory takes */
+  auto RunBytes() const -> size_t { return keys_.size() + tuples_.size() + entries_.size() * sizeof(Entry); }
+
+  /** Sort the run in memory by key. */
+  void SortRun();
+
+  /** Sort the run in memory and write it to temp pages, then clear it. */
+  void SpillRun();
+
+  /** Merge runs into one, written to temp pages. */
+  auto MergeRuns(std::vector<std::unique_ptr<TmpTupleFile>> &&runs) -> std::unique_ptr<TmpTupleFile>;
+
+  /** Start reading runs for a merge. */
+  auto OpenSources(std::vector<std::unique_ptr<TmpTupleFile>> &&runs) const -> std::vector<Source>;
+
+  BufferPoolManager *bpm_;
+  const SortKeyEncoder *encoder_;
+  uint64_t memory_budget_;
+
+  /** The run in memory: keys, tuples as SerializeTo() writes them, and an entry for each tuple */
+  std::string keys_;
+  std::vector<char> tuples_;
+  std::vector<Entry> entries_;
+  /** The next entry of a sorter that never spilled to return */
+  size_t cursor_{0};
+
+  /** The runs written to temp pages, in the order they were made */
+  std::vector<std::unique_ptr<TmpTupleFile>> runs_;
+  size_t num_spilled_runs_{0};
+  /** The runs of the final merge, and the tree that picks the next tuple out of them */
+  std::vector<Source> sources_;
+  std::unique_ptr<LoserTree<SourceLess>> merge_;
+};
+
+}  // namespace bustub
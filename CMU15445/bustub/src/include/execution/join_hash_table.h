@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_hash_table.h
+//
+// Identification: src/include/execution/join_hash_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/thread_pool.h"
+#include "common/util/hash_util.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tmp_tuple_file.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * JoinHashTable holds the build side of a hash join.
+ *
+ * Rows are split into NUM_PARTITIONS partitions by the top bits of the hash of their key, so that the table of each
+ * partition is small enough to stay in cache while it is built and probed. A partition keeps its rows serialized back
+ * to back in an arena and finds them through a flat open addressing table with linear probing. Rows with equal keys
+ * are chained, in the order they were inserted.
+ *
+ * Once the rows take more than the memory budget, all partitions are spilled to temp pages, and rows inserted after
+ * that go straight to them. A spilled table is joined one partition at a time: each partition is loaded by a table one
+ * level down, which splits it by the next bits of the hash and may spill in turn.
+ */
+class JoinHashTable {
+ public:
+  static constexpr size_t NUM_PARTITIONS = size_t{1} << HASH_JOIN_RADIX_BITS;
+  /**
+   * The deepest level. A table at this level keeps all its rows in memory instead of spilling: 8 levels have split
+   * the rows by 32 bits of the hash already, so a partition that is still too large holds few distinct keys, which
+   * splitting on more bits cannot separate.
+   */
+  static constexpr size_t MAX_LEVEL = 8;
+  /** Ends a chain of rows */
+  static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+  /** Rows serialized into an arena, with their join keys */
+  class Rows {
+   public:
+    /** Append a row whose key hashes to the given hash. */
+    void Append(hash_t hash, const Value &key, const Tuple &tuple);
+
+    /** Append all rows of another arena, leaving it empty. */
+    void Append(Rows &&other);
+
+    /** @return the number of rows */
+    auto Size() const -> size_t { return offsets_.size(); }
+
+    /** @return an estimate of the memory the rows take once they are in a partition */
+    auto NumBytes() const -> size_t;
+
+   private:
+    friend class JoinHashTable;
+
+    /** Each row as TmpTuplePage stores it: its size, then its data */
+    std::vector<char> arena_;
+    std::vector<size_t> offsets_;
+    std::vector<hash_t> hashes_;
+    std::vector<Value> keys_;
+  };
+
+  /** A right row found by a probe */
+  struct Match {
+    size_t partition_{0};
+    uint32_t row_{NO_ROW};
+
+    auto IsValid() const -> bool { return row_ != NO_ROW; }
+  };
+
+  /**
+   * @param bpm The buffer pool to spill to
+   * @param schema The schema of the rows
+   * @param key_expr The join key of a row, evaluated again when a spilled partition is loaded
+   * @param memory_budget The bytes the rows may take before the table spills
+   * @param level The bits of the hash that pick a partition; a table that loads a spilled partition is one level
+   * below the table that spilled it
+   */
+  JoinHashTable(BufferPoolManager *bpm, const Schema *schema, const AbstractExpression *key_expr,
+                uint64_t memory_budget, size_t level = 0);
+
+  /** @return the hash of a non-null join key, well mixed, which picks both a partition and a slot */
+  static auto Hash(const Value &key) -> hash_t {
+    // fmix64 of MurmurHash3, since HashValue() of an integer barely changes its top bits
+    hash_t hash = HashUtil::HashValue(&key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /** @return the partition of a hash at a level */
+  static auto PartitionOf(hash_t hash, size_t level) -> size_t {
+    return (hash >> (sizeof(hash_t) * 8 - HASH_JOIN_RADIX_BITS * (level + 1))) & (NUM_PARTITIONS - 1);
+  }
+
+  /** Insert a row, spilling the table if it grows over the budget. */
+  void Insert(const Value &key, const Tuple &tuple);
+
+  /**
+   * Add rows that were hashed and partitioned elsewhere, e.g. by the workers of a parallel build. Safe to call
+   * concurrently for different partitions; the table does not spill until Finish().
+   */
+  void Append(size_t partition, Rows &&rows) { partitions_[partition].rows_.Append(std::move(rows)); }
+
+  /**
+   * Finish building: spill the table if it is over the budget, or build the table of each partition otherwise.
+   * @param thread_pool builds the partitions in parallel, unless it is `nullptr`
+   */
+  void Finish(ThreadPool *thread_pool);
+
+  /** @return true if the table was spilled, and must be joined one partition at a time */
+  auto IsSpilled() const -> bool { return spilled_; }
+
+  /** @return the partitions of a spilled table, all NUM_PARTITIONS of them, each to be loaded one level down */
+  auto TakeSpilledPartitions() -> std::vector<std::unique_ptr<TmpTupleFile>>;
+
+  /** Insert the rows of a partition spilled by the table one level up. */
+  void LoadSpilled(TmpTupleFile *file);
+
+  /** @return the level of the table */
+  auto GetLevel() const -> size_t { return level_; }
+
+  /** @return the first row whose key equals the given one, which may be null */
+  auto Find(const Value &key) const -> Match;
+
+  /** @return the next row with the key of a match */
+  auto NextMatch(Match match) const -> Match {
+    return {match.partition_, partitions_[match.partition_].next_[match.row_]};
+  }
+
+  /** Append the values of a matching row to an output row. */
+  void AppendValues(Match match, std::vector<Value> *values) const;
+
+ private:
+  struct Partition {
+    Rows rows_;
+    /** The first row of each key, or NO_ROW; a power of two of them */
+    std::vector<uint32_t> slots_;
+    /** The next row with the same key as each row, or NO_ROW */
+    std::vector<uint32_t> next_;
+    /** The rows of the partition, once the table is spilled */
+    std::unique_ptr<TmpTupleFile> file_;
+  };
+
+  /** Build the slots of a partition from its rows. */
+  static void BuildSlots(Partition *partition);
+
+  /** Move the rows of all partitions to temp pages. */
+  void Spill();
+
+  /** @return a row of a partition as a tuple that points into the arena */
+  auto RowTuple(const Partition &partition, uint32_t row) const -> Tuple;
+
+  BufferPoolManager *bpm_;
+  const Schema *schema_;
+  const AbstractExpression *key_expr_;
+  uint64_t memory_budget_;
+  size_t level_;
+  /** The memory taken by rows inserted by Insert(), until the table spills */
+  size_t num_bytes_{0};
+  bool spilled_{false};
+  std::vector<Partition> partitions_{NUM_PARTITIONS};
+};
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline.h
+//
+// Identification: src/include/execution/pipeline.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+class HashJoinExecutor;
+
+/**
+ * Pipeline runs a chain of executors that pass every batch straight on to their parent, on the morsels of a table in
+ * parallel. The chain starts at a sequential scan, and is followed by any number of filters, projections and probes of
+ * hash joins (the left child of a hash join is its probe side).
+ *
+ * An executor that consumes all of its child before it produces anything -- an aggregation, or the build side of a
+ * hash join -- runs the pipeline of its child on the thread pool of the query instead of pulling the child, and merges
+ * what the workers produced.
+ */
+class Pipeline {
+ public:
+  /**
+   * Called with each batch that comes out of the pipeline.
+   * @param worker the worker running the pipeline, see ThreadPool::Run()
+   * @param morsel the morsel of the scan the batch comes from; batches of one morsel come in order, on one worker
+   * @param batch the batch, which the sink may move from
+   */
+  using Sink = std::function<void(size_t worker, size_t morsel, TupleBatch *batch)>;
+
+  /** Called by a stage with each batch it produces, which passes it on to the next stage. */
+  using Emit = std::function<void(TupleBatch *batch)>;
+
+  /**
+   * Make the pipeline that produces the output of an executor, building the hash tables of the joins it probes.
+   * @param executor The executor whose output the pipeline produces
+   * @return The pipeline, or `nullptr` if the query does not run in parallel, the executor is not the end of a chain,
+   * or the hash table of a join in the chain spilled
+   */
+  static auto Make(AbstractExecutor *executor) -> std::unique_ptr<Pipeline>;
+
+  /** @return The number of workers; the worker passed to a sink is below it */
+  auto NumWorkers() const -> size_t { return thread_pool_->NumWorkers(); }
+
+  /** @return The number of morsels; the morsel passed to a sink is below it */
+  auto NumMorsels() const -> size_t { return morsels_.size(); }
+
+  /** @return The number of pages of the scanned table */
+  auto NumPages() const -> size_t;
+
+  /**
+   * Push every morsel through the pipeline on the workers.
+   * @param sink Called concurrently with the batches that come out of the pipeline
+   */
+  void Run(const Sink &sink) { Run(0, NumMorsels(), sink); }
+
+  /**
+   * Push some of the morsels through the pipeline on the workers.
+   * @param begin The first morsel
+   * @param end The morsel after the last one
+   * @param sink Called concurrently with the batches that come out of the pipeline
+   */
+  void Run(size_t begin, size_t end, const Sink &sink);
+
+ private:
+  /**
+   * A step of the pipeline, which turns a batch into any number of batches of its parent: the batch itself, or batches
+   * it writes into the scratch batch, each emitted before the next is written.
+   */
+  using Stage = std::function<void(TupleBatch *batch, TupleBatch *scratch, const Emit &emit)>;
+
+  Pipeline(ThreadPool *thread_pool, const SeqScanExecutor *scan, std::vector<Stage> &&stages);
+
+  ThreadPool *thread_pool_;
+  /** The scan that starts the pipeline */
+  const SeqScanExecutor *scan_;
+  /** The steps after the scan, in order */
+  std::vector<Stage> stages_;
+  /** The morsels of the scanned table */
+  std::vector<SeqScanExecutor::Morsel> morsels_;
+};
+
+}  // namespace bustub
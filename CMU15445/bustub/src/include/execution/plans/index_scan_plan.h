@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -20,6 +21,15 @@
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
+
+/** One end of the key range of an index scan. */
+struct IndexScanBound {
+  /** The key, of the type of the index column. */
+  Value key_;
+  /** Whether the key itself is in the range. */
+  bool inclusive_;
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
  */
@@ -29,9 +39,20 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param filter_predicate the predicate that the tuples in the key range must also satisfy, or nullptr
+   * @param lower_bound the smallest key to scan, if any
+   * @param upper_bound the greatest key to scan, if any
+   * @param descending whether keys are scanned from the greatest to the smallest
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, AbstractExpressionRef filter_predicate = nullptr,
+                    std::optional<IndexScanBound> lower_bound = std::nullopt,
+                    std::optional<IndexScanBound> upper_bound = std::nullopt, bool descending = false)
+      : AbstractPlanNode(std::move(output), {}),
+        index_oid_(index_oid),
+        filter_predicate_(std::move(filter_predicate)),
+        lower_bound_(std::move(lower_bound)),
+        upper_bound_(std::move(upper_bound)),
+        descending_(descending) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -45,9 +66,27 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   // Add anything you want here for index lookup
 
+  /** The predicate that is left over once the key range has been taken out of the scan's filter, or nullptr. */
+  AbstractExpressionRef filter_predicate_;
+
+  /** The key range, either end open if not given. */
+  std::optional<IndexScanBound> lower_bound_;
+  std::optional<IndexScanBound> upper_bound_;
+
+  /** Whether keys are scanned from the greatest to the smallest. */
+  bool descending_;
+
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string range;
+    if (lower_bound_.has_value() || upper_bound_.has_value()) {
+      range = fmt::format(", range={}{}, {}{}", lower_bound_.has_value() && lower_bound_->inclusive_ ? "[" : "(",
+                          lower_bound_.has_value() ? lower_bound_->key_.ToString() : "-inf",
+                          upper_bound_.has_value() ? upper_bound_->key_.ToString() : "+inf",
+                          upper_bound_.has_value() && upper_bound_->inclusive_ ? "]" : ")");
+    }
+    std::string filter = filter_predicate_ != nullptr ? fmt::format(", filter={}", filter_predicate_) : "";
+    return fmt::format("IndexScan {{ index_oid={}{}{}{} }}", index_oid_, range, descending_ ? ", desc" : "", filter);
   }
 };
 
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder turns the values of the ORDER BY expressions on a tuple into a normalized key: a string of bytes
+ * whose memcmp order is the order of the ORDER BY clause, so that sorting compares no Value.
+ *
+ * Each value is a null byte, then its bytes big-endian with the sign bit flipped for numbers, or its characters with
+ * every 0x00 escaped to 0x00 0xFF and ended by 0x00 0x00 for varchars. Nulls sort as the smallest values. The bytes of
+ * a DESC value are inverted. No key is a prefix of another one that is not equal to it.
+ */
+class SortKeyEncoder {
+ public:
+  SortKeyEncoder(const Schema *schema, const std::vector<std::pair<OrderByType, AbstractExpressionRef>> *order_bys)
+      : schema_(schema), order_bys_(order_bys) {}
+
+  /**
+   * Append the key of a tuple to a string.
+   * @param tuple a tuple of the schema
+   * @param[out] key the string the key is appended to
+   */
+  void Encode(const Tuple &tuple, std::string *key) const {
+    for (const auto &[type, expr] : *order_bys_) {
+      EncodeValue(expr->Evaluate(&tuple, *schema_), type == OrderByType::DESC, key);
+    }
+  }
+
+  /** Append the encoding of a value to a key. */
+  static void EncodeValue(const Value &value, bool descending, std::string *key);
+
+  /** @return a negative number, zero or a positive number if a key sorts before, with or after another one */
+  static auto Compare(std::string_view a, std::string_view b) -> int {
+    auto cmp = memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    if (cmp != 0 || a.size() == b.size()) {
+      return cmp;
+    }
+    return a.size() < b.size() ? -1 : 1;
+  }
+
+ private:
+  const Schema *schema_;
+  const std::vector<std::pair<OrderByType, AbstractExpressionRef>> *order_bys_;
+};
+
+}  // namespace bustub
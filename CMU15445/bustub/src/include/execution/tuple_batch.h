@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch holds up to TUPLE_BATCH_SIZE rows of one schema, stored column by column.
+ *
+ * The rows that are part of the batch are listed by the selection vector, in order. An operator that drops rows,
+ * like a filter, only shrinks the selection vector and leaves the columns untouched, so the rows it keeps are never
+ * copied. Code that reads a batch must therefore only look at the rows in GetSelection().
+ */
+class TupleBatch {
+ public:
+  TupleBatch() = default;
+
+  /**
+   * Empty the batch and set the schema of the rows it holds from now on.
+   * @param schema the schema of the rows
+   */
+  void Reset(const Schema *schema);
+
+  /** @return the schema of the rows */
+  auto GetSchema() const -> const Schema * { return schema_; }
+
+  /** @return the number of rows stored in the columns, whether they are selected or not */
+  auto NumRows() const -> size_t { return num_rows_; }
+
+  /** @return the number of rows in the batch */
+  auto NumSelected() const -> size_t { return selection_.size(); }
+
+  /** @return true if no row is selected */
+  auto IsEmpty() const -> bool { return selection_.empty(); }
+
+  /** @return true if no more rows can be appended */
+  auto IsFull() const -> bool { return num_rows_ >= static_cast<size_t>(TUPLE_BATCH_SIZE); }
+
+  /**
+   * Append a row and select it.
+   * @param tuple the row, in the schema of the batch
+   * @param rid the RID of the row
+   */
+  void Append(const Tuple &tuple, RID rid);
+
+  /**
+   * Append a row and select it.
+   * @param values the values of the row, one per column of the schema
+   * @param rid the RID of the row
+   */
+  void Append(std::vector<Value> &&values, RID rid = RID{});
+
+  /** @return the value of one column in a row */
+  auto GetValue(size_t row, uint32_t col_idx) const -> const Value & { return columns_[col_idx][row]; }
+
+  /** @return all stored values of one column, indexed by row */
+  auto GetColumn(uint32_t col_idx) const -> const std::vector<Value> & { return columns_[col_idx]; }
+
+  /**
+   * Replace one column. Used with CopyRowLayout() to build a batch from columns that were computed as a whole.
+   * @param col_idx the column
+   * @param values one value per stored row
+   */
+  void SetColumn(uint32_t col_idx, std::vector<Value> &&values) {
+    BUSTUB_ASSERT(values.size() == num_rows_, "a column holds one value per row");
+    columns_[col_idx] = std::move(values);
+  }
+
+  /** @return the RID of a row */
+  auto GetRID(size_t row) const -> RID { return rids_[row]; }
+
+  /** @return the selected rows, in order */
+  auto GetSelection() const -> const std::vector<uint32_t> & { return selection_; }
+
+  /**
+   * Replace the selection vector.
+   * @param selection the rows to keep, in order; each must be stored in the batch
+   */
+  void SetSelection(std::vector<uint32_t> &&selection) { selection_ = std::move(selection); }
+
+  /** Keep only the first n selected rows. */
+  void TruncateSelection(size_t n) {
+    if (n < selection_.size()) {
+      selection_.resize(n);
+    }
+  }
+
+  /**
+   * Give this batch the rows, RIDs and selection of another one, with empty columns to be filled by SetColumn().
+   * @param other the batch whose layout is copied
+   */
+  void CopyRowLayout(const TupleBatch &other);
+
+  /** @return a row of the batch as a tuple */
+  auto GetTuple(size_t row) const -> Tuple;
+
+ private:
+  const Schema *schema_{nullptr};
+  /** one vector of values per column of the schema */
+  std::vector<std::vector<Value>> columns_;
+  std::vector<RID> rids_;
+  std::vector<uint32_t> selection_;
+  size_t num_rows_{0};
+};
+
+}  // namespace bustub
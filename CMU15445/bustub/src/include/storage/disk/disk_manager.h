@@ -13,15 +13,34 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/**
+ * A page read or write handed to DiskManager::SubmitRequests().
+ */
+struct DiskRequest {
+  /** True to write data_ to page_id_, false to read page_id_ into data_. */
+  bool is_write_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** The page buffer. It must stay valid until callback_ has run. */
+  char *data_;
+  /** Runs once the request has completed, on whichever thread completed it. May be empty. */
+  std::function<void()> callback_;
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -37,12 +56,16 @@ class DiskManager {
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  /**
+   * Waits for the background I/O threads, if any were started, to finish the requests already queued. By now the
+   * subclass is gone, so every subclass calls StopIoThreads() first in its own destructor.
+   */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -58,6 +81,36 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Make every page written so far durable. Meant for checkpoint and commit boundaries, so that backends which do not
+   * sync on every write only pay for it there. The fstream backend flushes on every write and has nothing left to do.
+   */
+  virtual void Sync() {}
+
+  /**
+   * Run a disk request on one of the DISK_IO_THREADS background I/O threads instead of the calling thread. The threads
+   * are started by the first request. Whoever schedules a request must keep the buffers it touches alive until it
+   * has run.
+   * @param request the request, typically a call to ReadPage and/or WritePage followed by a completion step
+   */
+  void Schedule(std::function<void()> request);
+
+  /**
+   * Submit a batch of page reads and writes without waiting for them. Requests in a batch may complete in any order;
+   * a request that must follow another one has to be submitted from the other's callback.
+   *
+   * The default implementation runs every request on the background I/O threads, see Schedule(). Backends that can
+   * hand a whole batch to the kernel at once override it.
+   * @param requests the requests to submit
+   */
+  virtual void SubmitRequests(std::vector<DiskRequest> requests);
+
+  /**
+   * Submit a batch of page reads and writes and wait for all of them to complete.
+   * @param requests the requests to run
+   */
+  void RunRequests(std::vector<DiskRequest> requests);
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -93,7 +146,18 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /**
+   * Lets the background I/O threads drain the queue, then joins them. The queued requests call the virtual ReadPage()
+   * and WritePage(), so a subclass must call this at the start of its destructor, while it is still whole.
+   */
+  void StopIoThreads();
+
   auto GetFileSize(const std::string &file_name) -> int;
+  /**
+   * Open or create the log file that belongs to file_name_, and set log_name_.
+   * @return false if the database file name has no extension to derive the log file name from
+   */
+  auto OpenLogFile() -> bool;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
@@ -101,11 +165,22 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+
+ private:
+  /** Loop run by every background I/O thread. */
+  void IoThreadMain();
+
+  /** Protects the request queue and the shutdown flag. */
+  std::mutex io_queue_latch_;
+  std::condition_variable io_queue_cv_;
+  std::deque<std::function<void()>> io_queue_;
+  bool io_shutdown_{false};
+  std::vector<std::thread> io_threads_;
 };
 
 }  // namespace bustub
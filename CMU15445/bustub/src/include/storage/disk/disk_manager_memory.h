@@ -9,6 +9,9 @@
 // Copyright (c) 2015-2020, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+
+#pragma once
+
 #include <array>
 #include <cstring>
 #include <fstream>
@@ -36,7 +39,10 @@ class DiskManagerMemory : public DiskManager {
  public:
   explicit DiskManagerMemory(size_t pages);
 
-  ~DiskManagerMemory() override { delete[] memory_; }
+  ~DiskManagerMemory() override {
+    StopIoThreads();
+    delete[] memory_;
+  }
 
   /**
    * Write a page to the database file.
@@ -64,6 +70,8 @@ class DiskManagerUnlimitedMemory : public DiskManager {
  public:
   DiskManagerUnlimitedMemory() = default;
 
+  ~DiskManagerUnlimitedMemory() override { StopIoThreads(); }
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
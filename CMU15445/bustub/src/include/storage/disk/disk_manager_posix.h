@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.h
+//
+// Identification: src/include/storage/disk/disk_manager_posix.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class IoUringEngine;
+
+/**
+ * DiskManagerPosix reads and writes pages of the database file with pread() and pwrite() on a raw file descriptor.
+ * Every call carries its own file offset, so page I/O from any number of threads runs concurrently without a latch.
+ *
+ * Writes are not synced one by one: Sync() issues a single fdatasync() for everything written so far, and is meant
+ * to be called at checkpoint and commit boundaries. The log file is still handled by the DiskManager base class.
+ *
+ * Batches from SubmitRequests() go to the kernel through an io_uring when one can be set up, and to the background
+ * I/O threads of the base class otherwise, which is always the case on platforms other than Linux.
+ */
+class DiskManagerPosix : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io open the database file with O_DIRECT, bypassing the OS page cache. If the platform or the file
+   * system does not support it, the file is opened without it; see IsDirectIo().
+   * @param use_io_uring submit request batches through an io_uring. If io_uring is not available, the background I/O
+   * threads are used instead; see UsesIoUring().
+   */
+  explicit DiskManagerPosix(const std::string &db_file, bool direct_io = false, bool use_io_uring = true);
+
+  ~DiskManagerPosix() override;
+
+  /**
+   * Shut down the disk manager, sync the database file and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file. The page is not synced; see Sync().
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file. The part of the page that lies beyond the end of the file reads as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Submit a batch of page reads and writes to the io_uring with a single system call, or to the background I/O
+   * threads if there is no io_uring.
+   * @param requests the requests to submit
+   */
+  void SubmitRequests(std::vector<DiskRequest> requests) override;
+
+  /**
+   * fdatasync() the database file, or fsync() it where there is no fdatasync().
+   */
+  void Sync() override;
+
+  /** @return true iff the database file is open with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+  /** @return true iff request batches go through an io_uring */
+  auto UsesIoUring() const -> bool { return io_uring_ != nullptr; }
+
+ private:
+  /** Write a page without counting it; WritePage() and the requests an io_uring counted at submission share it. */
+  void WritePageUncounted(page_id_t page_id, const char *page_data);
+
+  /**
+   * O_DIRECT transfers need a buffer aligned to the logical block size of the device. Buffers that are not page
+   * aligned are bounced through a per-thread aligned buffer instead.
+   */
+  static auto IsAligned(const char *page_data) -> bool;
+
+  /** File descriptor of the database file, or -1 once it has been closed. */
+  int db_fd_{-1};
+  /** True iff db_fd_ was opened with O_DIRECT. */
+  bool direct_io_{false};
+  /** The io_uring for request batches, or nullptr. */
+  std::unique_ptr<IoUringEngine> io_uring_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_engine.h
+//
+// Identification: src/include/storage/disk/io_uring_engine.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#ifdef __linux__
+
+#include <linux/io_uring.h>
+
+#include <chrono>  // NOLINT
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * IoUringEngine submits page reads and writes on one file to an io_uring, and reaps their completions on a thread of
+ * its own. It talks to the kernel through the raw io_uring_setup/io_uring_enter system calls.
+ *
+ * A whole batch of requests goes to the kernel with a single io_uring_enter. Requests that do not fit into the
+ * submission queue wait in an overflow queue, which the completion thread drains as slots free up, so Submit() never
+ * blocks, not even when it is called from a completion callback.
+ */
+class IoUringEngine {
+ public:
+  /** The longest the completion thread sleeps before it retries a failed wait for completions */
+  static constexpr std::chrono::milliseconds MAX_REAP_BACKOFF{10};
+
+  /**
+   * Set up an io_uring for page I/O on a file.
+   * @param fd the file to read and write pages of
+   * @param direct_io true if fd was opened with O_DIRECT, so that unaligned page buffers need a bounce buffer
+   * @param entries the size of the submission queue
+   * @param fallback redoes a request synchronously if the ring reported an error or a short transfer
+   * @return the engine, or nullptr if io_uring is not available (old kernel, seccomp, sysctl)
+   */
+  static auto Create(int fd, bool direct_io, unsigned entries, std::function<void(const DiskRequest &)> fallback)
+      -> std::unique_ptr<IoUringEngine>;
+
+  /**
+   * Waits for every submitted request to complete, then tears the ring down.
+   */
+  ~IoUringEngine();
+
+  /**
+   * Submit a batch of requests. Their callbacks run on the completion thread.
+   * @param requests the requests to submit
+   */
+  void Submit(std::vector<DiskRequest> requests);
+
+ private:
+  /** A request between Submit() and its completion. */
+  struct InFlight {
+    DiskRequest request_;
+    /** Aligned copy of the page for O_DIRECT, or nullptr if request_.data_ is used directly. */
+    char *bounce_{nullptr};
+    /** Result of the read or write as reported by the kernel. */
+    int result_{0};
+  };
+
+  IoUringEngine(int ring_fd, int fd, bool direct_io, std::function<void(const DiskRequest &)> fallback);
+
+  /** Map the rings of ring_fd_. @return false if a mapping failed */
+  auto MapRings(const io_uring_params &params) -> bool;
+
+  /** Move as many requests from pending_ into the submission queue as fit, and submit them. Caller holds latch_. */
+  void SubmitPending();
+
+  /**
+   * Loop of the completion thread. If waiting for completions keeps failing, it backs off up to MAX_REAP_BACKOFF
+   * between attempts instead of spinning.
+   */
+  void ReapCompletions();
+
+  /** Finish one request: copy out of the bounce buffer, or redo it synchronously, then run its callback. */
+  void Complete(InFlight *op);
+
+  /** The io_uring instance. */
+  int ring_fd_;
+  /** The file pages are read from and written to. */
+  int fd_;
+  bool direct_io_;
+  std::function<void(const DiskRequest &)> fallback_;
+
+  /** Mapped rings. With IORING_FEAT_SINGLE_MMAP the completion ring shares the submission ring's mapping. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned sq_entries_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Protects the submission queue, pending_, in_flight_ and stopping_. */
+  std::mutex latch_;
+  /** Requests that did not fit into the submission queue yet. nullptr is the shutdown marker. */
+  std::deque<InFlight *> pending_;
+  /** Requests in the submission or completion queue, never more than sq_entries_. */
+  unsigned in_flight_{0};
+  /** Set by the destructor once the shutdown marker has been queued. */
+  bool stopping_{false};
+  std::thread reaper_;
+};
+
+}  // namespace bustub
+
+#endif  // __linux__
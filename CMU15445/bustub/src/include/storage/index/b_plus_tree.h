@@ -10,6 +10,9 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
 #include <queue>
 #include <string>
 #include <utility>
@@ -34,6 +37,11 @@ enum class Operation { FIND = 0, INSERT, DELETE };  // 三种操作：查找、
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency: readers crab down with read latches. Writers first descend optimistically, read-latching internal
+ * pages and write-latching only the leaf; only if that leaf might split or underflow do they start over and crab
+ * down with write latches, keeping the latches of every ancestor the change can reach. The root page id is a
+ * versioned atomic word rather than a mutex-protected field, see LatchRoot().
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -42,7 +50,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LeafPage::DEFAULT_MAX_SIZE,
+                     int internal_max_size = InternalPage::DEFAULT_MAX_SIZE);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -53,9 +62,18 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  // Build this B+ tree bottom-up from entries sorted by strictly increasing key. The tree must be empty.
+  auto BulkLoad(typename std::vector<MappingType>::const_iterator begin,
+                typename std::vector<MappingType>::const_iterator end, double fill_factor = INDEX_FILL_FACTOR) -> bool;
+
   // return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr) -> bool;
 
+  // Look up a batch of keys, (*results)[i] getting the value of keys[i] if there is one. The keys are probed in
+  // sorted order, so that keys in the same subtree share one descent. Returns how many keys were found.
+  auto GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr) -> size_t;
+
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
@@ -64,6 +82,11 @@ class BPlusTree {
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
 
+  // range scan over the keys between low and high, an absent bound leaving that side open, in either direction. The
+  // iterator is at its end as soon as it leaves the range
+  auto Scan(const std::optional<KeyType> &low, bool low_inclusive, const std::optional<KeyType> &high,
+            bool high_inclusive, ScanDirection direction = ScanDirection::Forward) -> INDEXITERATOR_TYPE;
+
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -78,23 +101,54 @@ class BPlusTree {
 
   auto FindLeafPage(const KeyType &key, bool leftMost) -> Page *;
 
+  // latch-crab down to a leaf; FIND read-latches, INSERT/DELETE write-latch. Returns nullptr if the tree is empty
   auto FindLeafPageByOperation(const KeyType &key, Operation operation = Operation::FIND,
                                Transaction *transaction = nullptr, bool leftMost = false, bool rightMost = false)
-      -> std::pair<Page *, bool>;
+      -> Page *;
+
+  // read-latch the leaf before the one that holds key, and prefetch the leaves to its left. If the leaf of key is the
+  // leftmost one, that leaf is latched instead and *leftmost is set. Returns nullptr if the tree is empty
+  auto FindLeafPageBefore(const KeyType &key, bool *leftmost) -> Page *;
 
  private:
   void UpdateRootPageId(int insert_record = 0);
 
-  // helper function for insert
-  auto StartNewTree(const KeyType &key, const ValueType &value) -> void;
+  static auto RootPageIdOf(uint64_t root) -> page_id_t { return static_cast<page_id_t>(root & 0xFFFFFFFF); }
+  static auto NextRoot(uint64_t root, page_id_t root_page_id) -> uint64_t {
+    return ((root >> 32) + 1) << 32 | static_cast<uint32_t>(root_page_id);
+  }
+
+  // publish a new root page id; the caller holds the write latch of the old root
+  void SetRootPageId(page_id_t root_page_id);
+
+  // fetch and latch the current root page, or return nullptr if the tree is empty
+  auto LatchRoot(bool exclusive_internal, bool exclusive_leaf) -> Page *;
 
-  auto InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool;
+  // read-latch down to the leaf and write-latch only the leaf. Returns nullptr if the tree is empty
+  auto FindLeafPageOptimistic(const KeyType &key, Operation operation) -> Page *;
+
+  // helper function for GetValues: look up the keys at order[begin, end) in the subtree of the read-latched page,
+  // then unlatch and unpin it
+  auto GetValuesInSubtree(Page *page, const std::vector<KeyType> &keys, const std::vector<size_t> &order,
+                          size_t begin, size_t end, std::vector<std::vector<ValueType>> *results) -> size_t;
+
+  // helper function for bulk load: how many pages a level of num_entries entries is spread over
+  static auto PagesForLevel(size_t num_entries, int max_size, double fill_factor) -> size_t;
+
+  // bulk load of pages that hold variable-length keys, which are filled by bytes rather than by count
+  void BulkLoadVariableLength(typename std::vector<MappingType>::const_iterator begin,
+                              typename std::vector<MappingType>::const_iterator end, double fill_factor);
+
+  // helper function for insert; fails if the tree is not empty_root any more
+  auto StartNewTree(uint64_t empty_root, const KeyType &key, const ValueType &value) -> bool;
+
+  auto InsertIntoLeaf(Page *leaf_page, const KeyType &key, const ValueType &value, Transaction *transaction) -> bool;
 
   template <typename N>
   auto Split(N *node) -> N *;
 
   template <typename N>
-  auto CoalesceOrRedistribute(N *node, Transaction *transaction, bool *root_is_latched = nullptr) -> bool;
+  auto CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool;
 
   template <typename N>
   auto MaxSize(N *node) -> int;
@@ -106,13 +160,18 @@ class BPlusTree {
 
   template <typename N>
   auto Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction, bool *root_is_latched = nullptr) -> bool;
+                int index, Transaction *transaction) -> bool;
 
   template <typename N>
   void Redistribute(N *neighbor_node, N *node, int index);
 
+  // redistribute pages of variable-length keys, left and right being siblings with parent->KeyAt(key_index) between
+  // them; false if the parent has no room for their new split key
+  template <typename N>
+  auto RedistributeVariableLength(N *left, N *right, InternalPage *parent, int key_index) -> bool;
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr, bool *root_is_latched = nullptr);
+                        Transaction *transaction = nullptr);
 
   void UnlockPages(Transaction *transaction);
 
@@ -130,12 +189,12 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
-  std::mutex root_latch_;  // 保护root page id不被改变
+  // root page id in the low 32 bits, bumped by every root change in the high 32 bits
+  std::atomic<uint64_t> root_;
 };
 
 }  // namespace bustub
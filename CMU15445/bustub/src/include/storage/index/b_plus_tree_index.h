@@ -13,6 +13,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -35,12 +36,29 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Look up all keys in one batch, which shares the descents of keys that fall into the same pages. */
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Build the index from scratch out of a batch of entries, e.g. all rows of a table when it is first indexed.
+   * The entries are loaded bottom-up; if a key appears more than once, the first entry wins, just like inserting them
+   * one by one.
+   * @param entries the entries to index, best sorted by key already (see Catalog::CreateIndex); sorted in place if not
+   * @param transaction the transaction context
+   */
+  void BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries, Transaction *transaction);
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
+  /** Range scan over the keys between low and high, in either direction; see BPlusTree::Scan. */
+  auto GetScanIterator(const std::optional<KeyType> &low, bool low_inclusive, const std::optional<KeyType> &high,
+                       bool high_inclusive, ScanDirection direction) -> INDEXITERATOR_TYPE;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
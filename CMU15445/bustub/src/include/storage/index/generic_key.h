@@ -13,6 +13,9 @@
 #pragma once
 
 #include <cstring>
+#include <limits>
+
+#include "common/config.h"
 
 #include "storage/table/tuple.h"
 #include "type/value.h"
@@ -77,6 +80,18 @@ template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    switch (integer_key_size_) {
+      case sizeof(int8_t):
+        return CompareIntegers(ReadInteger<int8_t>(lhs.data_), ReadInteger<int8_t>(rhs.data_));
+      case sizeof(int16_t):
+        return CompareIntegers(ReadInteger<int16_t>(lhs.data_), ReadInteger<int16_t>(rhs.data_));
+      case sizeof(int32_t):
+        return CompareIntegers(ReadInteger<int32_t>(lhs.data_), ReadInteger<int32_t>(rhs.data_));
+      case sizeof(int64_t):
+        return CompareIntegers(ReadInteger<int64_t>(lhs.data_), ReadInteger<int64_t>(rhs.data_));
+      default:
+        break;
+    }
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +109,65 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, integer_key_size_{other.integer_key_size_} {}
+
+  /**
+   * @param key_schema The schema of the keys
+   * @param integer_key_search false to compare keys of one integer column value by value too, as other keys are
+   */
+  explicit GenericComparator(Schema *key_schema, bool integer_key_search = true)
+      : key_schema_(key_schema), integer_key_size_(integer_key_search ? IntegerKeySizeOf(key_schema) : 0) {}
+
+  /**
+   * @return the width in bytes of the key if it is a single integer column compared as a plain integer, 0 if keys
+   * are compared value by value through the key schema
+   */
+  inline auto IntegerKeySize() const -> uint32_t { return integer_key_size_; }
+
+  /** @return the integer stored at the front of a key, for a key of IntegerKeySize() == sizeof(T) */
+  template <typename T>
+  static inline auto ReadInteger(const char *data) -> T {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+  }
 
-  // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  /** @return true if an integer read from a key is NULL, which integer types store as their lowest value */
+  template <typename T>
+  static inline auto IsNullInteger(T value) -> bool {
+    return value == std::numeric_limits<T>::min();
+  }
 
  private:
+  template <typename T>
+  static inline auto CompareIntegers(T lhs, T rhs) -> int {
+    // NULL is neither less nor greater than any key, as in the Value comparisons
+    if (IsNullInteger(lhs) || IsNullInteger(rhs)) {
+      return 0;
+    }
+    return static_cast<int>(lhs > rhs) - static_cast<int>(lhs < rhs);
+  }
+
+  static auto IntegerKeySizeOf(Schema *key_schema) -> uint32_t {
+    if (key_schema == nullptr || key_schema->GetColumnCount() != 1) {
+      return 0;
+    }
+    const auto &col = key_schema->GetColumn(0);
+    switch (col.GetType()) {
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+        return col.GetOffset() == 0 && col.GetFixedLength() <= KeySize ? col.GetFixedLength() : 0;
+      default:
+        return 0;
+    }
+  }
+
   Schema *key_schema_;
+  // see IntegerKeySize()
+  uint32_t integer_key_size_;
 };
 
 }  // namespace bustub
@@ -13,12 +13,20 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/** The order in which a range scan hands out keys. */
+enum class ScanDirection { Forward = 0, Backward };
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
@@ -27,9 +35,17 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   IndexIterator();
   IndexIterator(BufferPoolManager *bpm, Page *page, int index);
+  /**
+   * A range scan starting at entry index of the read-latched leaf page, which may be nullptr for an empty tree.
+   * @param stop the last key of the range in scan direction, if there is one
+   * @param stop_inclusive whether stop itself is in the range
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm, Page *page, int index,
+                ScanDirection direction, std::optional<KeyType> stop, bool stop_inclusive,
+                const KeyComparator *comparator);
   ~IndexIterator();  // NOLINT
 
-  auto IsEnd() -> bool;
+  auto IsEnd() const -> bool;
 
   auto operator*() -> const MappingType &;
 
@@ -40,11 +56,53 @@ class IndexIterator {
   auto operator!=(const IndexIterator &itr) const -> bool;
 
  private:
+  /**
+   * Follow the leaf chain from the last leaf read ahead and prefetch leaves until READ_AHEAD_PAGES leaves beyond the
+   * current one are in flight or resident.
+   */
+  void ReadAhead();
+
+  // unlatch and unpin the current leaf, and go to the first entry of the next one
+  void MoveToNextLeaf();
+
+  /**
+   * Unlatch and unpin the current leaf, and go to the last entry of the leaf before it. Leaves only link to their right
+   * sibling, and latching leftwards while holding a latch could deadlock with writers, so this descends from the root
+   * again to the leaf of the greatest key below the current leaf.
+   */
+  void MoveToPrevLeaf();
+
+  // whether key lies beyond the stop key of a range scan
+  auto PastStop(const KeyType &key) const -> bool;
+
+  // step over leaves without entries in scan direction, then mark the scan as ended if it left its range
+  void Settle();
+
+  // unlatch and unpin the current leaf once the scan has ended
+  void Release();
+
   // add your own private member variables here
   BufferPoolManager *buffer_pool_manager_;
   Page *page_;
   int index_;
   LeafPage *leaf_;
+  /** The tree a backward scan descends again to step to the previous leaf. */
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  ScanDirection direction_{ScanDirection::Forward};
+  /** The last key of a range scan in scan direction, and whether it is in the range. */
+  std::optional<KeyType> stop_;
+  bool stop_inclusive_{true};
+  const KeyComparator *comparator_{nullptr};
+  /** Whether the current leaf is known to be the leftmost one, where a backward scan ends. */
+  bool leftmost_{false};
+  /** Whether the scan has run past the last entry of its range. */
+  bool end_{false};
+  /** The furthest leaf that has been prefetched, or INVALID_PAGE_ID before the first read-ahead. */
+  page_id_t read_ahead_page_id_{INVALID_PAGE_ID};
+  /** Number of leaves prefetched beyond the current one. */
+  int read_ahead_pages_{0};
+  /** The entry last handed out, for leaves that do not store their entries as they are. */
+  MappingType item_;
 };
 
 }  // namespace bustub
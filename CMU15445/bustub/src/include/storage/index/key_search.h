@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * Binary search over the sorted keys of a B+ tree page through the comparator. The keys sit one every `stride` bytes,
+ * starting at `keys`, so that the (key, value) array of a page can be searched in place. Both searches look at the
+ * keys in [begin, end) only.
+ */
+template <typename KeyType, typename KeyComparator>
+struct ComparatorKeySearch {
+  /** @return the index of the first key >= key, or end if there is none */
+  static auto LowerBound(const char *keys, size_t stride, int begin, int end, const KeyType &key,
+                         const KeyComparator &comparator) -> int {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(KeyAt(keys, stride, mid), key) < 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  /** @return the index of the first key > key, or end if there is none */
+  static auto UpperBound(const char *keys, size_t stride, int begin, int end, const KeyType &key,
+                         const KeyComparator &comparator) -> int {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(KeyAt(keys, stride, mid), key) <= 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+ private:
+  static auto KeyAt(const char *keys, size_t stride, int index) -> const KeyType & {
+    return *reinterpret_cast<const KeyType *>(keys + index * stride);
+  }
+};
+
+/** The search used by B+ tree pages. Key types that can do better than ComparatorKeySearch specialize it. */
+template <typename KeyType, typename KeyComparator>
+struct KeySearch : ComparatorKeySearch<KeyType, KeyComparator> {};
+
+/**
+ * Keys of one integer column are searched on the integers themselves, without a comparator call per probe. The
+ * search is branchless: each step halves the range with a conditional move rather than a jump, so it costs the
+ * same whatever the keys are and never mispredicts.
+ */
+template <size_t KeySize>
+struct KeySearch<GenericKey<KeySize>, GenericComparator<KeySize>> {
+  using KeyType = GenericKey<KeySize>;
+  using KeyComparator = GenericComparator<KeySize>;
+
+  static auto LowerBound(const char *keys, size_t stride, int begin, int end, const KeyType &key,
+                         const KeyComparator &comparator) -> int {
+    return Search<false>(keys, stride, begin, end, key, comparator);
+  }
+
+  static auto UpperBound(const char *keys, size_t stride, int begin, int end, const KeyType &key,
+                         const KeyComparator &comparator) -> int {
+    return Search<true>(keys, stride, begin, end, key, comparator);
+  }
+
+ private:
+  template <bool Upper>
+  static auto Search(const char *keys, size_t stride, int begin, int end, const KeyType &key,
+                     const KeyComparator &comparator) -> int {
+    switch (comparator.IntegerKeySize()) {
+      case sizeof(int8_t):
+        return BranchlessSearch<int8_t, Upper>(keys, stride, begin, end, key);
+      case sizeof(int16_t):
+        return BranchlessSearch<int16_t, Upper>(keys, stride, begin, end, key);
+      case sizeof(int32_t):
+        return BranchlessSearch<int32_t, Upper>(keys, stride, begin, end, key);
+      case sizeof(int64_t):
+        return BranchlessSearch<int64_t, Upper>(keys, stride, begin, end, key);
+      default:
+        break;
+    }
+    if (Upper) {
+      return ComparatorKeySearch<KeyType, KeyComparator>::UpperBound(keys, stride, begin, end, key, comparator);
+    }
+    return ComparatorKeySearch<KeyType, KeyComparator>::LowerBound(keys, stride, begin, end, key, comparator);
+  }
+
+  template <typename T, bool Upper>
+  static auto BranchlessSearch(const char *keys, size_t stride, int begin, int end, const KeyType &key) -> int {
+    if (begin >= end) {
+      return begin;
+    }
+    const T probe = KeyComparator::template ReadInteger<T>(key.data_);
+    const bool probe_is_null = KeyComparator::IsNullInteger(probe);
+    const char *first = keys + begin * stride;
+    size_t length = end - begin;
+    // the answer is always in [first, first + length]
+    while (length > 1) {
+      size_t half = length / 2;
+      T middle = KeyComparator::template ReadInteger<T>(first + (half - 1) * stride);
+      first += Before<T, Upper>(middle, probe, probe_is_null) ? half * stride : 0;
+      length -= half;
+    }
+    T last = KeyComparator::template ReadInteger<T>(first);
+    first += Before<T, Upper>(last, probe, probe_is_null) ? stride : 0;
+    return static_cast<int>((first - keys) / stride);
+  }
+
+  /**
+   * @return true if a key goes before the bound: if it compares < probe for the lower bound, <= probe for the upper
+   * one. NULL compares equal to any key, as in GenericComparator, without a branch.
+   */
+  template <typename T, bool Upper>
+  static auto Before(T key, T probe, bool probe_is_null) -> bool {
+    bool either_is_null = KeyComparator::IsNullInteger(key) | probe_is_null;
+    return Upper ? (key <= probe) | either_is_null : (key < probe) & !either_is_null;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varchar_key.h
+//
+// Identification: src/include/storage/index/varchar_key.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+/**
+ * Index key of one VARCHAR column: up to KeySize - 1 bytes of string, without the tuple's offset, length word and
+ * terminating null that a GenericKey stores. B+ trees over these keys use prefix-compressed, variable-length pages
+ * (see BPlusTreeVarcharPage), so a short key also takes little room on its page.
+ */
+template <size_t KeySize>
+class VarcharKey {
+ public:
+  static constexpr size_t MAX_LENGTH = std::min<size_t>(KeySize - 1, UINT8_MAX);
+
+  /** Set from a key tuple of a single VARCHAR column. A NULL string is stored as the empty string. */
+  inline void SetFromKey(const Tuple &tuple) {
+    const char *data = tuple.GetData();
+    uint32_t offset;
+    memcpy(&offset, data, sizeof(uint32_t));
+    uint32_t length;
+    memcpy(&length, data + offset, sizeof(uint32_t));
+    if (length == BUSTUB_VALUE_NULL || length == 0) {
+      SetFromString({});
+      return;
+    }
+    // the serialized string includes its terminating null
+    SetFromString(std::string_view(data + offset + sizeof(uint32_t), length - 1));
+  }
+
+  inline void SetFromString(std::string_view str) {
+    if (str.size() > MAX_LENGTH) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "string too long for index key");
+    }
+    length_ = static_cast<uint8_t>(str.size());
+    memcpy(data_, str.data(), str.size());
+  }
+
+  // NOTE: for test purpose only
+  // non-negative integers are zero-padded so that they sort as integers
+  inline void SetFromInteger(int64_t key) {
+    std::ostringstream str;
+    str << std::setw(20) << std::setfill('0') << key;
+    SetFromString(str.str());
+  }
+
+  inline auto GetLength() const -> size_t { return length_; }
+  inline auto GetData() const -> const char * { return data_; }
+  inline auto ToStringView() const -> std::string_view { return {data_, length_}; }
+  inline auto ToString() const -> std::string { return std::string(ToStringView()); }
+
+  friend auto operator<<(std::ostream &os, const VarcharKey &key) -> std::ostream & {
+    os << key.ToStringView();
+    return os;
+  }
+
+ private:
+  uint8_t length_{0};
+  char data_[KeySize - 1];
+};
+
+/** Orders VarcharKeys as VARCHAR values compare: bytewise, and a string before any longer string it starts. */
+template <size_t KeySize>
+class VarcharComparator {
+ public:
+  inline auto operator()(const VarcharKey<KeySize> &lhs, const VarcharKey<KeySize> &rhs) const -> int {
+    return lhs.ToStringView().compare(rhs.ToStringView());
+  }
+
+  // the key schema is not needed: a VarcharKey is always one VARCHAR column
+  explicit VarcharComparator(Schema *key_schema) {}
+  VarcharComparator(const VarcharComparator &other) = default;
+
+  /**
+   * @return the shortest key that is greater than left and not greater than right, for left < right. A page split
+   * between left and right only needs this much of right in its parent to route searches.
+   */
+  static auto Separator(const VarcharKey<KeySize> &left, const VarcharKey<KeySize> &right) -> VarcharKey<KeySize> {
+    std::string_view l = left.ToStringView();
+    std::string_view r = right.ToStringView();
+    size_t common = 0;
+    while (common < l.size() && common < r.size() && l[common] == r[common]) {
+      common++;
+    }
+    VarcharKey<KeySize> separator;
+    separator.SetFromString(r.substr(0, std::min(common + 1, r.size())));
+    return separator;
+  }
+};
+
+}  // namespace bustub
@@ -35,6 +35,10 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
+  // keys have a fixed length, so that a page holds a fixed number of entries and can be redistributed
+  static constexpr bool VARIABLE_LENGTH = false;
+  static constexpr int DEFAULT_MAX_SIZE = INTERNAL_PAGE_SIZE;
+
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
@@ -55,9 +59,10 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
+  // append children to the end of this page and make this page their parent, used by bulk loading
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &item, BufferPoolManager *buffer_pool_manager);
 
   void CopyFirstFrom(const MappingType &item, BufferPoolManager *buffer_pool_manager);
@@ -66,3 +71,6 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   // std::mutex latch_;     // DEBUG
 };
 }  // namespace bustub
+
+// pages of trees over VarcharKeys are specializations with a format of their own
+#include "storage/page/b_plus_tree_varchar_page.h"
@@ -42,6 +42,10 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
+  // keys have a fixed length, so that a page holds a fixed number of entries and can be redistributed
+  static constexpr bool VARIABLE_LENGTH = false;
+  static constexpr int DEFAULT_MAX_SIZE = LEAF_PAGE_SIZE;
+
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
@@ -49,6 +53,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
   auto KeyAt(int index) const -> KeyType;
+  // the key that the parent holds for this page after a split
+  auto LowKey() const -> KeyType;
   auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
   auto GetItem(int index) -> const MappingType &;
 
@@ -62,9 +68,10 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  // append items to the end of this page, used by bulk loading
+  void CopyNFrom(const MappingType *items, int size);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
@@ -72,3 +79,6 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   MappingType array_[0];
 };
 }  // namespace bustub
+
+// pages of trees over VarcharKeys are specializations with a format of their own
+#include "storage/page/b_plus_tree_varchar_page.h"
@@ -0,0 +1,246 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varchar_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_varchar_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "storage/index/varchar_key.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+#define VARCHAR_PAGE_TEMPLATE_ARGUMENTS template <typename ValueType, size_t KeySize>
+#define B_PLUS_TREE_VARCHAR_PAGE_TYPE BPlusTreeVarcharPage<ValueType, KeySize>
+#define B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE BPlusTreeLeafPage<VarcharKey<KeySize>, ValueType, VarcharComparator<KeySize>>
+#define B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE \
+  BPlusTreeInternalPage<VarcharKey<KeySize>, ValueType, VarcharComparator<KeySize>>
+#define VARCHAR_PAGE_HEADER_SIZE 44
+
+/**
+ * The part that leaf and internal pages of a B+ tree over VarcharKeys share. Keys are stored with their own length
+ * and without the prefix that every key of the page starts with, so a page holds as many entries as fit by bytes
+ * rather than a fixed number of full-size keys.
+ *
+ * Every page covers a key range [low fence, high fence): the root covers all keys, and a split divides the range of
+ * a page at the key that it pushes into the parent. All keys in the range start with the common prefix of the two
+ * fences, which is thus stored once, as part of the fences. A leaf split pushes the shortest key that separates its
+ * two halves rather than the whole first key of the right half, which keeps internal pages small as well.
+ *
+ * Page format:
+ *  --------------------------------------------------------------------------------------
+ * | HEADER | SLOT(0) | SLOT(1) | ... | SLOT(n-1) | free space | KEY BYTES | FENCE BYTES |
+ *  --------------------------------------------------------------------------------------
+ * Key bytes grow down from the end of the page, and a slot is the (offset, length) of a key without the prefix, and
+ * its value. A removed key leaves its bytes behind as garbage until an insert runs out of room and compacts the page.
+ * The first key of an internal page is never looked at, so it is not stored: it reads as the low fence.
+ *
+ *  Header format (size in byte, 44 bytes in total):
+ *  ----------------------------------------------------------------------------------------
+ * | BPlusTreePage header (24) | NextPageId (4) | HeapBegin (2) | Garbage (2) |
+ *  ----------------------------------------------------------------------------------------
+ * | LowOffset (2) | LowLength (2) | HighOffset (2) | HighLength (2) | PrefixLength (2) | (2) |
+ *  ----------------------------------------------------------------------------------------
+ *
+ * As the number of entries that fit depends on their keys, GetMaxSize() and GetMinSize() are worked out from the
+ * bytes in use instead of stored: a page reaches its max size once a key of the longest length might not fit any
+ * more, and it is under its min size while less than a quarter of it is in use. The max size given to Init() caps
+ * the number of entries on top of that, and a page with fewer than half of that many entries is under its min size
+ * as well. Both hide the BPlusTreePage versions, so the tree asks them through the page types.
+ *
+ * Pages are merged whenever the result fits. Otherwise they are redistributed, which moves the fence between them
+ * and so replaces their key in the parent: the new key must leave the parent with room for one more entry, and if
+ * no split point gives such a key, the page stays under its min size.
+ */
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+class BPlusTreeVarcharPage : public BPlusTreePage {
+  using KeyType = VarcharKey<KeySize>;
+  using KeyComparator = VarcharComparator<KeySize>;
+
+ public:
+  static constexpr bool VARIABLE_LENGTH = true;
+
+  auto GetMaxSize() const -> int;
+  auto GetMinSize() const -> int;
+
+  auto KeyAt(int index) const -> KeyType;
+  // the low fence, which is also the key that the parent holds for this page
+  auto LowKey() const -> KeyType;
+
+  // whether this page and its right sibling fit on one page, with middle_key between them in their parent
+  auto CanMergeWith(const BPlusTreeVarcharPage *right, const KeyType &middle_key) const -> bool;
+
+  // the longest key that can replace the one at index, such that the page still has room for one more entry
+  auto MaxKeyLengthAt(int index) const -> int;
+
+  // set the key range of an empty page, high == nullptr meaning no upper bound; used by bulk loading
+  void SetFences(const KeyType &low, const KeyType *high);
+
+  // the key that the parent holds for a page that starts at items[index], for index > 0
+  static auto SplitKey(bool leaf, const MappingType *items, int index) -> KeyType;
+
+  // how many of the sorted items, from the first on, fill fill_factor of a page with low fence low; at least one
+  static auto FitEntries(bool leaf, const KeyType &low, const MappingType *items, int size, int max_size,
+                         double fill_factor) -> int;
+
+ protected:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t length_;
+    ValueType value_;
+  };
+
+  // entry count cap for pages whose size is only bounded by their bytes
+  static constexpr int DEFAULT_MAX_SIZE = (BUSTUB_PAGE_SIZE - VARCHAR_PAGE_HEADER_SIZE) / sizeof(Slot) + 1;
+
+  void InitPage(IndexPageType page_type, page_id_t page_id, page_id_t parent_id, int max_size);
+
+  // index of the first key >= key (or > key if upper), among the keys at [begin, size)
+  auto Search(const KeyType &key, int begin, bool upper) const -> int;
+
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  void RemoveAt(int index);
+
+  // append items at the end; they must lie in the key range of the page and fit
+  void Append(const MappingType *items, int size);
+
+  auto Entries() const -> std::vector<MappingType>;
+  // rewrite this page to hold entries[begin, end) and cover [low, high)
+  void Rebuild(const std::vector<MappingType> &entries, int begin, int end, const KeyType &low, const KeyType *high);
+
+  // where to split entries, such that the halves hold about the same bytes and their split key is short
+  auto ChooseSplit(const std::vector<MappingType> &entries) const -> int;
+
+  // Where to split the entries of this page and its right sibling right, which cover [low, high) together, such that
+  // both halves fit and their split key is at most max_key_length long; -1 if there is no such split.
+  auto ChooseRedistribution(const std::vector<MappingType> &entries, const KeyType &low, const KeyType *high,
+                            int max_key_length) const -> int;
+
+  // the high fence, or nullptr if there is no upper bound; the key is stored in *buffer
+  auto HighKey(KeyType *buffer) const -> const KeyType *;
+
+  page_id_t next_page_id_;
+  uint16_t heap_begin_;
+  uint16_t garbage_;
+  uint16_t low_offset_;
+  uint16_t low_length_;
+  uint16_t high_offset_;
+  uint16_t high_length_;
+  uint16_t prefix_length_;
+  // Flexible array member for page data.
+  Slot slots_[0];
+
+ private:
+  static constexpr uint16_t NO_HIGH_FENCE = UINT16_MAX;
+  static constexpr int CAPACITY = BUSTUB_PAGE_SIZE - VARCHAR_PAGE_HEADER_SIZE;
+
+  // bytes that an entry with the longest key may take, given the prefix length
+  static auto WorstEntryBytes(int prefix_length) -> int {
+    return sizeof(Slot) + static_cast<int>(KeyType::MAX_LENGTH) - prefix_length;
+  }
+
+  auto Data() -> char * { return reinterpret_cast<char *>(this); }
+  auto Data() const -> const char * { return reinterpret_cast<const char *>(this); }
+  auto Prefix() const -> std::string_view { return {Data() + low_offset_, prefix_length_}; }
+  auto SuffixAt(int index) const -> std::string_view { return {Data() + slots_[index].offset_, slots_[index].length_}; }
+  auto ContiguousFreeBytes() const -> int;
+  auto FreeBytes() const -> int { return ContiguousFreeBytes() + garbage_; }
+  auto UsedBytes() const -> int { return CAPACITY - FreeBytes(); }
+  // whether a page of this many entries and used bytes is under its min size
+  auto UnderMinSize(int entries, int used_bytes) const -> bool;
+  // sum of the full lengths of the keys stored on this page
+  auto KeyBytes() const -> int;
+  // whether entries of keys with key_bytes full length in total, keys of them stored, fit a page with these fences
+  static auto Fits(int entries, int keys, int key_bytes, const KeyType &low, const KeyType *high) -> bool;
+
+  // copy bytes to the bottom of the key bytes, which must have room for them, and return their offset
+  auto AppendBytes(std::string_view bytes) -> uint16_t;
+  void Compact();
+};
+
+/**
+ * Leaf page of a B+ tree over VarcharKeys, see BPlusTreeVarcharPage for its format. The interface is the one of
+ * BPlusTreeLeafPage, except that entries are returned by value as they are not stored as they are.
+ */
+template <typename ValueType, size_t KeySize>
+class BPlusTreeLeafPage<VarcharKey<KeySize>, ValueType, VarcharComparator<KeySize>>
+    : public BPlusTreeVarcharPage<ValueType, KeySize> {
+  using KeyType = VarcharKey<KeySize>;
+  using KeyComparator = VarcharComparator<KeySize>;
+
+ public:
+  static constexpr int DEFAULT_MAX_SIZE = BPlusTreeVarcharPage<ValueType, KeySize>::DEFAULT_MAX_SIZE;
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = DEFAULT_MAX_SIZE);
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
+  auto GetItem(int index) const -> MappingType;
+
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const -> bool;
+  auto RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) -> int;
+
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveAllTo(BPlusTreeLeafPage *recipient);
+  // Even out the entries of this page and its right sibling right, and return their new split key in *split_key.
+  // Returns false, and changes nothing, if the split key would be longer than max_key_length.
+  auto RedistributeWith(BPlusTreeLeafPage *right, int max_key_length, KeyType *split_key) -> bool;
+
+  // append items to the end of this page, used by bulk loading
+  void CopyNFrom(const MappingType *items, int size);
+};
+
+/**
+ * Internal page of a B+ tree over VarcharKeys, see BPlusTreeVarcharPage for its format. The interface is the one of
+ * BPlusTreeInternalPage, except that redistribution moves any number of entries at once.
+ */
+template <typename ValueType, size_t KeySize>
+class BPlusTreeInternalPage<VarcharKey<KeySize>, ValueType, VarcharComparator<KeySize>>
+    : public BPlusTreeVarcharPage<ValueType, KeySize> {
+  using KeyType = VarcharKey<KeySize>;
+  using KeyComparator = VarcharComparator<KeySize>;
+
+ public:
+  static constexpr int DEFAULT_MAX_SIZE = BPlusTreeVarcharPage<ValueType, KeySize>::DEFAULT_MAX_SIZE;
+
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = DEFAULT_MAX_SIZE);
+  auto ValueAt(int index) const -> ValueType;
+  auto ValueIndex(const ValueType &value) const -> int;
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+  // replace the key at index, which must be at most MaxKeyLengthAt(index) long
+  void SetKeyAt(int index, const KeyType &key);
+  void Remove(int index);
+  auto RemoveAndReturnOnlyChild() -> ValueType;
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  // Even out the children of this page and its right sibling right, with middle_key between them in their parent,
+  // and return their new split key in *split_key. Returns false, and changes nothing, if the split key would be
+  // longer than max_key_length.
+  auto RedistributeWith(BPlusTreeInternalPage *right, const KeyType &middle_key, int max_key_length,
+                        KeyType *split_key, BufferPoolManager *buffer_pool_manager) -> bool;
+
+  // append children to the end of this page and make this page their parent, used by bulk loading
+  void CopyNFrom(const MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+
+ private:
+  // make this page the parent of the children at [begin, end), end == -1 meaning up to the last one
+  void AdoptChildren(int begin, BufferPoolManager *buffer_pool_manager, int end = -1);
+};
+
+}  // namespace bustub
@@ -33,6 +33,9 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  Slot i is bit i % 8 of byte i / 8 of the occupied_ and readable_ bitmaps. Lookups, the search for a free slot
+ *  and the counts go over the bitmaps a 64-bit word at a time with popcount and count-trailing-zeros.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -117,6 +120,14 @@ class HashTableBucketPage {
    */
   void SetReadable(uint32_t bucket_idx);
 
+  /**
+   * Finds the first readable slot at or after bucket_idx. The readable_ bitmap is scanned a 64-bit word at a time.
+   *
+   * @param bucket_idx index to start looking at
+   * @return the index of the slot, or BUCKET_ARRAY_SIZE if there is none
+   */
+  auto NextReadable(uint32_t bucket_idx) const -> uint32_t;
+
   /**
    * @return the number of readable elements, i.e. current size
    */
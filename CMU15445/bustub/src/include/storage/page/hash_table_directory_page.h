@@ -165,6 +165,8 @@ class HashTableDirectoryPage {
    * Gets the high bit corresponding to the bucket's local depth.
    * This is not the same as the bucket index itself.  This method
    * is helpful for finding the pair, or "split image", of a bucket.
+   * It is the bit just above the local depth mask, which tells apart
+   * the entries that stay from the ones that move when the bucket splits.
    *
    * @param bucket_idx bucket index to lookup
    * @return the high bit corresponding to the bucket's local depth
@@ -48,3 +48,21 @@
  * implementation.
  */
 #define DIRECTORY_ARRAY_SIZE 512
+
+/**
+ * Swiss Table Page Definitions
+ */
+#define HASH_TABLE_SWISS_TYPE HashTableSwissPage<KeyType, ValueType, KeyComparator>
+
+/**
+ * SWISS_GROUP_SIZE is the number of slots whose control bytes are probed together, with one 256-bit or two 128-bit
+ * vector compares. The page format does not depend on the vector width the code is built with.
+ */
+#define SWISS_GROUP_SIZE 32
+
+/**
+ * SWISS_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a Swiss table page. Each pair takes one
+ * control byte besides its own size; 48 bytes are kept for the two counters at the start of the page and for
+ * rounding the control bytes up to whole groups.
+ */
+#define SWISS_ARRAY_SIZE ((BUSTUB_PAGE_SIZE - 48) / (sizeof(MappingType) + 1))
@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_swiss_page.h
+//
+// Identification: src/include/storage/page/hash_table_swiss_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * A hash table page laid out like a Swiss table: every slot has a one-byte control entry, which either marks the slot
+ * empty or deleted or holds a 7-bit fingerprint of the hash of the key in it. A probe compares the fingerprint with
+ * the control bytes of a whole group of slots at once (SSE2 or AVX2 when built with them), and only compares full
+ * keys through the KeyComparator where the fingerprint matches. Supports non-unique keys.
+ *
+ * Slots are open addressed: a key starts at the group its hash picks and goes on to the next group, wrapping around,
+ * until a group with an empty slot ends the probe. The page serves as a bucket of DiskExtendibleHashTable and as a
+ * block of LinearProbeHashTable, which carries on to the next block when the probe does not end in this one.
+ *
+ * Swiss page format (size in byte):
+ *  ---------------------------------------------------------------------------------------------------
+ * | NumReadable (4) | NumDeleted (4) | Control (1 per slot, whole groups) | KEY(1) + VALUE(1) | ... |
+ *  ---------------------------------------------------------------------------------------------------
+ *
+ * A zeroed page is an empty one.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableSwissPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableSwissPage() = delete;
+
+  /**
+   * Collects the values that have the matching key.
+   *
+   * @param key the key to look up
+   * @param hash hash of the key, the same one it was inserted with
+   * @param cmp comparator for keys
+   * @param[out] result the values of the key
+   * @param[out] probe_ended if not null, set to whether the probe ended at an empty slot of this page, that is,
+   *             whether the key cannot be anywhere past it
+   * @return true if at least one key matched
+   */
+  auto GetValue(const KeyType &key, uint64_t hash, KeyComparator cmp, std::vector<ValueType> *result,
+                bool *probe_ended = nullptr) const -> bool;
+
+  /**
+   * Inserts a key and value into the first free slot of its probe.
+   *
+   * @return true if inserted, false if duplicate KV pair or page is full
+   */
+  auto Insert(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp) -> bool;
+
+  /**
+   * Removes a key and value.
+   *
+   * @param[out] probe_ended as for GetValue, set if the pair was not found
+   * @return true if removed, false if not found
+   */
+  auto Remove(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp,
+              bool *probe_ended = nullptr) -> bool;
+
+  /**
+   * Gets the key at an index in the page.
+   */
+  auto KeyAt(uint32_t bucket_idx) const -> KeyType { return array_[bucket_idx].first; }
+
+  /**
+   * Gets the value at an index in the page.
+   */
+  auto ValueAt(uint32_t bucket_idx) const -> ValueType { return array_[bucket_idx].second; }
+
+  /**
+   * Remove the KV pair at bucket_idx. The slot becomes empty again if its group has an empty slot, since then no
+   * probe goes past the group; otherwise it is marked deleted.
+   */
+  void RemoveAt(uint32_t bucket_idx);
+
+  /**
+   * @return true if the slot at bucket_idx holds a KV pair
+   */
+  auto IsReadable(uint32_t bucket_idx) const -> bool { return (ctrl_[bucket_idx] & FULL_BIT) != 0; }
+
+  /**
+   * Finds the first readable slot at or after bucket_idx, a group of control bytes at a time.
+   *
+   * @return the index of the slot, or SWISS_ARRAY_SIZE if there is none
+   */
+  auto NextReadable(uint32_t bucket_idx) const -> uint32_t;
+
+  /**
+   * @return how many groups of control bytes a lookup of the key in the slot at bucket_idx compares its fingerprint
+   * with in this page, hash being the hash of that key
+   */
+  auto ProbeLength(uint32_t bucket_idx, uint64_t hash) const -> uint32_t {
+    return (bucket_idx / SWISS_GROUP_SIZE + NUM_GROUPS - HomeGroupOf(Mix(hash))) % NUM_GROUPS + 1;
+  }
+
+  /**
+   * @return the number of groups of control bytes, which is the length of a probe that goes through the whole page
+   */
+  static constexpr auto NumGroups() -> uint32_t { return NUM_GROUPS; }
+
+  /**
+   * Empties the page, dropping deleted markers as well.
+   */
+  void Clear();
+
+  /**
+   * @return the number of readable elements, i.e. current size
+   */
+  auto NumReadable() const -> uint32_t { return num_readable_; }
+
+  /**
+   * @return the number of slots marked deleted, which lengthen probes until the page is cleared
+   */
+  auto NumDeleted() const -> uint32_t { return num_deleted_; }
+
+  /**
+   * @return whether the page is full
+   */
+  auto IsFull() const -> bool { return num_readable_ == SWISS_ARRAY_SIZE; }
+
+  /**
+   * @return whether the page is empty
+   */
+  auto IsEmpty() const -> bool { return num_readable_ == 0; }
+
+ private:
+  static constexpr uint32_t NUM_GROUPS = (SWISS_ARRAY_SIZE + SWISS_GROUP_SIZE - 1) / SWISS_GROUP_SIZE;
+  /** Control byte of a slot that never held a pair. A zeroed page is all empty. */
+  static constexpr uint8_t EMPTY = 0x00;
+  /** Control byte of a slot whose pair was removed while its group had no empty slot */
+  static constexpr uint8_t DELETED = 0x01;
+  /** Set in the control byte of every readable slot, the low 7 bits being the fingerprint */
+  static constexpr uint8_t FULL_BIT = 0x80;
+
+  /** Spreads the bits of the caller's hash, which may be only 32 bits wide and share its low bits with every key of
+   * an extendible hash bucket */
+  static auto Mix(uint64_t hash) -> uint64_t { return hash * 0x9E3779B97F4A7C15ULL; }
+  static auto FingerprintOf(uint64_t mixed) -> uint8_t { return static_cast<uint8_t>(FULL_BIT | (mixed >> 57)); }
+  static auto HomeGroupOf(uint64_t mixed) -> uint32_t { return static_cast<uint32_t>((mixed >> 32) % NUM_GROUPS); }
+
+  /** @return bit i set for each slot i of the group that exists, the last group being only partly used */
+  static auto ValidMask(uint32_t group) -> uint32_t;
+
+  /** @return bit i set for each slot i of the group whose control byte is byte */
+  auto Match(uint32_t group, uint8_t byte) const -> uint32_t;
+
+  /** @return bit i set for each readable slot i of the group */
+  auto MatchReadable(uint32_t group) const -> uint32_t;
+
+  /** @return the slot of the pair, or SWISS_ARRAY_SIZE if it is not here */
+  auto Find(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp, bool *probe_ended) const
+      -> uint32_t;
+
+  uint32_t num_readable_;
+  uint32_t num_deleted_;
+  uint8_t ctrl_[NUM_GROUPS * SWISS_GROUP_SIZE];
+  // Flexible array member for page data.
+  MappingType array_[1];
+};
+
+}  // namespace bustub
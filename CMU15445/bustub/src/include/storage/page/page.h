@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -24,14 +27,23 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * A Page either owns its data or, in a buffer pool, points into the frame arena of the pool, so that the
+ * book-keeping of all frames stays packed together instead of being spread out at 4KB strides.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates the page data and zeros it out. */
+  Page() : owned_data_(new char[BUSTUB_PAGE_SIZE]{}), data_(owned_data_.get()) {}
+
+  /**
+   * Constructor for a page whose data lives elsewhere, e.g. in the frame arena of a buffer pool.
+   * @param data BUSTUB_PAGE_SIZE bytes that outlive the page; they are not zeroed out
+   */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,7 +55,7 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
@@ -78,12 +90,17 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The data of the page if it owns it, nullptr if it lives elsewhere. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page, BUSTUB_PAGE_SIZE bytes. */
+  char *data_;
+  /** The ID of this page. Atomic, as buffer pool hits read it without the pool latch. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Buffer pool hits pin without the pool latch; a frame that is free or being handed to
+   * another page holds -1 so that they leave it alone, and reads as unpinned.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
   /** Page latch. */
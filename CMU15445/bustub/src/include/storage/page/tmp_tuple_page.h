@@ -1,16 +1,17 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
+ * TmpTuplePage holds tuples that an operator spills out of memory, e.g. the partitions of a hash join that does not
+ * fit its memory budget. It is only ever appended to, and read back as a whole.
+ *
  * TmpTuplePage format:
  *
  * Sizes are in bytes.
@@ -20,17 +21,61 @@ namespace bustub {
  */
 class TmpTuplePage : public Page {
  public:
+  /** Initialize an empty page of the given size. */
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  /** @return the page id written by Init() */
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /** @return the offset of the most recently inserted tuple, or the page size if the page is empty */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /**
+   * Append a tuple to the page.
+   * @param tuple the tuple
+   * @param[out] out where the tuple was stored
+   * @return false if there is not enough space left for it
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    auto size = sizeof(uint32_t) + tuple.GetLength();
+    auto free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
+
+  /**
+   * Read a tuple of the page.
+   * @param offset the offset of the tuple, as returned by Insert() or found walking from GetFreeSpacePointer()
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it, which is the page size after the first tuple
+   */
+  auto Get(uint32_t offset, Tuple *tuple) -> uint32_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
+
+  /** @return the largest tuple that fits an empty page of the given size */
+  static constexpr auto MaxTupleSize(uint32_t page_size) -> uint32_t {
+    return page_size - SIZE_HEADER - sizeof(uint32_t);
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr uint32_t OFFSET_FREE_SPACE = sizeof(page_id_t) + sizeof(lsn_t);
+  static constexpr uint32_t SIZE_HEADER = OFFSET_FREE_SPACE + sizeof(uint32_t);
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
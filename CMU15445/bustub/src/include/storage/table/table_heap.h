@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -95,9 +97,12 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param acquire_read_lock whether to take the page read latch; false if the caller already holds it
+   * @param access_type how the page is accessed, AccessType::Scan when called by a TableIterator
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true,
+                AccessType access_type = AccessType::Lookup) -> bool;
 
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
@@ -105,6 +110,17 @@ class TableHeap {
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
 
+  /** @return the ids of the pages of this table, in the order of the page chain */
+  auto GetPageIds() -> std::vector<page_id_t>;
+
+  /**
+   * Read every tuple of one page of this table, e.g. to scan a table by page ranges on several threads.
+   * @param page_id the page
+   * @param txn transaction performing the read
+   * @param[out] tuples the tuples of the page are appended to it, in slot order
+   */
+  void GetPageTuples(page_id_t page_id, Transaction *txn, std::vector<Tuple> *tuples);
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
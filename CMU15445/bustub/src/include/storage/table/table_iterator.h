@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "common/config.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -21,6 +22,7 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -32,7 +34,11 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        read_ahead_page_id_(other.read_ahead_page_id_),
+        read_ahead_pages_(other.read_ahead_pages_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +60,26 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    read_ahead_page_id_ = other.read_ahead_page_id_;
+    read_ahead_pages_ = other.read_ahead_pages_;
     return *this;
   }
 
  private:
+  /**
+   * Follow the page chain from the last page read ahead and prefetch pages until READ_AHEAD_PAGES pages beyond
+   * cur_page are in flight or resident.
+   * @param cur_page the page the iterator is on, read-latched by the caller
+   */
+  void ReadAhead(TablePage *cur_page);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The furthest page of the chain that has been prefetched, or INVALID_PAGE_ID before the first read-ahead. */
+  page_id_t read_ahead_page_id_{INVALID_PAGE_ID};
+  /** Number of pages prefetched beyond the page the iterator is on. */
+  int read_ahead_pages_{0};
 };
 
 }  // namespace bustub
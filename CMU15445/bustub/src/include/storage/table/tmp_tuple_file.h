@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.h
+//
+// Identification: src/include/storage/table/tmp_tuple_file.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleFile is a sequence of tuples that an operator spilled out of memory, stored on TmpTuplePages in the buffer
+ * pool. Tuples are appended, then read back in the same order; the pages are deleted with the file.
+ *
+ * Only the page being appended to stays pinned, until FinishWriting() is called.
+ */
+class TmpTupleFile {
+ public:
+  explicit TmpTupleFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  ~TmpTupleFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleFile);
+
+  /**
+   * Append a tuple to the file.
+   * @param tuple the tuple, which must fit a page
+   * @throws Exception if the buffer pool has no frame left for a new page
+   */
+  void Append(const Tuple &tuple);
+
+  /** Unpin the page being appended to. Appending again pins it again. */
+  void FinishWriting();
+
+  /** @return the number of tuples in the file */
+  auto NumTuples() const -> size_t { return num_tuples_; }
+
+  /** @return the number of pages the file takes */
+  auto NumPages() const -> size_t { return page_ids_.size(); }
+
+  /** Reader reads the tuples of a file in the order they were appended, copying out one page at a time. */
+  class Reader {
+   public:
+    explicit Reader(TmpTupleFile *file) : file_(file) {}
+
+    /**
+     * @param[out] tuple the next tuple of the file
+     * @return false if all tuples were read
+     */
+    auto Next(Tuple *tuple) -> bool;
+
+   private:
+    TmpTupleFile *file_;
+    /** The next page to read */
+    size_t page_index_{0};
+    /** The tuples of the page read last, and the next one to return */
+    std::vector<Tuple> tuples_;
+    size_t cursor_{0};
+  };
+
+ private:
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  /** The last page, pinned while tuples are appended to it */
+  TmpTuplePage *write_page_{nullptr};
+  size_t num_tuples_{0};
+};
+
+}  // namespace bustub
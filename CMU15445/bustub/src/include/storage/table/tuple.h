@@ -31,6 +31,8 @@ class Tuple {
   friend class TablePage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class JoinHashTable;
+  friend class ExternalSorter;
 
  public:
   // Default constructor (to create a dummy tuple)
@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <utility>
 #include "catalog/column.h"
 #include "catalog/schema.h"
 #include "common/exception.h"
@@ -7,6 +9,7 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/hash_join_plan.h"
@@ -17,6 +20,100 @@
 
 namespace bustub {
 
+namespace {
+
+/**
+ * Match `<column of one side> = <column of the other side>`.
+ * @return the key expressions of the left and right side, each on its own tuple, or nullopt if expr does not match
+ */
+auto MatchEquiCondition(const AbstractExpression &expr)
+    -> std::optional<std::pair<AbstractExpressionRef, AbstractExpressionRef>> {
+  // Check if expr is equal condition where one is for the left table, and one is for the right table.
+  if (const auto *cmp_expr = dynamic_cast<const ComparisonExpression *>(&expr); cmp_expr != nullptr) {
+    if (cmp_expr->comp_type_ == ComparisonType::Equal) {
+      if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[0].get());
+          left_expr != nullptr) {
+        if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(cmp_expr->children_[1].get());
+            right_expr != nullptr) {
+          // Ensure both exprs have tuple_id == 0
+          auto left_expr_tuple_0 =
+              std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
+          auto right_expr_tuple_0 =
+              std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
+          // Now it's in form of <column_expr> = <column_expr>. Let's check if one of them is from the left table, and
+          // the other is from the right table.
+          if (left_expr->GetTupleIdx() == 0 && right_expr->GetTupleIdx() == 1) {
+            return std::make_pair(std::move(left_expr_tuple_0), std::move(right_expr_tuple_0));
+          }
+          if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
+            return std::make_pair(std::move(right_expr_tuple_0), std::move(left_expr_tuple_0));
+          }
+        }
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+/** Split a predicate into the terms of its top-level AND. */
+void SplitConjunction(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *terms) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    SplitConjunction(logic_expr->children_[0], terms);
+    SplitConjunction(logic_expr->children_[1], terms);
+    return;
+  }
+  terms->push_back(expr);
+}
+
+/** Collect the join sides, 0 for left and 1 for right, that the columns of an expression come from. */
+void CollectTupleIdx(const AbstractExpressionRef &expr, std::vector<bool> *sides) {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr.get()); column_expr != nullptr) {
+    (*sides)[column_expr->GetTupleIdx()] = true;
+    return;
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectTupleIdx(child, sides);
+  }
+}
+
+/**
+ * Rewrite an expression on the two input tuples of a join to one on a single tuple.
+ * @param expr the expression
+ * @param right_offset the index of the first right column in that tuple; the left columns keep their indices
+ */
+auto RewriteOnOneTuple(const AbstractExpressionRef &expr, uint32_t right_offset) -> AbstractExpressionRef {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr.get()); column_expr != nullptr) {
+    auto col_idx = column_expr->GetColIdx() + (column_expr->GetTupleIdx() == 0 ? 0 : right_offset);
+    return std::make_shared<ColumnValueExpression>(0, col_idx, column_expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(RewriteOnOneTuple(child, right_offset));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+/** @return the AND of a list of terms, or nullptr if it is empty */
+auto MakeConjunction(const std::vector<AbstractExpressionRef> &terms) -> AbstractExpressionRef {
+  AbstractExpressionRef conjunction;
+  for (const auto &term : terms) {
+    conjunction = conjunction == nullptr ? term : std::make_shared<LogicExpression>(conjunction, term, LogicType::And);
+  }
+  return conjunction;
+}
+
+/** @return the plan with a filter on top, or the plan itself if there is no predicate */
+auto WithFilter(AbstractPlanNodeRef plan, AbstractExpressionRef predicate) -> AbstractPlanNodeRef {
+  if (predicate == nullptr) {
+    return plan;
+  }
+  auto output_schema = plan->output_schema_;
+  return std::make_shared<FilterPlanNode>(std::move(output_schema), std::move(predicate), std::move(plan));
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -29,32 +126,46 @@ auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> Abstra
     // Has exactly two children
     BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
 
-    // Check if expr is equal condition where one is for the left table, and one is for the right table.
-    if (const auto *expr = dynamic_cast<const ComparisonExpression *>(&nlj_plan.Predicate()); expr != nullptr) {
-      if (expr->comp_type_ == ComparisonType::Equal) {
-        if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-            left_expr != nullptr) {
-          if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
-            // Ensure both exprs have tuple_id == 0
-            auto left_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
-            auto right_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
-            // Now it's in form of <column_expr> = <column_expr>. Let's check if one of them is from the left table, and
-            // the other is from the right table.
-            if (left_expr->GetTupleIdx() == 0 && right_expr->GetTupleIdx() == 1) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(left_expr_tuple_0),
-                                                        std::move(right_expr_tuple_0), nlj_plan.GetJoinType());
-            }
-            if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(right_expr_tuple_0),
-                                                        std::move(left_expr_tuple_0), nlj_plan.GetJoinType());
-            }
+    if (auto keys = MatchEquiCondition(nlj_plan.Predicate()); keys.has_value()) {
+      return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
+                                                nlj_plan.GetRightPlan(), std::move(keys->first),
+                                                std::move(keys->second), nlj_plan.GetJoinType());
+    }
+
+    // An inner join can also hash on one equi-condition of a conjunction. The terms on one side filter that side
+    // before the join, the others filter its output. For a left join the other terms decide which rows get padded,
+    // so they must stay in the join.
+    if (nlj_plan.GetJoinType() == JoinType::INNER) {
+      std::vector<AbstractExpressionRef> terms;
+      SplitConjunction(nlj_plan.predicate_, &terms);
+      for (size_t i = 0; i < terms.size(); i++) {
+        auto keys = MatchEquiCondition(*terms[i]);
+        if (!keys.has_value()) {
+          continue;
+        }
+        std::vector<AbstractExpressionRef> left_terms;
+        std::vector<AbstractExpressionRef> right_terms;
+        std::vector<AbstractExpressionRef> join_terms;
+        auto left_column_count = nlj_plan.GetLeftPlan()->OutputSchema().GetColumnCount();
+        for (size_t j = 0; j < terms.size(); j++) {
+          if (j == i) {
+            continue;
+          }
+          std::vector<bool> sides(2, false);
+          CollectTupleIdx(terms[j], &sides);
+          if (sides[0] && sides[1]) {
+            join_terms.push_back(RewriteOnOneTuple(terms[j], left_column_count));
+          } else if (sides[1]) {
+            right_terms.push_back(RewriteOnOneTuple(terms[j], 0));
+          } else {
+            left_terms.push_back(terms[j]);
           }
         }
+        auto hash_join = std::make_shared<HashJoinPlanNode>(
+            nlj_plan.output_schema_, WithFilter(nlj_plan.GetLeftPlan(), MakeConjunction(left_terms)),
+            WithFilter(nlj_plan.GetRightPlan(), MakeConjunction(right_terms)), std::move(keys->first),
+            std::move(keys->second), nlj_plan.GetJoinType());
+        return WithFilter(std::move(hash_join), MakeConjunction(join_terms));
       }
     }
   }
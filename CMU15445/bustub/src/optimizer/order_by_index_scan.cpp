@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "binder/bound_order_by.h"
 #include "catalog/catalog.h"
@@ -8,7 +10,9 @@
 #include "common/exception.h"
 #include "common/macros.h"
 #include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
@@ -21,6 +25,81 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return whether bound narrows the range further than current does, for a lower bound if lower is set */
+auto IsTighter(const IndexScanBound &bound, const std::optional<IndexScanBound> &current, bool lower) -> bool {
+  if (!current.has_value()) {
+    return true;
+  }
+  auto cmp = lower ? bound.key_.CompareGreaterThan(current->key_) : bound.key_.CompareLessThan(current->key_);
+  return cmp == CmpBool::CmpTrue ||
+         (bound.key_.CompareEquals(current->key_) == CmpBool::CmpTrue && !bound.inclusive_ && current->inclusive_);
+}
+
+/**
+ * Take the conjuncts of predicate that compare column col_idx against a constant of the column's type out into a key
+ * range; all other conjuncts are collected in residual.
+ */
+void ExtractKeyRange(const AbstractExpressionRef &predicate, uint32_t col_idx, TypeId key_type,
+                     std::optional<IndexScanBound> *lower, std::optional<IndexScanBound> *upper,
+                     std::vector<AbstractExpressionRef> *residual) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(predicate.get());
+      logic != nullptr && logic->logic_type_ == LogicType::And) {
+    ExtractKeyRange(logic->children_[0], col_idx, key_type, lower, upper, residual);
+    ExtractKeyRange(logic->children_[1], col_idx, key_type, lower, upper, residual);
+    return;
+  }
+
+  if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(predicate.get()); comparison != nullptr) {
+    // <column> op <constant>, or <constant> op <column> with op mirrored
+    auto comp_type = comparison->comp_type_;
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->children_[0].get());
+    const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->children_[1].get());
+    if (column == nullptr || constant == nullptr) {
+      column = dynamic_cast<const ColumnValueExpression *>(comparison->children_[1].get());
+      constant = dynamic_cast<const ConstantValueExpression *>(comparison->children_[0].get());
+      switch (comp_type) {
+        case ComparisonType::LessThan:
+          comp_type = ComparisonType::GreaterThan;
+          break;
+        case ComparisonType::LessThanOrEqual:
+          comp_type = ComparisonType::GreaterThanOrEqual;
+          break;
+        case ComparisonType::GreaterThan:
+          comp_type = ComparisonType::LessThan;
+          break;
+        case ComparisonType::GreaterThanOrEqual:
+          comp_type = ComparisonType::LessThanOrEqual;
+          break;
+        default:
+          break;
+      }
+    }
+    if (column != nullptr && constant != nullptr && column->GetTupleIdx() == 0 && column->GetColIdx() == col_idx &&
+        constant->val_.GetTypeId() == key_type && !constant->val_.IsNull() &&
+        comp_type != ComparisonType::NotEqual) {
+      bool has_lower = comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThan ||
+                       comp_type == ComparisonType::GreaterThanOrEqual;
+      bool has_upper = comp_type == ComparisonType::Equal || comp_type == ComparisonType::LessThan ||
+                       comp_type == ComparisonType::LessThanOrEqual;
+      IndexScanBound bound{constant->val_,
+                           comp_type != ComparisonType::GreaterThan && comp_type != ComparisonType::LessThan};
+      if (has_lower && IsTighter(bound, *lower, true)) {
+        *lower = bound;
+      }
+      if (has_upper && IsTighter(bound, *upper, false)) {
+        *upper = bound;
+      }
+      return;
+    }
+  }
+
+  residual->push_back(predicate);
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -37,9 +116,9 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc, default or desc
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT || order_type == OrderByType::DESC)) {
       return optimized_plan;
     }
 
@@ -53,19 +132,44 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
 
     // Has exactly one child
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
-    const auto &child_plan = optimized_plan->children_[0];
+    const auto *child_plan = optimized_plan->children_[0].get();
+
+    // A filter right below the sort is pushed into the scan as well
+    std::vector<AbstractExpressionRef> predicates;
+    if (child_plan->GetType() == PlanType::Filter) {
+      predicates.push_back(dynamic_cast<const FilterPlanNode &>(*child_plan).GetPredicate());
+      child_plan = child_plan->children_[0].get();
+    }
 
     if (child_plan->GetType() == PlanType::SeqScan) {
       const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
+      if (seq_scan.filter_predicate_ != nullptr) {
+        predicates.push_back(seq_scan.filter_predicate_);
+      }
 
       for (const auto *index : indices) {
         const auto &columns = index->key_schema_.GetColumns();
-        if (columns.size() == 1 &&
+        // only a B+ tree keeps its keys in order
+        if (index->index_type_ == IndexType::BPlusTreeIndex && columns.size() == 1 &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
-          // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          // Index matched, return index scan instead, scanning only the key range the predicates allow
+          std::optional<IndexScanBound> lower;
+          std::optional<IndexScanBound> upper;
+          std::vector<AbstractExpressionRef> residual;
+          for (const auto &predicate : predicates) {
+            ExtractKeyRange(predicate, order_by_column_id, columns[0].GetType(), &lower, &upper, &residual);
+          }
+          AbstractExpressionRef filter_predicate;
+          for (auto &predicate : residual) {
+            filter_predicate = filter_predicate == nullptr
+                                   ? std::move(predicate)
+                                   : std::make_shared<LogicExpression>(filter_predicate, predicate, LogicType::And);
+          }
+          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_,
+                                                     std::move(filter_predicate), std::move(lower), std::move(upper),
+                                                     order_type == OrderByType::DESC);
         }
       }
     }
@@ -125,13 +125,15 @@ auto Planner::PlanSelectAgg(const SelectStatement &statement, AbstractPlanNodeRe
 
     agg_types.push_back(agg_type);
     output_col_names.emplace_back(fmt::format("agg#{}", term_idx));
-    ctx_.expr_in_agg_.emplace_back(
-        std::make_unique<ColumnValueExpression>(0, agg_begin_idx + term_idx, TypeId::INTEGER));
 
     term_idx += 1;
   }
 
   auto agg_output_schema = AggregationPlanNode::InferAggSchema(group_by_exprs, input_exprs, agg_types);
+  for (size_t idx = agg_begin_idx; idx < agg_output_schema.GetColumnCount(); idx++) {
+    ctx_.expr_in_agg_.emplace_back(
+        std::make_unique<ColumnValueExpression>(0, idx, agg_output_schema.GetColumn(idx).GetType()));
+  }
 
   // Create the aggregation plan node for the first phase (finally!)
   AbstractPlanNodeRef plan = std::make_shared<AggregationPlanNode>(
@@ -31,23 +31,9 @@ static char *buffer_used;
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  std::string::size_type n = file_name_.rfind('.');
-  if (n == std::string::npos) {
-    LOG_DEBUG("wrong file format");
+  if (!OpenLogFile()) {
     return;
   }
-  log_name_ = file_name_.substr(0, n) + ".log";
-
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
 
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
@@ -63,10 +49,13 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() { StopIoThreads(); }
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  StopIoThreads();
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
@@ -122,6 +111,93 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Queue a request for the background I/O threads, starting them if this is the first one
+ */
+void DiskManager::Schedule(std::function<void()> request) {
+  {
+    std::scoped_lock scoped_io_queue_latch(io_queue_latch_);
+    if (io_threads_.empty()) {
+      io_shutdown_ = false;
+      for (int i = 0; i < DISK_IO_THREADS; i++) {
+        io_threads_.emplace_back([this] { IoThreadMain(); });
+      }
+    }
+    io_queue_.push_back(std::move(request));
+  }
+  io_queue_cv_.notify_one();
+}
+
+/**
+ * Run every request of the batch on the background I/O threads
+ */
+void DiskManager::SubmitRequests(std::vector<DiskRequest> requests) {
+  for (auto &request : requests) {
+    Schedule([this, request = std::move(request)] {
+      if (request.is_write_) {
+        WritePage(request.page_id_, request.data_);
+      } else {
+        ReadPage(request.page_id_, request.data_);
+      }
+      if (request.callback_) {
+        request.callback_();
+      }
+    });
+  }
+}
+
+/**
+ * Submit a batch of requests and block until the last one has completed
+ */
+void DiskManager::RunRequests(std::vector<DiskRequest> requests) {
+  std::mutex latch;
+  std::condition_variable done_cv;
+  size_t remaining = requests.size();
+  for (auto &request : requests) {
+    request.callback_ = [&latch, &done_cv, &remaining, callback = std::move(request.callback_)] {
+      if (callback) {
+        callback();
+      }
+      // Notify while holding the latch: the waiter owns done_cv and may return as soon as it can take the latch.
+      std::scoped_lock lock(latch);
+      if (--remaining == 0) {
+        done_cv.notify_all();
+      }
+    };
+  }
+  SubmitRequests(std::move(requests));
+  std::unique_lock lock(latch);
+  done_cv.wait(lock, [&remaining] { return remaining == 0; });
+}
+
+void DiskManager::IoThreadMain() {
+  std::unique_lock lock(io_queue_latch_);
+  while (true) {
+    io_queue_cv_.wait(lock, [this] { return io_shutdown_ || !io_queue_.empty(); });
+    if (io_queue_.empty()) {
+      return;
+    }
+    auto request = std::move(io_queue_.front());
+    io_queue_.pop_front();
+    lock.unlock();
+    request();
+    lock.lock();
+  }
+}
+
+void DiskManager::StopIoThreads() {
+  std::vector<std::thread> io_threads;
+  {
+    std::scoped_lock scoped_io_queue_latch(io_queue_latch_);
+    io_shutdown_ = true;
+    io_threads.swap(io_threads_);
+  }
+  io_queue_cv_.notify_all();
+  for (auto &thread : io_threads) {
+    thread.join();
+  }
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
@@ -184,6 +260,30 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Open the log file next to the database file, creating it if it does not exist yet
+ */
+auto DiskManager::OpenLogFile() -> bool {
+  std::string::size_type n = file_name_.rfind('.');
+  if (n == std::string::npos) {
+    LOG_DEBUG("wrong file format");
+    return false;
+  }
+  log_name_ = file_name_.substr(0, n) + ".log";
+
+  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
+  // directory or file does not exist
+  if (!log_io_.is_open()) {
+    log_io_.clear();
+    // create a new file
+    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!log_io_.is_open()) {
+      throw Exception("can't open dblog file");
+    }
+  }
+  return true;
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.cpp
+//
+// Identification: src/storage/disk/disk_manager_posix.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_posix.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#ifdef __linux__
+#include "storage/disk/io_uring_engine.h"
+#endif
+
+namespace bustub {
+
+/** Bounce buffer for O_DIRECT transfers from and to page buffers that are not aligned. */
+alignas(BUSTUB_PAGE_SIZE) static thread_local char bounce_buffer[BUSTUB_PAGE_SIZE];
+
+/**
+ * Constructor: open/create the database file as a raw file descriptor, and the log file as a stream
+ */
+DiskManagerPosix::DiskManagerPosix(const std::string &db_file, bool direct_io, bool use_io_uring) {
+  file_name_ = db_file;
+  if (!OpenLogFile()) {
+    return;
+  }
+
+  int flags = O_RDWR | O_CREAT;
+  if (direct_io) {
+#ifdef __linux__
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    // tmpfs and a few other file systems refuse O_DIRECT with EINVAL: fall back to the page cache
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("O_DIRECT is not supported for %s, using buffered I/O", db_file.c_str());
+    } else {
+      direct_io_ = db_fd_ >= 0;
+    }
+#else
+    LOG_WARN("O_DIRECT is only supported on Linux, using buffered I/O for %s", db_file.c_str());
+#endif
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+
+#ifdef __linux__
+  if (use_io_uring) {
+    // the writes of a batch were counted when it was submitted
+    io_uring_ = IoUringEngine::Create(db_fd_, direct_io_, IO_URING_ENTRIES, [this](const DiskRequest &request) {
+      if (request.is_write_) {
+        WritePageUncounted(request.page_id_, request.data_);
+      } else {
+        ReadPage(request.page_id_, request.data_);
+      }
+    });
+  }
+#endif
+}
+
+DiskManagerPosix::~DiskManagerPosix() {
+  StopIoThreads();
+  io_uring_.reset();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
+/**
+ * Close all file resources, after making the database file durable
+ */
+void DiskManagerPosix::ShutDown() {
+  io_uring_.reset();
+  DiskManager::ShutDown();
+  if (db_fd_ >= 0) {
+    Sync();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+}
+
+/**
+ * Write the contents of the specified page into disk file
+ */
+void DiskManagerPosix::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  WritePageUncounted(page_id, page_data);
+}
+
+void DiskManagerPosix::WritePageUncounted(page_id_t page_id, const char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (direct_io_ && !IsAligned(page_data)) {
+    memcpy(bounce_buffer, page_data, BUSTUB_PAGE_SIZE);
+    page_data = bounce_buffer;
+  }
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    // O_DIRECT only transfers from and to aligned offsets, so a short write is redone for the whole page
+    size_t start = direct_io_ ? 0 : written;
+    ssize_t rc = pwrite(db_fd_, page_data + start, BUSTUB_PAGE_SIZE - start, offset + start);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written = start + rc;
+  }
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void DiskManagerPosix::ReadPage(page_id_t page_id, char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  char *buffer = direct_io_ && !IsAligned(page_data) ? bounce_buffer : page_data;
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    // O_DIRECT only transfers from and to aligned offsets, so a short read is redone for the whole page
+    size_t start = direct_io_ ? 0 : read_count;
+    ssize_t rc = pread(db_fd_, buffer + start, BUSTUB_PAGE_SIZE - start, offset + start);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    // if file ends before reading BUSTUB_PAGE_SIZE: nothing more, or for O_DIRECT no more than last time
+    size_t end = start + rc;
+    if (rc == 0 || end == read_count) {
+      memset(buffer + end, 0, BUSTUB_PAGE_SIZE - end);
+      break;
+    }
+    read_count = end;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, BUSTUB_PAGE_SIZE);
+  }
+}
+
+/**
+ * Hand the whole batch to the kernel at once
+ */
+void DiskManagerPosix::SubmitRequests(std::vector<DiskRequest> requests) {
+#ifdef __linux__
+  if (io_uring_ != nullptr) {
+    for (const auto &request : requests) {
+      if (request.is_write_) {
+        num_writes_ += 1;
+      }
+    }
+    io_uring_->Submit(std::move(requests));
+    return;
+  }
+#endif
+  DiskManager::SubmitRequests(std::move(requests));
+}
+
+/**
+ * Make the pages written so far durable
+ */
+void DiskManagerPosix::Sync() {
+#ifdef __linux__
+  int rc = db_fd_ >= 0 ? fdatasync(db_fd_) : 0;
+#else
+  // fdatasync() is not available everywhere, fsync() is
+  int rc = db_fd_ >= 0 ? fsync(db_fd_) : 0;
+#endif
+  if (rc != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+}
+
+auto DiskManagerPosix::IsAligned(const char *page_data) -> bool {
+  return reinterpret_cast<uintptr_t>(page_data) % BUSTUB_PAGE_SIZE == 0;
+}
+
+}  // namespace bustub
@@ -0,0 +1,240 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring_engine.cpp
+//
+// Identification: src/storage/disk/io_uring_engine.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_uring_engine.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+auto SysIoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto SysIoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+auto IoUringEngine::Create(int fd, bool direct_io, unsigned entries, std::function<void(const DiskRequest &)> fallback)
+    -> std::unique_ptr<IoUringEngine> {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = SysIoUringSetup(entries, &params);
+  if (ring_fd < 0) {
+    LOG_WARN("io_uring is not available (errno %d)", errno);
+    return nullptr;
+  }
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine(ring_fd, fd, direct_io, std::move(fallback)));
+  if (!engine->MapRings(params)) {
+    LOG_WARN("failed to map the io_uring rings (errno %d)", errno);
+    return nullptr;
+  }
+  engine->reaper_ = std::thread([engine = engine.get()] { engine->ReapCompletions(); });
+  return engine;
+}
+
+IoUringEngine::IoUringEngine(int ring_fd, int fd, bool direct_io, std::function<void(const DiskRequest &)> fallback)
+    : ring_fd_(ring_fd), fd_(fd), direct_io_(direct_io), fallback_(std::move(fallback)) {}
+
+IoUringEngine::~IoUringEngine() {
+  if (reaper_.joinable()) {
+    {
+      std::scoped_lock lock(latch_);
+      stopping_ = true;
+      pending_.push_back(nullptr);
+      SubmitPending();
+    }
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  close(ring_fd_);
+}
+
+auto IoUringEngine::MapRings(const io_uring_params &params) -> bool {
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  void *sq_ring =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    return false;
+  }
+  sq_ring_ = sq_ring;
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void *cq_ring =
+        mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      return false;
+    }
+    cq_ring_ = cq_ring;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+void IoUringEngine::Submit(std::vector<DiskRequest> requests) {
+  std::scoped_lock lock(latch_);
+  for (auto &request : requests) {
+    auto *op = new InFlight{std::move(request)};
+    if (direct_io_ && reinterpret_cast<uintptr_t>(op->request_.data_) % BUSTUB_PAGE_SIZE != 0) {
+      op->bounce_ = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE));
+      if (op->request_.is_write_) {
+        memcpy(op->bounce_, op->request_.data_, BUSTUB_PAGE_SIZE);
+      }
+    }
+    pending_.push_back(op);
+  }
+  SubmitPending();
+}
+
+void IoUringEngine::SubmitPending() {
+  // Only submitters write the tail, and they hold latch_; the kernel moves the head.
+  unsigned tail = *sq_tail_;
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  bool queued = false;
+  while (!pending_.empty() && in_flight_ < sq_entries_ && tail - head < sq_entries_) {
+    InFlight *op = pending_.front();
+    pending_.pop_front();
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    if (op == nullptr) {
+      sqe->opcode = IORING_OP_NOP;
+    } else {
+      sqe->opcode = op->request_.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = fd_;
+      sqe->off = static_cast<uint64_t>(op->request_.page_id_) * BUSTUB_PAGE_SIZE;
+      sqe->addr = reinterpret_cast<uint64_t>(op->bounce_ != nullptr ? op->bounce_ : op->request_.data_);
+      sqe->len = BUSTUB_PAGE_SIZE;
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+    sq_array_[index] = index;
+    tail++;
+    in_flight_++;
+    queued = true;
+  }
+  if (!queued) {
+    return;
+  }
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+  // Entries the kernel did not take this time stay in the ring, and go along with the next io_uring_enter.
+  unsigned to_submit = tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  while (SysIoUringEnter(ring_fd_, to_submit, 0, 0) < 0 && errno == EINTR) {
+  }
+}
+
+void IoUringEngine::ReapCompletions() {
+  bool stop_seen = false;
+  std::vector<InFlight *> completed;
+  auto backoff = std::chrono::microseconds(0);
+  while (true) {
+    if (SysIoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      // completions that are already there are still reaped below, and the wait is retried after a growing pause
+      if (backoff.count() == 0) {
+        LOG_WARN("io_uring_enter failed (errno %d), backing off", errno);
+      }
+      backoff = std::min<std::chrono::microseconds>(std::max(2 * backoff, std::chrono::microseconds(1)),
+                                                    MAX_REAP_BACKOFF);
+      std::this_thread::sleep_for(backoff);
+    } else {
+      backoff = std::chrono::microseconds(0);
+    }
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned num_reaped = 0;
+    for (; head != tail; head++, num_reaped++) {
+      io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+      auto *op = reinterpret_cast<InFlight *>(cqe->user_data);
+      if (op == nullptr) {
+        stop_seen = true;
+        continue;
+      }
+      op->result_ = cqe->res;
+      completed.push_back(op);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    for (auto *op : completed) {
+      Complete(op);
+    }
+    completed.clear();
+
+    std::scoped_lock lock(latch_);
+    in_flight_ -= num_reaped;
+    SubmitPending();
+    if (stop_seen && in_flight_ == 0 && pending_.empty()) {
+      return;
+    }
+  }
+}
+
+void IoUringEngine::Complete(InFlight *op) {
+  const DiskRequest &request = op->request_;
+  if (op->result_ != BUSTUB_PAGE_SIZE) {
+    // An error, or a read past the end of the file: the synchronous path knows how to deal with both.
+    fallback_(request);
+  } else if (op->bounce_ != nullptr && !request.is_write_) {
+    memcpy(request.data_, op->bounce_, BUSTUB_PAGE_SIZE);
+  }
+  std::free(op->bounce_);
+  if (request.callback_) {
+    request.callback_();
+  }
+  delete op;
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 
 #include "common/exception.h"
@@ -11,17 +12,17 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
                           int leaf_max_size, int internal_max_size)
     : index_name_(std::move(name)),
-      root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      root_(static_cast<uint32_t>(INVALID_PAGE_ID)) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_PAGE_ID; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return RootPageIdOf(root_.load()) == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -44,7 +45,10 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   // }
   // result->push_back(value);
   // return true;
-  Page *leaf_page = FindLeafPageByOperation(key, Operation::FIND, transaction).first;
+  Page *leaf_page = FindLeafPageByOperation(key, Operation::FIND, transaction);
+  if (leaf_page == nullptr) {
+    return false;
+  }
 
   // 2 在leaf page里找这个key
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());  // 记得加上GetData()
@@ -63,6 +67,86 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return true;
 }
 
+/*
+ * Batched point lookups. The keys are sorted, and each page on the way down hands each of its children the run of
+ * keys that falls into it, so a subtree is descended into once per batch rather than once per key. Pages stay
+ * read-latched until all of their children are done, and the children of a page are prefetched once it is known
+ * which of them the batch needs.
+ * @return : the number of keys found
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) -> size_t {
+  results->assign(keys.size(), {});
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(),
+            [this, &keys](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  Page *root_page = LatchRoot(false, false);
+  if (root_page == nullptr) {
+    return 0;
+  }
+  return GetValuesInSubtree(root_page, keys, order, 0, order.size(), results);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetValuesInSubtree(Page *page, const std::vector<KeyType> &keys,
+                                        const std::vector<size_t> &order, size_t begin, size_t end,
+                                        std::vector<std::vector<ValueType>> *results) -> size_t {
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  size_t found = 0;
+  if (node->IsLeafPage()) {
+    auto leaf_node = reinterpret_cast<LeafPage *>(node);
+    for (size_t i = begin; i < end; i++) {
+      ValueType value{};
+      if (leaf_node->Lookup(keys[order[i]], &value, comparator_)) {
+        (*results)[order[i]].push_back(value);
+        found++;
+      }
+    }
+  } else {
+    // 1 按child把有序的keys分段：同一个child的keys是连续的
+    auto i_node = reinterpret_cast<InternalPage *>(node);
+    std::vector<std::pair<page_id_t, size_t>> runs;  // child page id, and where its run of keys starts
+    for (size_t i = begin; i < end; i++) {
+      page_id_t child_page_id = i_node->Lookup(keys[order[i]], comparator_);
+      if (runs.empty() || runs.back().first != child_page_id) {
+        runs.emplace_back(child_page_id, i);
+      }
+    }
+    // 2 先预取后面的children，再逐个下降
+    for (size_t r = 1; r < runs.size(); r++) {
+      buffer_pool_manager_->PrefetchPage(runs[r].first, AccessType::Index);
+    }
+    // a subtree lets go of its own pages, on the way out of a failure too; this page is let go of here
+    auto release = [this, page] {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    };
+    for (size_t r = 0; r < runs.size(); r++) {
+      Page *child_page = buffer_pool_manager_->FetchPage(runs[r].first, AccessType::Index);
+      if (child_page == nullptr) {
+        release();
+        throw std::runtime_error("out of memory");
+      }
+      child_page->RLatch();
+      size_t run_end = r + 1 < runs.size() ? runs[r + 1].second : end;
+      try {
+        found += GetValuesInSubtree(child_page, keys, order, runs[r].second, run_end, results);
+      } catch (...) {
+        release();
+        throw;
+      }
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -75,15 +159,37 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  {
-    const std::lock_guard<std::mutex> guard(root_latch_);  // 注意新建根节点时要锁住
-    // std::scoped_lock lock{root_latch_};
-    if (IsEmpty()) {
-      StartNewTree(key, value);
-      return true;
+  while (true) {
+    uint64_t root = root_.load();
+    if (RootPageIdOf(root) == INVALID_PAGE_ID) {
+      if (StartNewTree(root, key, value)) {
+        return true;
+      }
+      continue;
+    }
+
+    // Optimistic pass: only the leaf is write-latched. Most inserts do not split, and are done after this.
+    Page *leaf_page = FindLeafPageOptimistic(key, Operation::INSERT);
+    if (leaf_page == nullptr) {
+      continue;
+    }
+    auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    if (IsSafe(leaf_node, Operation::INSERT)) {
+      int size = leaf_node->GetSize();
+      bool inserted = leaf_node->Insert(key, value, comparator_) != size;
+      leaf_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), inserted);
+      return inserted;
+    }
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+
+    // The leaf may split: start over and write-latch every page that the split may reach.
+    leaf_page = FindLeafPageByOperation(key, Operation::INSERT, transaction);
+    if (leaf_page != nullptr) {
+      return InsertIntoLeaf(leaf_page, key, value, transaction);
     }
   }
-  return InsertIntoLeaf(key, value, transaction);
 }
 
 // INDEX_TEMPLATE_ARGUMENTS
@@ -102,7 +208,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 // }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+auto BPLUSTREE_TYPE::StartNewTree(uint64_t empty_root, const KeyType &key, const ValueType &value) -> bool {
   // LOG_INFO("ENTER StartNewTree key=%ld thread=%lu", key.ToString(), getThreadId());  // DEBUG
 
   // 1 缓冲池申请一个new page，作为root page
@@ -111,20 +217,180 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   if (nullptr == root_page) {
     throw std::runtime_error("out of memory");
   }
-  // 2 page id赋值给root page id，并插入header page的root page id
-  root_page_id_ = new_page_id;
-  UpdateRootPageId(1);  // insert root page id in header page
-
-  // 3 使用leaf page的Insert函数插入(key,value)
+  // 2 使用leaf page的Insert函数插入(key,value)
   LeafPage *root_node = reinterpret_cast<LeafPage *>(root_page->GetData());  // 记得加上GetData()
   root_node->Init(new_page_id, INVALID_PAGE_ID, leaf_max_size_);             // 记得初始化为leaf_max_size
   root_node->Insert(key, value, comparator_);
-  // 4 unpin root page
+  // 3 unpin root page
   buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);  // 注意：这里dirty要置为true！
 
+  // 4 page id赋值给root page id，并插入header page的root page id
+  // Another insert may have started a tree in the meantime: then ours is thrown away, and the key goes into theirs.
+  if (!root_.compare_exchange_strong(empty_root, NextRoot(empty_root, new_page_id))) {
+    buffer_pool_manager_->DeletePage(new_page_id);
+    return false;
+  }
+  UpdateRootPageId(1);  // insert root page id in header page
+  return true;
+
   // LOG_INFO("END StartNewTree key=%ld thread=%lu", key.ToString(), getThreadId());  // DEBUG
 }
 
+/*
+ * Build the tree bottom-up from entries sorted by strictly increasing key: first the leaves, packed in order and
+ * chained by their next page ids, then every internal level from the first keys of the level below it, until a
+ * single page is left as the root. Each page is filled to fill_factor of what it holds before it splits, so that
+ * inserts after the load do not split every page they touch.
+ * The tree must be empty and nobody may use it until the load returns.
+ * @return : false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(typename std::vector<MappingType>::const_iterator begin,
+                              typename std::vector<MappingType>::const_iterator end, double fill_factor) -> bool {
+  if (!IsEmpty()) {
+    return false;
+  }
+  if (begin == end) {
+    return true;
+  }
+  if constexpr (LeafPage::VARIABLE_LENGTH) {
+    BulkLoadVariableLength(begin, end, fill_factor);
+    return true;
+  }
+
+  // 1 叶子层：entries平均分到各个leaf page，并用next page id串起来
+  // Every level is kept as the first key and page id of each of its pages, which is what its parent level is built of.
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  auto num_entries = static_cast<size_t>(end - begin);
+  size_t num_pages = PagesForLevel(num_entries, leaf_max_size_, fill_factor);
+  LeafPage *prev_leaf = nullptr;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto first = begin + num_entries * i / num_pages;
+    auto last = begin + num_entries * (i + 1) / num_pages;
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw std::runtime_error("out of memory");
+    }
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    leaf->CopyNFrom(&*first, static_cast<int>(last - first));
+    level.emplace_back(first->first, page_id);
+    // 前一个leaf要等到知道下一个leaf的page id之后才能unpin
+    if (prev_leaf != nullptr) {
+      prev_leaf->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+    }
+    prev_leaf = leaf;
+  }
+  buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+
+  // 2 内部层：自底向上逐层构建，直到只剩一个page作为root
+  while (level.size() > 1) {
+    num_pages = PagesForLevel(level.size(), internal_max_size_, fill_factor);
+    std::vector<std::pair<KeyType, page_id_t>> parent_level;
+    for (size_t i = 0; i < num_pages; i++) {
+      size_t first = level.size() * i / num_pages;
+      size_t last = level.size() * (i + 1) / num_pages;
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw std::runtime_error("out of memory");
+      }
+      auto internal = reinterpret_cast<InternalPage *>(page->GetData());
+      internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+      // The first key of an internal page is never looked at, so the first key of the first child can stay there.
+      internal->CopyNFrom(level.data() + first, static_cast<int>(last - first), buffer_pool_manager_);
+      parent_level.emplace_back(level[first].first, page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    level = std::move(parent_level);
+  }
+
+  SetRootPageId(level[0].second);
+  UpdateRootPageId(1);  // insert root page id in header page
+  return true;
+}
+
+/*
+ * Bulk load for pages of variable-length keys. Entries cannot be spread evenly by count here, so each page takes
+ * as many entries as fill fill_factor of its bytes, and its key range ends at the split key of the next page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadVariableLength(typename std::vector<MappingType>::const_iterator begin,
+                                            typename std::vector<MappingType>::const_iterator end,
+                                            double fill_factor) {
+  // only instantiated for pages that have fences to set
+  if constexpr (LeafPage::VARIABLE_LENGTH) {
+    // 1 叶子层：每个leaf page尽量装满，key range为[low, 下一个page的split key)
+    std::vector<std::pair<KeyType, page_id_t>> level;
+    KeyType low{};  // the leftmost page of every level covers all keys below the next one
+    LeafPage *prev_leaf = nullptr;
+    for (auto first = begin; first != end;) {
+      int count = LeafPage::FitEntries(true, low, &*first, static_cast<int>(end - first), leaf_max_size_, fill_factor);
+      auto last = first + count;
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPage(&page_id);
+      if (page == nullptr) {
+        throw std::runtime_error("out of memory");
+      }
+      auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+      KeyType high{};
+      if (last != end) {
+        high = LeafPage::SplitKey(true, &*first, count);
+      }
+      leaf->SetFences(low, last != end ? &high : nullptr);
+      leaf->CopyNFrom(&*first, count);
+      level.emplace_back(low, page_id);
+      if (prev_leaf != nullptr) {
+        prev_leaf->SetNextPageId(page_id);
+        buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+      }
+      prev_leaf = leaf;
+      low = high;
+      first = last;
+    }
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+
+    // 2 内部层：key即为下一层各page的low fence
+    while (level.size() > 1) {
+      std::vector<std::pair<KeyType, page_id_t>> parent_level;
+      for (size_t first = 0; first < level.size();) {
+        int count = InternalPage::FitEntries(false, level[first].first, level.data() + first,
+                                             static_cast<int>(level.size() - first), internal_max_size_, fill_factor);
+        size_t last = first + count;
+        page_id_t page_id;
+        Page *page = buffer_pool_manager_->NewPage(&page_id);
+        if (page == nullptr) {
+          throw std::runtime_error("out of memory");
+        }
+        auto internal = reinterpret_cast<InternalPage *>(page->GetData());
+        internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+        internal->SetFences(level[first].first, last != level.size() ? &level[last].first : nullptr);
+        internal->CopyNFrom(level.data() + first, count, buffer_pool_manager_);
+        parent_level.emplace_back(level[first].first, page_id);
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        first = last;
+      }
+      level = std::move(parent_level);
+    }
+
+    SetRootPageId(level[0].second);
+    UpdateRootPageId(1);  // insert root page id in header page
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PagesForLevel(size_t num_entries, int max_size, double fill_factor) -> size_t {
+  // A page splits once it reaches max_size entries, so max_size - 1 is as full as it gets.
+  auto per_page = std::max<size_t>(static_cast<size_t>((max_size - 1) * fill_factor), 1);
+  size_t num_pages = (num_entries + per_page - 1) / per_page;
+  // Entries are spread evenly, so with a low fill factor fewer pages may be needed to keep each at its min size.
+  auto min_size = std::max<size_t>(max_size / 2, 1);
+  return std::max<size_t>(std::min(num_pages, num_entries / min_size), 1);
+}
+
 // INDEX_TEMPLATE_ARGUMENTS
 // auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page* {
 //   if (IsEmpty()) {
@@ -148,34 +414,54 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  return FindLeafPageByOperation(key, Operation::FIND, nullptr, leftMost, false).first;
+  return FindLeafPageByOperation(key, Operation::FIND, nullptr, leftMost, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LatchRoot(bool exclusive_internal, bool exclusive_leaf) -> Page * {
+  while (true) {
+    uint64_t root = root_.load();
+    if (RootPageIdOf(root) == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(RootPageIdOf(root));
+    if (page == nullptr) {
+      // nullptr means an empty tree to the callers, so a root that cannot be fetched must not look like one
+      throw std::runtime_error("out of memory");
+    }
+    // If the root moved on in the meantime, the type may be stale; the check below sends us around again then.
+    bool exclusive = reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage() ? exclusive_leaf
+                                                                                        : exclusive_internal;
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    // Nobody moves the root away from a page without write-latching it, so if the root pointer is still the same
+    // now that we hold the latch, the page stays the root until we let go of it.
+    if (root_.load() == root) {
+      return page;
+    }
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &key, Operation operation, Transaction *transaction,
-                                             bool leftMost, bool rightMost) -> std::pair<Page *, bool> {
+                                             bool leftMost, bool rightMost) -> Page * {
   assert(operation == Operation::FIND ? !(leftMost && rightMost) : transaction != nullptr);
 
-  // LOG_INFO("BEGIN FindLeafPage key=%ld Thread=%lu Operation=%d", key.ToString(), getThreadId(),
-  //          OpToString(operation));  // DEBUG
-
-  root_latch_.lock();
-  bool is_root_page_id_latched = true;
-
-  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
-  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
-
-  if (operation == Operation::FIND) {
-    page->RLatch();
-    is_root_page_id_latched = false;
-    root_latch_.unlock();
-  } else {
-    page->WLatch();
-    if (IsSafe(node, operation)) {
-      is_root_page_id_latched = false;
-      root_latch_.unlock();
-    }
+  bool exclusive = operation != Operation::FIND;
+  Page *page = LatchRoot(exclusive, exclusive);
+  if (page == nullptr) {
+    return nullptr;
   }
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   while (!node->IsLeafPage()) {
     auto i_node = reinterpret_cast<InternalPage *>(node);
@@ -200,11 +486,10 @@ auto BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &key, Operation opera
       child_page->WLatch();
       transaction->AddIntoPageSet(page);
       // child node is safe, release all locks on ancestors
-      if (IsSafe(child_node, operation)) {
-        if (is_root_page_id_latched) {
-          is_root_page_id_latched = false;
-          root_latch_.unlock();
-        }
+      // (asked through the page type, as pages of variable-length keys work out their sizes from their bytes)
+      bool safe = child_node->IsLeafPage() ? IsSafe(reinterpret_cast<LeafPage *>(child_node), operation)
+                                           : IsSafe(reinterpret_cast<InternalPage *>(child_node), operation);
+      if (safe) {
         UnlockUnpinPages(transaction);
       }
     }
@@ -213,10 +498,103 @@ auto BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &key, Operation opera
     node = child_node;
   }  // end while
 
-  // LOG_INFO("END FindLeafPage key=%ld Thread=%lu Operation=%d", key.ToString(), getThreadId(),
-  //          OpToString(operation));  // DEBUG
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType &key, bool *leftmost) -> Page * {
+  Page *page = LatchRoot(false, false);
+  if (page == nullptr) {
+    return nullptr;
+  }
+
+  // 1 像查找一样下降到key所在的叶子，但不放开路径上的读锁，以便回溯
+  // (a parent's key may be below the first key of its child once that has been deleted, so the way to the leaf before
+  // is only known from the path to the leaf of key)
+  std::vector<std::pair<Page *, int>> path;  // internal pages on the way down, and the child taken at each
+  while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    auto i_node = reinterpret_cast<InternalPage *>(page->GetData());
+    int child_index = i_node->ValueIndex(i_node->Lookup(key, comparator_));
+    path.emplace_back(page, child_index);
+    page = buffer_pool_manager_->FetchPage(i_node->ValueAt(child_index), AccessType::Index);
+    page->RLatch();
+  }
 
-  return std::make_pair(page, is_root_page_id_latched);
+  // 2 回溯到最深的、没有走最左child的祖先，从它左边的child一路向最右下降
+  int level = static_cast<int>(path.size()) - 1;
+  while (level >= 0 && path[level].second == 0) {
+    level--;
+  }
+  *leftmost = level < 0;
+  if (!*leftmost) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    while (static_cast<int>(path.size()) > level + 1) {
+      path.back().first->RUnlatch();
+      buffer_pool_manager_->UnpinPage(path.back().first->GetPageId(), false);
+      path.pop_back();
+    }
+    auto i_node = reinterpret_cast<InternalPage *>(path.back().first->GetData());
+    int child_index = path.back().second - 1;
+    while (true) {
+      page = buffer_pool_manager_->FetchPage(i_node->ValueAt(child_index), AccessType::Index);
+      page->RLatch();
+      auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        // a backward scan goes on with the leaves to the left, which only the parent knows about
+        for (int i = child_index - 1; i >= 0 && i >= child_index - READ_AHEAD_PAGES; i--) {
+          buffer_pool_manager_->PrefetchPage(i_node->ValueAt(i), AccessType::Index);
+        }
+        break;
+      }
+      i_node = reinterpret_cast<InternalPage *>(node);
+      child_index = i_node->GetSize() - 1;
+      path.emplace_back(page, child_index);
+    }
+  }
+
+  for (auto &[path_page, child_index] : path) {
+    path_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(path_page->GetPageId(), false);
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key, Operation operation) -> Page * {
+  assert(operation != Operation::FIND);
+
+  Page *page = LatchRoot(false, true);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+  while (!node->IsLeafPage()) {
+    auto i_node = reinterpret_cast<InternalPage *>(node);
+    auto child_page = buffer_pool_manager_->FetchPage(i_node->Lookup(key, comparator_));
+    auto child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    // A page only turns from leaf into internal page or back by being freed and reused, and the child cannot be
+    // freed while we hold the parent's latch, so its type can be read before latching it.
+    if (child_node->IsLeafPage()) {
+      child_page->WLatch();
+    } else {
+      child_page->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    page = child_page;
+    node = child_node;
+  }
+
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetRootPageId(page_id_t root_page_id) {
+  uint64_t root = root_.load();
+  root_.store(NextRoot(root, root_page_id));
 }
 
 /* unlock all pages */
@@ -227,8 +605,11 @@ void BPLUSTREE_TYPE::UnlockPages(Transaction *transaction) {
   }
 
   // unlock 和 unpin 事务经过的所有parent page
+  // The page set holds the pin taken on the way down, which nobody else releases: without unpinning it here, every
+  // split or merge leaked a frame of the buffer pool.
   for (Page *page : *transaction->GetPageSet()) {  // 前面加*是因为page set是shared_ptr类型
     page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
   }
   transaction->GetPageSet()->clear();  // 清空page set
 
@@ -336,16 +717,8 @@ auto BPLUSTREE_TYPE::IsSafe(N *node, Operation op) -> bool {
 // }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
-  // LOG_INFO("ENTER InsertIntoLeaf key=%ld thread=%lu", key.ToString(), getThreadId());
-
-  // bool is_root_latched_;  // DEBUG
-
-  // 1 find the leaf page as insertion target
-  // Page *leaf_page = FindLeafPage(key, false, transaction, Operation::INSERT,
-  //  &is_root_latched_);  // pin and W Latch leaf page and ancesters
-  auto [leaf_page, root_is_latched] = FindLeafPageByOperation(key, Operation::INSERT, transaction);
-
+auto BPLUSTREE_TYPE::InsertIntoLeaf(Page *leaf_page, const KeyType &key, const ValueType &value,
+                                    Transaction *transaction) -> bool {
   auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());  // 注意，记得加上GetData()
 
   // ValueType lookup_value{};  // not used
@@ -358,11 +731,6 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
   // if (is_exist) {
   if (new_size == size) {
-    // assert(root_is_latched_ == true);
-    if (root_is_latched) {
-      // LOG_INFO("Before END InsertIntoLeaf duplicate keys: root_latch_.unlock()");
-      root_latch_.unlock();
-    }
     UnlockUnpinPages(transaction);  // 此函数中会释放叶子的所有现在被锁住的祖先（不包括叶子）
     // assert(root_is_latched_ == false);
     leaf_page->WUnlatch();
@@ -372,13 +740,9 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   }
 
   if (new_size < leaf_node->GetMaxSize()) {
-    // UnlockUnpinPages(transaction, Operation::INSERT);  // DEBUG 疑问：此处是否需要释放所有祖先节点的锁？
-    // 似乎不需要，因为如果叶子节点插入后小于maxsize，说明其父节点在之前在findLeafPage就已经释放过锁了
-
-    if (root_is_latched) {
-      // LOG_INFO("Before END InsertIntoLeaf no split: root_latch_.unlock()");
-      root_latch_.unlock();
-    }
+    // 定长key时祖先在findLeafPage就已经释放过锁了；
+    // 但变长key的page按字节算maxsize，插入短key后仍可能未满，所以这里释放仍被锁住的祖先
+    UnlockUnpinPages(transaction);
 
     leaf_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);  // unpin leaf page
@@ -389,23 +753,10 @@ auto BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   // new_size >= leaf_node->GetMaxSize()
   LeafPage *new_leaf_node = Split(leaf_node);  // pin new leaf node
 
-  bool *pointer_root_is_latched = new bool(root_is_latched);
-
-  InsertIntoParent(leaf_node, new_leaf_node->KeyAt(0), new_leaf_node, transaction,
-                   pointer_root_is_latched);  // 此函数内将会 W Unlatch
-
-  assert((*pointer_root_is_latched) == false);
-
-  delete pointer_root_is_latched;
+  InsertIntoParent(leaf_node, new_leaf_node->LowKey(), new_leaf_node, transaction);  // 此函数内将会 W Unlatch
 
   // 疑问：这里别人似乎没有unpin？？？(我觉得必须unpin，InsertIntoParent函数里面并不会unpin old node和new node)
 
-  // DEBUG
-  // if (is_root_latched_) {
-  //   // LOG_INFO("Before END InsertIntoLeaf with split: root_latch_.unlock()");
-  //   root_latch_.unlock();
-  // }
-
   leaf_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);      // unpin leaf page
   buffer_pool_manager_->UnpinPage(new_leaf_node->GetPageId(), true);  // DEBUG: unpin new leaf node
@@ -508,13 +859,12 @@ N *BPLUSTREE_TYPE::Split(N *node) {
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction, bool *root_is_latched) {
+                                      Transaction *transaction) {
   // 1 old_node是根结点，那么整棵树直接升高一层
   // 具体操作是创建一个新结点R当作根结点，其关键字为key，左右孩子结点分别为old_node和new_node
   if (old_node->IsRootPage()) {  // old node为根结点
     page_id_t new_page_id = INVALID_PAGE_ID;
     Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);  // 这里应该是NewPage，不是FetchPage！
-    root_page_id_ = new_page_id;
 
     auto new_root_node = reinterpret_cast<InternalPage *>(new_page->GetData());
     new_root_node->Init(new_page_id, INVALID_PAGE_ID, internal_max_size_);  // 注意初始化parent page id和max_size
@@ -527,14 +877,10 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     // buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);  // DEBUG
     buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);  // 修改了new_page->data，所以dirty置为true
 
+    // The new root is complete before it is published, and the old root is still write-latched until then.
+    SetRootPageId(new_page_id);
     UpdateRootPageId(0);  // update root page id in header page
 
-    // 新的root必定不在transaction的page_set_队列中
-    if (*root_is_latched) {
-      *root_is_latched = false;
-      root_latch_.unlock();
-    }
-
     UnlockPages(transaction);
     // LOG_INFO("InsertIntoParent old node is root: completed key=%ld thread=%lu", key.ToString(), getThreadId());
     return;  // 结束递归
@@ -555,12 +901,6 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 
   // 父节点未满
   if (parent_node->GetSize() < parent_node->GetMaxSize()) {
-    // DEBUG
-    if (*root_is_latched) {
-      *root_is_latched = false;
-      root_latch_.unlock();
-    }
-
     UnlockPages(transaction);  // unlock除了叶子结点以外的所有上锁的祖先节点
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);  // unpin parent page
     return;
@@ -570,7 +910,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   // parent_node拆分成两个，分别是parent_node和new_parent_node
   InternalPage *new_parent_node = Split(parent_node);  // pin new parent node
   // 继续递归，下一层递归是将拆分后新结点new_parent_node的第一个key插入到parent_node的父结点
-  InsertIntoParent(parent_node, new_parent_node->KeyAt(0), new_parent_node, transaction, root_is_latched);
+  InsertIntoParent(parent_node, new_parent_node->KeyAt(0), new_parent_node, transaction);
 
   buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);      // unpin parent page
   buffer_pool_manager_->UnpinPage(new_parent_node->GetPageId(), true);  // unpin new parent node
@@ -607,22 +947,34 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   // LOG_INFO("ENTER Remove key=%ld thread=%lu", key.ToString(), getThreadId());
 
   // std::scoped_lock lock{latch_};  // DEBUG
-  if (IsEmpty()) {
+  // Optimistic pass: only the leaf is write-latched, which is enough as long as it does not underflow.
+  Page *leaf_page = FindLeafPageOptimistic(key, Operation::DELETE);
+  if (leaf_page == nullptr) {
     return;
   }
+  auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  if (IsSafe(leaf_node, Operation::DELETE)) {
+    int size = leaf_node->GetSize();
+    bool removed = leaf_node->RemoveAndDeleteRecord(key, comparator_) != size;
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), removed);
+    return;
+  }
+  leaf_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+
   // find the leaf page as deletion target
   // Page *leaf_page = FindLeafPage(key, false, transaction, Operation::DELETE);  // pin leaf page
-  // Page *leaf_page = FindLeafPageByOperation(key, Operation::DELETE, transaction).first;
-  auto [leaf_page, root_is_latched] = FindLeafPageByOperation(key, Operation::DELETE, transaction);
-  auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  leaf_page = FindLeafPageByOperation(key, Operation::DELETE, transaction);
+  if (leaf_page == nullptr) {
+    return;
+  }
+  leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   int old_size = leaf_node->GetSize();
   int new_size = leaf_node->RemoveAndDeleteRecord(key, comparator_);  // 在leaf中删除key（如果不存在该key，则size不变）
 
   // 1 删除失败
   if (new_size == old_size) {
-    if (root_is_latched) {
-      root_latch_.unlock();
-    }
     UnlockUnpinPages(transaction);
 
     leaf_page->WUnlatch();
@@ -632,24 +984,13 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   }
 
   // 2 删除成功，然后调用CoalesceOrRedistribute
-  bool *pointer_root_is_latched = new bool(root_is_latched);
-
-  bool leaf_should_delete = CoalesceOrRedistribute(leaf_node, transaction, pointer_root_is_latched);
+  bool leaf_should_delete = CoalesceOrRedistribute(leaf_node, transaction);
   // NOTE: unlock and unpin are finished in CoalesceOrRedistribute
-  // NOTE: root node must be unlocked in CoalesceOrRedistribute
-  assert((*pointer_root_is_latched) == false);
-
-  delete pointer_root_is_latched;
 
   if (leaf_should_delete) {
     transaction->AddIntoDeletedPageSet(leaf_page->GetPageId());
   }
 
-  // if (root_is_latched) {
-  //   LOG_INFO("END Remove key=%ld thread=%lu root_latch_.unlock()", key.ToString(), getThreadId());
-  //   root_latch_.unlock();
-  // }
-
   leaf_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);  // unpin leaf page
 
@@ -701,31 +1042,16 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, bool *root_is_latched) -> bool {
+auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -> bool {
   if (node->IsRootPage()) {
     bool root_should_delete = AdjustRoot(node);
 
-    // DEBUG
-    if (*root_is_latched) {
-      // LOG_INFO("CoalesceOrRedistribute node is root page root_latch_.unlock()");
-      *root_is_latched = false;
-      root_latch_.unlock();
-    }
-
     UnlockPages(transaction);
     return root_should_delete;  // NOTE: size of root page can be less than min size
   }
 
   // 不需要合并或者重分配，直接返回false
   if (node->GetSize() >= node->GetMinSize()) {
-    // 疑问：此处为什么不用root_latch_.unlock()
-
-    if (*root_is_latched) {
-      // LOG_INFO("CoalesceOrRedistribute node > minsize root_latch_.unlock()");
-      *root_is_latched = false;
-      root_latch_.unlock();
-    }
-
     UnlockPages(transaction);
     return false;
   }
@@ -735,6 +1061,13 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, b
   Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
   auto parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
 
+  // A page of variable-length keys that cannot be merged stays underflowed, so its parent may have a single child.
+  if (N::VARIABLE_LENGTH && parent->GetSize() < 2) {
+    UnlockPages(transaction);
+    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+    return false;
+  }
+
   // 获得node在parent的孩子指针(value)的index
   int index = parent->ValueIndex(node->GetPageId());
   // 寻找兄弟结点，尽量找到前一个结点(前驱结点)
@@ -745,14 +1078,25 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, b
 
   auto sibling_node = reinterpret_cast<N *>(sibling_page->GetData());
 
-  // 1 Redistribute 当kv总和能支撑两个Node，那么重新分配即可，不必删除node
-  if (node->GetSize() + sibling_node->GetSize() >= node->GetMaxSize()) {
-    if (*root_is_latched) {
-      // LOG_INFO("CoalesceOrRedistribute before Redistribute root_latch_.unlock()");
-      *root_is_latched = false;
-      root_latch_.unlock();
-    }
+  if constexpr (N::VARIABLE_LENGTH) {
+    // Pages of variable-length keys are merged if the result fits, and otherwise redistributed if the parent has room
+    // for their new split key; failing both, the page is left underflowed.
+    N *left = index == 0 ? node : sibling_node;
+    N *right = index == 0 ? sibling_node : node;
+    int key_index = index == 0 ? 1 : index;
+    if (!left->CanMergeWith(right, parent->KeyAt(key_index))) {
+      bool redistributed = RedistributeVariableLength(left, right, parent, key_index);
+
+      UnlockPages(transaction);
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), redistributed);
+
+      sibling_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), redistributed);
 
+      return false;
+    }
+  } else if (node->GetSize() + sibling_node->GetSize() >= node->GetMaxSize()) {
+    // 1 Redistribute 当kv总和能支撑两个Node，那么重新分配即可，不必删除node
     Redistribute(sibling_node, node, index);  // 无返回值
 
     UnlockPages(transaction);
@@ -766,17 +1110,7 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, b
 
   // 2 Coalesce 当sibling和node只能凑成一个Node，那么合并两个结点到sibling，删除node
   // Coalesce函数继续递归调用CoalesceOrRedistribute
-  bool parent_should_delete =
-      Coalesce(&sibling_node, &node, &parent, index, transaction, root_is_latched);  // 返回值是parent是否需要被删除
-
-  assert((*root_is_latched) == false);
-
-  // 特别注意此处的解锁root
-  // if (*root_is_latched) {
-  //   LOG_INFO("CoalesceOrRedistribute after Coalesce root_latch_.unlock()");
-  //   *root_is_latched = false;
-  //   root_latch_.unlock();
-  // }
+  bool parent_should_delete = Coalesce(&sibling_node, &node, &parent, index, transaction);  // 返回值是parent是否需要被删除
 
   if (parent_should_delete) {
     transaction->AddIntoDeletedPageSet(parent->GetPageId());
@@ -788,6 +1122,11 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, b
   sibling_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
 
+  // node was the leftmost child, so Coalesce merged its right sibling into it: that sibling is the page to delete.
+  if (index == 0) {
+    transaction->AddIntoDeletedPageSet(sibling_page_id);
+    return false;
+  }
   return true;  // node需要被删除
 }
 
@@ -828,19 +1167,15 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
     // NOTE: don't need to unpin old_root_node, this operation will be done in CoalesceOrRedistribute function
     // buffer_pool_manager_->UnpinPage(old_root_node->GetPageId(), true);
 
-    // update root page id
-    root_page_id_ = child_page_id;
-    UpdateRootPageId(0);
     // update parent page id of new root node
-    Page *new_root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+    Page *new_root_page = buffer_pool_manager_->FetchPage(child_page_id);
     auto new_root_node = reinterpret_cast<InternalPage *>(new_root_page->GetData());
     new_root_node->SetParentPageId(INVALID_PAGE_ID);
-
-    // if (root_is_latched) {
-    //   root_latch_.unlock();
-    // }
-
     buffer_pool_manager_->UnpinPage(new_root_page->GetPageId(), true);
+
+    // update root page id; the old root stays write-latched until the new one is published
+    SetRootPageId(child_page_id);
+    UpdateRootPageId(0);
     return true;
   }
   // Case 2: old_root_node是叶结点，且大小为0。直接更新root page id
@@ -848,7 +1183,7 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
   if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
     // LOG_INFO("AdjustRoot: all elements deleted from the B+ tree");
     // NOTE: don't need to unpin old_root_node, this operation will be done in Remove function
-    root_page_id_ = INVALID_PAGE_ID;
+    SetRootPageId(INVALID_PAGE_ID);
     UpdateRootPageId(0);
 
     // if (root_is_latched) {
@@ -897,7 +1232,7 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction, bool *root_is_latched) {
+                              Transaction *transaction) {
   // Assume that *neighbor_node is the left sibling of *node (neighbor -> node)
   // index表示node在parent中的孩子指针(value)的下标
   // key_index表示 交换后的 node在parent中的孩子指针(value)的下标
@@ -931,10 +1266,31 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
   (*parent)->Remove(key_index);  // 注意，是key_index，不是index
 
   // 因为parent中删除了kv对，所以递归调用CoalesceOrRedistribute函数判断parent结点是否需要被删除
-  return CoalesceOrRedistribute(*parent, transaction, root_is_latched);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+auto BPLUSTREE_TYPE::RedistributeVariableLength(N *left, N *right, InternalPage *parent, int key_index) -> bool {
+  // 重新分配left和right的entries，新的split key替换parent中key_index处的key，且不能让parent变满
+  KeyType split_key;
+  int max_key_length = parent->MaxKeyLengthAt(key_index);
+  bool redistributed;
+  if (left->IsLeafPage()) {
+    redistributed = reinterpret_cast<LeafPage *>(left)->RedistributeWith(reinterpret_cast<LeafPage *>(right),
+                                                                          max_key_length, &split_key);
+  } else {
+    redistributed = reinterpret_cast<InternalPage *>(left)->RedistributeWith(
+        reinterpret_cast<InternalPage *>(right), parent->KeyAt(key_index), max_key_length, &split_key,
+        buffer_pool_manager_);
+  }
+  if (redistributed) {
+    parent->SetKeyAt(key_index, split_key);
+  }
+  return redistributed;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
@@ -995,7 +1351,10 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  Page *leaf_page = FindLeafPageByOperation(KeyType(), Operation::FIND, nullptr, true).first;
+  Page *leaf_page = FindLeafPageByOperation(KeyType(), Operation::FIND, nullptr, true);
+  if (leaf_page == nullptr) {
+    return INDEXITERATOR_TYPE();  // 空树
+  }
   // LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, 0);  // 最左边的叶子且index=0
 }
@@ -1007,7 +1366,10 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  Page *leaf_page = FindLeafPageByOperation(key, Operation::FIND).first;
+  Page *leaf_page = FindLeafPageByOperation(key, Operation::FIND);
+  if (leaf_page == nullptr) {
+    return INDEXITERATOR_TYPE();  // 空树
+  }
   auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   int index = leaf_node->KeyIndex(key, comparator_);  // 此处直接用KeyIndex，而不是Lookup
   // LOG_INFO("Tree.Begin before return INDEX class, index=%d leaf page id=%d leaf node page id=%d", index,
@@ -1015,6 +1377,46 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, index);
 }
 
+/*
+ * Range scan: forward scans start at the first key in range and stop after high, backward scans start at the last key
+ * in range and stop after low
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Scan(const std::optional<KeyType> &low, bool low_inclusive, const std::optional<KeyType> &high,
+                          bool high_inclusive, ScanDirection direction) -> INDEXITERATOR_TYPE {
+  const auto &start = direction == ScanDirection::Forward ? low : high;
+  bool start_inclusive = direction == ScanDirection::Forward ? low_inclusive : high_inclusive;
+  Page *leaf_page;
+  if (start.has_value()) {
+    leaf_page = FindLeafPageByOperation(*start, Operation::FIND);
+  } else {
+    leaf_page = FindLeafPageByOperation(KeyType(), Operation::FIND, nullptr, direction == ScanDirection::Forward,
+                                        direction == ScanDirection::Backward);
+  }
+
+  int index = 0;
+  if (leaf_page != nullptr) {
+    auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    if (!start.has_value()) {
+      index = direction == ScanDirection::Forward ? 0 : leaf_node->GetSize() - 1;
+    } else {
+      // 第一个>=start的下标；start本身不在范围内时，正向跳过它，反向则从它前一个开始
+      index = leaf_node->KeyIndex(*start, comparator_);
+      bool at_start = index < leaf_node->GetSize() && comparator_(leaf_node->KeyAt(index), *start) == 0;
+      if (direction == ScanDirection::Forward) {
+        index += at_start && !start_inclusive ? 1 : 0;
+      } else {
+        index -= at_start && start_inclusive ? 0 : 1;
+      }
+    }
+  }
+  const auto &stop = direction == ScanDirection::Forward ? high : low;
+  bool stop_inclusive = direction == ScanDirection::Forward ? high_inclusive : low_inclusive;
+  return INDEXITERATOR_TYPE(this, buffer_pool_manager_, leaf_page, index, direction, stop, stop_inclusive,
+                            &comparator_);
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -1022,7 +1424,10 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
-  Page *leaf_page = FindLeafPageByOperation(KeyType(), Operation::FIND, nullptr, false, true).first;
+  Page *leaf_page = FindLeafPageByOperation(KeyType(), Operation::FIND, nullptr, false, true);
+  if (leaf_page == nullptr) {
+    return INDEXITERATOR_TYPE();  // 空树
+  }
   auto leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   // 从左向右开始遍历叶子层结点，直到最后一个
   // while (leaf_node->GetNextPageId() != INVALID_PAGE_ID) {
@@ -1040,7 +1445,7 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
  * @return Page id of the root of this tree
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
+auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return RootPageIdOf(root_.load()); }
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -1056,13 +1461,15 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return root_page_id_; }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   auto header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
+  // The header page is shared by every index, and the root of this one can now change under concurrent writers.
+  header_page->WLatch();
+  page_id_t root_page_id = GetRootPageId();
+  // A tree that was emptied and started over already has its record.
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id)) {
     // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+    header_page->UpdateRecord(index_name_, root_page_id);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -1110,7 +1517,7 @@ void BPLUSTREE_TYPE::Draw(BufferPoolManager *bpm, const std::string &outf) {
   }
   std::ofstream out(outf);
   out << "digraph G {" << std::endl;
-  ToGraph(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm, out);
+  ToGraph(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(GetRootPageId())->GetData()), bpm, out);
   out << "}" << std::endl;
   out.flush();
   out.close();
@@ -1125,7 +1532,7 @@ void BPLUSTREE_TYPE::Print(BufferPoolManager *bpm) {
     LOG_WARN("Print an empty tree");
     return;
   }
-  ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
+  ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(GetRootPageId())->GetData()), bpm);
 }
 
 /**
@@ -1259,4 +1666,6 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTree<VarcharKey<64>, RID, VarcharComparator<64>>;
 }  // namespace bustub
@@ -11,6 +11,8 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 namespace bustub {
 /*
  * Constructor
@@ -48,6 +50,35 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  // construct scan index keys
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+
+  container_.GetValues(index_keys, results, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries, Transaction *transaction) {
+  auto less = [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) < 0; };
+  auto equal = [this](const auto &a, const auto &b) { return comparator_(a.first, b.first) == 0; };
+  // the caller sorts the entries, normally; stable, so that the first of several entries with the same key is kept
+  if (!std::is_sorted(entries->begin(), entries->end(), less)) {
+    std::stable_sort(entries->begin(), entries->end(), less);
+  }
+  entries->erase(std::unique(entries->begin(), entries->end(), equal), entries->end());
+
+  if (!container_.BulkLoad(entries->cbegin(), entries->cend())) {
+    for (const auto &[key, value] : *entries) {
+      container_.Insert(key, value, transaction);
+    }
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -57,10 +88,19 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_.End(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetScanIterator(const std::optional<KeyType> &low, bool low_inclusive,
+                                           const std::optional<KeyType> &high, bool high_inclusive,
+                                           ScanDirection direction) -> INDEXITERATOR_TYPE {
+  return container_.Scan(low, low_inclusive, high, high_inclusive, direction);
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<VarcharKey<64>, RID, VarcharComparator<64>>;
+
 }  // namespace bustub
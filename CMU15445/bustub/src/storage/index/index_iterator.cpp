@@ -2,7 +2,9 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -11,46 +13,202 @@ namespace bustub {
  * NOTE: you can change the destructor/constructor method here
  * set your own input parameters
  */
+/** An iterator at the end, e.g. of an empty tree. */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator() : IndexIterator(nullptr, nullptr, 0) {}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, Page *page, int index)
-    : buffer_pool_manager_(bpm), page_(page), index_(index) {
-  leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());
+    : IndexIterator(nullptr, bpm, page, index, ScanDirection::Forward, std::nullopt, true, nullptr) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                                  Page *page, int index, ScanDirection direction, std::optional<KeyType> stop,
+                                  bool stop_inclusive, const KeyComparator *comparator)
+    : buffer_pool_manager_(bpm),
+      page_(page),
+      index_(index),
+      leaf_(page == nullptr ? nullptr : reinterpret_cast<LeafPage *>(page->GetData())),
+      tree_(tree),
+      direction_(direction),
+      stop_(std::move(stop)),
+      stop_inclusive_(stop_inclusive),
+      comparator_(comparator) {
+  // start at an entry: the key may be past the last one of its leaf, and pages of variable-length keys may be empty
+  Settle();
   // LOG_INFO("ENTER IndexIterator()");
   // LOG_INFO("LEAVE IndexIterator()");
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-  page_->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
-}  // NOLINT
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  return leaf_->GetNextPageId() == INVALID_PAGE_ID && index_ == leaf_->GetSize();
-}
+auto INDEXITERATOR_TYPE::IsEnd() const -> bool { return end_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return leaf_->GetItem(index_); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  if constexpr (LeafPage::VARIABLE_LENGTH) {
+    // such leaves do not store entries as they are, so they hand out a copy
+    item_ = leaf_->GetItem(index_);
+    return item_;
+  } else {
+    return leaf_->GetItem(index_);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (end_) {
+    return *this;
+  }
+  if (direction_ == ScanDirection::Backward) {
+    index_--;
+    Settle();
+    return *this;
+  }
   index_++;
-  if (index_ == leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
-    Page *next_page = buffer_pool_manager_->FetchPage(leaf_->GetNextPageId());  // pin next leaf page
-    next_page->RLatch();
-    page_->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);  // unpin current leaf page
-
-    page_ = next_page;
-    leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());  // update leaf page to next page
-    index_ = 0;                                              // reset index to zero
+  if (read_ahead_page_id_ == INVALID_PAGE_ID) {
+    ReadAhead();
   }
+  while (index_ == leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
+    MoveToNextLeaf();
+    if (read_ahead_pages_ > 0) {
+      read_ahead_pages_--;
+    }
+    ReadAhead();
+  }
+  Settle();
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveToNextLeaf() {
+  Page *next_page = buffer_pool_manager_->FetchPage(leaf_->GetNextPageId(), AccessType::Index);  // pin next leaf page
+  next_page->RLatch();
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);  // unpin current leaf page
+
+  page_ = next_page;
+  leaf_ = reinterpret_cast<LeafPage *>(page_->GetData());  // update leaf page to next page
+  index_ = 0;                                              // reset index to zero
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveToPrevLeaf() {
+  // 以当前叶子的最小key（空叶子用low fence）定位当前叶子，再找它前一个叶子
+  KeyType bound = leaf_->GetSize() > 0 ? leaf_->KeyAt(0) : leaf_->LowKey();
+  page_id_t from_page_id = page_->GetPageId();
+  Release();
+  while (true) {
+    bool leftmost;
+    Page *page = tree_->FindLeafPageBefore(bound, &leftmost);
+    if (page == nullptr) {
+      return;  // the tree has been emptied meanwhile
+    }
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(bound, *comparator_) - 1;
+    // The leftmost leaf, or getting back where we came from, means that there is nothing left of it.
+    if (index >= 0 || leftmost || page->GetPageId() == from_page_id) {
+      page_ = page;
+      leaf_ = leaf;
+      index_ = index;
+      leftmost_ = leftmost || page->GetPageId() == from_page_id;
+      return;
+    }
+    // a leaf without entries, which pages of variable-length keys may leave behind: keep going left
+    bound = leaf->LowKey();
+    from_page_id = page->GetPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(from_page_id, false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::PastStop(const KeyType &key) const -> bool {
+  if (!stop_.has_value()) {
+    return false;
+  }
+  int cmp = (*comparator_)(key, *stop_);
+  if (direction_ == ScanDirection::Backward) {
+    cmp = -cmp;
+  }
+  return cmp > 0 || (cmp == 0 && !stop_inclusive_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Settle() {
+  if (direction_ == ScanDirection::Forward) {
+    while (page_ != nullptr && index_ == leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
+      MoveToNextLeaf();
+    }
+    end_ = page_ == nullptr || index_ == leaf_->GetSize();
+  } else {
+    while (page_ != nullptr && index_ < 0 && !leftmost_) {
+      MoveToPrevLeaf();
+    }
+    end_ = page_ == nullptr || index_ < 0;
+  }
+  end_ = end_ || PastStop(leaf_->KeyAt(index_));
+  if (end_) {
+    Release();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  page_ = nullptr;
+  leaf_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  if (read_ahead_pages_ == 0) {
+    read_ahead_page_id_ = page_->GetPageId();
+  }
+  // a range scan reads no further ahead than the leaf that holds its last key
+  auto ends_range = [this](const LeafPage *leaf) {
+    return leaf->GetSize() > 0 && PastStop(leaf->KeyAt(leaf->GetSize() - 1));
+  };
+  while (read_ahead_pages_ < READ_AHEAD_PAGES) {
+    // Only the last leaf read ahead knows its right sibling, so extending the window may wait for that one read.
+    page_id_t next_page_id;
+    bool last_leaf;
+    if (read_ahead_page_id_ == page_->GetPageId()) {
+      next_page_id = leaf_->GetNextPageId();
+      last_leaf = ends_range(leaf_);
+    } else {
+      Page *frontier_page = buffer_pool_manager_->FetchPage(read_ahead_page_id_, AccessType::Index);
+      if (frontier_page == nullptr) {
+        return;
+      }
+      frontier_page->RLatch();
+      auto frontier_leaf = reinterpret_cast<LeafPage *>(frontier_page->GetData());
+      next_page_id = frontier_leaf->GetNextPageId();
+      last_leaf = ends_range(frontier_leaf);
+      frontier_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(read_ahead_page_id_, false);
+    }
+    if (next_page_id == INVALID_PAGE_ID || last_leaf) {
+      return;
+    }
+    buffer_pool_manager_->PrefetchPage(next_page_id, AccessType::Index);
+    read_ahead_page_id_ = next_page_id;
+    read_ahead_pages_++;
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const -> bool {
+  // all iterators past the end of their range are alike, whatever leaf they stopped at
+  if (end_ || itr.end_) {
+    return end_ == itr.end_;
+  }
   return leaf_->GetPageId() == itr.leaf_->GetPageId() && index_ == itr.index_;  // leaf page和index均相同
 }
 
@@ -69,4 +227,6 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<VarcharKey<64>, RID, VarcharComparator<64>>;
+
 }  // namespace bustub
@@ -13,6 +13,7 @@
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -66,17 +67,9 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { ret
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
-  int left = 1;
-  int right = GetSize() - 1;
-  while (left <= right) {
-    int mid = left + (right - left) / 2;
-    if (comparator(KeyAt(mid), key) > 0) {  // 下标还需要减小
-      right = mid - 1;
-    } else {  // 下标还需要增大
-      left = mid + 1;
-    }
-  }  // upper_bound
-  int target_index = left;
+  // upper_bound，第一个key无效，从下标1开始查找
+  int target_index = KeySearch<KeyType, KeyComparator>::UpperBound(reinterpret_cast<const char *>(&array_[0].first),
+                                                                   sizeof(MappingType), 1, GetSize(), key, comparator);
   assert(target_index - 1 >= 0);
   // 注意，返回的value下标要减1，这样才能满足key(i-1) <= subtree(value(i)) < key(i)
   return ValueAt(target_index - 1);
@@ -118,7 +111,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
   // [items,items+size)复制到当前page的array最后一个之后的空间
   std::copy(items, items + size, array_ + GetSize());
   // 修改array中的value的parent page id，其中array范围为[GetSize(), GetSize() + size)
@@ -13,6 +13,7 @@
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -53,7 +54,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) {
   std::copy(items, items + size, array_ + GetSize());  // [items,items+size)复制到该page的array最后一个之后的空间
   IncreaseSize(size);     
 }
@@ -66,7 +67,8 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
     -> int {
   int insert_index = KeyIndex(key, comparator);  // 查找第一个>=key的的下标
 
-  if (comparator(KeyAt(insert_index), key) == 0) {  // 重复的key
+  // insert_index may be GetSize(), whose slot holds whatever was last removed from there
+  if (insert_index < GetSize() && comparator(KeyAt(insert_index), key) == 0) {  // 重复的key
     return GetSize();
   }
 
@@ -109,22 +111,10 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
-  // 这里手写二分查找lower_bound，速度快于for循环的顺序查找
-  // array类型为std::pair<KeyType, ValueType>
-  // 叶结点的下标范围是[0,size-1]
-  // std::scoped_lock lock{latch_};  // DEBUG
-  int left = 0;
-  int right = GetSize() - 1;
-  while (left <= right) {
-    int mid = left + (right - left) / 2;
-    if (comparator(KeyAt(mid), key) >= 0) {  // 下标还需要减小
-      right = mid - 1;
-    } else {  // 下标还需要增大
-      left = mid + 1;
-    }
-  }  // lower_bound
-  int target_index = right + 1;
-  return target_index;  // 返回array中第一个>=key的下标（如果key大于所有array，则找到下标为size）
+  // 二分查找lower_bound，整数key走KeySearch的无分支版本
+  // 返回array中第一个>=key的下标（如果key大于所有array，则找到下标为size）
+  return KeySearch<KeyType, KeyComparator>::LowerBound(reinterpret_cast<const char *>(&array_[0].first),
+                                                       sizeof(MappingType), 0, GetSize(), key, comparator);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -143,6 +133,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   return array_[index].first;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::LowKey() const -> KeyType {
+  // 分裂后右半部分的第一个key即为父结点中的分隔key
+  return array_[0].first;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
   // LOG_INFO("LEAF BEGIN MoveFirstToEndOf");
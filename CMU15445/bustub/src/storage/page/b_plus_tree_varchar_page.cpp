@@ -0,0 +1,643 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varchar_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_varchar_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_varchar_page.h"
+
+namespace bustub {
+
+namespace {
+
+auto CommonPrefixLength(std::string_view a, std::string_view b) -> size_t {
+  size_t length = 0;
+  while (length < a.size() && length < b.size() && a[length] == b[length]) {
+    length++;
+  }
+  return length;
+}
+
+}  // namespace
+
+/*****************************************************************************
+ * COMMON PART
+ *****************************************************************************/
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::InitPage(IndexPageType page_type, page_id_t page_id, page_id_t parent_id,
+                                             int max_size) {
+  SetPageType(page_type);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetSize(0);
+  SetMaxSize(max_size);
+  next_page_id_ = INVALID_PAGE_ID;
+  // a new page covers all keys, until a split gives it a range
+  SetFences(KeyType(), nullptr);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::GetMaxSize() const -> int {
+  // once free space is short of one entry with the longest key, the next insert may have to split the page
+  return std::min(BPlusTreePage::GetMaxSize(), GetSize() + FreeBytes() / WorstEntryBytes(prefix_length_));
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::GetMinSize() const -> int {
+  // The tree merges a page once its size is below the min size, and only deletes without latching the ancestors if
+  // its size is above it. So: merge below a quarter in use and half the entry cap, and delete safely while a removal
+  // stays above either.
+  if (UnderMinSize(GetSize(), UsedBytes())) {
+    return GetSize() + 1;
+  }
+  if (UnderMinSize(GetSize() - 1, UsedBytes() - WorstEntryBytes(prefix_length_))) {
+    return GetSize();
+  }
+  return GetSize() - 1;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::UnderMinSize(int entries, int used_bytes) const -> bool {
+  return used_bytes < CAPACITY / 4 && entries < BPlusTreePage::GetMaxSize() / 2;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  if (!IsLeafPage() && index == 0) {
+    return LowKey();
+  }
+  char buffer[KeySize];
+  std::string_view suffix = SuffixAt(index);
+  memcpy(buffer, Data() + low_offset_, prefix_length_);
+  memcpy(buffer + prefix_length_, suffix.data(), suffix.size());
+  KeyType key;
+  key.SetFromString(std::string_view(buffer, prefix_length_ + suffix.size()));
+  return key;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::LowKey() const -> KeyType {
+  KeyType key;
+  key.SetFromString(std::string_view(Data() + low_offset_, low_length_));
+  return key;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::HighKey(KeyType *buffer) const -> const KeyType * {
+  if (high_length_ == NO_HIGH_FENCE) {
+    return nullptr;
+  }
+  buffer->SetFromString(std::string_view(Data() + high_offset_, high_length_));
+  return buffer;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::CanMergeWith(const BPlusTreeVarcharPage *right, const KeyType &middle_key) const
+    -> bool {
+  if (GetSize() + right->GetSize() >= BPlusTreePage::GetMaxSize()) {
+    return false;
+  }
+  // The merged page covers [our low fence, their high fence), whose common prefix may be shorter than either one's.
+  KeyType high_buffer;
+  int keys = GetSize() + right->GetSize();
+  int key_bytes = KeyBytes() + right->KeyBytes();
+  if (!IsLeafPage()) {
+    // our first key is still not stored, while the first key of the right page is stored as middle_key
+    keys--;
+    key_bytes += middle_key.GetLength();
+  }
+  return Fits(GetSize() + right->GetSize(), keys, key_bytes, LowKey(), right->HighKey(&high_buffer));
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::MaxKeyLengthAt(int index) const -> int {
+  // the old key becomes garbage, which is free space as well
+  int spare_bytes = FreeBytes() - WorstEntryBytes(prefix_length_);
+  return std::min(static_cast<int>(KeyType::MAX_LENGTH), prefix_length_ + slots_[index].length_ + spare_bytes);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::Fits(int entries, int keys, int key_bytes, const KeyType &low,
+                                         const KeyType *high) -> bool {
+  int prefix_length = high == nullptr ? 0 : CommonPrefixLength(low.ToStringView(), high->ToStringView());
+  int fence_bytes = low.GetLength() + (high == nullptr ? 0 : high->GetLength());
+  int bytes = entries * static_cast<int>(sizeof(Slot)) + key_bytes - keys * prefix_length + fence_bytes;
+  return bytes <= CAPACITY - WorstEntryBytes(prefix_length);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::SetFences(const KeyType &low, const KeyType *high) {
+  assert(GetSize() == 0);
+  heap_begin_ = BUSTUB_PAGE_SIZE;
+  garbage_ = 0;
+  low_length_ = low.GetLength();
+  low_offset_ = AppendBytes(low.ToStringView());
+  if (high == nullptr) {
+    high_length_ = NO_HIGH_FENCE;
+    high_offset_ = heap_begin_;
+    prefix_length_ = 0;
+  } else {
+    high_length_ = high->GetLength();
+    high_offset_ = AppendBytes(high->ToStringView());
+    prefix_length_ = CommonPrefixLength(low.ToStringView(), high->ToStringView());
+  }
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::SplitKey(bool leaf, const MappingType *items, int index) -> KeyType {
+  // a leaf only needs a key that separates its last key from the next one, an internal page needs the key itself
+  return leaf ? KeyComparator::Separator(items[index - 1].first, items[index].first) : items[index].first;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::FitEntries(bool leaf, const KeyType &low, const MappingType *items, int size,
+                                               int max_size, double fill_factor) -> int {
+  int max_entries = std::min(size, std::max(static_cast<int>((max_size - 1) * fill_factor), 1));
+  // The more entries, the wider the key range and the shorter its common prefix, so the bytes only ever grow.
+  int fit = 1;
+  int key_bytes = 0;
+  int keys = 0;
+  for (int count = 1; count <= max_entries; count++) {
+    if (leaf || count > 1) {
+      key_bytes += items[count - 1].first.GetLength();
+      keys++;
+    }
+    int prefix_length = 0;
+    int fence_bytes = low.GetLength();
+    if (count < size) {
+      KeyType high = SplitKey(leaf, items, count);
+      prefix_length = CommonPrefixLength(low.ToStringView(), high.ToStringView());
+      fence_bytes += high.GetLength();
+    }
+    int bytes = count * sizeof(Slot) + key_bytes - keys * prefix_length + fence_bytes;
+    if (count > 1 && bytes > (CAPACITY - WorstEntryBytes(prefix_length)) * fill_factor) {
+      break;
+    }
+    fit = count;
+  }
+  return fit;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::Search(const KeyType &key, int begin, bool upper) const -> int {
+  // Every key of the page starts with the prefix, so a key that does not comes before or after all of them. The
+  // others are only compared on the rest of their bytes.
+  std::string_view rest = key.ToStringView();
+  int prefix_order = rest.substr(0, prefix_length_).compare(Prefix());
+  if (prefix_order != 0) {
+    return prefix_order < 0 ? begin : GetSize();
+  }
+  rest.remove_prefix(prefix_length_);
+  int end = GetSize();
+  while (begin < end) {
+    int mid = begin + (end - begin) / 2;
+    int order = SuffixAt(mid).compare(rest);
+    if (order < 0 || (upper && order == 0)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  std::string_view suffix;
+  // the first key of an internal page is not stored
+  if (IsLeafPage() || index > 0) {
+    suffix = key.ToStringView();
+    assert(suffix.substr(0, prefix_length_) == Prefix());
+    suffix.remove_prefix(prefix_length_);
+  }
+  if (ContiguousFreeBytes() < static_cast<int>(sizeof(Slot) + suffix.size())) {
+    Compact();
+  }
+  BUSTUB_ASSERT(ContiguousFreeBytes() >= static_cast<int>(sizeof(Slot) + suffix.size()), "varchar page overflow");
+  uint16_t offset = AppendBytes(suffix);
+  std::copy_backward(slots_ + index, slots_ + GetSize(), slots_ + GetSize() + 1);
+  slots_[index] = Slot{offset, static_cast<uint16_t>(suffix.size()), value};
+  IncreaseSize(1);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::RemoveAt(int index) {
+  // the bytes of the last key appended can be given back right away
+  if (slots_[index].offset_ == heap_begin_) {
+    heap_begin_ += slots_[index].length_;
+  } else {
+    garbage_ += slots_[index].length_;
+  }
+  std::copy(slots_ + index + 1, slots_ + GetSize(), slots_ + index);
+  IncreaseSize(-1);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::Append(const MappingType *items, int size) {
+  for (int i = 0; i < size; i++) {
+    InsertAt(GetSize(), items[i].first, items[i].second);
+  }
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::Entries() const -> std::vector<MappingType> {
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize());
+  for (int i = 0; i < GetSize(); i++) {
+    entries.emplace_back(KeyAt(i), slots_[i].value_);
+  }
+  return entries;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::Rebuild(const std::vector<MappingType> &entries, int begin, int end,
+                                            const KeyType &low, const KeyType *high) {
+  SetSize(0);
+  SetFences(low, high);
+  Append(entries.data() + begin, end - begin);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::ChooseSplit(const std::vector<MappingType> &entries) const -> int {
+  int size = entries.size();
+  std::vector<int> bytes_before(size + 1, 0);
+  for (int i = 0; i < size; i++) {
+    bytes_before[i + 1] = bytes_before[i] + sizeof(Slot) + entries[i].first.GetLength();
+  }
+  int total = bytes_before[size];
+  // neither half may be under its min size, which with a small entry cap may take an even split by count
+  auto balanced = [&](int i) {
+    return !UnderMinSize(i, bytes_before[i]) && !UnderMinSize(size - i, total - bytes_before[i]);
+  };
+  int middle = 1;
+  while (middle < size - 1 && bytes_before[middle] * 2 < total) {
+    middle++;
+  }
+  if (!balanced(middle)) {
+    middle = size / 2;
+  }
+  // Any split point that leaves 40% to 60% of the bytes on either side will do, so take the one with the shortest
+  // split key: that key is what the parent holds for the new page. Ties go to the one nearest the middle.
+  int best = middle;
+  int best_length = SplitKey(IsLeafPage(), entries.data(), middle).GetLength();
+  for (int i = 1; i < size; i++) {
+    if (bytes_before[i] * 5 < total * 2 || bytes_before[i] * 5 > total * 3 || !balanced(i)) {
+      continue;
+    }
+    int length = SplitKey(IsLeafPage(), entries.data(), i).GetLength();
+    if (length < best_length || (length == best_length && std::abs(i - middle) < std::abs(best - middle))) {
+      best = i;
+      best_length = length;
+    }
+  }
+  return best;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::ChooseRedistribution(const std::vector<MappingType> &entries, const KeyType &low,
+                                                         const KeyType *high, int max_key_length) const -> int {
+  int size = entries.size();
+  int max_entries = BPlusTreePage::GetMaxSize() - 1;
+  std::vector<int> key_bytes_before(size + 1, 0);
+  for (int i = 0; i < size; i++) {
+    key_bytes_before[i + 1] = key_bytes_before[i] + entries[i].first.GetLength();
+  }
+  // Of the split points that leave both halves fitting, take the one nearest the middle by bytes whose key is short
+  // enough. The first key of an internal page is not stored, so it is not counted either.
+  int skip = IsLeafPage() ? 0 : 1;
+  int best = -1;
+  int best_distance = 0;
+  for (int i = 1; i < size; i++) {
+    if (i > max_entries || size - i > max_entries) {
+      continue;
+    }
+    KeyType split_key = SplitKey(IsLeafPage(), entries.data(), i);
+    if (static_cast<int>(split_key.GetLength()) > max_key_length) {
+      continue;
+    }
+    int left_bytes = key_bytes_before[i] - key_bytes_before[skip];
+    int right_bytes = key_bytes_before[size] - key_bytes_before[i + skip];
+    if (!Fits(i, i - skip, left_bytes, low, &split_key) ||
+        !Fits(size - i, size - i - skip, right_bytes, split_key, high)) {
+      continue;
+    }
+    if (UnderMinSize(i, i * static_cast<int>(sizeof(Slot)) + left_bytes) ||
+        UnderMinSize(size - i, (size - i) * static_cast<int>(sizeof(Slot)) + right_bytes)) {
+      continue;
+    }
+    int distance = std::abs((i * static_cast<int>(sizeof(Slot)) + key_bytes_before[i]) * 2 -
+                            (size * static_cast<int>(sizeof(Slot)) + key_bytes_before[size]));
+    if (best == -1 || distance < best_distance) {
+      best = i;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::ContiguousFreeBytes() const -> int {
+  return heap_begin_ - (VARCHAR_PAGE_HEADER_SIZE + GetSize() * static_cast<int>(sizeof(Slot)));
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::KeyBytes() const -> int {
+  int bytes = 0;
+  int keys = 0;
+  for (int i = IsLeafPage() ? 0 : 1; i < GetSize(); i++) {
+    bytes += slots_[i].length_;
+    keys++;
+  }
+  return bytes + keys * prefix_length_;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_PAGE_TYPE::AppendBytes(std::string_view bytes) -> uint16_t {
+  heap_begin_ -= bytes.size();
+  memcpy(Data() + heap_begin_, bytes.data(), bytes.size());
+  return heap_begin_;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_PAGE_TYPE::Compact() {
+  char copy[BUSTUB_PAGE_SIZE];
+  memcpy(copy, Data(), BUSTUB_PAGE_SIZE);
+  heap_begin_ = BUSTUB_PAGE_SIZE;
+  low_offset_ = AppendBytes(std::string_view(copy + low_offset_, low_length_));
+  if (high_length_ != NO_HIGH_FENCE) {
+    high_offset_ = AppendBytes(std::string_view(copy + high_offset_, high_length_));
+  }
+  for (int i = 0; i < GetSize(); i++) {
+    slots_[i].offset_ = AppendBytes(std::string_view(copy + slots_[i].offset_, slots_[i].length_));
+  }
+  garbage_ = 0;
+}
+
+/*****************************************************************************
+ * LEAF PAGE
+ *****************************************************************************/
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->InitPage(IndexPageType::LEAF_PAGE, page_id, parent_id, max_size);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return this->next_page_id_; }
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { this->next_page_id_ = next_page_id; }
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
+  // keys are compared bytewise on the page, which is the order of the comparator
+  return this->Search(key, 0, false);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::GetItem(int index) const -> MappingType {
+  return {this->KeyAt(index), this->slots_[index].value_};
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                                                const KeyComparator &comparator) -> int {
+  int index = KeyIndex(key, comparator);
+  if (index < this->GetSize() && comparator(this->KeyAt(index), key) == 0) {
+    return this->GetSize();
+  }
+  this->InsertAt(index, key, value);
+  return this->GetSize();
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value,
+                                                const KeyComparator &comparator) const -> bool {
+  int index = KeyIndex(key, comparator);
+  if (index == this->GetSize() || comparator(key, this->KeyAt(index)) != 0) {
+    return false;
+  }
+  *value = this->slots_[index].value_;
+  return true;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator)
+    -> int {
+  int index = KeyIndex(key, comparator);
+  if (index == this->GetSize() || comparator(key, this->KeyAt(index)) != 0) {
+    return this->GetSize();
+  }
+  this->RemoveAt(index);
+  return this->GetSize();
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  // Both halves are written anew: their key ranges are narrower than ours, so their prefixes may be longer.
+  std::vector<MappingType> entries = this->Entries();
+  int split = this->ChooseSplit(entries);
+  KeyType separator = this->SplitKey(true, entries.data(), split);
+  KeyType high_buffer;
+  const KeyType *high = this->HighKey(&high_buffer);
+  recipient->Rebuild(entries, split, entries.size(), separator, high);
+  this->Rebuild(entries, 0, split, this->LowKey(), &separator);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> entries = recipient->Entries();
+  std::vector<MappingType> ours = this->Entries();
+  entries.insert(entries.end(), ours.begin(), ours.end());
+  KeyType high_buffer;
+  recipient->Rebuild(entries, 0, entries.size(), recipient->LowKey(), this->HighKey(&high_buffer));
+  this->SetSize(0);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::RedistributeWith(BPlusTreeLeafPage *right, int max_key_length,
+                                                          KeyType *split_key) -> bool {
+  std::vector<MappingType> entries = this->Entries();
+  std::vector<MappingType> theirs = right->Entries();
+  entries.insert(entries.end(), theirs.begin(), theirs.end());
+  KeyType low = this->LowKey();
+  KeyType high_buffer;
+  const KeyType *high = right->HighKey(&high_buffer);
+  int split = this->ChooseRedistribution(entries, low, high, max_key_length);
+  if (split == -1) {
+    return false;
+  }
+  *split_key = this->SplitKey(true, entries.data(), split);
+  right->Rebuild(entries, split, entries.size(), *split_key, high);
+  this->Rebuild(entries, 0, split, low, split_key);
+  return true;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_LEAF_PAGE_TYPE::CopyNFrom(const MappingType *items, int size) { this->Append(items, size); }
+
+/*****************************************************************************
+ * INTERNAL PAGE
+ *****************************************************************************/
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  this->InitPage(IndexPageType::INTERNAL_PAGE, page_id, parent_id, max_size);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  return this->slots_[index].value_;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int i = 0; i < this->GetSize(); i++) {
+    if (this->slots_[i].value_ == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const
+    -> ValueType {
+  // upper bound from index 1, as the first key is not looked at: a page with a single child sends every key there
+  int index = this->Search(key, 1, true);
+  return ValueAt(index - 1);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                             const ValueType &new_value) {
+  // a new root covers all keys, so it has no prefix and new_key goes in whole
+  this->InsertAt(0, KeyType(), old_value);
+  this->InsertAt(1, new_key, new_value);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                             const ValueType &new_value) -> int {
+  this->InsertAt(ValueIndex(old_value) + 1, new_key, new_value);
+  return this->GetSize();
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  // the key must stay within the fences, so the prefix does not change
+  ValueType value = ValueAt(index);
+  this->RemoveAt(index);
+  this->InsertAt(index, key, value);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::Remove(int index) { this->RemoveAt(index); }
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() -> ValueType {
+  this->SetSize(0);
+  return ValueAt(0);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                                                       BufferPoolManager *buffer_pool_manager) {
+  std::vector<MappingType> entries = recipient->Entries();
+  int begin = entries.size();
+  std::vector<MappingType> ours = this->Entries();
+  // our first key is not stored, and in the recipient it is the key that its parent held for us
+  ours[0].first = middle_key;
+  entries.insert(entries.end(), ours.begin(), ours.end());
+  KeyType high_buffer;
+  recipient->Rebuild(entries, 0, entries.size(), recipient->LowKey(), this->HighKey(&high_buffer));
+  recipient->AdoptChildren(begin, buffer_pool_manager);
+  this->SetSize(0);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
+                                                        BufferPoolManager *buffer_pool_manager) {
+  // the first key of the recipient is the one that goes up into the parent, and becomes its low fence
+  std::vector<MappingType> entries = this->Entries();
+  int split = this->ChooseSplit(entries);
+  KeyType separator = entries[split].first;
+  KeyType high_buffer;
+  const KeyType *high = this->HighKey(&high_buffer);
+  recipient->Rebuild(entries, split, entries.size(), separator, high);
+  recipient->AdoptChildren(0, buffer_pool_manager);
+  this->Rebuild(entries, 0, split, this->LowKey(), &separator);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::RedistributeWith(BPlusTreeInternalPage *right, const KeyType &middle_key,
+                                                              int max_key_length, KeyType *split_key,
+                                                              BufferPoolManager *buffer_pool_manager) -> bool {
+  std::vector<MappingType> entries = this->Entries();
+  int size = entries.size();
+  std::vector<MappingType> theirs = right->Entries();
+  // the first key of the right page is not stored, and is middle_key here
+  theirs[0].first = middle_key;
+  entries.insert(entries.end(), theirs.begin(), theirs.end());
+  KeyType low = this->LowKey();
+  KeyType high_buffer;
+  const KeyType *high = right->HighKey(&high_buffer);
+  int split = this->ChooseRedistribution(entries, low, high, max_key_length);
+  if (split == -1) {
+    return false;
+  }
+  *split_key = entries[split].first;
+  right->Rebuild(entries, split, entries.size(), *split_key, high);
+  this->Rebuild(entries, 0, split, low, split_key);
+  // the children that moved get a new parent
+  if (split < size) {
+    right->AdoptChildren(0, buffer_pool_manager, size - split);
+  } else {
+    AdoptChildren(size, buffer_pool_manager);
+  }
+  return true;
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::CopyNFrom(const MappingType *items, int size,
+                                                       BufferPoolManager *buffer_pool_manager) {
+  int begin = this->GetSize();
+  this->Append(items, size);
+  AdoptChildren(begin, buffer_pool_manager);
+}
+
+VARCHAR_PAGE_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VARCHAR_INTERNAL_PAGE_TYPE::AdoptChildren(int begin, BufferPoolManager *buffer_pool_manager,
+                                                           int end) {
+  if (end == -1) {
+    end = this->GetSize();
+  }
+  for (int i = begin; i < end; i++) {
+    Page *child_page = buffer_pool_manager->FetchPage(ValueAt(i));
+    auto child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    child_node->SetParentPageId(this->GetPageId());
+    buffer_pool_manager->UnpinPage(child_page->GetPageId(), true);
+  }
+}
+
+static_assert(sizeof(BPlusTreeVarcharPage<RID, 64>) == VARCHAR_PAGE_HEADER_SIZE);
+static_assert(sizeof(BPlusTreeVarcharPage<page_id_t, 64>) == VARCHAR_PAGE_HEADER_SIZE);
+
+template class BPlusTreeVarcharPage<RID, 64>;
+template class BPlusTreeVarcharPage<page_id_t, 64>;
+template class BPlusTreeLeafPage<VarcharKey<64>, RID, VarcharComparator<64>>;
+template class BPlusTreeInternalPage<VarcharKey<64>, page_id_t, VarcharComparator<64>>;
+}  // namespace bustub
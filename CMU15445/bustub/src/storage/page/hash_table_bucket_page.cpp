@@ -11,6 +11,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,63 +23,135 @@
 
 namespace bustub {
 
+namespace {
+/** The 64 bits of a bitmap of num_bytes bytes from bit 64 * word on, the bits past its end being zero. */
+inline auto LoadBitmapWord(const char *bitmap, size_t num_bytes, size_t word) -> uint64_t {
+  uint64_t bits = 0;
+  memcpy(&bits, bitmap + word * sizeof(uint64_t), std::min(sizeof(uint64_t), num_bytes - word * sizeof(uint64_t)));
+  return bits;
+}
+}  // namespace
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+  bool found = false;
+  for (uint32_t i = NextReadable(0); i < BUCKET_ARRAY_SIZE; i = NextReadable(i + 1)) {
+    if (cmp(array_[i].first, key) == 0) {
+      result->push_back(array_[i].second);
+      found = true;
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
-  return true;
+  for (uint32_t i = NextReadable(0); i < BUCKET_ARRAY_SIZE; i = NextReadable(i + 1)) {
+    if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      return false;
+    }
+  }
+  // the first slot that is not readable, found a word of the bitmap at a time
+  constexpr size_t num_bytes = sizeof(readable_);
+  for (size_t word = 0; word * sizeof(uint64_t) < num_bytes; word++) {
+    uint64_t free = ~LoadBitmapWord(readable_, num_bytes, word);
+    if (free == 0) {
+      continue;
+    }
+    auto bucket_idx = static_cast<uint32_t>(word * 64 + __builtin_ctzll(free));
+    if (bucket_idx >= BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    array_[bucket_idx] = MappingType(key, value);
+    SetOccupied(bucket_idx);
+    SetReadable(bucket_idx);
+    return true;
+  }
+  return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  for (uint32_t i = NextReadable(0); i < BUCKET_ARRAY_SIZE; i = NextReadable(i + 1)) {
+    if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      RemoveAt(i);
+      return true;
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+auto HASH_TABLE_BUCKET_TYPE::NextReadable(uint32_t bucket_idx) const -> uint32_t {
+  constexpr size_t num_bytes = sizeof(readable_);
+  size_t word = bucket_idx / 64;
+  if (word * sizeof(uint64_t) >= num_bytes) {
+    return BUCKET_ARRAY_SIZE;
+  }
+  // mask off the slots before bucket_idx in its own word, then skip over empty words
+  uint64_t bits = LoadBitmapWord(readable_, num_bytes, word) & (~uint64_t{0} << (bucket_idx % 64));
+  while (bits == 0) {
+    if (++word * sizeof(uint64_t) >= num_bytes) {
+      return BUCKET_ARRAY_SIZE;
+    }
+    bits = LoadBitmapWord(readable_, num_bytes, word);
+  }
+  return static_cast<uint32_t>(word * 64 + __builtin_ctzll(bits));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+  constexpr size_t num_bytes = sizeof(readable_);
+  uint32_t count = 0;
+  for (size_t word = 0; word * sizeof(uint64_t) < num_bytes; word++) {
+    count += __builtin_popcountll(LoadBitmapWord(readable_, num_bytes, word));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+  return NextReadable(0) == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -0,0 +1,234 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_swiss_page.cpp
+//
+// Identification: src/storage/page/hash_table_swiss_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_swiss_page.h"
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "common/logger.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+namespace {
+/** @return bit i set for each of the SWISS_GROUP_SIZE control bytes ctrl[i] equal to byte */
+inline auto MatchControlBytes(const uint8_t *ctrl, uint8_t byte) -> uint32_t {
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(byte)))));
+#elif defined(__SSE2__)
+  __m128i pattern = _mm_set1_epi8(static_cast<char>(byte));
+  __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+  __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl + 16));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, pattern))) |
+         static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, pattern))) << 16;
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+    mask |= static_cast<uint32_t>(ctrl[i] == byte) << i;
+  }
+  return mask;
+#endif
+}
+
+/** @return bit i set for each of the SWISS_GROUP_SIZE control bytes ctrl[i] with the high bit set */
+inline auto MatchHighBits(const uint8_t *ctrl) -> uint32_t {
+#if defined(__AVX2__)
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(ctrl))));
+#elif defined(__SSE2__)
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))) |
+         static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl + 16))))
+             << 16;
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < SWISS_GROUP_SIZE; i++) {
+    mask |= static_cast<uint32_t>(ctrl[i] >> 7) << i;
+  }
+  return mask;
+#endif
+}
+}  // namespace
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::ValidMask(uint32_t group) -> uint32_t {
+  uint32_t valid = SWISS_ARRAY_SIZE - group * SWISS_GROUP_SIZE;
+  return valid >= SWISS_GROUP_SIZE ? ~uint32_t{0} : (uint32_t{1} << valid) - 1;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::Match(uint32_t group, uint8_t byte) const -> uint32_t {
+  return MatchControlBytes(ctrl_ + group * SWISS_GROUP_SIZE, byte);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::MatchReadable(uint32_t group) const -> uint32_t {
+  return MatchHighBits(ctrl_ + group * SWISS_GROUP_SIZE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::GetValue(const KeyType &key, uint64_t hash, KeyComparator cmp,
+                                     std::vector<ValueType> *result, bool *probe_ended) const -> bool {
+  uint64_t mixed = Mix(hash);
+  uint8_t fingerprint = FingerprintOf(mixed);
+  uint32_t group = HomeGroupOf(mixed);
+  bool found = false;
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t hits = Match(group, fingerprint); hits != 0; hits &= hits - 1) {
+      uint32_t slot = group * SWISS_GROUP_SIZE + __builtin_ctz(hits);
+      if (cmp(array_[slot].first, key) == 0) {
+        result->push_back(array_[slot].second);
+        found = true;
+      }
+    }
+    if ((Match(group, EMPTY) & ValidMask(group)) != 0) {
+      if (probe_ended != nullptr) {
+        *probe_ended = true;
+      }
+      return found;
+    }
+    group = group + 1 == NUM_GROUPS ? 0 : group + 1;
+  }
+  if (probe_ended != nullptr) {
+    *probe_ended = false;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::Find(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp,
+                                 bool *probe_ended) const -> uint32_t {
+  uint64_t mixed = Mix(hash);
+  uint8_t fingerprint = FingerprintOf(mixed);
+  uint32_t group = HomeGroupOf(mixed);
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t hits = Match(group, fingerprint); hits != 0; hits &= hits - 1) {
+      uint32_t slot = group * SWISS_GROUP_SIZE + __builtin_ctz(hits);
+      if (cmp(array_[slot].first, key) == 0 && array_[slot].second == value) {
+        return slot;
+      }
+    }
+    if ((Match(group, EMPTY) & ValidMask(group)) != 0) {
+      if (probe_ended != nullptr) {
+        *probe_ended = true;
+      }
+      return SWISS_ARRAY_SIZE;
+    }
+    group = group + 1 == NUM_GROUPS ? 0 : group + 1;
+  }
+  if (probe_ended != nullptr) {
+    *probe_ended = false;
+  }
+  return SWISS_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::Insert(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp)
+    -> bool {
+  uint64_t mixed = Mix(hash);
+  uint8_t fingerprint = FingerprintOf(mixed);
+  uint32_t group = HomeGroupOf(mixed);
+  // the probe goes on to its end to rule out a duplicate, remembering the first free slot on the way
+  uint32_t free_slot = SWISS_ARRAY_SIZE;
+  for (uint32_t probes = 0; probes < NUM_GROUPS; probes++) {
+    for (uint32_t hits = Match(group, fingerprint); hits != 0; hits &= hits - 1) {
+      uint32_t slot = group * SWISS_GROUP_SIZE + __builtin_ctz(hits);
+      if (cmp(array_[slot].first, key) == 0 && array_[slot].second == value) {
+        return false;
+      }
+    }
+    uint32_t empty = Match(group, EMPTY) & ValidMask(group);
+    if (free_slot == SWISS_ARRAY_SIZE) {
+      uint32_t free = empty | Match(group, DELETED);
+      if (free != 0) {
+        free_slot = group * SWISS_GROUP_SIZE + __builtin_ctz(free);
+      }
+    }
+    if (empty != 0) {
+      break;
+    }
+    group = group + 1 == NUM_GROUPS ? 0 : group + 1;
+  }
+  if (free_slot == SWISS_ARRAY_SIZE) {
+    return false;
+  }
+  if (ctrl_[free_slot] == DELETED) {
+    num_deleted_--;
+  }
+  ctrl_[free_slot] = fingerprint;
+  array_[free_slot] = MappingType(key, value);
+  num_readable_++;
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::Remove(const KeyType &key, const ValueType &value, uint64_t hash, KeyComparator cmp,
+                                   bool *probe_ended) -> bool {
+  uint32_t slot = Find(key, value, hash, cmp, probe_ended);
+  if (slot == SWISS_ARRAY_SIZE) {
+    return false;
+  }
+  RemoveAt(slot);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_SWISS_TYPE::RemoveAt(uint32_t bucket_idx) {
+  uint32_t group = bucket_idx / SWISS_GROUP_SIZE;
+  if ((Match(group, EMPTY) & ValidMask(group)) != 0) {
+    ctrl_[bucket_idx] = EMPTY;
+  } else {
+    ctrl_[bucket_idx] = DELETED;
+    num_deleted_++;
+  }
+  num_readable_--;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_SWISS_TYPE::NextReadable(uint32_t bucket_idx) const -> uint32_t {
+  uint32_t group = bucket_idx / SWISS_GROUP_SIZE;
+  if (group >= NUM_GROUPS) {
+    return SWISS_ARRAY_SIZE;
+  }
+  // mask off the slots before bucket_idx in its own group, then skip over groups with nothing readable
+  uint32_t readable = MatchReadable(group) & (~uint32_t{0} << (bucket_idx % SWISS_GROUP_SIZE));
+  while (readable == 0) {
+    if (++group == NUM_GROUPS) {
+      return SWISS_ARRAY_SIZE;
+    }
+    readable = MatchReadable(group);
+  }
+  return group * SWISS_GROUP_SIZE + __builtin_ctz(readable);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_SWISS_TYPE::Clear() {
+  static_assert(sizeof(HashTableSwissPage) - sizeof(MappingType) + SWISS_ARRAY_SIZE * sizeof(MappingType) <=
+                    BUSTUB_PAGE_SIZE,
+                "the counters, the control bytes and the pairs have to fit in a page");
+  num_readable_ = 0;
+  num_deleted_ = 0;
+  memset(ctrl_, EMPTY, sizeof(ctrl_));
+}
+
+template class HashTableSwissPage<int, int, IntComparator>;
+
+template class HashTableSwissPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableSwissPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableSwissPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableSwissPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableSwissPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
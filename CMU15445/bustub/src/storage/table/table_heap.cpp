@@ -156,9 +156,10 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock,
+                         AccessType access_type) -> bool {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), access_type));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -182,7 +183,7 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
@@ -196,6 +197,36 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   return {this, rid, txn};
 }
 
+auto TableHeap::GetPageIds() -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(page_id);
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
+    page->RLatch();
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return page_ids;
+}
+
+void TableHeap::GetPageTuples(page_id_t page_id, Transaction *txn, std::vector<Tuple> *tuples) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, AccessType::Scan));
+  page->RLatch();
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    // read in place, as tuples are not movable
+    tuples->emplace_back();
+    if (!page->GetTuple(rid, &tuples->back(), txn, lock_manager_)) {
+      tuples->pop_back();
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
 
 }  // namespace bustub
@@ -21,7 +21,7 @@ namespace bustub {
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, true, AccessType::Scan)) {
       throw bustub::Exception("read non-existing tuple");
     }
   }
@@ -39,19 +39,27 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), AccessType::Scan));
   BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
 
   cur_page->RLatch();
+  if (read_ahead_page_id_ == INVALID_PAGE_ID) {
+    ReadAhead(cur_page);
+  }
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), AccessType::Scan));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      if (read_ahead_pages_ > 0) {
+        read_ahead_pages_--;
+      }
+      ReadAhead(cur_page);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -62,7 +70,7 @@ auto TableIterator::operator++() -> TableIterator & {
   if (*this != table_heap_->End()) {
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
+    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false, AccessType::Scan)) {
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       throw bustub::Exception("read non-existing tuple");
@@ -74,6 +82,37 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+void TableIterator::ReadAhead(TablePage *cur_page) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (read_ahead_pages_ == 0) {
+    read_ahead_page_id_ = cur_page->GetTablePageId();
+  }
+  while (read_ahead_pages_ < READ_AHEAD_PAGES) {
+    // Only the last page read ahead knows where the chain goes next, so extending the window may wait for that one
+    // read. The pages between it and cur_page are already on their way.
+    page_id_t next_page_id;
+    if (read_ahead_page_id_ == cur_page->GetTablePageId()) {
+      next_page_id = cur_page->GetNextPageId();
+    } else {
+      auto frontier_page =
+          static_cast<TablePage *>(buffer_pool_manager->FetchPage(read_ahead_page_id_, AccessType::Scan));
+      if (frontier_page == nullptr) {
+        return;
+      }
+      frontier_page->RLatch();
+      next_page_id = frontier_page->GetNextPageId();
+      frontier_page->RUnlatch();
+      buffer_pool_manager->UnpinPage(read_ahead_page_id_, false);
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    buffer_pool_manager->PrefetchPage(next_page_id, AccessType::Scan);
+    read_ahead_page_id_ = next_page_id;
+    read_ahead_pages_++;
+  }
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
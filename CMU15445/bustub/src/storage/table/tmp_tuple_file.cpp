@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_file.cpp
+//
+// Identification: src/storage/table/tmp_tuple_file.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_file.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+TmpTupleFile::~TmpTupleFile() {
+  FinishWriting();
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+void TmpTupleFile::Append(const Tuple &tuple) {
+  BUSTUB_ASSERT(tuple.GetLength() <= TmpTuplePage::MaxTupleSize(BUSTUB_PAGE_SIZE), "tuple does not fit a page");
+  if (write_page_ == nullptr && !page_ids_.empty()) {
+    write_page_ = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_.back()));
+    if (write_page_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill tuples to");
+    }
+  }
+  TmpTuple out(INVALID_PAGE_ID, 0);
+  if (write_page_ != nullptr && write_page_->Insert(tuple, &out)) {
+    num_tuples_++;
+    return;
+  }
+  FinishWriting();
+  page_id_t page_id;
+  write_page_ = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (write_page_ == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free frame to spill tuples to");
+  }
+  write_page_->Init(page_id, BUSTUB_PAGE_SIZE);
+  page_ids_.push_back(page_id);
+  write_page_->Insert(tuple, &out);
+  num_tuples_++;
+}
+
+void TmpTupleFile::FinishWriting() {
+  if (write_page_ != nullptr) {
+    bpm_->UnpinPage(write_page_->GetTablePageId(), true);
+    write_page_ = nullptr;
+  }
+}
+
+auto TmpTupleFile::Reader::Next(Tuple *tuple) -> bool {
+  while (cursor_ >= tuples_.size()) {
+    if (page_index_ >= file_->page_ids_.size()) {
+      return false;
+    }
+    auto page_id = file_->page_ids_[page_index_++];
+    auto *page = reinterpret_cast<TmpTuplePage *>(file_->bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, fmt::format("no free frame to read spilled page {}", page_id));
+    }
+    // the tuples of a page go from the newest to the oldest one
+    tuples_.clear();
+    for (auto offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;) {
+      offset = page->Get(offset, &tuples_.emplace_back());
+    }
+    std::reverse(tuples_.begin(), tuples_.end());
+    file_->bpm_->UnpinPage(page_id, false);
+    cursor_ = 0;
+  }
+  *tuple = tuples_[cursor_++];
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_flush_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_flush_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_posix.h"
+
+namespace bustub {
+
+namespace {
+
+/** Dirties every page of the pool. */
+void DirtyAllPages(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, char value) {
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    std::memset(page->GetData(), value, BUSTUB_PAGE_SIZE);
+    bpm->UnpinPage(page_id, true);
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllPagesTest) {
+  const size_t buffer_pool_size = 50;
+  for (bool use_io_uring : {false, true}) {
+    auto *disk_manager = new DiskManagerPosix("test.db", false, use_io_uring);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      page_ids.push_back(page_id);
+    }
+    DirtyAllPages(bpm, page_ids, 'a');
+    // A pinned page is flushed as well, and stays pinned.
+    auto *pinned = bpm->FetchPage(page_ids[0]);
+    bpm->FlushAllPages();
+    EXPECT_EQ(static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+    EXPECT_EQ(1, pinned->GetPinCount());
+    bpm->UnpinPage(page_ids[0], false);
+
+    // Nothing is dirty any more, so a second flush writes nothing.
+    bpm->FlushAllPages();
+    EXPECT_EQ(static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+    char buf[BUSTUB_PAGE_SIZE];
+    for (auto page_id : page_ids) {
+      disk_manager->ReadPage(page_id, buf);
+      EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, 'a'), std::string(buf, BUSTUB_PAGE_SIZE));
+    }
+
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CheckpointStallBenchmark) {
+  const size_t buffer_pool_size = 1024;
+
+  std::cout << "Time to checkpoint a buffer pool of " << buffer_pool_size
+            << " dirty pages: one FlushPage at a time vs. FlushAllPages" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int backend = 0; backend < 3; backend++) {
+    std::unique_ptr<DiskManager> disk_manager;
+    std::string name;
+    if (backend == 0) {
+      disk_manager = std::make_unique<DiskManager>("test.db");
+      name = "fstream:              ";
+    } else {
+      auto posix = std::make_unique<DiskManagerPosix>("test.db", true, backend == 2);
+      name = posix->UsesIoUring() ? "pwrite+io_uring:      " : "pwrite+thread pool:   ";
+      if (!posix->IsDirectIo()) {
+        name += "(no O_DIRECT) ";
+      }
+      disk_manager = std::move(posix);
+    }
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      page_ids.push_back(page_id);
+    }
+
+    DirtyAllPages(bpm.get(), page_ids, 'a');
+    auto start = std::chrono::steady_clock::now();
+    for (auto page_id : page_ids) {
+      bpm->FlushPage(page_id);
+    }
+    disk_manager->Sync();
+    auto one_at_a_time = std::chrono::steady_clock::now() - start;
+
+    DirtyAllPages(bpm.get(), page_ids, 'b');
+    start = std::chrono::steady_clock::now();
+    bpm->FlushAllPages();
+    auto batched = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << "one at a time="
+              << std::chrono::duration_cast<std::chrono::microseconds>(one_at_a_time).count() / 1000.0
+              << "ms FlushAllPages=" << std::chrono::duration_cast<std::chrono::microseconds>(batched).count() / 1000.0
+              << "ms" << std::endl;
+
+    bpm.reset();
+    disk_manager->ShutDown();
+    disk_manager.reset();
+    remove("test.db");
+    remove("test.log");
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -12,13 +12,19 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "common/logger.h"
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -146,4 +152,171 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Write 2 * buffer_pool_size pages, so that the first half has been evicted by the time we are done.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Prefetched pages can be fetched and hold what was written to them, whether the fetch comes before or
+  // after the read has completed.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 2); ++page_id) {
+    bpm->PrefetchPage(page_id, AccessType::Scan);
+  }
+  char expected[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size / 2); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: Prefetching a page that is already resident, or an invalid page id, does nothing.
+  bpm->PrefetchPage(0);
+  bpm->PrefetchPage(INVALID_PAGE_ID);
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+
+  // Scenario: Once every frame is pinned, prefetching is a no-op, and the pinned pages are left alone.
+  std::vector<page_id_t> pinned{0};
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pinned.push_back(page_id_temp);
+  }
+  bpm->PrefetchPage(buffer_pool_size);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  for (auto page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // The buffer pool waits for outstanding prefetches, so delete it before shutting down the disk.
+  bpm->PrefetchPage(buffer_pool_size + 1);
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t clean_target = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The cleaner writes back the pages that are going to be evicted next, but no more than that.
+  bpm->StartPageCleaner(clean_target);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (bpm->GetBackgroundWriteBacks() < clean_target && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(3 * PAGE_CLEANER_INTERVAL_MS));
+  EXPECT_EQ(clean_target, bpm->GetBackgroundWriteBacks());
+
+  // Scenario: Evicting the cleaned pages does not write anything in the foreground.
+  for (size_t i = 0; i < clean_target; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteBacks());
+
+  // Scenario: Pages written back by the cleaner read back correctly.
+  bpm->StopPageCleaner();
+  char expected[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(clean_target); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitMissTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  const size_t num_threads = 8;
+  const size_t num_fetches = 20000;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, 2);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Hits pin frames without the latch while misses keep handing frames to other pages. Every fetch still
+  // gets the page it asked for, with its contents, and nothing is left pinned.
+  std::vector<std::thread> threads;
+  std::atomic<size_t> wrong_pages{0};
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<page_id_t> hot(0, 3);
+      std::uniform_int_distribution<page_id_t> cold(4, num_pages - 1);
+      char expected[BUSTUB_PAGE_SIZE];
+      for (size_t i = 0; i < num_fetches; ++i) {
+        page_id_t page_id = i % 2 == 0 ? cold(rng) : hot(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          wrong_pages++;
+          continue;
+        }
+        snprintf(expected, BUSTUB_PAGE_SIZE, "page %d", page_id);
+        if (page->GetPageId() != page_id || strcmp(page->GetData(), expected) != 0) {
+          wrong_pages++;
+        }
+        bpm->UnpinPage(page_id, i % 8 == 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong_pages);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
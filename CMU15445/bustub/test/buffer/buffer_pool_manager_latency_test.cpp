@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_latency_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_latency_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage_test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, HitLatencyWithMissesInFlightBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 16;
+  const size_t num_cold_pages = 512;
+  const size_t num_hit_threads = 2;
+  const size_t num_miss_threads = 2;
+  const size_t hits_per_thread = 2000;
+  // Hits are issued at a steady pace, so that the samples are spread evenly over the time the misses take.
+  const auto think_time = std::chrono::microseconds(100);
+
+  SlowDiskManager disk_manager(std::chrono::microseconds(500), std::chrono::microseconds(500));
+  BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, 2);
+
+  // Every page is written once, so that later misses have something to read.
+  std::vector<page_id_t> hot_pages;
+  std::vector<page_id_t> cold_pages;
+  for (size_t i = 0; i < num_hot_pages + num_cold_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    page->GetData()[0] = static_cast<char>(page_id);
+    ASSERT_TRUE(bpm.UnpinPage(page_id, true));
+    (i < num_hot_pages ? hot_pages : cold_pages).push_back(page_id);
+  }
+  bpm.FlushAllPages();
+  // Warm up the hot set so that it has k accesses and is never chosen over a cold page.
+  for (size_t round = 0; round < 2; round++) {
+    for (auto page_id : hot_pages) {
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+      ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> miss_threads;
+  for (size_t tid = 0; tid < num_miss_threads; tid++) {
+    miss_threads.emplace_back([&, tid]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, cold_pages.size() - 1);
+      while (!stop) {
+        page_id_t page_id = cold_pages[dist(rng)];
+        auto *page = bpm.FetchPage(page_id);
+        if (page != nullptr) {
+          EXPECT_EQ(static_cast<char>(page_id), page->GetData()[0]);
+          bpm.UnpinPage(page_id, tid % 2 == 0);
+        }
+      }
+    });
+  }
+
+  std::vector<std::vector<int64_t>> latencies(num_hit_threads);
+  std::vector<std::thread> hit_threads;
+  for (size_t tid = 0; tid < num_hit_threads; tid++) {
+    hit_threads.emplace_back([&, tid]() {
+      std::mt19937 rng(tid + num_miss_threads);
+      std::uniform_int_distribution<size_t> dist(0, hot_pages.size() - 1);
+      latencies[tid].reserve(hits_per_thread);
+      for (size_t i = 0; i < hits_per_thread; i++) {
+        page_id_t page_id = hot_pages[dist(rng)];
+        auto start = std::chrono::steady_clock::now();
+        auto *page = bpm.FetchPage(page_id);
+        auto end = std::chrono::steady_clock::now();
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(static_cast<char>(page_id), page->GetData()[0]);
+        bpm.UnpinPage(page_id, false);
+        latencies[tid].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        std::this_thread::sleep_for(think_time);
+      }
+    });
+  }
+  for (auto &thread : hit_threads) {
+    thread.join();
+  }
+  stop = true;
+  for (auto &thread : miss_threads) {
+    thread.join();
+  }
+
+  std::vector<int64_t> all;
+  for (auto &thread_latencies : latencies) {
+    all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  std::cout << "Latency of buffer pool hits while misses to a 500us disk are in flight" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "p50: " << all[all.size() / 2] / 1000.0 << "us" << std::endl;
+  std::cout << "p99: " << all[all.size() * 99 / 100] / 1000.0 << "us" << std::endl;
+  std::cout << "max: " << all.back() / 1000.0 << "us" << std::endl;
+  std::cout << ">>> END" << std::endl;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerInsertLatencyBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t clean_target = 16;
+  const size_t num_inserts = 2000;
+  // Time spent filling each page, during which the cleaner can get ahead of the evictions.
+  const auto fill_time = std::chrono::microseconds(300);
+
+  std::cout << "Latency of NewPage() while appending dirty pages to a full pool on a 500us disk" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool use_cleaner : {false, true}) {
+    SlowDiskManager disk_manager(std::chrono::microseconds(500), std::chrono::microseconds(500));
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager, 2);
+    if (use_cleaner) {
+      bpm.StartPageCleaner(clean_target);
+    }
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(num_inserts);
+    for (size_t i = 0; i < num_inserts; i++) {
+      page_id_t page_id;
+      auto start = std::chrono::steady_clock::now();
+      auto *page = bpm.NewPage(&page_id);
+      auto end = std::chrono::steady_clock::now();
+      ASSERT_NE(nullptr, page);
+      latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+      page->GetData()[0] = static_cast<char>(page_id);
+      std::this_thread::sleep_for(fill_time);
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.StopPageCleaner();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << (use_cleaner ? "page cleaner:    " : "no page cleaner: ") << "p50=" << latencies[num_inserts / 2] / 1000.0
+              << "us p99=" << latencies[num_inserts * 99 / 100] / 1000.0 << "us max=" << latencies.back() / 1000.0
+              << "us foreground write-backs=" << bpm.GetForegroundWriteBacks()
+              << " background write-backs=" << bpm.GetBackgroundWriteBacks() << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_scan_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/table_page.h"
+#include "storage_test_util.h"  // NOLINT
+#include "test_util.h"     // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** Number of disk reads issued by the current thread. */
+thread_local size_t reads_by_this_thread = 0;
+
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  ~CountingDiskManager() override { StopIoThreads(); }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    reads_by_this_thread++;
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+};
+
+/** Reads every tuple of the table the way TableIterator does, with the given access type. */
+void ScanTable(BufferPoolManager *bpm, page_id_t first_page_id, AccessType access_type) {
+  Transaction txn(0);
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id, access_type));
+    ASSERT_NE(nullptr, page);
+    RID rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      auto *tuple_page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id, access_type));
+      Tuple tuple;
+      tuple_page->GetTuple(rid, &tuple, &txn, nullptr);
+      bpm->UnpinPage(page_id, false);
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, IndexHitRateUnderScansBenchmark) {
+  const size_t buffer_pool_size = 128;
+  const size_t num_rows = 1000000;
+  const int64_t num_keys = 20000;
+  const size_t num_lookups = 50000;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto table_schema = ParseCreateStatement("a bigint,b bigint");
+
+  std::cout << "Index point lookup hit rate while another thread scans a " << num_rows << "-row table" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (auto scan_access_type : {AccessType::Unknown, AccessType::Scan}) {
+    CountingDiskManager disk_manager;
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+    page_id_t header_page_id;
+    bpm.NewPage(&header_page_id);
+
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", &bpm, comparator);
+    GenericKey<8> index_key;
+    Transaction txn(0);
+    for (int64_t key = 1; key <= num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key)), &txn);
+    }
+    page_id_t first_page_id = BuildTable(&bpm, table_schema.get(), num_rows);
+
+    // Warm up the index, so that every miss afterwards is a page the scan pushed out.
+    std::vector<RID> result;
+    for (int64_t key = 1; key <= num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &result);
+    }
+
+    std::atomic<bool> stop{false};
+    std::thread scanner([&]() {
+      while (!stop) {
+        ScanTable(&bpm, first_page_id, scan_access_type);
+      }
+    });
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int64_t> dist(1, num_keys);
+    reads_by_this_thread = 0;
+    for (size_t i = 0; i < num_lookups; i++) {
+      index_key.SetFromInteger(dist(rng));
+      result.clear();
+      EXPECT_TRUE(tree.GetValue(index_key, &result));
+      // Give the scanner a chance to run between lookups even on a single core.
+      if (i % 64 == 0) {
+        std::this_thread::yield();
+      }
+    }
+    size_t lookup_misses = reads_by_this_thread;
+    stop = true;
+    scanner.join();
+
+    bpm.UnpinPage(header_page_id, true);
+    std::cout << (scan_access_type == AccessType::Scan ? "scan hint:    " : "no hint:      ")
+              << "index page misses per 1000 lookups=" << lookup_misses * 1000 / num_lookups << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Counts the data TLB misses of the calling thread, if the machine exposes the counter. */
+class TlbMissCounter {
+ public:
+  TlbMissCounter() {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  ~TlbMissCounter() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  void Start() {
+#ifdef __linux__
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  /** @return the misses since Start(), or -1 if they cannot be counted */
+  auto Stop() -> int64_t {
+    int64_t count = -1;
+#ifdef __linux__
+    if (fd_ < 0) {
+      return count;
+    }
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      return -1;
+    }
+#endif
+    return count;
+  }
+
+ private:
+  int fd_{-1};
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, FrameLayoutTest) {
+  const size_t num_frames = 1000;
+  for (bool huge_pages : {false, true}) {
+    FrameArena arena(num_frames, huge_pages, NumaPolicy::Interleave, 0);
+    if (!huge_pages) {
+      EXPECT_EQ(FrameArena::Backing::SmallPages, arena.GetBacking());
+    }
+    for (frame_id_t frame_id = 0; frame_id < static_cast<frame_id_t>(num_frames); frame_id++) {
+      char *data = arena.FrameData(frame_id);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE);
+      EXPECT_EQ(0, data[0]);
+      EXPECT_EQ(0, data[BUSTUB_PAGE_SIZE - 1]);
+      memset(data, static_cast<char>(frame_id), BUSTUB_PAGE_SIZE);
+    }
+    for (frame_id_t frame_id = 0; frame_id < static_cast<frame_id_t>(num_frames); frame_id++) {
+      char *data = arena.FrameData(frame_id);
+      EXPECT_EQ(static_cast<char>(frame_id), data[0]);
+      EXPECT_EQ(static_cast<char>(frame_id), data[BUSTUB_PAGE_SIZE - 1]);
+    }
+  }
+}
+
+// Allocates two 1GB pools, too much for the sanitizers on a CI machine; run with --gtest_also_run_disabled_tests
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, DISABLED_FetchThroughputBenchmark) {
+  // 1GB of frames: large enough that 4KB pages overflow the TLB many times over, small enough for a test machine.
+  const size_t buffer_pool_size = 256 * 1024;
+  const size_t num_fetches = 1000000;
+
+  std::cout << "Random FetchPage() hits on a " << buffer_pool_size * BUSTUB_PAGE_SIZE / (1024 * 1024)
+            << "MB buffer pool, 4KB vs 2MB pages" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  bool huge_pages_before = buffer_pool_huge_pages;
+  for (bool huge_pages : {false, true}) {
+    buffer_pool_huge_pages = huge_pages;
+    DiskManagerUnlimitedMemory disk_manager;
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, &disk_manager);
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      page->GetData()[BUSTUB_PAGE_SIZE / 2] = static_cast<char>(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> dist(0, buffer_pool_size - 1);
+    std::vector<page_id_t> page_ids(num_fetches);
+    for (auto &page_id : page_ids) {
+      page_id = dist(rng);
+    }
+    TlbMissCounter tlb_misses;
+    uint64_t checksum = 0;
+    tlb_misses.Start();
+    auto start = std::chrono::steady_clock::now();
+    for (auto page_id : page_ids) {
+      auto *page = bpm->FetchPage(page_id);
+      checksum += static_cast<unsigned char>(page->GetData()[BUSTUB_PAGE_SIZE / 2]);
+      bpm->UnpinPage(page_id, false);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    int64_t misses = tlb_misses.Stop();
+
+    // The same accesses straight to the frames, which is the part of a fetch that the page size can speed up.
+    Page *pages = bpm->GetPages();
+    start = std::chrono::steady_clock::now();
+    for (auto page_id : page_ids) {
+      checksum += static_cast<unsigned char>(pages[page_id].GetData()[BUSTUB_PAGE_SIZE / 2]);
+    }
+    auto raw_elapsed = std::chrono::steady_clock::now() - start;
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    std::cout << (huge_pages ? "2MB pages: " : "4KB pages: ")
+              << "fetches/s=" << static_cast<int64_t>(num_fetches * 1000.0 / std::max<int64_t>(ms, 1))
+              << " dTLB misses/fetch=";
+    if (misses >= 0) {
+      std::cout << static_cast<double>(misses) / num_fetches;
+    } else {
+      std::cout << "n/a";
+    }
+    std::cout << " ns/frame access="
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(raw_elapsed).count() / num_fetches
+              << " (checksum " << checksum << ")" << std::endl;
+  }
+  buffer_pool_huge_pages = huge_pages_before;
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -4,7 +4,9 @@
 
 #include "buffer/lru_k_replacer.h"
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <memory>
 #include <random>
 #include <set>
@@ -101,4 +103,67 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, EvictionCandidatesTest) {
+  const size_t num_frames = 64;
+  LRUKReplacer lru_replacer(num_frames, 2);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<frame_id_t> dist(0, num_frames - 1);
+  for (size_t i = 0; i < 4 * num_frames; i++) {
+    lru_replacer.RecordAccess(dist(rng));
+  }
+  for (frame_id_t frame_id = 0; frame_id < static_cast<frame_id_t>(num_frames); frame_id += 3) {
+    lru_replacer.SetEvictable(frame_id, false);
+  }
+
+  // The candidates are exactly the frames Evict() returns, in the same order, and peeking does not evict anything.
+  size_t size = lru_replacer.Size();
+  auto candidates = lru_replacer.EvictionCandidates(10);
+  ASSERT_EQ(10, candidates.size());
+  ASSERT_EQ(size, lru_replacer.Size());
+  ASSERT_EQ(size, lru_replacer.EvictionCandidates(num_frames).size());
+  for (auto candidate : candidates) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+    ASSERT_EQ(candidate, frame_id);
+  }
+}
+
+TEST(LRUKReplacerTest, EvictRecordAccessBenchmark) {
+  const size_t k = 2;
+  const size_t num_ops = 20000;
+
+  std::cout << "Cost of an Evict + RecordAccess + SetEvictable round with 1% of the frames pinned" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_frames : {1000, 100000, 1000000}) {
+    LRUKReplacer lru_replacer(num_frames, k);
+    // The oldest frames are pinned, like the pages a long-running query holds on to.
+    const size_t num_pinned = num_frames / 100;
+    for (size_t i = 0; i < num_frames; i++) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      lru_replacer.RecordAccess(frame_id);
+      lru_replacer.SetEvictable(frame_id, i >= num_pinned);
+    }
+    ASSERT_EQ(num_frames - num_pinned, lru_replacer.Size());
+
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<size_t> dist(num_pinned, num_frames - 1);
+    auto clock_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_ops; i++) {
+      frame_id_t frame_id;
+      ASSERT_TRUE(lru_replacer.Evict(&frame_id));
+      lru_replacer.RecordAccess(frame_id);
+      lru_replacer.SetEvictable(frame_id, true);
+      // Hit on some other resident frame.
+      auto hit = static_cast<frame_id_t>(dist(rng));
+      lru_replacer.RecordAccess(hit);
+      lru_replacer.SetEvictable(hit, true);
+    }
+    auto clock_end = std::chrono::steady_clock::now();
+    auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start);
+    std::cout << "frames=" << num_frames << " ns/round=" << dur.count() / num_ops << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
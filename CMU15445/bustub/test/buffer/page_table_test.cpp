@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable table(8);
+  frame_id_t frame_id;
+  EXPECT_FALSE(table.Find(1, frame_id));
+  table.Insert(1, 3);
+  table.Insert(2, 4);
+  EXPECT_TRUE(table.Find(1, frame_id));
+  EXPECT_EQ(3, frame_id);
+  table.Insert(1, 5);
+  EXPECT_TRUE(table.Find(1, frame_id));
+  EXPECT_EQ(5, frame_id);
+  EXPECT_EQ(2, table.Size());
+
+  EXPECT_TRUE(table.Remove(1));
+  EXPECT_FALSE(table.Remove(1));
+  EXPECT_FALSE(table.Find(1, frame_id));
+  EXPECT_TRUE(table.Find(2, frame_id));
+  EXPECT_EQ(4, frame_id);
+  EXPECT_EQ(1, table.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ChurnTest) {
+  // Far more updates than there are slots, like a buffer pool that keeps evicting, so that tombstones pile up and the
+  // table has to be rebuilt over and over.
+  const size_t num_frames = 64;
+  PageTable table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::vector<page_id_t> resident;
+  std::mt19937 rng(0);
+  page_id_t next_page_id = 0;
+  for (size_t i = 0; i < 100000; i++) {
+    if (resident.size() < num_frames) {
+      auto frame_id = static_cast<frame_id_t>(rng() % num_frames);
+      table.Insert(next_page_id, frame_id);
+      expected[next_page_id] = frame_id;
+      resident.push_back(next_page_id++);
+      continue;
+    }
+    size_t victim = rng() % resident.size();
+    ASSERT_TRUE(table.Remove(resident[victim]));
+    expected.erase(resident[victim]);
+    resident[victim] = resident.back();
+    resident.pop_back();
+  }
+
+  ASSERT_EQ(expected.size(), table.Size());
+  for (page_id_t page_id = 0; page_id < next_page_id; page_id++) {
+    frame_id_t frame_id;
+    auto it = expected.find(page_id);
+    ASSERT_EQ(it != expected.end(), table.Find(page_id, frame_id));
+    if (it != expected.end()) {
+      ASSERT_EQ(it->second, frame_id);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Readers look up pages that stay in the table the whole time while a writer churns the rest of it.
+  const size_t num_frames = 64;
+  const page_id_t num_stable = 16;
+  PageTable table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 2; tid++) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+          frame_id_t frame_id;
+          ASSERT_TRUE(table.Find(page_id, frame_id));
+          ASSERT_EQ(page_id, frame_id);
+        }
+      }
+    });
+  }
+
+  std::vector<page_id_t> churn;
+  page_id_t next_page_id = num_stable;
+  for (size_t i = 0; i < 200000; i++) {
+    if (churn.size() < num_frames - num_stable) {
+      table.Insert(next_page_id, static_cast<frame_id_t>(next_page_id % num_frames));
+      churn.push_back(next_page_id++);
+    } else {
+      table.Remove(churn[i % churn.size()]);
+      churn[i % churn.size()] = churn.back();
+      churn.pop_back();
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, HitPathBenchmark) {
+  const size_t num_frames = 4096;
+  const size_t num_lookups = 2000000;
+
+  PageTable page_table(num_frames);
+  ExtendibleHashTable<page_id_t, frame_id_t> extendible_table(4);
+  // A pool that has been running for a while: its pages are not numbered 0..num_frames-1 any more.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_frames; i++) {
+    auto page_id = static_cast<page_id_t>(i * 7 + 1000);
+    page_table.Insert(page_id, static_cast<frame_id_t>(i));
+    extendible_table.Insert(page_id, static_cast<frame_id_t>(i));
+    page_ids.push_back(page_id);
+  }
+  std::mt19937 rng(0);
+  std::vector<page_id_t> lookups(num_lookups);
+  for (auto &page_id : lookups) {
+    page_id = page_ids[rng() % num_frames];
+  }
+
+  std::cout << "Cost of a page table hit, " << num_frames << " resident pages" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_threads : {1, 2, 4}) {
+    for (bool use_page_table : {false, true}) {
+      std::atomic<uint64_t> checksum{0};
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid] {
+          uint64_t sum = 0;
+          frame_id_t frame_id = 0;
+          for (size_t i = tid; i < num_lookups; i += num_threads) {
+            if (use_page_table) {
+              page_table.Find(lookups[i], frame_id);
+            } else {
+              extendible_table.Find(lookups[i], frame_id);
+            }
+            sum += frame_id;
+          }
+          checksum += sum;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << (use_page_table ? "PageTable:           " : "ExtendibleHashTable: ") << "threads=" << num_threads
+                << " ns/lookup=" << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / num_lookups
+                << " (checksum " << checksum << ")" << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
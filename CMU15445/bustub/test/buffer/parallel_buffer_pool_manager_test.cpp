@@ -0,0 +1,202 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  const page_id_t page0_id = page_id_temp;
+
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until every instance is full, and the page ids handed out by an
+  // instance always map back to that instance.
+  std::vector<page_id_t> page_ids{page0_id};
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id_temp, page->GetPageId());
+    page_ids.push_back(page_id_temp);
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(page_ids.end(), std::unique(page_ids.begin(), page_ids.end()));
+
+  // Scenario: Once all instances are full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning every page we should be able to create new pages in every instance.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago.
+  page0 = bpm->FetchPage(page0_id);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(page0_id, false));
+  EXPECT_EQ(false, bpm->UnpinPage(page0_id, false));
+
+  // Scenario: Deleting an unpinned page succeeds.
+  EXPECT_EQ(true, bpm->DeletePage(page0_id));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+namespace {
+
+/**
+ * Runs `num_threads` workers that repeatedly fetch and unpin random pages out of the resident `page_ids`.
+ * @return throughput in fetch/unpin pairs per second
+ */
+auto FetchUnpinThroughput(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                          size_t ops_per_thread) -> double {
+  std::vector<std::thread> threads;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, &page_ids, tid, ops_per_thread]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  auto dur = std::chrono::duration<double>(clock_end - clock_start).count();
+  return static_cast<double>(num_threads * ops_per_thread) / dur;
+}
+
+auto CreatePages(BufferPoolManager *bpm, size_t num_pages) -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+    page_ids.push_back(page_id);
+  }
+  return page_ids;
+}
+
+}  // namespace
+
+namespace {
+
+/** An in-memory disk that counts the writes and the syncs. */
+class SyncCountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  ~SyncCountingDiskManager() override { StopIoThreads(); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    num_page_writes_++;
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  void Sync() override { num_syncs_++; }
+
+  std::atomic<size_t> num_page_writes_{0};
+  std::atomic<int> num_syncs_{0};
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllSyncsOnceTest) {
+  const size_t num_instances = 4;
+  const size_t num_pages = 12;
+  auto disk_manager = std::make_unique<SyncCountingDiskManager>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, num_pages, disk_manager.get());
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+  // every instance wrote its pages, and one sync made all of them durable
+  EXPECT_EQ(num_pages, disk_manager->num_page_writes_);
+  EXPECT_EQ(1, disk_manager->num_syncs_);
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchUnpinScalingBenchmark) {
+  const size_t num_instances = 16;
+  const size_t pool_size_per_instance = 64;
+  const size_t ops_per_thread = 10000;
+
+  std::cout << "Fetch/unpin throughput (ops/sec) of a hit-only workload, single instance vs. " << num_instances
+            << " instances" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8, 16}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+
+    BufferPoolManagerInstance single(num_instances * pool_size_per_instance, disk_manager.get());
+    auto single_pages = CreatePages(&single, num_instances * pool_size_per_instance);
+    double single_tput = FetchUnpinThroughput(&single, single_pages, num_threads, ops_per_thread);
+
+    ParallelBufferPoolManager parallel(num_instances, pool_size_per_instance, disk_manager.get());
+    auto parallel_pages = CreatePages(&parallel, num_instances * pool_size_per_instance);
+    double parallel_tput = FetchUnpinThroughput(&parallel, parallel_pages, num_threads, ops_per_thread);
+
+    std::cout << "threads=" << num_threads << " single=" << static_cast<size_t>(single_tput)
+              << " parallel=" << static_cast<size_t>(parallel_tput) << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -688,4 +688,57 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// A hash index is populated from the table when it is created, and answers equality lookups
+TEST(CatalogTest, HashIndexInteraction) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  const std::string index_name{"index1"};
+
+  // Construct a new table with some rows in it
+  std::vector<Column> columns{{"A", TypeId::INTEGER}, {"B", TypeId::INTEGER}};
+  Schema table_schema{columns};
+  auto *table_info = catalog->CreateTable(nullptr, table_name, table_schema);
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)}, &table_schema};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+    rids.push_back(rid);
+  }
+
+  // Construct a hash index on A
+  std::vector<Column> key_columns{{"A", TypeId::INTEGER}};
+  std::vector<uint32_t> key_attrs{0};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      txn.get(), index_name, table_name, table_schema, key_schema, key_attrs, 4, HashFunction<GenericKey<4>>{},
+      IndexType::HashTableIndex);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  EXPECT_EQ(IndexType::HashTableIndex, index_info->index_type_);
+  auto *index = index_info->index_.get();
+
+  // Every row is in the index
+  for (int i = 0; i < 1000; i++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(-i)}, &table_schema};
+    const Tuple index_key = tuple.KeyFromTuple(table_info->schema_, *index->GetKeySchema(), index->GetKeyAttrs());
+    std::vector<RID> results{};
+    index->ScanKey(index_key, &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(rids[i], results[0]);
+
+    index->DeleteEntry(index_key, rids[i], txn.get());
+    results.clear();
+    index->ScanKey(index_key, &results, txn.get());
+    EXPECT_TRUE(results.empty());
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_test.cpp
+//
+// Identification: test/common/thread_pool_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ThreadPoolTest, RunTest) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.NumWorkers());
+  for (size_t num_tasks : {0, 1, 3, 100}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    std::vector<std::atomic<int>> busy(pool.NumWorkers());
+    pool.Run(num_tasks, [&](size_t worker, size_t task) {
+      // the tasks of one worker never overlap
+      EXPECT_EQ(0, busy[worker]++);
+      runs[task]++;
+      busy[worker]--;
+    });
+    for (const auto &run : runs) {
+      EXPECT_EQ(1, run);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ThreadPoolTest, StealTest) {
+  ThreadPool pool(2);
+  // worker 0 is dealt the first half and gets stuck on its first task, so worker 1 must steal the rest of it
+  std::atomic<int> done{0};
+  pool.Run(10, [&](size_t /* worker */, size_t task) {
+    if (task == 0) {
+      while (done < 9) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    done++;
+  });
+  EXPECT_EQ(10, done);
+}
+
+// NOLINTNEXTLINE
+TEST(ThreadPoolTest, ExceptionTest) {
+  ThreadPool pool(3);
+  std::atomic<int> runs{0};
+  EXPECT_THROW(pool.Run(30,
+                        [&](size_t /* worker */, size_t task) {
+                          runs++;
+                          if (task == 5) {
+                            throw std::runtime_error("task failed");
+                          }
+                        }),
+               std::runtime_error);
+  EXPECT_LE(runs, 30);
+  // the pool stays usable
+  runs = 0;
+  pool.Run(30, [&](size_t /* worker */, size_t /* task */) { runs++; });
+  EXPECT_EQ(30, runs);
+}
+
+}  // namespace bustub
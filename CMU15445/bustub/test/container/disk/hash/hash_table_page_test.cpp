@@ -10,20 +10,28 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
+#include "container/hash/hash_function.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/index/generic_key.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_swiss_page.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +65,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -114,4 +122,132 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, SwissPageSampleTest) {
+  // the page size macros are written in terms of these
+  using KeyType = int;
+  using ValueType = int;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  HashFunction<int> hash_fn;
+
+  page_id_t swiss_page_id = INVALID_PAGE_ID;
+  auto swiss_page = reinterpret_cast<HashTableSwissPage<int, int, IntComparator> *>(
+      bpm->NewPage(&swiss_page_id, nullptr)->GetData());
+  EXPECT_TRUE(swiss_page->IsEmpty());
+  EXPECT_EQ(SWISS_ARRAY_SIZE, swiss_page->NextReadable(0));
+
+  // fill the page up, with two values for every key
+  const int num_keys = SWISS_ARRAY_SIZE / 2;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(swiss_page->Insert(i, i, hash_fn.GetHash(i), IntComparator()));
+    EXPECT_TRUE(swiss_page->Insert(i, -i - 1, hash_fn.GetHash(i), IntComparator()));
+    EXPECT_FALSE(swiss_page->Insert(i, i, hash_fn.GetHash(i), IntComparator()));
+  }
+  EXPECT_EQ(2 * num_keys, swiss_page->NumReadable());
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> result;
+    bool probe_ended = false;
+    EXPECT_TRUE(swiss_page->GetValue(i, hash_fn.GetHash(i), IntComparator(), &result, &probe_ended));
+    std::sort(result.begin(), result.end());
+    EXPECT_EQ((std::vector<int>{-i - 1, i}), result);
+  }
+  std::vector<int> result;
+  EXPECT_FALSE(swiss_page->GetValue(num_keys, hash_fn.GetHash(num_keys), IntComparator(), &result));
+
+  // every readable slot is visited once by NextReadable
+  uint32_t num_readable = 0;
+  for (uint32_t idx = swiss_page->NextReadable(0); idx < SWISS_ARRAY_SIZE; idx = swiss_page->NextReadable(idx + 1)) {
+    EXPECT_TRUE(swiss_page->IsReadable(idx));
+    num_readable++;
+  }
+  EXPECT_EQ(swiss_page->NumReadable(), num_readable);
+
+  // remove the negative values, the others are still found after the deleted slots
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(swiss_page->Remove(i, -i - 1, hash_fn.GetHash(i), IntComparator()));
+    EXPECT_FALSE(swiss_page->Remove(i, -i - 1, hash_fn.GetHash(i), IntComparator()));
+  }
+  EXPECT_EQ(num_keys, swiss_page->NumReadable());
+  for (int i = 0; i < num_keys; i++) {
+    result.clear();
+    EXPECT_TRUE(swiss_page->GetValue(i, hash_fn.GetHash(i), IntComparator(), &result));
+    EXPECT_EQ(std::vector<int>{i}, result);
+  }
+
+  swiss_page->Clear();
+  EXPECT_TRUE(swiss_page->IsEmpty());
+  EXPECT_EQ(0, swiss_page->NumDeleted());
+  EXPECT_FALSE(swiss_page->GetValue(0, hash_fn.GetHash(0), IntComparator(), &result, nullptr));
+
+  bpm->UnpinPage(swiss_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, ProbeBenchmark) {
+  using KeyType = GenericKey<8>;
+  using ValueType = RID;
+  using SwissPage = HashTableSwissPage<GenericKey<8>, RID, GenericComparator<8>>;
+  using BucketPage = HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+  const int64_t num_probes = 100000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  HashFunction<GenericKey<8>> hash_fn;
+  auto swiss_data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+  auto bucket_data = std::make_unique<char[]>(BUSTUB_PAGE_SIZE);
+  auto *swiss_page = reinterpret_cast<SwissPage *>(swiss_data.get());
+  auto *bucket_page = reinterpret_cast<BucketPage *>(bucket_data.get());
+
+  // keys [0, num_keys) are in the page, keys past them are misses
+  auto probes_per_second = [&](int64_t num_keys, bool hit, auto &&probe) {
+    GenericKey<8> index_key;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < num_probes; i++) {
+      int64_t key = hit ? i % num_keys : num_keys + i % num_keys;
+      index_key.SetFromInteger(key);
+      std::vector<RID> result;
+      found += static_cast<size_t>(probe(index_key, &result));
+    }
+    auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(hit ? num_probes : 0, found);
+    return num_probes * 1000000 / std::max<int64_t>(micros, 1);
+  };
+
+  std::cout << "Probes of a page of bigint keys at increasing load factors" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (double load_factor : {0.5, 0.75, 0.9, 0.95}) {
+    std::fill_n(swiss_data.get(), BUSTUB_PAGE_SIZE, 0);
+    std::fill_n(bucket_data.get(), BUSTUB_PAGE_SIZE, 0);
+    auto num_swiss_keys = static_cast<int64_t>(load_factor * SWISS_ARRAY_SIZE);
+    auto num_bucket_keys = static_cast<int64_t>(load_factor * BUCKET_ARRAY_SIZE);
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_swiss_keys; key++) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(swiss_page->Insert(index_key, RID(key), hash_fn.GetHash(index_key), comparator));
+    }
+    for (int64_t key = 0; key < num_bucket_keys; key++) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(bucket_page->Insert(index_key, RID(key), comparator));
+    }
+    for (bool hit : {true, false}) {
+      auto swiss = probes_per_second(num_swiss_keys, hit, [&](const GenericKey<8> &key, std::vector<RID> *result) {
+        return swiss_page->GetValue(key, hash_fn.GetHash(key), comparator, result);
+      });
+      auto bitmap = probes_per_second(num_bucket_keys, hit, [&](const GenericKey<8> &key, std::vector<RID> *result) {
+        return bucket_page->GetValue(key, comparator, result);
+      });
+      std::cout << "load=" << load_factor << " " << (hit ? "hits" : "misses") << " swiss probes/s=" << swiss
+                << " bitmap probes/s=" << bitmap << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
@@ -10,6 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <numeric>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -18,13 +23,14 @@
 #include "container/disk/hash/disk_extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-
-// NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +123,139 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // enough keys to split the first bucket many times over
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i;
+  }
+  ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res)) << "Failed to keep " << i;
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+
+  // removing every key merges the buckets back into one
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  // every thread inserts its own keys while looking up those of the others, then removes the odd ones
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t * keys_per_thread; i < (t + 1) * keys_per_thread; i++) {
+        ASSERT_TRUE(ht.Insert(nullptr, i, i));
+        std::vector<int> res;
+        ht.GetValue(nullptr, (i + keys_per_thread) % (num_threads * keys_per_thread), &res);
+        ASSERT_LE(res.size(), 1);
+      }
+      for (int i = t * keys_per_thread + 1; i < (t + 1) * keys_per_thread; i += 2) {
+        ASSERT_TRUE(ht.Remove(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i % 2 == 0) {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+      EXPECT_EQ(i, res[0]);
+    } else {
+      EXPECT_EQ(0, res.size()) << "Failed to remove " << i;
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, PointLookupBenchmark) {
+  const int64_t num_keys = 50000;
+  const int64_t num_lookups = 500000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+  // the header page the tree keeps its root in comes first
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>> ht("foo_hash", bpm, comparator,
+                                                                       HashFunction<GenericKey<8>>());
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+  auto *transaction = new Transaction(0);
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(ht.Insert(nullptr, index_key, RID(key)));
+    ASSERT_TRUE(tree.Insert(index_key, RID(key), transaction));
+  }
+
+  std::mt19937 rng(7);
+  std::vector<int64_t> probes(num_lookups);
+  for (auto &probe : probes) {
+    probe = rng() % num_keys;
+  }
+  auto lookups_per_second = [&](auto &&lookup) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto probe : probes) {
+      index_key.SetFromInteger(probe);
+      std::vector<RID> result;
+      lookup(index_key, &result);
+      ASSERT_EQ(1, result.size());
+    }
+    auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_lookups * 1000000 / std::max<int64_t>(micros, 1) << std::endl;
+  };
+  std::cout << "Random point lookups on " << num_keys << " bigint keys" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "extendible hash lookups/s=";
+  lookups_per_second([&](const GenericKey<8> &key, std::vector<RID> *result) { ht.GetValue(nullptr, key, result); });
+  std::cout << "b+ tree lookups/s=";
+  lookups_per_second([&](const GenericKey<8> &key, std::vector<RID> *result) { tree.GetValue(key, result); });
+  std::cout << ">>> END" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,301 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/disk/hash/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/disk/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+namespace {
+// the page size macros are written in terms of these
+using KeyType = int;
+using ValueType = int;
+
+using IntTable = LinearProbeHashTable<int, int, IntComparator>;
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+  // rounded up to whole blocks
+  EXPECT_EQ((1000 + SWISS_ARRAY_SIZE - 1) / SWISS_ARRAY_SIZE * SWISS_ARRAY_SIZE, ht.GetSize());
+
+  // insert a few values, each key with a second value
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ((std::vector<int>{i, 2 * i + 1}), res);
+  }
+
+  // remove the first values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(std::vector<int>{2 * i + 1}, res);
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 5, &res));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, GrowTest) {
+  const int num_keys = 20000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  EXPECT_EQ(SWISS_ARRAY_SIZE, ht.GetSize());
+
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    // the pairs are found whether or not they have been moved yet
+    if (i % 97 == 0) {
+      for (int j = 0; j <= i; j += 89) {
+        std::vector<int> res;
+        ASSERT_TRUE(ht.GetValue(nullptr, j, &res));
+        ASSERT_EQ(std::vector<int>{j}, res);
+      }
+    }
+  }
+  ht.FinishResize();
+  EXPECT_FALSE(ht.IsResizing());
+  EXPECT_GE(ht.GetSize(), num_keys);
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+
+  auto stats = ht.GetProbeStats();
+  EXPECT_EQ(num_keys, stats.num_entries_);
+  EXPECT_EQ(ht.GetSize(), stats.num_slots_);
+  EXPECT_LE(num_keys, IntTable::MAX_LOAD_FACTOR * stats.num_slots_);
+  EXPECT_LT(stats.MeanProbeLength(), 2);
+  EXPECT_LE(stats.ProbeLengthPercentile(0.5), stats.ProbeLengthPercentile(0.99));
+
+  // an explicit resize keeps every pair
+  ht.Resize(ht.GetSize());
+  for (int i = 0; i < num_keys; i += 2) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.FinishResize();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_EQ(num_keys / 2, ht.GetProbeStats().num_entries_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, TombstoneTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  // churn just below the load that makes the table grow, which leaves slots marked deleted in full groups
+  auto num_keys = static_cast<int>(IntTable::MAX_LOAD_FACTOR * ht.GetSize());
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int round = 0; round < 20; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      ASSERT_TRUE(ht.Remove(nullptr, round * num_keys + i, i));
+      ASSERT_TRUE(ht.Insert(nullptr, (round + 1) * num_keys + i, i));
+    }
+    ht.FinishResize();
+    auto stats = ht.GetProbeStats();
+    EXPECT_EQ(num_keys, stats.num_entries_);
+    EXPECT_LE(stats.num_tombstones_, IntTable::MAX_TOMBSTONE_FACTOR * stats.num_slots_ + 1);
+  }
+  // rehashing at the same size kept the table from growing
+  EXPECT_EQ(SWISS_ARRAY_SIZE, ht.GetSize());
+  for (int i = 0; i < 21 * num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_EQ(i >= 20 * num_keys, ht.GetValue(nullptr, i, &res));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, OutOfFramesTest) {
+  const int num_keys = 2000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.FinishResize();
+  auto size = ht.GetSize();
+
+  // pin all frames but two, which a lookup needs, while moving a block needs more
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (bpm->NewPage(&page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  for (int i = 0; i < 2; i++) {
+    bpm->UnpinPage(pinned.back(), false);
+    pinned.pop_back();
+  }
+  ht.Resize(size / 2);
+  ASSERT_TRUE(ht.IsResizing());
+  ASSERT_EQ(size, ht.GetSize());
+  std::this_thread::sleep_for(5 * IntTable::MIGRATION_BACKOFF);
+  // the migration backs off without losing a pair
+  EXPECT_TRUE(ht.IsResizing());
+  for (int i = 0; i < num_keys; i += 7) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(std::vector<int>{i}, res);
+  }
+
+  // with no frame left every operation throws, and a failed insert gives its slot back
+  for (int i = 0; i < 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  // enough of them to fill the table if their slots were not given back
+  for (int i = 0; i <= static_cast<int>(size) - num_keys; i++) {
+    EXPECT_THROW(ht.Insert(nullptr, num_keys + i, i), Exception);
+  }
+  EXPECT_THROW(ht.Remove(nullptr, 0, 0), Exception);
+
+  for (auto id : pinned) {
+    bpm->UnpinPage(id, false);
+  }
+  ht.FinishResize();
+  EXPECT_FALSE(ht.IsResizing());
+  EXPECT_TRUE(ht.Insert(nullptr, num_keys, num_keys));
+  EXPECT_EQ(size, ht.GetSize());
+  EXPECT_EQ(num_keys + 1, ht.GetProbeStats().num_entries_);
+  for (int i = 0; i <= num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(std::vector<int>{i}, res);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // starts with a single block, so that it grows and moves blocks while the threads go on
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t] {
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        // every thread also races to insert the same shared pairs; exactly one may win each
+        ht.Insert(nullptr, -1 - i % 100, i % 100);
+        std::vector<int> res;
+        EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+      }
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        if (i % 3 == 0) {
+          EXPECT_TRUE(ht.Remove(nullptr, i, i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    std::vector<int> res;
+    if (i % 3 == 0) {
+      EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+    } else {
+      EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+      EXPECT_EQ(std::vector<int>{i}, res);
+    }
+  }
+  for (int i = 0; i < 100; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, -1 - i, &res));
+    EXPECT_EQ(std::vector<int>{i}, res);
+  }
+  ht.FinishResize();
+  EXPECT_EQ(num_threads * keys_per_thread - (num_threads * keys_per_thread + 2) / 3 + 100,
+            ht.GetProbeStats().num_entries_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(LinearProbeHashTableTest, InsertLatencyBenchmark) {
+  const int num_keys = 200000;
+  std::cout << "Inserts of " << num_keys << " int keys into a table of one block" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  // a stop-the-world resize is emulated by finishing every resize in the insert that started it
+  for (bool incremental : {true, false}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+    LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+    std::vector<int64_t> latencies(num_keys);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_keys; i++) {
+      auto insert_start = std::chrono::steady_clock::now();
+      ASSERT_TRUE(ht.Insert(nullptr, i, i));
+      if (!incremental && ht.IsResizing()) {
+        ht.FinishResize();
+      }
+      latencies[i] =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - insert_start).count();
+    }
+    auto micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::sort(latencies.begin(), latencies.end());
+    ht.FinishResize();
+    auto stats = ht.GetProbeStats();
+    std::cout << (incremental ? "incremental" : "stop-the-world")
+              << " inserts/s=" << int64_t{num_keys} * 1000000 / std::max<int64_t>(micros, 1)
+              << " p99.9 latency ns=" << latencies[num_keys * 999 / 1000] << " max latency ns=" << latencies.back()
+              << " mean probe=" << stats.MeanProbeLength() << " p99 probe=" << stats.ProbeLengthPercentile(0.99)
+              << std::endl;
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
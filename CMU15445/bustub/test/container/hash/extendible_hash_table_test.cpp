@@ -2,9 +2,18 @@
  * extendible_hash_test.cpp
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <random>
 #include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
 
+#include "common/config.h"
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 
@@ -68,4 +77,115 @@ TEST(ExtendibleHashTableTest, ConcurrentInsertTest) {
   }
 }
 
+TEST(ExtendibleHashTableTest, ConcurrentMixedTest) {
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+
+  // Every thread inserts, updates and removes its own keys while it keeps looking up everybody else's, so that
+  // lookups race with splits all the time.
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(4);
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, &table, &failed]() {
+      std::mt19937 rng(tid);
+      int value;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * num_threads + tid;
+        table->Insert(key, key);
+        table->Insert(key, -key);
+        if (!table->Find(key, value) || value != -key) {
+          failed = true;
+        }
+        int other = static_cast<int>(rng() % (keys_per_thread * num_threads));
+        if (table->Find(other, value) && value != -other && value != other) {
+          failed = true;
+        }
+        if (i % 2 == 1 && !table->Remove(key)) {
+          failed = true;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(failed);
+
+  for (int key = 0; key < keys_per_thread * num_threads; key++) {
+    int value;
+    bool kept = (key / num_threads) % 2 == 0;
+    ASSERT_EQ(kept, table->Find(key, value)) << key;
+    if (kept) {
+      EXPECT_EQ(-key, value);
+    }
+  }
+  // every directory entry points to a bucket that is at most as deep as the directory
+  for (int i = 0; i < (1 << table->GetGlobalDepth()); i++) {
+    EXPECT_LE(table->GetLocalDepth(i), table->GetGlobalDepth());
+  }
+}
+
+TEST(ExtendibleHashTableTest, MixedWorkloadBenchmark) {
+  const int num_keys = 100000;
+  const int ops_per_thread = 400000;
+
+  // The table as it was: one latch around every operation.
+  std::unordered_map<int, int> locked_map;
+  std::mutex map_latch;
+  auto table = std::make_unique<ExtendibleHashTable<int, int>>(BUCKET_SIZE);
+  for (int key = 0; key < num_keys; key += 2) {
+    table->Insert(key, key);
+    locked_map[key] = key;
+  }
+
+  std::cout << "90% Find, 10% Insert/Remove over " << num_keys << " keys, million operations per second" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (int num_threads : {1, 2, 4, 8}) {
+    for (bool use_table : {false, true}) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      std::atomic<int64_t> found{0};
+      for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid]() {
+          std::mt19937 rng(tid);
+          int64_t hits = 0;
+          int value;
+          for (int i = 0; i < ops_per_thread; i++) {
+            int key = static_cast<int>(rng() % num_keys);
+            int op = static_cast<int>(rng() % 20);
+            if (use_table) {
+              if (op == 0) {
+                table->Insert(key, key);
+              } else if (op == 1) {
+                table->Remove(key);
+              } else {
+                hits += table->Find(key, value) ? 1 : 0;
+              }
+            } else {
+              std::scoped_lock lock(map_latch);
+              if (op == 0) {
+                locked_map[key] = key;
+              } else if (op == 1) {
+                locked_map.erase(key);
+              } else {
+                hits += locked_map.count(key);
+              }
+            }
+          }
+          found += hits;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << (use_table ? "ExtendibleHashTable:    " : "single latch + hashmap: ") << "threads=" << num_threads
+                << " Mops/s=" << static_cast<double>(num_threads) * ops_per_thread / std::max<int64_t>(us.count(), 1)
+                << " (hits " << found << ")" << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
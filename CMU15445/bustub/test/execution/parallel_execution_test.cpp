@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_execution_test.cpp
+//
+// Identification: test/execution/parallel_execution_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"  // NOLINT
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, SameResultTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateTestTable();
+  RunQuery(bustub.get(), "CREATE TABLE t1 (a int, b int, c varchar(16));");
+  RunQuery(bustub.get(), "CREATE TABLE t2 (a int, d int);");
+  // enough pages for several morsels
+  const int num_rows = 20000;
+  for (int start = 0; start < num_rows; start += 1000) {
+    std::string t1_values;
+    std::string t2_values;
+    for (int i = start; i < start + 1000; i++) {
+      t1_values += fmt::format("{}({}, {}, 'v{}')", i == start ? "" : ", ", i, i % 7, i % 13);
+      // every third key of t1 joins twice, some keys of t2 are null
+      t2_values += fmt::format("{}({}, {})", i == start ? "" : ", ", i % 3 == 0 ? "null" : std::to_string(i / 2), i);
+    }
+    RunQuery(bustub.get(), fmt::format("INSERT INTO t1 VALUES {};", t1_values));
+    RunQuery(bustub.get(), fmt::format("INSERT INTO t2 VALUES {};", t2_values));
+  }
+
+  // groups come out in any order, the rows of a join in the order of the table
+  std::vector<std::pair<std::string, bool>> queries{
+      {"SELECT count(*), sum(a), min(a), max(b) FROM t1;", true},
+      {"SELECT b, count(*), count(c), sum(a), min(a), max(a) FROM t1 WHERE a > 500 AND b < 5 GROUP BY b;", true},
+      {"SELECT e, count(*), sum(f) FROM (SELECT b + 1 AS e, a - 1 AS f FROM t1 WHERE b <> 2) GROUP BY e;", true},
+      {"SELECT count(*), min(a), max(b) FROM t1 WHERE a < 0;", true},
+      {"SELECT t1.b, count(*), max(t2.d) FROM t1 INNER JOIN t2 ON t1.a = t2.a WHERE t2.d < 15000 GROUP BY t1.b;",
+       true},
+      {"SELECT count(*), sum(t3.b) FROM (t1 INNER JOIN t2 ON t1.a = t2.a) INNER JOIN t1 AS t3 ON t2.d = t3.a;", true},
+      {"SELECT * FROM t1 INNER JOIN t2 ON t1.a = t2.a;", false},
+      {"SELECT * FROM t1 LEFT JOIN t2 ON t1.a = t2.a WHERE t1.b = 3;", false},
+      // a few left rows with thousands of matches each, more than a batch holds
+      {"SELECT t2.d, t1.a FROM t2 INNER JOIN t1 ON t2.a = t1.b;", false},
+  };
+  std::vector<std::string> serial_results;
+  for (const auto &[sql, sorted] : queries) {
+    serial_results.push_back(sorted ? RunQuerySorted(bustub.get(), sql) : RunQuery(bustub.get(), sql));
+    EXPECT_FALSE(serial_results.back().empty()) << sql;
+  }
+  for (const auto *parallelism : {"2", "4"}) {
+    RunQuery(bustub.get(), fmt::format("SET parallelism = {};", parallelism));
+    for (size_t i = 0; i < queries.size(); i++) {
+      const auto &[sql, sorted] = queries[i];
+      EXPECT_EQ(serial_results[i], sorted ? RunQuerySorted(bustub.get(), sql) : RunQuery(bustub.get(), sql))
+          << "parallelism=" << parallelism << " " << sql;
+    }
+  }
+  EXPECT_EQ(fmt::format("{}\t\n", num_rows), RunQuery(bustub.get(), "SELECT count(*) FROM t1;"));
+  EXPECT_EQ("parallelism=4\t\n", RunQuery(bustub.get(), "SHOW parallelism;"));
+
+  // a bad value keeps the previous one
+  std::stringstream result;
+  auto writer = SimpleStreamWriter(result, true);
+  auto *txn = bustub->txn_manager_->Begin();
+  EXPECT_THROW(bustub->ExecuteSqlTxn("SET parallelism = 0;", writer, txn), Exception);
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  EXPECT_EQ("parallelism=4\t\n", RunQuery(bustub.get(), "SHOW parallelism;"));
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelExecutionTest, ScanJoinBenchmark) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateMockTable();
+  bustub->GenerateTestTable();
+  // TableHeap::InsertTuple walks the pages from the first one, so loading takes time quadratic in the rows
+#ifdef NDEBUG
+  const int num_rows = 50000;
+#else
+  const int num_rows = 20000;
+#endif
+  RunQuery(bustub.get(), "CREATE TABLE big (x int, y int);");
+  RunQuery(bustub.get(), "CREATE TABLE dim (x int, y int);");
+  auto load_start = std::chrono::steady_clock::now();
+  EXPECT_EQ(fmt::format("{}\t\n", num_rows),
+            RunQuery(bustub.get(), fmt::format("INSERT INTO big SELECT * FROM __mock_t4_1m LIMIT {};", num_rows)));
+  RunQuery(bustub.get(), fmt::format("INSERT INTO dim SELECT * FROM __mock_t2_100k LIMIT {};", num_rows / 10));
+
+  std::vector<std::pair<std::string, std::string>> queries{
+      {"scan", "SELECT count(*), min(x), max(y) FROM big WHERE x > 1000 AND y < 4000000;"},
+      {"group", "SELECT y, count(*) FROM (SELECT x, y FROM big WHERE x < 100) GROUP BY y;"},
+      {"join", "SELECT count(*), max(big.y), max(dim.y) FROM big INNER JOIN dim ON big.x = dim.x;"},
+  };
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "load rows=" << num_rows << " ms="
+            << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - load_start).count()
+            << std::endl;
+  for (const auto &[name, sql] : queries) {
+    std::string serial_result;
+    for (int parallelism : {1, 2, 4, 8}) {
+      RunQuery(bustub.get(), fmt::format("SET parallelism = {};", parallelism));
+      auto start = std::chrono::steady_clock::now();
+      auto result = RunQuerySorted(bustub.get(), sql);
+      auto millis =
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+      if (parallelism == 1) {
+        serial_result = result;
+      }
+      EXPECT_EQ(serial_result, result) << name << " parallelism=" << parallelism;
+      std::cout << name << " rows=" << num_rows << " parallelism=" << parallelism << " ms=" << millis
+                << " rows/s=" << int64_t{num_rows} * 1000 / std::max<int64_t>(millis, 1) << std::endl;
+    }
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
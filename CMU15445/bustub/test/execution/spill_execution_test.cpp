@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// spill_execution_test.cpp
+//
+// Identification: test/execution/spill_execution_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** Create t1 and t2, where t2 is too large for a small work_mem, has duplicate and null keys, and misses some. */
+void CreateTables(BustubInstance *bustub, int num_rows) {
+  RunQuerySorted(bustub, "CREATE TABLE t1 (a int, b varchar(32));");
+  RunQuerySorted(bustub, "CREATE TABLE t2 (a int, c varchar(32));");
+  for (int start = 0; start < num_rows; start += 1000) {
+    std::string t1_values;
+    std::string t2_values;
+    for (int i = start; i < start + 1000; i++) {
+      t1_values += fmt::format("{}({}, 'left{}')", i == start ? "" : ", ", i % 11 == 0 ? "null" : std::to_string(i), i);
+      t2_values += fmt::format("{}({}, 'right{}')", i == start ? "" : ", ", i % 5 == 0 ? "null" : std::to_string(i / 2),
+                               i);
+    }
+    RunQuerySorted(bustub, fmt::format("INSERT INTO t1 VALUES {};", t1_values));
+    RunQuerySorted(bustub, fmt::format("INSERT INTO t2 VALUES {};", t2_values));
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(SpillExecutionTest, HashJoinTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateTestTable();
+  CreateTables(bustub.get(), 10000);
+
+  // a spilled join emits its rows partition by partition, so only the sets of rows are compared
+  std::vector<std::string> queries{
+      "SELECT * FROM t1 INNER JOIN t2 ON t1.a = t2.a;",
+      "SELECT * FROM t1 LEFT JOIN t2 ON t1.a = t2.a;",
+      "SELECT t1.a, count(*) FROM t1 LEFT JOIN t2 ON t1.a = t2.a WHERE t1.a < 3000 GROUP BY t1.a;",
+      "SELECT count(*) FROM (t1 INNER JOIN t2 ON t1.a = t2.a) INNER JOIN t1 AS t3 ON t2.a = t3.a;",
+  };
+  std::vector<std::string> results;
+  for (const auto &sql : queries) {
+    results.push_back(RunQuerySorted(bustub.get(), sql));
+    EXPECT_FALSE(results.back().empty()) << sql;
+  }
+  for (const auto *parallelism : {"1", "4"}) {
+    RunQuerySorted(bustub.get(), fmt::format("SET parallelism = {};", parallelism));
+    for (const auto *work_mem : {"65536", "16384", "1"}) {
+      RunQuerySorted(bustub.get(), fmt::format("SET work_mem = {};", work_mem));
+      for (size_t i = 0; i < queries.size(); i++) {
+        EXPECT_EQ(results[i], RunQuerySorted(bustub.get(), queries[i]))
+            << "parallelism=" << parallelism << " work_mem=" << work_mem << " " << queries[i];
+      }
+    }
+  }
+
+  // a bad value keeps the previous one
+  std::stringstream result;
+  auto writer = SimpleStreamWriter(result, true);
+  auto *txn = bustub->txn_manager_->Begin();
+  EXPECT_THROW(bustub->ExecuteSqlTxn("SET work_mem = 0;", writer, txn), Exception);
+  bustub->txn_manager_->Commit(txn);
+  delete txn;
+  EXPECT_EQ("work_mem=1\t\n", RunQuerySorted(bustub.get(), "SHOW work_mem;"));
+}
+
+// NOLINTNEXTLINE
+TEST(SpillExecutionTest, SortTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateTestTable();
+  // more pages than the buffer pool has frames
+  CreateTables(bustub.get(), 20000);
+
+  // ties keep the order of the table, so the whole output is compared
+  std::vector<std::string> queries{
+      "SELECT * FROM t1 ORDER BY b;",
+      "SELECT * FROM t2 ORDER BY a DESC, c;",
+      "SELECT c, a FROM t2 ORDER BY a;",
+      "SELECT * FROM t2 ORDER BY a, c DESC LIMIT 100;",
+  };
+  std::vector<std::string> results;
+  for (const auto &sql : queries) {
+    results.push_back(RunQuery(bustub.get(), sql));
+    EXPECT_FALSE(results.back().empty()) << sql;
+  }
+  // nulls sort first, a key that compares equal keeps the order of the table
+  EXPECT_EQ(0, results[2].find("right0\t"));
+  EXPECT_NE(std::string::npos, results[2].find("\nright1\t0\t\nright2\t1\t\nright3\t1\t\nright4\t2\t\n"));
+  EXPECT_EQ(results[3], RunQuery(bustub.get(), "SELECT * FROM (SELECT * FROM t2 ORDER BY a, c DESC) LIMIT 100;"));
+  for (const auto *work_mem : {"65536", "4096", "1"}) {
+    RunQuery(bustub.get(), fmt::format("SET work_mem = {};", work_mem));
+    for (size_t i = 0; i < queries.size(); i++) {
+      EXPECT_EQ(results[i], RunQuery(bustub.get(), queries[i])) << "work_mem=" << work_mem << " " << queries[i];
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SpillExecutionTest, WideKeySortTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  // keys of over half a page, which differ only past a long common prefix
+  RunQuery(bustub.get(), "CREATE TABLE t4 (a int, b varchar(3000));");
+  const int num_rows = 200;
+  const std::string prefix(2500, 'x');
+  for (int start = 0; start < num_rows; start += 10) {
+    std::string values;
+    for (int i = start; i < start + 10; i++) {
+      values += fmt::format("{}({}, '{}{:05}')", i == start ? "" : ", ", i, prefix, i * 7 % num_rows);
+    }
+    RunQuery(bustub.get(), fmt::format("INSERT INTO t4 VALUES {};", values));
+  }
+  std::vector<int> order(num_rows);
+  for (int i = 0; i < num_rows; i++) {
+    order[i * 7 % num_rows] = i;
+  }
+  std::string expected;
+  for (auto i : order) {
+    expected += fmt::format("{}\t\n", i);
+  }
+  for (const auto *work_mem : {"67108864", "65536", "4096", "1"}) {
+    RunQuery(bustub.get(), fmt::format("SET work_mem = {};", work_mem));
+    EXPECT_EQ(expected, RunQuery(bustub.get(), "SELECT a FROM (SELECT * FROM t4 ORDER BY b);"))
+        << "work_mem=" << work_mem;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SpillExecutionTest, CreateIndexTest) {
+  // the entries of a B+ tree index are sorted within work_mem before they are loaded
+  for (const auto *work_mem : {"67108864", "4096", "1"}) {
+    auto bustub = std::make_unique<BustubInstance>();
+    RunQuery(bustub.get(), "CREATE TABLE t3 (a int, b varchar(32));");
+    const int num_rows = 20000;
+    for (int start = 0; start < num_rows; start += 1000) {
+      std::string values;
+      for (int i = start; i < start + 1000; i++) {
+        values += fmt::format("{}({}, 'row{}')", i == start ? "" : ", ", i * 7919 % num_rows, i);
+      }
+      RunQuery(bustub.get(), fmt::format("INSERT INTO t3 VALUES {};", values));
+    }
+    auto sorted = RunQuery(bustub.get(), "SELECT * FROM t3 ORDER BY a;");
+    RunQuery(bustub.get(), fmt::format("SET work_mem = {};", work_mem));
+    RunQuery(bustub.get(), "CREATE INDEX t3a ON t3(a);");
+    EXPECT_NE(std::string::npos, RunQuery(bustub.get(), "EXPLAIN SELECT * FROM t3 ORDER BY a;").find("IndexScan"));
+    EXPECT_EQ(sorted, RunQuery(bustub.get(), "SELECT * FROM t3 ORDER BY a;")) << "work_mem=" << work_mem;
+    EXPECT_EQ("4321\trow10959\t\n", RunQuery(bustub.get(), "SELECT * FROM t3 WHERE a = 4321;"));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SpillExecutionTest, AggregationTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateTestTable();
+  CreateTables(bustub.get(), 10000);
+
+  // groups come out in any order
+  std::vector<std::string> queries{
+      "SELECT a, count(*), count(c), sum(a), min(a), max(a) FROM t2 GROUP BY a;",
+      "SELECT c, count(*), max(a) FROM t2 GROUP BY c;",
+      "SELECT e, count(*) FROM (SELECT a + a AS e FROM t1) GROUP BY e;",
+      "SELECT count(*), sum(a), min(a) FROM t2;",
+      "SELECT count(*) FROM (SELECT a, count(*) AS n FROM t2 GROUP BY a) WHERE n = 2000;",
+  };
+  std::vector<std::string> results;
+  for (const auto &sql : queries) {
+    results.push_back(RunQuerySorted(bustub.get(), sql));
+    EXPECT_FALSE(results.back().empty()) << sql;
+  }
+  // the rows with a null key make one group
+  EXPECT_EQ("1\t\n", results[4]);
+  // t2 takes about 90 pages: it fits 1MB but not the smaller budgets, and in parallel its groups spill out of each
+  // worker's share of the budget before the worker tables are merged
+  for (const auto *parallelism : {"1", "4"}) {
+    RunQuery(bustub.get(), fmt::format("SET parallelism = {};", parallelism));
+    for (const auto *work_mem : {"1048576", "65536", "4096", "1"}) {
+      RunQuery(bustub.get(), fmt::format("SET work_mem = {};", work_mem));
+      for (size_t i = 0; i < queries.size(); i++) {
+        EXPECT_EQ(results[i], RunQuerySorted(bustub.get(), queries[i]))
+            << "parallelism=" << parallelism << " work_mem=" << work_mem << " " << queries[i];
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// vectorized_execution_test.cpp
+//
+// Identification: test/execution/vectorized_execution_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/config.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "query_test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** @return the rows of a query and the time it took, pulling the executors by batches or by single tuples */
+auto RunQueryTimed(BustubInstance *bustub, const std::string &sql, bool vectorized)
+    -> std::pair<std::string, int64_t> {
+  enable_vectorized_execution = vectorized;
+  auto start = std::chrono::steady_clock::now();
+  auto result = RunQuery(bustub, sql);
+  auto millis =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  enable_vectorized_execution = true;
+  return {result, millis};
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(VectorizedExecutionTest, SameResultTest) {
+  auto bustub = std::make_unique<BustubInstance>();
+  RunQuery(bustub.get(), "CREATE TABLE t1 (a int, b int, c varchar(16));");
+  RunQuery(bustub.get(), "CREATE TABLE t2 (a int, d int);");
+  // more rows than fit in one batch, so that the results span batches
+  const int num_rows = 3000;
+  for (int start = 0; start < num_rows; start += 500) {
+    std::string t1_values;
+    std::string t2_values;
+    for (int i = start; i < start + 500; i++) {
+      t1_values += fmt::format("{}({}, {}, 'v{}')", i == start ? "" : ", ", i, i % 7, i % 13);
+      // every third key of t1 joins twice, some keys of t2 are null
+      t2_values += fmt::format("{}({}, {})", i == start ? "" : ", ", i % 3 == 0 ? "null" : std::to_string(i / 2), i);
+    }
+    RunQuery(bustub.get(), fmt::format("INSERT INTO t1 VALUES {};", t1_values));
+    RunQuery(bustub.get(), fmt::format("INSERT INTO t2 VALUES {};", t2_values));
+  }
+
+  std::vector<std::string> queries{
+      "SELECT * FROM t1;",
+      "SELECT * FROM t1 WHERE a > 100 AND b < 3;",
+      "SELECT a + b, a - 1, c FROM t1 WHERE b >= 5 OR c = 'v1';",
+      "SELECT b, count(*), count(c), sum(a), min(c), max(c) FROM t1 GROUP BY b;",
+      "SELECT count(*), sum(a), min(a) FROM t1 WHERE a < 0;",
+      "SELECT * FROM t1 INNER JOIN t2 ON t1.a = t2.a;",
+      "SELECT * FROM t1 LEFT JOIN t2 ON t1.a = t2.a;",
+      "SELECT t1.b, count(*), max(t2.d) FROM t1, t2 WHERE t1.a = t2.a AND t1.b > 2 AND t2.d < 2500 GROUP BY t1.b;",
+      "SELECT * FROM t1 WHERE b = 1 LIMIT 150;",
+      "SELECT * FROM t1 LIMIT 1500;",
+  };
+  for (const auto &sql : queries) {
+    auto [tuple_result, tuple_millis] = RunQueryTimed(bustub.get(), sql, false);
+    auto [batch_result, batch_millis] = RunQueryTimed(bustub.get(), sql, true);
+    EXPECT_FALSE(tuple_result.empty()) << sql;
+    EXPECT_EQ(tuple_result, batch_result) << sql;
+  }
+  EXPECT_EQ(fmt::format("{}\t\n", num_rows), RunQuery(bustub.get(), "SELECT count(*) FROM t1;"));
+  EXPECT_EQ("0\tinteger_null\tinteger_null\t\n", RunQuery(bustub.get(), "SELECT count(*), sum(a), min(a) FROM t1 WHERE a < 0;"));
+  EXPECT_EQ("150\t\n", RunQuery(bustub.get(), "SELECT count(*) FROM (SELECT * FROM t1 WHERE b = 1 LIMIT 150);"));
+}
+
+// NOLINTNEXTLINE
+TEST(VectorizedExecutionTest, LeaderboardBenchmark) {
+  auto bustub = std::make_unique<BustubInstance>();
+  // as in the sqllogictest runner; the test table also keeps the first table page apart from the index header page
+  bustub->GenerateMockTable();
+  bustub->GenerateTestTable();
+  RunQuery(bustub.get(), "CREATE TABLE t1_50k (x int, y int);");
+  RunQuery(bustub.get(), "CREATE INDEX t1x ON t1_50k(x);");
+  EXPECT_EQ("50000\t\n", RunQuery(bustub.get(), "INSERT INTO t1_50k SELECT * FROM __mock_t1_50k;"));
+
+  // the queries of test/sql/p3.leaderboard-q*.slt
+  std::string q3_aggregates;
+  for (int i = 0; i < 8; i++) {
+    q3_aggregates += ", min(v1), max(v2), min(v2), max(v1) + min(v1), max(v2) + min(v2)";
+  }
+  std::vector<std::pair<std::string, std::string>> queries{
+      {"q1",
+       "SELECT count(*), max(t1_50k.x), max(t1_50k.y), max(__mock_t2_100k.x), max(__mock_t2_100k.y), "
+       "max(__mock_t3_1k.x), max(__mock_t3_1k.y) FROM (t1_50k INNER JOIN __mock_t2_100k ON t1_50k.x = "
+       "__mock_t2_100k.x) INNER JOIN __mock_t3_1k ON __mock_t2_100k.y = __mock_t3_1k.y;"},
+      {"q2",
+       "SELECT count(*), max(__mock_t4_1m.x), max(__mock_t4_1m.y), max(__mock_t5_1m.x), max(__mock_t5_1m.y), "
+       "max(__mock_t6_1m.x), max(__mock_t6_1m.y) FROM (SELECT * FROM __mock_t4_1m, __mock_t5_1m WHERE "
+       "__mock_t4_1m.x = __mock_t5_1m.x), __mock_t6_1m WHERE (__mock_t6_1m.y = __mock_t5_1m.y) AND "
+       "(__mock_t4_1m.y >= 1000000) AND (__mock_t4_1m.y < 1500000) AND (__mock_t6_1m.x < 150000) AND "
+       "(__mock_t6_1m.x >= 100000);"},
+      {"q3",
+       "SELECT v, d1, d2 FROM (SELECT v, max(v1) AS d1, max(v1) + max(v1) + max(v2) AS d2" + q3_aggregates +
+           " FROM __mock_t7 LEFT JOIN (SELECT v4 FROM __mock_t8 WHERE 1 == 2) ON v < v4 GROUP BY v);"},
+  };
+#ifndef NDEBUG
+  // q2 and q3 take minutes in a sanitized debug build, whose timings say little anyway
+  queries.resize(1);
+#endif
+  std::cout << "<<< BEGIN" << std::endl;
+  for (const auto &[name, sql] : queries) {
+    auto [tuple_result, tuple_millis] = RunQueryTimed(bustub.get(), sql, false);
+    auto [batch_result, batch_millis] = RunQueryTimed(bustub.get(), sql, true);
+    EXPECT_FALSE(tuple_result.empty()) << name;
+    EXPECT_EQ(tuple_result, batch_result) << name;
+    std::cout << name << " tuple-at-a-time ms=" << tuple_millis << " batch-at-a-time ms=" << batch_millis
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// query_test_util.h
+//
+// Identification: test/include/query_test_util.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** @return the rows of a query, one line each, in the order the executors produced them */
+inline auto RunQuery(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream result;
+  auto writer = SimpleStreamWriter(result, true);
+  EXPECT_TRUE(bustub->ExecuteSql(sql, writer)) << sql;
+  return result.str();
+}
+
+/** @return the rows of a query, sorted */
+inline auto RunQuerySorted(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream result{RunQuery(bustub, sql)};
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(result, line);) {
+    lines.push_back(line);
+  }
+  std::sort(lines.begin(), lines.end());
+  std::string sorted;
+  for (const auto &line : lines) {
+    sorted += line + "\n";
+  }
+  return sorted;
+}
+
+}  // namespace bustub
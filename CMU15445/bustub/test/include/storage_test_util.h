@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// storage_test_util.h
+//
+// Identification: test/include/storage_test_util.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/table_page.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** An in-memory disk whose reads and writes take as long as requests to a slow device. */
+class SlowDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  SlowDiskManager(std::chrono::microseconds read_latency, std::chrono::microseconds write_latency)
+      : read_latency_(read_latency), write_latency_(write_latency) {}
+
+  ~SlowDiskManager() override { StopIoThreads(); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    std::this_thread::sleep_for(write_latency_);
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    std::this_thread::sleep_for(read_latency_);
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+ private:
+  std::chrono::microseconds read_latency_;
+  std::chrono::microseconds write_latency_;
+};
+
+/** Builds a chain of full table pages holding num_rows two-column tuples, and returns the first page id. */
+inline auto BuildTable(BufferPoolManager *bpm, const Schema *schema, size_t num_rows) -> page_id_t {
+  Transaction txn(0);
+  page_id_t first_page_id;
+  auto *page = reinterpret_cast<TablePage *>(bpm->NewPage(&first_page_id));
+  page->Init(first_page_id, BUSTUB_PAGE_SIZE, INVALID_PAGE_ID, nullptr, &txn);
+  for (int64_t i = 0; i < static_cast<int64_t>(num_rows); i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetBigIntValue(i * 2)}, schema);
+    RID rid;
+    if (!page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr)) {
+      page_id_t next_page_id;
+      auto *next_page = reinterpret_cast<TablePage *>(bpm->NewPage(&next_page_id));
+      next_page->Init(next_page_id, BUSTUB_PAGE_SIZE, page->GetTablePageId(), nullptr, &txn);
+      page->SetNextPageId(next_page_id);
+      bpm->UnpinPage(page->GetTablePageId(), true);
+      page = next_page;
+      EXPECT_TRUE(page->InsertTuple(tuple, &rid, &txn, nullptr, nullptr));
+    }
+  }
+  bpm->UnpinPage(page->GetTablePageId(), true);
+  return first_page_id;
+}
+
+}  // namespace bustub
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+using BulkLoadTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+namespace {
+
+/** @return entries for the keys 2, 4, ..., 2 * n, so that odd keys can be inserted in between afterwards */
+auto EvenEntries(int64_t n) -> std::vector<std::pair<GenericKey<8>, RID>> {
+  std::vector<std::pair<GenericKey<8>, RID>> entries(n);
+  for (int64_t i = 0; i < n; i++) {
+    int64_t key = 2 * (i + 1);
+    entries[i].first.SetFromInteger(key);
+    entries[i].second.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+  }
+  return entries;
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, BulkLoadTest) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 4}, std::pair{5, 5}, std::pair{32, 16}}) {
+    for (double fill_factor : {0.5, 0.9, 1.0}) {
+      for (int64_t n : {1, 2, 7, 1000}) {
+        auto *disk_manager = new DiskManagerUnlimitedMemory();
+        auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+        page_id_t page_id;
+        bpm->NewPage(&page_id);
+        BulkLoadTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+        auto *transaction = new Transaction(0);
+
+        auto entries = EvenEntries(n);
+        ASSERT_TRUE(tree.BulkLoad(entries.cbegin(), entries.cend(), fill_factor));
+        ASSERT_FALSE(tree.BulkLoad(entries.cbegin(), entries.cend(), fill_factor));
+
+        // every key comes back, in order, from a scan and from a point lookup
+        int64_t expected = 2;
+        for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+          EXPECT_EQ(expected, (*it).second.GetSlotNum());
+          expected += 2;
+        }
+        EXPECT_EQ(2 * (n + 1), expected);
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int64_t key = 1; key <= 2 * n + 1; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids)) << key;
+        }
+
+        // the loaded tree keeps working: fill in the odd keys, then take out the even ones
+        RID rid;
+        for (int64_t key = 1; key <= 2 * n + 1; key += 2) {
+          index_key.SetFromInteger(key);
+          rid.Set(0, key);
+          EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+        }
+        for (int64_t key = 2; key <= 2 * n; key += 2) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, transaction);
+        }
+        for (int64_t key = 1; key <= 2 * n + 1; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_EQ(key % 2 == 1, tree.GetValue(index_key, &rids)) << key;
+        }
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete transaction;
+        delete bpm;
+        delete disk_manager;
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeTests, BulkLoadFillFactorTest) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto entries = EvenEntries(10000);
+
+  // Leaves of 100 entries hold at most 99 before they split: a full load packs them, and a half-full load stops at
+  // the minimum size of 50. Entries are spread evenly over the leaves, so a leaf may come out a couple short.
+  for (auto [fill_factor, leaf_size] : {std::pair{1.0, 99}, std::pair{0.5, 50}}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BulkLoadTree tree("foo_pk", bpm, comparator, 100, 100);
+    ASSERT_TRUE(tree.BulkLoad(entries.cbegin(), entries.cend(), fill_factor));
+
+    Page *page = tree.FindLeafPage(GenericKey<8>(), true);
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+    EXPECT_GE(leaf->GetSize(), leaf_size - 2);
+    EXPECT_LE(leaf->GetSize(), leaf_size);
+    page->RUnlatch();
+    bpm->UnpinPage(page->GetPageId(), false);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// Takes long under the sanitizers; run with --gtest_also_run_disabled_tests
+TEST(BPlusTreeTests, DISABLED_BulkLoadBenchmark) {  // NOLINT
+  const int64_t num_keys = 500000;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = i + 1;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  std::cout << "Building an index of " << num_keys << " random keys" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool bulk_load : {false, true}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BulkLoadTree tree("foo_pk", bpm, comparator);
+    auto *transaction = new Transaction(0);
+
+    auto clock_start = std::chrono::steady_clock::now();
+    std::vector<std::pair<GenericKey<8>, RID>> entries(num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+      entries[i].first.SetFromInteger(keys[i]);
+      entries[i].second.Set(0, static_cast<uint32_t>(keys[i]));
+    }
+    auto sort_ms = std::chrono::milliseconds(0);
+    if (bulk_load) {
+      std::sort(entries.begin(), entries.end(),
+                [&](const auto &a, const auto &b) { return comparator(a.first, b.first) < 0; });
+      sort_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - clock_start);
+      ASSERT_TRUE(tree.BulkLoad(entries.cbegin(), entries.cend()));
+    } else {
+      for (const auto &[key, rid] : entries) {
+        tree.Insert(key, rid, transaction);
+      }
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - clock_start);
+
+    int64_t count = 0;
+    for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+      count++;
+    }
+    EXPECT_EQ(num_keys, count);
+    std::cout << (bulk_load ? "sort + BulkLoad: " : "Insert:          ") << ms.count() << " ms";
+    if (bulk_load) {
+      std::cout << " (sort " << sort_ms.count() << " ms)";
+    }
+    std::cout << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -2,11 +2,14 @@
  * b_plus_tree_contention_test.cpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <future>  // NOLINT
 #include <iostream>
+#include <random>
 #include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -154,4 +157,68 @@ TEST(BPlusTreeTest, BPlusTreeContentionBenchmark2) {  // NOLINT
             << std::endl;
 }
 
+TEST(BPlusTreeTest, BPlusTreeThroughputBenchmark) {  // NOLINT
+  const int64_t num_keys = 100000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    keys[i] = i + 1;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  std::cout << "Insert and lookup throughput of " << num_keys << " random keys" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    auto *disk_manager = new DiskManagerMemory(256 << 10);  // 1GB
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    auto run = [&](bool insert) {
+      std::vector<std::thread> threads;
+      std::atomic<int64_t> found{0};
+      auto clock_start = std::chrono::steady_clock::now();
+      for (size_t tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid] {
+          Transaction transaction(static_cast<txn_id_t>(tid + 1));
+          GenericKey<8> index_key;
+          RID rid;
+          std::vector<RID> result;
+          int64_t local_found = 0;
+          for (size_t i = tid; i < keys.size(); i += num_threads) {
+            index_key.SetFromInteger(keys[i]);
+            if (insert) {
+              rid.Set(0, static_cast<uint32_t>(keys[i]));
+              tree.Insert(index_key, rid, &transaction);
+            } else {
+              result.clear();
+              local_found += tree.GetValue(index_key, &result) ? 1 : 0;
+            }
+          }
+          found += local_found;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_start);
+      if (!insert) {
+        EXPECT_EQ(num_keys, found);
+      }
+      return static_cast<int64_t>(num_keys * 1000000.0 / std::max<int64_t>(us.count(), 1));
+    };
+    int64_t inserts_per_sec = run(true);
+    int64_t lookups_per_sec = run(false);
+    std::cout << "threads=" << num_threads << " inserts/s=" << inserts_per_sec << " lookups/s=" << lookups_per_sec
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
 }  // namespace bustub
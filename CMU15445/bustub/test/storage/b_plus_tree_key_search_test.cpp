@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search_test.cpp
+//
+// Identification: test/storage/b_plus_tree_key_search_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_search.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+template <typename T>
+void CheckKeySearch(const std::string &column_type) {
+  using Search = KeySearch<GenericKey<8>, GenericComparator<8>>;
+  auto key_schema = ParseCreateStatement("a " + column_type);
+  GenericComparator<8> value_comparator(key_schema.get(), false);
+  GenericComparator<8> integer_comparator(key_schema.get());
+  ASSERT_EQ(sizeof(T), integer_comparator.IntegerKeySize());
+  ASSERT_EQ(0, value_comparator.IntegerKeySize());
+
+  // (key, value) pairs as laid out in a leaf page, with plenty of duplicates and negative keys
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int> dist(-60, 60);
+  for (int size : {0, 1, 2, 3, 7, 8, 64, 255}) {
+    std::vector<std::pair<GenericKey<8>, RID>> array(size);
+    std::vector<T> values(size);
+    for (auto &value : values) {
+      value = static_cast<T>(dist(rng));
+    }
+    std::sort(values.begin(), values.end());
+    for (int i = 0; i < size; i++) {
+      memset(array[i].first.data_, 0, sizeof(array[i].first.data_));
+      memcpy(array[i].first.data_, &values[i], sizeof(T));
+    }
+    const char *keys = size == 0 ? nullptr : reinterpret_cast<const char *>(&array[0].first);
+    for (int probe = -62; probe <= 62; probe++) {
+      GenericKey<8> key;
+      memset(key.data_, 0, sizeof(key.data_));
+      T probe_value = static_cast<T>(probe);
+      memcpy(key.data_, &probe_value, sizeof(T));
+      for (int begin : {0, std::min(1, size)}) {
+        int lower = std::lower_bound(values.begin() + begin, values.end(), probe_value) - values.begin();
+        int upper = std::upper_bound(values.begin() + begin, values.end(), probe_value) - values.begin();
+        EXPECT_EQ(lower, Search::LowerBound(keys, sizeof(array[0]), begin, size, key, integer_comparator));
+        EXPECT_EQ(upper, Search::UpperBound(keys, sizeof(array[0]), begin, size, key, integer_comparator));
+        EXPECT_EQ(lower, Search::LowerBound(keys, sizeof(array[0]), begin, size, key, value_comparator));
+        EXPECT_EQ(upper, Search::UpperBound(keys, sizeof(array[0]), begin, size, key, value_comparator));
+      }
+    }
+
+    // NULL is neither less nor greater than any key, whichever way keys are compared
+    GenericKey<8> null_key;
+    memset(null_key.data_, 0, sizeof(null_key.data_));
+    T null_value = std::numeric_limits<T>::min();
+    memcpy(null_key.data_, &null_value, sizeof(T));
+    for (int i = 0; i < size; i++) {
+      EXPECT_EQ(0, integer_comparator(array[i].first, null_key));
+      EXPECT_EQ(0, value_comparator(array[i].first, null_key));
+      EXPECT_EQ(0, integer_comparator(null_key, array[i].first));
+      EXPECT_EQ(0, value_comparator(null_key, array[i].first));
+    }
+    for (const auto &comparator : {integer_comparator, value_comparator}) {
+      EXPECT_EQ(0, Search::LowerBound(keys, sizeof(array[0]), 0, size, null_key, comparator));
+      EXPECT_EQ(size, Search::UpperBound(keys, sizeof(array[0]), 0, size, null_key, comparator));
+    }
+  }
+}
+
+/** @return point lookups per second, in random order, on a tree of num_keys keys of KeySize bytes */
+template <size_t KeySize>
+auto PointLookupsPerSecond(bool integer_key_search, int64_t num_keys) -> int64_t {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<KeySize> comparator(key_schema.get(), integer_key_search);
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> tree("foo_pk", bpm, comparator);
+  std::vector<std::pair<GenericKey<KeySize>, RID>> entries(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    entries[i].first.SetFromInteger(i);
+    entries[i].second.Set(0, static_cast<uint32_t>(i));
+  }
+  tree.BulkLoad(entries.cbegin(), entries.cend());
+
+  std::vector<int64_t> probes(num_keys);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+  for (auto &probe : probes) {
+    probe = dist(rng);
+  }
+  GenericKey<KeySize> index_key;
+  std::vector<RID> rids;
+  int64_t found = 0;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (auto probe : probes) {
+    index_key.SetFromInteger(probe);
+    rids.clear();
+    found += tree.GetValue(index_key, &rids) ? 1 : 0;
+  }
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_start);
+  EXPECT_EQ(num_keys, found);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  return static_cast<int64_t>(num_keys * 1000000.0 / std::max<int64_t>(us.count(), 1));
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, IntegerKeySearchTest) {  // NOLINT
+  CheckKeySearch<int8_t>("tinyint");
+  CheckKeySearch<int16_t>("smallint");
+  CheckKeySearch<int32_t>("int");
+  CheckKeySearch<int64_t>("bigint");
+}
+
+TEST(BPlusTreeTests, KeySearchFallbackTest) {  // NOLINT
+  // keys of more than one column, or of other types, are still compared value by value
+  for (const auto *columns : {"a bigint,b bigint", "a varchar", "a double"}) {
+    auto key_schema = ParseCreateStatement(columns);
+    GenericComparator<8> comparator(key_schema.get());
+    EXPECT_EQ(0, comparator.IntegerKeySize()) << columns;
+  }
+}
+
+TEST(BPlusTreeTests, KeySearchBenchmark) {  // NOLINT
+  const int64_t num_keys = 200000;
+  std::cout << "Point lookups on " << num_keys << " bigint keys, Value comparisons vs integer key search"
+            << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  auto report = [](size_t key_size, int64_t value_lookups, int64_t integer_lookups) {
+    std::cout << "key size=" << key_size << " value lookups/s=" << value_lookups
+              << " integer lookups/s=" << integer_lookups << std::endl;
+  };
+  report(8, PointLookupsPerSecond<8>(false, num_keys), PointLookupsPerSecond<8>(true, num_keys));
+  report(16, PointLookupsPerSecond<16>(false, num_keys), PointLookupsPerSecond<16>(true, num_keys));
+  report(32, PointLookupsPerSecond<32>(false, num_keys), PointLookupsPerSecond<32>(true, num_keys));
+  report(64, PointLookupsPerSecond<64>(false, num_keys), PointLookupsPerSecond<64>(true, num_keys));
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_multi_get_test.cpp
+//
+// Identification: test/storage/b_plus_tree_multi_get_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** @return point lookups per second on a tree of num_keys keys, probing batch_size random keys at a time */
+auto BatchedLookupsPerSecond(int64_t num_keys, size_t batch_size) -> int64_t {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  std::vector<std::pair<GenericKey<8>, RID>> entries(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    entries[i].first.SetFromInteger(i);
+    entries[i].second.Set(0, static_cast<uint32_t>(i));
+  }
+  tree.BulkLoad(entries.cbegin(), entries.cend());
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - 1);
+  std::vector<GenericKey<8>> probes(num_keys);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(dist(rng));
+  }
+  std::vector<GenericKey<8>> batch;
+  std::vector<std::vector<RID>> results;
+  std::vector<RID> rids;
+  int64_t found = 0;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t begin = 0; begin < probes.size(); begin += batch_size) {
+    if (batch_size == 1) {
+      rids.clear();
+      found += tree.GetValue(probes[begin], &rids) ? 1 : 0;
+      continue;
+    }
+    batch.assign(probes.begin() + begin, probes.begin() + std::min(begin + batch_size, probes.size()));
+    found += tree.GetValues(batch, &results);
+  }
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_start);
+  EXPECT_EQ(num_keys, found);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  return static_cast<int64_t>(num_keys * 1000000.0 / std::max<int64_t>(us.count(), 1));
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, MultiGetTest) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // small pages, so that a batch spreads over many subtrees of a tall tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  auto *transaction = new Transaction(0);
+
+  std::vector<std::vector<RID>> results;
+  std::vector<GenericKey<8>> probes(3);
+  for (auto &probe : probes) {
+    probe.SetFromInteger(1);
+  }
+  EXPECT_EQ(0, tree.GetValues(probes, &results));
+  ASSERT_EQ(3, results.size());
+  EXPECT_TRUE(std::all_of(results.begin(), results.end(), [](const auto &r) { return r.empty(); }));
+
+  // even keys only, inserted in random order
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 2000; key += 2) {
+    keys.push_back(key);
+  }
+  std::mt19937 rng(0);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key));
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // unsorted batches with absent keys, keys out of range and repeated keys, checked against GetValue
+  std::uniform_int_distribution<int64_t> dist(-10, 2010);
+  for (size_t batch_size : {1, 2, 7, 64, 1000}) {
+    probes.resize(batch_size);
+    std::vector<int64_t> probe_keys(batch_size);
+    for (size_t i = 0; i < batch_size; i++) {
+      probe_keys[i] = i % 5 == 4 ? probe_keys[i / 2] : dist(rng);
+      probes[i].SetFromInteger(probe_keys[i]);
+    }
+    size_t expected_found = 0;
+    size_t found = tree.GetValues(probes, &results, transaction);
+    ASSERT_EQ(batch_size, results.size());
+    for (size_t i = 0; i < batch_size; i++) {
+      std::vector<RID> expected;
+      expected_found += tree.GetValue(probes[i], &expected) ? 1 : 0;
+      ASSERT_EQ(expected.size(), results[i].size()) << "key " << probe_keys[i];
+      if (!expected.empty()) {
+        EXPECT_EQ(expected[0], results[i][0]);
+        EXPECT_EQ(static_cast<uint32_t>(probe_keys[i]), results[i][0].GetSlotNum());
+      }
+    }
+    EXPECT_EQ(expected_found, found);
+  }
+
+  // with too few frames for a descent the batch fails, and lets go of every page it fetched on the way
+  const size_t pool_size = 50;
+  std::vector<page_id_t> pinned(pool_size - 4);
+  for (auto &pinned_page_id : pinned) {
+    ASSERT_NE(nullptr, bpm->NewPage(&pinned_page_id));
+  }
+  EXPECT_THROW(tree.GetValues(probes, &results, transaction), std::runtime_error);
+  for (auto pinned_page_id : pinned) {
+    bpm->UnpinPage(pinned_page_id, false);
+  }
+  // every frame but the header's can be had again, once the prefetches of the batch have landed
+  pinned.resize(pool_size - 1);
+  for (auto &pinned_page_id : pinned) {
+    Page *page = bpm->NewPage(&pinned_page_id);
+    for (int retry = 0; page == nullptr && retry < 100; retry++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      page = bpm->NewPage(&pinned_page_id);
+    }
+    ASSERT_NE(nullptr, page);
+  }
+  for (auto pinned_page_id : pinned) {
+    bpm->UnpinPage(pinned_page_id, false);
+  }
+  EXPECT_GT(tree.GetValues(probes, &results, transaction), 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, MultiGetBenchmark) {  // NOLINT
+  const int64_t num_keys = 200000;
+  std::cout << "Random point lookups on " << num_keys << " bigint keys, one by one vs in sorted batches" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (size_t batch_size : {1, 16, 256, 4096}) {
+    std::cout << "batch size=" << batch_size << " lookups/s=" << BatchedLookupsPerSecond(num_keys, batch_size)
+              << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
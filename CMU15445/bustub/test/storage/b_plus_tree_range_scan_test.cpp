@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_range_scan_test.cpp
+//
+// Identification: test/storage/b_plus_tree_range_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** Compare random range scans in both directions against the same ranges of keys */
+template <typename KeyType, typename KeyComparator>
+void CheckScans(BPlusTree<KeyType, RID, KeyComparator> *tree, const std::set<int64_t> &keys, int64_t max_key,
+                std::mt19937 *rng) {
+  std::uniform_int_distribution<int64_t> key_dist(0, max_key);
+  std::uniform_int_distribution<int> coin(0, 3);
+  for (int trial = 0; trial < 200; trial++) {
+    std::optional<int64_t> low;
+    std::optional<int64_t> high;
+    if (coin(*rng) != 0) {
+      low = key_dist(*rng);
+    }
+    if (coin(*rng) != 0) {
+      high = key_dist(*rng);
+    }
+    bool low_inclusive = coin(*rng) < 2;
+    bool high_inclusive = coin(*rng) < 2;
+
+    std::vector<int64_t> expected;
+    for (auto key : keys) {
+      bool above_low = !low.has_value() || key > *low || (low_inclusive && key == *low);
+      bool below_high = !high.has_value() || key < *high || (high_inclusive && key == *high);
+      if (above_low && below_high) {
+        expected.push_back(key);
+      }
+    }
+    auto to_key = [](const std::optional<int64_t> &value) -> std::optional<KeyType> {
+      if (!value.has_value()) {
+        return std::nullopt;
+      }
+      KeyType key;
+      key.SetFromInteger(*value);
+      return key;
+    };
+
+    for (auto direction : {ScanDirection::Forward, ScanDirection::Backward}) {
+      std::vector<int64_t> scanned;
+      for (auto it = tree->Scan(to_key(low), low_inclusive, to_key(high), high_inclusive, direction); !it.IsEnd();
+           ++it) {
+        scanned.push_back((*it).second.GetSlotNum());
+      }
+      if (direction == ScanDirection::Backward) {
+        std::reverse(scanned.begin(), scanned.end());
+      }
+      ASSERT_EQ(expected, scanned) << "low=" << low.value_or(-1) << " high=" << high.value_or(-1)
+                                   << " backward=" << (direction == ScanDirection::Backward);
+    }
+  }
+}
+
+template <typename KeyType, typename KeyComparator>
+void CheckRangeScans(const KeyComparator &comparator) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // small pages, so that scans cross many leaves and backward steps go up more than one level
+  BPlusTree<KeyType, RID, KeyComparator> tree("foo_pk", bpm, comparator, 4, 4);
+  auto *transaction = new Transaction(0);
+  std::mt19937 rng(0);
+
+  KeyType index_key;
+  index_key.SetFromInteger(1);
+  EXPECT_TRUE(tree.Scan(index_key, true, std::nullopt, true).IsEnd());
+  EXPECT_TRUE(tree.Scan(std::nullopt, true, std::nullopt, true, ScanDirection::Backward).IsEnd());
+
+  // every third key, so that bounds fall both on and between keys
+  std::set<int64_t> keys;
+  std::vector<int64_t> order;
+  for (int64_t key = 0; key < 3000; key += 3) {
+    order.push_back(key);
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  for (auto key : order) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), transaction);
+    keys.insert(key);
+  }
+  CheckScans(&tree, keys, 3002, &rng);
+
+  // thin the tree out, which merges and redistributes leaves
+  std::shuffle(order.begin(), order.end(), rng);
+  for (size_t i = 0; i < order.size() * 3 / 4; i++) {
+    index_key.SetFromInteger(order[i]);
+    tree.Remove(index_key, transaction);
+    keys.erase(order[i]);
+  }
+  CheckScans(&tree, keys, 3002, &rng);
+
+  // a scan that has run out of its range equals End(), wherever it stopped
+  index_key.SetFromInteger(*keys.begin());
+  auto it = tree.Scan(std::nullopt, true, index_key, true);
+  ASSERT_FALSE(it.IsEnd());
+  ++it;
+  EXPECT_TRUE(it.IsEnd());
+  EXPECT_TRUE(it == tree.End());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, RangeScanTest) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  CheckRangeScans<GenericKey<8>>(GenericComparator<8>(key_schema.get()));
+  CheckRangeScans<VarcharKey<64>>(VarcharComparator<64>(nullptr));
+}
+
+TEST(BPlusTreeTests, EmptyTreeIteratorTest) {  // NOLINT
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<DiskManagerMemory>(100);
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(3, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm.get(), comparator);
+
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(42);
+  EXPECT_TRUE(tree.Begin().IsEnd());
+  EXPECT_TRUE(tree.Begin(index_key).IsEnd());
+  EXPECT_TRUE(tree.End().IsEnd());
+  EXPECT_TRUE(tree.Begin() == tree.End());
+
+  // a root that cannot be fetched is an error, not an empty tree
+  auto *transaction = new Transaction(0);
+  ASSERT_TRUE(tree.Insert(index_key, RID(0, 42), transaction));
+  page_id_t page_ids[2];
+  ASSERT_NE(nullptr, bpm->NewPage(&page_ids[0]));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_ids[1]));
+  std::vector<RID> rids;
+  EXPECT_THROW(tree.GetValue(index_key, &rids, transaction), std::runtime_error);
+  bpm->UnpinPage(page_ids[0], false);
+  EXPECT_TRUE(tree.GetValue(index_key, &rids, transaction));
+  bpm->UnpinPage(page_ids[1], false);
+  bpm->UnpinPage(header_page_id, true);
+  delete transaction;
+}
+
+TEST(BPlusTreeTests, RangeScanBenchmark) {  // NOLINT
+  const int64_t num_keys = 200000;
+  const int64_t range = 1000;
+  const int num_scans = 50;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(4096, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  std::vector<std::pair<GenericKey<8>, RID>> entries(num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    entries[i].first.SetFromInteger(i);
+    entries[i].second.Set(0, static_cast<uint32_t>(i));
+  }
+  tree.BulkLoad(entries.cbegin(), entries.cend());
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(0, num_keys - range);
+  std::vector<int64_t> starts(num_scans);
+  for (auto &start : starts) {
+    start = dist(rng);
+  }
+
+  // microseconds per scan of range keys: a bounded scan in either direction, or the whole index filtered by key
+  auto time_scans = [&](auto &&scan) {
+    auto clock_start = std::chrono::steady_clock::now();
+    for (auto start : starts) {
+      EXPECT_EQ(range, scan(start));
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - clock_start);
+    return us.count() / num_scans;
+  };
+  auto bounded_scan = [&](ScanDirection direction) {
+    return [&, direction](int64_t start) {
+      GenericKey<8> low;
+      GenericKey<8> high;
+      low.SetFromInteger(start);
+      high.SetFromInteger(start + range);
+      int64_t count = 0;
+      for (auto it = tree.Scan(low, true, high, false, direction); !it.IsEnd(); ++it) {
+        count++;
+      }
+      return count;
+    };
+  };
+  auto filtered_scan = [&](int64_t start) {
+    int64_t count = 0;
+    for (auto it = tree.Begin(); !it.IsEnd(); ++it) {
+      auto key = static_cast<int64_t>((*it).second.GetSlotNum());
+      count += key >= start && key < start + range ? 1 : 0;
+    }
+    return count;
+  };
+
+  std::cout << "Scans of " << range << " out of " << num_keys << " keys, microseconds per scan" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  std::cout << "forward=" << time_scans(bounded_scan(ScanDirection::Forward))
+            << " backward=" << time_scans(bounded_scan(ScanDirection::Backward))
+            << " full scan with filter=" << time_scans(filtered_scan) << std::endl;
+  std::cout << ">>> END" << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
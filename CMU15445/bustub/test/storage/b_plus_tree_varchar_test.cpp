@@ -0,0 +1,304 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_varchar_test.cpp
+//
+// Identification: test/storage/b_plus_tree_varchar_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using VarcharTree = BPlusTree<VarcharKey<64>, RID, VarcharComparator<64>>;
+
+namespace {
+
+/** @return n distinct, sorted strings that share long prefixes, as URLs or composite keys do */
+auto UrlStrings(int n) -> std::vector<std::string> {
+  std::vector<std::string> strings;
+  strings.reserve(n);
+  char buffer[64];
+  for (int i = 0; i < n; i++) {
+    snprintf(buffer, sizeof(buffer), "https://example.com/user/%07d/item/%d", i / 8, i % 8);
+    strings.emplace_back(buffer);
+  }
+  std::sort(strings.begin(), strings.end());
+  return strings;
+}
+
+auto MakeRid(int i) -> RID { return RID(i / 1000, i % 1000); }
+
+/** Shape of a tree: its height, and how many pages it is made of */
+struct TreeShape {
+  int height_{0};
+  int pages_{0};
+};
+
+template <typename KeyType, typename KeyComparator>
+auto ShapeOf(BPlusTree<KeyType, RID, KeyComparator> *tree, BufferPoolManager *bpm) -> TreeShape {
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  TreeShape shape;
+  std::queue<std::pair<page_id_t, int>> pages;
+  pages.emplace(tree->GetRootPageId(), 1);
+  while (!pages.empty()) {
+    auto [page_id, depth] = pages.front();
+    pages.pop();
+    Page *page = bpm->FetchPage(page_id);
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    shape.pages_++;
+    shape.height_ = std::max(shape.height_, depth);
+    if (!node->IsLeafPage()) {
+      auto internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        pages.emplace(internal->ValueAt(i), depth + 1);
+      }
+    }
+    bpm->UnpinPage(page_id, false);
+  }
+  return shape;
+}
+
+/** Check that exactly the strings with present[i] set are in the tree, through lookups and a scan */
+void CheckContents(VarcharTree *tree, const std::vector<std::string> &strings, const std::vector<bool> &present) {
+  VarcharKey<64> key;
+  std::vector<RID> rids;
+  std::vector<int> expected;
+  for (size_t i = 0; i < strings.size(); i++) {
+    key.SetFromString(strings[i]);
+    rids.clear();
+    ASSERT_EQ(present[i], tree->GetValue(key, &rids)) << strings[i];
+    if (present[i]) {
+      EXPECT_EQ(MakeRid(i), rids[0]);
+      expected.push_back(i);
+    }
+  }
+  size_t next = 0;
+  for (auto it = tree->Begin(); !it.IsEnd(); ++it) {
+    ASSERT_LT(next, expected.size());
+    EXPECT_EQ(strings[expected[next]], (*it).first.ToString());
+    EXPECT_EQ(MakeRid(expected[next]), (*it).second);
+    next++;
+  }
+  EXPECT_EQ(expected.size(), next);
+}
+
+}  // namespace
+
+TEST(BPlusTreeTests, VarcharSeparatorTest) {  // NOLINT
+  VarcharKey<64> left;
+  VarcharKey<64> right;
+  auto separator = [&](const std::string &l, const std::string &r) {
+    left.SetFromString(l);
+    right.SetFromString(r);
+    return VarcharComparator<64>::Separator(left, right).ToString();
+  };
+  EXPECT_EQ("b", separator("apple", "banana"));
+  EXPECT_EQ("user/1", separator("user/0999", "user/1000"));
+  EXPECT_EQ("ab", separator("a", "abc"));
+  EXPECT_EQ("a", separator("", "abc"));
+}
+
+TEST(BPlusTreeTests, VarcharInsertDeleteTest) {  // NOLINT
+  VarcharComparator<64> comparator(nullptr);
+  auto strings = UrlStrings(3000);
+
+  // small entry caps give deep trees with many splits and merges, the default fills pages by bytes
+  using LeafPage = BPlusTreeLeafPage<VarcharKey<64>, RID, VarcharComparator<64>>;
+  using InternalPage = BPlusTreeInternalPage<VarcharKey<64>, page_id_t, VarcharComparator<64>>;
+  for (auto [leaf_max_size, internal_max_size] :
+       {std::pair{4, 4}, std::pair{16, 8}, std::pair{LeafPage::DEFAULT_MAX_SIZE, InternalPage::DEFAULT_MAX_SIZE}}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    VarcharTree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+    auto *transaction = new Transaction(0);
+
+    std::vector<int> order(strings.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(leaf_max_size));
+    VarcharKey<64> key;
+    for (int i : order) {
+      key.SetFromString(strings[i]);
+      ASSERT_TRUE(tree.Insert(key, MakeRid(i), transaction));
+    }
+    key.SetFromString(strings[0]);
+    EXPECT_FALSE(tree.Insert(key, MakeRid(0), transaction));
+    std::vector<bool> present(strings.size(), true);
+    CheckContents(&tree, strings, present);
+
+    // take out two thirds, in another order, and check that the rest is still there
+    std::shuffle(order.begin(), order.end(), std::mt19937(internal_max_size));
+    for (size_t j = 0; j < order.size() * 2 / 3; j++) {
+      key.SetFromString(strings[order[j]]);
+      tree.Remove(key, transaction);
+      present[order[j]] = false;
+    }
+    CheckContents(&tree, strings, present);
+
+    // put them back, then take out everything
+    for (size_t j = 0; j < order.size() * 2 / 3; j++) {
+      key.SetFromString(strings[order[j]]);
+      ASSERT_TRUE(tree.Insert(key, MakeRid(order[j]), transaction));
+      present[order[j]] = true;
+    }
+    CheckContents(&tree, strings, present);
+    for (int i : order) {
+      key.SetFromString(strings[i]);
+      tree.Remove(key, transaction);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BPlusTreeTests, VarcharBulkLoadTest) {  // NOLINT
+  VarcharComparator<64> comparator(nullptr);
+  auto strings = UrlStrings(5000);
+
+  for (double fill_factor : {0.5, 0.9, 1.0}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    VarcharTree tree("foo_pk", bpm, comparator);
+    auto *transaction = new Transaction(0);
+
+    // load every other string, then insert the rest in between
+    std::vector<std::pair<VarcharKey<64>, RID>> entries;
+    std::vector<bool> present(strings.size(), false);
+    for (size_t i = 0; i < strings.size(); i += 2) {
+      VarcharKey<64> key;
+      key.SetFromString(strings[i]);
+      entries.emplace_back(key, MakeRid(i));
+      present[i] = true;
+    }
+    ASSERT_TRUE(tree.BulkLoad(entries.cbegin(), entries.cend(), fill_factor));
+    CheckContents(&tree, strings, present);
+
+    VarcharKey<64> key;
+    for (size_t i = 1; i < strings.size(); i += 2) {
+      key.SetFromString(strings[i]);
+      ASSERT_TRUE(tree.Insert(key, MakeRid(i), transaction));
+      present[i] = true;
+    }
+    CheckContents(&tree, strings, present);
+    for (size_t i = 0; i < strings.size(); i += 3) {
+      key.SetFromString(strings[i]);
+      tree.Remove(key, transaction);
+      present[i] = false;
+    }
+    CheckContents(&tree, strings, present);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BPlusTreeTests, VarcharPageBenchmark) {  // NOLINT
+  const int num_keys = 100000;
+  auto strings = UrlStrings(num_keys);
+  std::vector<int> order(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), std::mt19937(0));
+  std::cout << num_keys << " URL keys of " << strings[0].size()
+            << " bytes, GenericKey<64> pages vs prefix-compressed VarcharKey<64> pages" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+
+  // GenericKey<64> over a VARCHAR column, as an index on that column stores it today
+  auto key_schema = ParseCreateStatement("a varchar");
+  GenericComparator<64> generic_comparator(key_schema.get());
+  std::vector<std::pair<GenericKey<64>, RID>> generic_entries(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    Tuple tuple({ValueFactory::GetVarcharValue(strings[i])}, key_schema.get());
+    generic_entries[i].first.SetFromKey(tuple);
+    generic_entries[i].second = MakeRid(i);
+  }
+  std::vector<std::pair<VarcharKey<64>, RID>> varchar_entries(num_keys);
+  for (int i = 0; i < num_keys; i++) {
+    varchar_entries[i].first.SetFromString(strings[i]);
+    varchar_entries[i].second = MakeRid(i);
+  }
+
+  auto run = [&](const char *name, auto *tree, auto &entries, BufferPoolManager *bpm, Transaction *transaction,
+                 bool bulk_load) {
+    auto clock_start = std::chrono::steady_clock::now();
+    if (bulk_load) {
+      tree->BulkLoad(entries.cbegin(), entries.cend());
+    } else {
+      for (int i : order) {
+        tree->Insert(entries[i].first, entries[i].second, transaction);
+      }
+    }
+    auto build_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - clock_start);
+    clock_start = std::chrono::steady_clock::now();
+    std::vector<RID> rids;
+    int found = 0;
+    for (int i : order) {
+      rids.clear();
+      found += tree->GetValue(entries[i].first, &rids) ? 1 : 0;
+    }
+    auto lookup_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - clock_start);
+    EXPECT_EQ(num_keys, found);
+    TreeShape shape = ShapeOf(tree, bpm);
+    std::cout << name << (bulk_load ? " bulk load" : " inserts") << ": height=" << shape.height_
+              << " pages=" << shape.pages_ << " (" << shape.pages_ * BUSTUB_PAGE_SIZE / 1024 << " KiB)"
+              << " build=" << build_ms.count() << "ms lookups=" << lookup_ms.count() << "ms" << std::endl;
+    return shape;
+  };
+
+  for (bool bulk_load : {true, false}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(1024, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    auto *transaction = new Transaction(0);
+    BPlusTree<GenericKey<64>, RID, GenericComparator<64>> generic_tree("generic", bpm, generic_comparator);
+    VarcharTree varchar_tree("varchar", bpm, VarcharComparator<64>(nullptr));
+
+    TreeShape generic_shape = run("GenericKey<64>", &generic_tree, generic_entries, bpm, transaction, bulk_load);
+    TreeShape varchar_shape = run("VarcharKey<64>", &varchar_tree, varchar_entries, bpm, transaction, bulk_load);
+    EXPECT_LE(varchar_shape.height_, generic_shape.height_);
+    EXPECT_LT(varchar_shape.pages_ * 2, generic_shape.pages_);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub
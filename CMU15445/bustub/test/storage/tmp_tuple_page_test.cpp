@@ -10,20 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tmp_tuple_file.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
-  // There are many ways to do this assignment, and this is only one of them.
-  // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
-  // You will get full credit as long as you are correctly using a linear probe hash table.
-
+TEST(TmpTuplePageTest, BasicTest) {
   TmpTuplePage page{};
   page_id_t page_id = 15445;
   page.Init(page_id, BUSTUB_PAGE_SIZE);
@@ -41,11 +41,49 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
 
   Tuple tuple(values, &schema);
   TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
-  page.Insert(tuple, &tmp_tuple);
+  ASSERT_TRUE(page.Insert(tuple, &tmp_tuple));
 
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), BUSTUB_PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + BUSTUB_PAGE_SIZE - 4), 123);
+  ASSERT_EQ(TmpTuple(page_id, BUSTUB_PAGE_SIZE - 8), tmp_tuple);
+
+  Tuple read;
+  ASSERT_EQ(BUSTUB_PAGE_SIZE, page.Get(tmp_tuple.GetOffset(), &read));
+  ASSERT_EQ(123, read.GetValue(&schema, 0).GetAs<int32_t>());
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, FileTest) {
+  auto disk_manager = std::make_unique<DiskManagerMemory>(1000);
+  // fewer frames than the file takes pages, so that it goes through the disk
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(4, disk_manager.get());
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 64)});
+  {
+    TmpTupleFile file(bpm.get());
+    const int num_tuples = 2000;
+    for (int i = 0; i < num_tuples; i++) {
+      file.Append(Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 50, 'x'))},
+                        &schema));
+    }
+    file.FinishWriting();
+    EXPECT_EQ(num_tuples, file.NumTuples());
+    EXPECT_GT(file.NumPages(), 4);
+
+    TmpTupleFile::Reader reader(&file);
+    Tuple tuple;
+    for (int i = 0; i < num_tuples; i++) {
+      ASSERT_TRUE(reader.Next(&tuple));
+      ASSERT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      ASSERT_EQ(std::string(i % 50, 'x'), tuple.GetValue(&schema, 1).ToString());
+    }
+    EXPECT_FALSE(reader.Next(&tuple));
+  }
+  // the file unpinned and deleted its pages
+  for (int i = 0; i < 4; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
 }
 
 }  // namespace bustub
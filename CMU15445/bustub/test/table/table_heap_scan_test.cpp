@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_scan_test.cpp
+//
+// Identification: test/table/table_heap_scan_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "storage_test_util.h"  // NOLINT
+#include "test_util.h"     // NOLINT
+
+namespace bustub {
+
+namespace {
+
+/** A buffer pool that ignores prefetch hints, so that every scan waits for each page when it reaches it. */
+class NoPrefetchBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+ protected:
+  void PrefetchPgImp(page_id_t page_id, AccessType access_type) override {}
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ColdScanReadAheadBenchmark) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_rows = 50000;
+  const auto read_latency = std::chrono::microseconds(500);
+
+  auto schema = ParseCreateStatement("a bigint,b bigint");
+  SlowDiskManager disk_manager(read_latency, std::chrono::microseconds(0));
+  page_id_t first_page_id;
+  {
+    BufferPoolManagerInstance bpm(buffer_pool_size, &disk_manager);
+    first_page_id = BuildTable(&bpm, schema.get(), num_rows);
+    bpm.FlushAllPages();
+  }
+
+  std::cout << "Sequential scan of a " << num_rows << "-row table on a cold buffer pool, " << read_latency.count()
+            << "us per page read" << std::endl;
+  std::cout << "<<< BEGIN" << std::endl;
+  for (bool read_ahead : {false, true}) {
+    // A fresh buffer pool for every run, so that every page has to come from disk.
+    std::unique_ptr<BufferPoolManagerInstance> bpm;
+    if (read_ahead) {
+      bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, &disk_manager);
+    } else {
+      bpm = std::make_unique<NoPrefetchBufferPoolManager>(buffer_pool_size, &disk_manager);
+    }
+    TableHeap table_heap(bpm.get(), nullptr, nullptr, first_page_id);
+    Transaction txn(0);
+
+    size_t num_tuples = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto iter = table_heap.Begin(&txn); iter != table_heap.End(); ++iter) {
+      num_tuples++;
+    }
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_rows, num_tuples);
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    std::cout << (read_ahead ? "read-ahead:    " : "no read-ahead: ") << ms << "ms ("
+              << num_rows * 1000 / std::max<int64_t>(ms, 1) << " rows/s)" << std::endl;
+  }
+  std::cout << ">>> END" << std::endl;
+}
+
+}  // namespace bustub